@@ -0,0 +1,127 @@
+// Copyright (C) Codeplay Software Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+// Exceptions; you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://github.com/codeplaysoftware/oneapi-construction-kit/blob/main/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+/// @file
+///
+/// @brief Allocation stress benchmark for `hal::allocator_t`.
+///
+/// Usage: allocator_stress [live-allocations] [operations] [seed]
+///
+/// Fills the allocator with `live-allocations` small buffers then performs
+/// `operations` random frees and allocations of mixed sizes and alignments,
+/// reporting throughput and fragmentation statistics.
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "allocator.h"
+
+namespace {
+struct options_t {
+  size_t live = 100000;
+  size_t operations = 1000000;
+  uint64_t seed = 42;
+};
+
+void print_stats(const char *label, const hal::allocator_t &allocator) {
+  const hal::allocator_t::stats_t stats = allocator.stats();
+  std::printf(
+      "%-8s allocated: %zu blocks, %" PRIu64 " bytes; free: %zu blocks, "
+      "%" PRIu64 " bytes, largest %" PRIu64 " bytes; fragmentation %.3f\n",
+      label, stats.allocated_blocks, uint64_t(stats.allocated_bytes),
+      stats.free_blocks, uint64_t(stats.free_bytes),
+      uint64_t(stats.largest_free_block), stats.fragmentation());
+}
+}  // namespace
+
+int main(int argc, char **argv) {
+  options_t options;
+  if (argc > 1) {
+    options.live = std::strtoull(argv[1], nullptr, 10);
+  }
+  if (argc > 2) {
+    options.operations = std::strtoull(argv[2], nullptr, 10);
+  }
+  if (argc > 3) {
+    options.seed = std::strtoull(argv[3], nullptr, 10);
+  }
+
+  // 1 GiB of device memory at an arbitrary non-zero base address.
+  const hal::hal_addr_t base = 0x10000000;
+  const hal::hal_size_t size = hal::hal_size_t(1) << 30;
+  hal::allocator_t allocator(base, size);
+
+  std::mt19937_64 rng(options.seed);
+  // Mostly small buffers with an occasional large one, which is typical of
+  // kernels with many arguments.
+  auto random_size = [&]() -> hal::hal_size_t {
+    return rng() % 16 == 0 ? 4096 + rng() % (1 << 16) : 1 + rng() % 1024;
+  };
+  auto random_alignment = [&]() -> hal::hal_size_t {
+    return hal::hal_size_t(1) << (rng() % 8);
+  };
+
+  std::vector<hal::hal_addr_t> live;
+  live.reserve(options.live);
+
+  using clock = std::chrono::steady_clock;
+  auto start = clock::now();
+  for (size_t i = 0; i < options.live; i++) {
+    const hal::hal_addr_t addr =
+        allocator.alloc(random_size(), random_alignment());
+    if (addr) {
+      live.push_back(addr);
+    }
+  }
+  const std::chrono::duration<double> fill_time = clock::now() - start;
+  std::printf("fill:    %zu allocations in %.3f s\n", live.size(),
+              fill_time.count());
+  print_stats("fill:", allocator);
+
+  size_t failures = 0;
+  start = clock::now();
+  for (size_t i = 0; i < options.operations; i++) {
+    if (!live.empty() && (rng() & 1)) {
+      const size_t index = rng() % live.size();
+      allocator.free(live[index]);
+      live[index] = live.back();
+      live.pop_back();
+    } else {
+      const hal::hal_addr_t addr =
+          allocator.alloc(random_size(), random_alignment());
+      if (addr) {
+        live.push_back(addr);
+      } else {
+        failures++;
+      }
+    }
+  }
+  const std::chrono::duration<double> churn_time = clock::now() - start;
+  std::printf("churn:   %zu operations in %.3f s (%.1f ns/op), %zu failed\n",
+              options.operations, churn_time.count(),
+              churn_time.count() * 1e9 / double(options.operations), failures);
+  print_stats("churn:", allocator);
+
+  for (const hal::hal_addr_t addr : live) {
+    allocator.free(addr);
+  }
+  print_stats("drain:", allocator);
+  return allocator.available() == size ? 0 : 1;
+}
@@ -21,26 +21,51 @@
 #ifndef HAL_ALLOCATOR_H_INCLUDED
 #define HAL_ALLOCATOR_H_INCLUDED
 
+#include <array>
 #include <cassert>
+#include <cstddef>
 #include <cstdint>
-#include <set>
+#include <unordered_map>
+#include <vector>
 
 #include "hal_types.h"
 
 namespace hal {
 
+// Two level segregated fit (TLSF) allocator for device memory.
+//
+// Free blocks are binned by size into a first level of power of two classes,
+// each of which is split linearly into `sl_count` second level classes. A pair
+// of bitmaps records which bins are non-empty so a suitable free block is found
+// with a couple of bit scans rather than a walk over every block. Adjacent free
+// blocks are coalesced immediately on `free`.
+//
+// As device memory can't be accessed directly the block headers are kept on
+// the host, linked by index into `blocks`, and allocated blocks are found by
+// address through a hash map. `alloc` and `free` are therefore constant time
+// apart from the hash map lookup.
 struct allocator_t {
-  struct block_t {
-    block_t() : addr(0), is_free(true) {}
+  // snapshot of the allocator state, see `stats()`.
+  struct stats_t {
+    // sum total of all free memory.
+    hal_size_t free_bytes;
+    // sum total of all allocated memory, including padding.
+    hal_size_t allocated_bytes;
+    // size of the largest allocation which could succeed with no alignment.
+    hal_size_t largest_free_block;
+    // number of free blocks.
+    size_t free_blocks;
+    // number of live allocations.
+    size_t allocated_blocks;
 
-    // used for block ordering in the set
-    bool operator<(const block_t &rhs) const { return addr < rhs.addr; }
-
-    // block start address
-    hal_addr_t addr;
-
-    // true if this block is not yet allocated
-    bool is_free;
+    // fraction of free memory which is not part of the largest free block,
+    // zero when all free memory is contiguous and approaching one as free
+    // memory is split into many small blocks.
+    double fragmentation() const {
+      return free_bytes == 0 ? 0.0
+                             : 1.0 - static_cast<double>(largest_free_block) /
+                                         static_cast<double>(free_bytes);
+    }
   };
 
   // allocator constructed which will provide allocations within the memory
@@ -54,11 +79,19 @@ struct allocator_t {
   // reset the allocator back to blank slate state.
   void reset() {
     blocks.clear();
+    unused_blocks.clear();
+    allocated.clear();
+    fl_bitmap = 0;
+    sl_bitmap.fill(0);
+    for (auto &heads : free_heads) {
+      heads.fill(null_block);
+    }
+    free_bytes = 0;
     // create the initial free block
     block_t new_block;
     new_block.addr = addr_lo;
-    new_block.is_free = true;
-    blocks.insert(new_block);
+    new_block.size = addr_hi - addr_lo;
+    insert_free(new_block_index(new_block));
   }
 
   // request a memory allocation of `size` bytes with the specified byte
@@ -71,40 +104,28 @@ struct allocator_t {
     if (size == 0) {
       size = 1;
     }
-    auto itt = blocks.begin();
-    while (itt != blocks.end()) {
-      // search for a free block
-      auto next = std::next(itt);
-      if (!itt->is_free) {
-        itt = next;
-        continue;
-      }
-      // compute the start point
-      hal_addr_t start = block_end(itt);
-      bool underflow = start < size;
-      start -= size;
-      start &= ~(hal_addr_t(alignment) - 1lu);
-      // check if allocation will fit in this block
-      if (start < itt->addr || underflow) {
-        // this block does not have enough space, try next one
-        itt = next;
-        continue;
-      }
-      // allocation will not fit so create new block
-      block_t new_block;
-      new_block.addr = start;
-      new_block.is_free = false;
-      if (start == itt->addr) {
-        // this block has just enough space and will not be divided.
-        // remove free block so it can be replaced with a taken block.
-        blocks.erase(itt);
-      }
-      // insert new block
-      blocks.insert(new_block);
-      return start;
+    const uint32_t index = find_free(size, alignment);
+    if (index == null_block) {
+      // return nullptr
+      return 0;
+    }
+    remove_free(index);
+
+    // split off any space skipped to align the start as a new free block
+    const hal_addr_t start = align_up(blocks[index].addr, alignment);
+    uint32_t taken = index;
+    if (start != blocks[index].addr) {
+      taken = split(index, start - blocks[index].addr);
+      insert_free(index);
+    }
+    // give any space beyond the end of the allocation back
+    if (blocks[taken].size > size) {
+      insert_free(split(taken, size));
     }
-    // return nullptr
-    return 0;
+
+    blocks[taken].is_free = false;
+    allocated.emplace(start, taken);
+    return start;
   }
 
   void free(hal_addr_t ptr) {
@@ -112,88 +133,305 @@ struct allocator_t {
     if (ptr == hal_nullptr) {
       return;
     }
-    // create prototype block to search for
-    block_t proto;
-    proto.addr = ptr;
-    proto.is_free = true;
-    std::set<block_t>::iterator itt = blocks.find(proto);
+    auto itt = allocated.find(ptr);
     // check it is valid
-    assert(itt != blocks.end() && "No block with this address found in free()");
-    assert(itt->addr == ptr && "Found incorrect block in free()");
-    assert(itt->is_free == false && "Block is already free in free()");
-    if (itt != blocks.end()) {
-      // construct a new free block in place of the original.
-      // note that we cant simply change `is_free` as std::set iterators are
-      // const due to the strict ordering.
-      blocks.erase(itt);
-      blocks.insert(proto);
-      // run a pass to merge adjacent free blocks
-      consolidate();
+    assert(itt != allocated.end() &&
+           "No block with this address found in free()");
+    if (itt == allocated.end()) {
+      return;
     }
+    uint32_t index = itt->second;
+    allocated.erase(itt);
+    assert(blocks[index].is_free == false &&
+           "Block is already free in free()");
+
+    // merge with the physically adjacent blocks if they are free
+    const uint32_t next = blocks[index].next_phys;
+    if (next != null_block && blocks[next].is_free) {
+      remove_free(next);
+      merge(index, next);
+    }
+    const uint32_t prev = blocks[index].prev_phys;
+    if (prev != null_block && blocks[prev].is_free) {
+      remove_free(prev);
+      merge(prev, index);
+      index = prev;
+    }
+    insert_free(index);
   }
 
   // return the sum total of all free memory, note however that
   // memory fragmentation may impact the ability to allocate large chunks
   // even if the total memory is available.
-  hal_size_t available() const {
-    hal_size_t sum = 0;
-    auto itt = blocks.begin();
-    while (itt != blocks.end()) {
-      if (itt->is_free) {
-        sum += block_size(itt);
+  hal_size_t available() const { return free_bytes; }
+
+  // return fragmentation statistics, this walks the largest non-empty size
+  // class and so is more expensive than `available()`.
+  stats_t stats() const {
+    stats_t result;
+    result.free_bytes = free_bytes;
+    result.allocated_bytes = (addr_hi - addr_lo) - free_bytes;
+    result.largest_free_block = 0;
+    result.allocated_blocks = allocated.size();
+    result.free_blocks =
+        blocks.size() - unused_blocks.size() - allocated.size();
+    if (fl_bitmap != 0) {
+      const unsigned fl = find_last_set(fl_bitmap);
+      const unsigned sl = find_last_set(sl_bitmap[fl]);
+      for (uint32_t index = free_heads[fl][sl]; index != null_block;
+           index = blocks[index].next_free) {
+        if (blocks[index].size > result.largest_free_block) {
+          result.largest_free_block = blocks[index].size;
+        }
       }
-      itt = std::next(itt);
     }
-    return sum;
+    return result;
   }
 
  protected:
-  // return the end address of this block
-  hal_addr_t block_end(std::set<block_t>::iterator &itt) const {
-    // find the end address
-    hal_addr_t end = addr_hi;
-    auto next = std::next(itt);
-    if (next != blocks.end()) {
-      end = next->addr;
-    }
-    return end;
-  }
-
-  // compute the number of bytes in a block
-  hal_size_t block_size(std::set<block_t>::iterator &itt) const {
-    // get the end address
-    const hal_addr_t end = block_end(itt);
-    // compute the block size
-    const hal_size_t size = end - itt->addr;
-    return size;
-  }
-
-  // merge adjacent free blocks
-  void consolidate() {
-    // loop over all blocks
-    auto itt = blocks.begin();
-    for (;;) {
-      auto next = std::next(itt);
-      if (next == blocks.end()) {
-        // there are no more blocks to merge with
-        break;
+  // log2 of the number of second level classes per first level class.
+  static constexpr unsigned sl_log2 = 4;
+  static constexpr unsigned sl_count = 1u << sl_log2;
+  // sizes below this are binned linearly into first level class zero.
+  static constexpr hal_size_t small_size = hal_size_t(1) << sl_log2;
+  // enough first level classes to bin any 64-bit size.
+  static constexpr unsigned fl_count = 64 - sl_log2 + 1;
+  static constexpr uint32_t null_block = UINT32_MAX;
+
+  struct block_t {
+    // block start address
+    hal_addr_t addr = 0;
+    // number of bytes in the block
+    hal_size_t size = 0;
+    // neighbouring blocks in address order
+    uint32_t prev_phys = null_block;
+    uint32_t next_phys = null_block;
+    // neighbouring blocks in the same free list
+    uint32_t prev_free = null_block;
+    uint32_t next_free = null_block;
+    // true if this block is not yet allocated
+    bool is_free = true;
+  };
+
+  // index of the most significant set bit, `value` must not be zero.
+  static unsigned find_last_set(uint64_t value) {
+    assert(value != 0);
+#if defined(__GNUC__) || defined(__clang__)
+    return 63 - static_cast<unsigned>(__builtin_clzll(value));
+#else
+    unsigned bit = 0;
+    while (value >>= 1) {
+      bit++;
+    }
+    return bit;
+#endif
+  }
+
+  // index of the least significant set bit, `value` must not be zero.
+  static unsigned find_first_set(uint64_t value) {
+    assert(value != 0);
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<unsigned>(__builtin_ctzll(value));
+#else
+    unsigned bit = 0;
+    while (!(value & 1)) {
+      value >>= 1;
+      bit++;
+    }
+    return bit;
+#endif
+  }
+
+  static hal_addr_t align_up(hal_addr_t addr, hal_size_t alignment) {
+    return (addr + alignment - 1) & ~(hal_addr_t(alignment) - 1);
+  }
+
+  // compute the size class a block of `size` bytes is binned in.
+  static void mapping(hal_size_t size, unsigned &fl, unsigned &sl) {
+    if (size < small_size) {
+      fl = 0;
+      sl = static_cast<unsigned>(size);
+    } else {
+      const unsigned msb = find_last_set(size);
+      fl = msb - sl_log2 + 1;
+      sl = static_cast<unsigned>(size >> (msb - sl_log2)) ^ sl_count;
+    }
+  }
+
+  // find a non-empty size class at or above the one given.
+  bool next_class(unsigned &fl, unsigned &sl) const {
+    const uint64_t sl_map = sl_bitmap[fl] & (~uint64_t(0) << sl);
+    if (sl_map != 0) {
+      sl = find_first_set(sl_map);
+      return true;
+    }
+    if (fl + 1 >= fl_count) {
+      return false;
+    }
+    const uint64_t fl_map = fl_bitmap & (~uint64_t(0) << (fl + 1));
+    if (fl_map == 0) {
+      return false;
+    }
+    fl = find_first_set(fl_map);
+    sl = find_first_set(sl_bitmap[fl]);
+    return true;
+  }
+
+  // true if an allocation of `size` bytes aligned to `alignment` fits in a
+  // free block.
+  bool fits(uint32_t index, hal_size_t size, hal_size_t alignment) const {
+    const block_t &block = blocks[index];
+    const hal_addr_t start = align_up(block.addr, alignment);
+    return start >= block.addr && start - block.addr <= block.size &&
+           block.size - (start - block.addr) >= size;
+  }
+
+  // find a free block which can hold an allocation, or `null_block`.
+  uint32_t find_free(hal_size_t size, hal_size_t alignment) const {
+    // rounding the request (plus worst case alignment padding) up to the next
+    // size class means any block found is large enough without inspecting it
+    hal_size_t rounded = size + (alignment - 1);
+    bool overflow = rounded < size;
+    if (!overflow && rounded >= small_size) {
+      const hal_size_t round =
+          (hal_size_t(1) << (find_last_set(rounded) - sl_log2)) - 1;
+      overflow = rounded + round < rounded;
+      rounded += round;
+    }
+    unsigned fl, sl;
+    // first class in which every block fits, or past the last class
+    unsigned fit_fl = fl_count, fit_sl = 0;
+    if (!overflow) {
+      mapping(rounded, fit_fl, fit_sl);
+      fl = fit_fl;
+      sl = fit_sl;
+      if (next_class(fl, sl)) {
+        return free_heads[fl][sl];
+      }
+    }
+    // otherwise blocks in the classes between the request's own size class and
+    // that one may still fit, e.g. a request for all of the remaining memory or
+    // with a large alignment, so inspect each of them
+    const auto below_fit = [&] {
+      return fl < fit_fl || (fl == fit_fl && sl < fit_sl);
+    };
+    mapping(size, fl, sl);
+    while (next_class(fl, sl) && below_fit()) {
+      for (uint32_t index = free_heads[fl][sl]; index != null_block;
+           index = blocks[index].next_free) {
+        if (fits(index, size, alignment)) {
+          return index;
+        }
       }
-      // we need two free adjacent blocks in order to merge them
-      if (!itt->is_free || !next->is_free) {
-        itt = next;
-        continue;
+      if (++sl == sl_count) {
+        sl = 0;
+        if (++fl == fl_count) {
+          break;
+        }
       }
-      // erase the next block to effectively give its space back to `itt`
-      blocks.erase(next);
     }
+    return null_block;
+  }
+
+  void insert_free(uint32_t index) {
+    block_t &block = blocks[index];
+    unsigned fl, sl;
+    mapping(block.size, fl, sl);
+    block.is_free = true;
+    block.prev_free = null_block;
+    block.next_free = free_heads[fl][sl];
+    if (block.next_free != null_block) {
+      blocks[block.next_free].prev_free = index;
+    }
+    free_heads[fl][sl] = index;
+    fl_bitmap |= uint64_t(1) << fl;
+    sl_bitmap[fl] |= uint64_t(1) << sl;
+    free_bytes += block.size;
+  }
+
+  void remove_free(uint32_t index) {
+    block_t &block = blocks[index];
+    assert(block.is_free);
+    unsigned fl, sl;
+    mapping(block.size, fl, sl);
+    if (block.prev_free != null_block) {
+      blocks[block.prev_free].next_free = block.next_free;
+    } else {
+      free_heads[fl][sl] = block.next_free;
+    }
+    if (block.next_free != null_block) {
+      blocks[block.next_free].prev_free = block.prev_free;
+    }
+    if (free_heads[fl][sl] == null_block) {
+      sl_bitmap[fl] &= ~(uint64_t(1) << sl);
+      if (sl_bitmap[fl] == 0) {
+        fl_bitmap &= ~(uint64_t(1) << fl);
+      }
+    }
+    block.prev_free = null_block;
+    block.next_free = null_block;
+    free_bytes -= block.size;
+  }
+
+  // split a block in two, keeping the first `size` bytes and returning the
+  // index of a new block holding the remainder.
+  uint32_t split(uint32_t index, hal_size_t size) {
+    assert(size < blocks[index].size);
+    block_t remainder;
+    remainder.addr = blocks[index].addr + size;
+    remainder.size = blocks[index].size - size;
+    remainder.prev_phys = index;
+    remainder.next_phys = blocks[index].next_phys;
+    const uint32_t remainder_index = new_block_index(remainder);
+    if (blocks[remainder_index].next_phys != null_block) {
+      blocks[blocks[remainder_index].next_phys].prev_phys = remainder_index;
+    }
+    blocks[index].size = size;
+    blocks[index].next_phys = remainder_index;
+    return remainder_index;
+  }
+
+  // merge a block into the block physically preceding it.
+  void merge(uint32_t index, uint32_t next) {
+    assert(blocks[index].next_phys == next);
+    blocks[index].size += blocks[next].size;
+    blocks[index].next_phys = blocks[next].next_phys;
+    if (blocks[index].next_phys != null_block) {
+      blocks[blocks[index].next_phys].prev_phys = index;
+    }
+    unused_blocks.push_back(next);
+  }
+
+  uint32_t new_block_index(const block_t &block) {
+    if (!unused_blocks.empty()) {
+      const uint32_t index = unused_blocks.back();
+      unused_blocks.pop_back();
+      blocks[index] = block;
+      return index;
+    }
+    blocks.push_back(block);
+    return static_cast<uint32_t>(blocks.size() - 1);
   }
 
   // the valid address range to allocate within
   const hal_addr_t addr_lo;
   const hal_addr_t addr_hi;
 
-  // the block list
-  std::set<block_t> blocks;
+  // block headers, indexed by the links in `block_t`
+  std::vector<block_t> blocks;
+  // indices of `blocks` entries which were merged away and can be reused
+  std::vector<uint32_t> unused_blocks;
+  // allocated blocks by start address
+  std::unordered_map<hal_addr_t, uint32_t> allocated;
+
+  // bit `fl` is set if any second level class of `fl` is non-empty
+  uint64_t fl_bitmap = 0;
+  // bit `sl` of entry `fl` is set if `free_heads[fl][sl]` is non-empty
+  std::array<uint64_t, fl_count> sl_bitmap = {};
+  // heads of the free lists of each size class
+  std::array<std::array<uint32_t, sl_count>, fl_count> free_heads;
+  // sum total of all free memory
+  hal_size_t free_bytes = 0;
 };
 
 }  // namespace hal
@@ -182,6 +182,87 @@ struct hal_device_t {
   /// @return returns `false` if the operation fails otherwise `true`.
   virtual bool mem_write(hal_addr_t dst, const void *src, hal_size_t size) = 0;
 
+  /// @brief Query whether the `*_async` operations of this device may complete
+  /// after they return.
+  ///
+  /// Devices which don't override this only provide the default `*_async`
+  /// implementations, which complete synchronously, and callers should prefer
+  /// the synchronous operations.
+  ///
+  /// @return Returns `true` if asynchronous operations are supported.
+  virtual bool async_supported() const { return false; }
+
+  /// @brief Submit a kernel for execution without waiting for it to complete.
+  ///
+  /// Takes the same parameters as `kernel_exec`, `args` and the memory it
+  /// points to must remain valid until the returned event has been waited on.
+  /// Asynchronous operations may execute in any order relative to each other,
+  /// callers are responsible for waiting on events to order dependent
+  /// operations.
+  ///
+  /// @return Returns `hal_invalid_event` if the operation could not be
+  /// submitted otherwise an event which must be passed to `event_wait`.
+  virtual hal_event_t kernel_exec_async(hal_program_t program,
+                                        hal_kernel_t kernel,
+                                        const hal_ndrange_t *nd_range,
+                                        const hal_arg_t *args,
+                                        uint32_t num_args, uint32_t work_dim) {
+    return kernel_exec(program, kernel, nd_range, args, num_args, work_dim)
+               ? hal_completed_event
+               : hal_invalid_event;
+  }
+
+  /// @brief Submit a read of target memory to the host without waiting for it
+  /// to complete.
+  ///
+  /// Takes the same parameters as `mem_read`, `dst` must not be accessed until
+  /// the returned event has been waited on.
+  ///
+  /// @return Returns `hal_invalid_event` if the operation could not be
+  /// submitted otherwise an event which must be passed to `event_wait`.
+  virtual hal_event_t mem_read_async(void *dst, hal_addr_t src,
+                                     hal_size_t size) {
+    return mem_read(dst, src, size) ? hal_completed_event : hal_invalid_event;
+  }
+
+  /// @brief Submit a write of host memory to the target without waiting for it
+  /// to complete.
+  ///
+  /// Takes the same parameters as `mem_write`, `src` must remain valid until
+  /// the returned event has been waited on.
+  ///
+  /// @return Returns `hal_invalid_event` if the operation could not be
+  /// submitted otherwise an event which must be passed to `event_wait`.
+  virtual hal_event_t mem_write_async(hal_addr_t dst, const void *src,
+                                      hal_size_t size) {
+    return mem_write(dst, src, size) ? hal_completed_event : hal_invalid_event;
+  }
+
+  /// @brief Check whether an asynchronous operation has completed without
+  /// blocking.
+  ///
+  /// @param event is an event returned by one of the `*_async` operations.
+  /// @param complete is set to `true` if the operation has completed.
+  ///
+  /// @return Returns `false` if the operation fails otherwise `true`.
+  virtual bool event_poll(hal_event_t event, bool &complete) {
+    complete = true;
+    return event != hal_invalid_event;
+  }
+
+  /// @brief Wait for an asynchronous operation to complete and release its
+  /// event.
+  ///
+  /// Every event returned by the `*_async` operations must be waited on
+  /// exactly once, the event is invalid after this call.
+  ///
+  /// @param event is an event returned by one of the `*_async` operations.
+  ///
+  /// @return Returns `false` if the operation failed otherwise `true`.
+  virtual bool event_wait(hal_event_t event) {
+    return event != hal_invalid_event;
+  }
+
   /// @brief If the counter specified has an unread value, read it out.
   /// This will implicitly mark the data as read.
   ///
@@ -218,7 +299,7 @@ struct hal_device_t {
 struct hal_t {
   /// @brief Current version of the HAL API. The version number needs to be
   /// bumped any time the interface is changed.
-  static constexpr uint32_t api_version = 6;
+  static constexpr uint32_t api_version = 7;
 
   /// @brief Return generic platform information.
   ///
@@ -38,13 +38,20 @@ typedef uint64_t hal_word_t;
 typedef uint64_t hal_program_t;
 /// @brief A unique handle identifying a kernel.
 typedef uint64_t hal_kernel_t;
+/// @brief A unique handle identifying an asynchronous operation.
+typedef uint64_t hal_event_t;
 
 enum {
   hal_nullptr = 0,
   hal_invalid_program = 0,
   hal_invalid_kernel = 0,
+  hal_invalid_event = 0,
 };
 
+/// @brief Event returned by the default `*_async` implementations, which
+/// complete the operation before returning.
+constexpr hal_event_t hal_completed_event = ~hal_event_t(0);
+
 enum hal_arg_kind_t {
   hal_arg_address,
   hal_arg_value,
@@ -571,16 +571,33 @@ struct ph_middle_filter_extract<abacus_ulong, abacus_ulong> {
 template <typename T>
 struct ph_middle_filter_extract<T, abacus_ulong> {
   static void _(const T &index, T &i0, T &i1, T &i2, T &i3) {
+    using SignedType = typename TypeTraits<T>::SignedType;
     const T clampedIndex = abacus::detail::common::min(index, (abacus_ulong)16);
 
-    for (unsigned i = 0; i < TypeTraits<T>::num_elements; i++) {
-      const typename TypeTraits<T>::ElementType e = clampedIndex[i];
+    // As for the 32-bit payload, avoid gathering a lane at a time, which turns
+    // into extract/load/insert sequences and stops the backend from using the
+    // full vector width. Instead, shift a window over the payload one bit of
+    // the index at a time, from the most significant. After the level for
+    // `bit`, the following levels can only add up to `bit - 1`, so only the
+    // first `bit + 3` entries of the window are still needed. Bit 4 is only set
+    // for an index of exactly 16, when the lower bits are all clear.
+    const unsigned payloadSize = sizeof(payloadD) / sizeof(payloadD[0]);
+    T window[payloadSize];
+    for (unsigned j = 0; j < payloadSize; j++) {
+      window[j] = payloadD[j];
+    }
 
-      i0[i] = payloadD[e + 0];
-      i1[i] = payloadD[e + 1];
-      i2[i] = payloadD[e + 2];
-      i3[i] = payloadD[e + 3];
+    for (abacus_ulong bit = 16; bit != 0; bit >>= 1) {
+      const SignedType cond = (clampedIndex & bit) != 0;
+      for (unsigned j = 0; j < bit + 3 && j + bit < payloadSize; j++) {
+        window[j] = __abacus_select(window[j], window[j + bit], cond);
+      }
     }
+
+    i0 = window[0];
+    i1 = window[1];
+    i2 = window[2];
+    i3 = window[3];
   }
 };
 
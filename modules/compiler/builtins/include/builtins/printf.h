@@ -77,17 +77,18 @@ struct descriptor final {
 
 /// @brief Unpack data from a buffer and print it to the screen.
 ///
+/// The buffer starts with the 4 byte length of the data `printf` calls
+/// attempted to store, including these 8 header bytes, followed by the 4 byte
+/// length of the data which overflowed the buffer, followed by the packed
+/// `printf` calls of every work-group. Output is formatted into a host side
+/// batch and written to `stdout` in large chunks.
+///
 /// @param[in] data Buffer of data to unpack and print.
 /// @param[in] max_length Maximum length of the storage buffer `data`.
 /// @param[in] printf_calls List of printf calls descriptors that may be found
 /// in the buffer.
-/// @param[in,out] group offsets Offset into the work group chunk of the buffer
-/// to start printing. This function can be called multiple times on the same
-/// buffer, to avoid printing duplicate data start from an offset which is set
-/// on function return.
-void print(uint8_t* data, size_t max_length,
-           const std::vector<descriptor>& printf_calls,
-           std::vector<uint32_t>& group_offets);
+void print(const uint8_t* data, size_t max_length,
+           const std::vector<descriptor>& printf_calls);
 }  // namespace printf
 
 /// @}
@@ -139,17 +139,45 @@ size_t ParseSpecifier(std::string str, size_t pos, size_t &w, size_t &p,
   return i;
 }
 
+/// @brief Append a value formatted with a host `printf` format string to the
+/// output, used instead of printing directly so that output can be written in
+/// batches.
+///
+/// @param[in,out] out String to append the formatted value to.
+/// @param[in] format Format string containing only one `printf` specifier.
+/// @param[in] value The value to format.
+template <typename T>
+void AppendFormatted(std::string &out, const std::string &format, T value) {
+  char stack_buffer[128];
+  // KLOCWORK "SV.FMTSTR.GENERIC" possible false positive
+  // Possible vulnerability when the printf format string comes from the user
+  const int length =
+      std::snprintf(stack_buffer, sizeof(stack_buffer), format.c_str(), value);
+  if (length < 0) {
+    return;
+  }
+  if (static_cast<size_t>(length) < sizeof(stack_buffer)) {
+    out.append(stack_buffer, length);
+    return;
+  }
+  const size_t start = out.size();
+  out.resize(start + length + 1);
+  std::snprintf(&out[start], length + 1, format.c_str(), value);
+  out.resize(start + length);
+}
+
 /// @brief Function used to print floating point values.
 ///
 /// It uses the system `printf` for formatting unless the floating point is a
 /// NaN or infinity in which case it prints them with the formatting mandated
 /// by the OpenCL 1.2 specification.
 ///
+/// @param[in,out] out String to append the formatted value to.
 /// @param[in] partial String starting with a valid `printf` format specifier
 /// and containing only one `printf` specifier.
 /// @param[in] d The floating point valule to print.
 template <typename T>
-void PrintFloatingPoint(std::string partial, T d) {
+void PrintFloatingPoint(std::string &out, std::string partial, T d) {
 #if defined(__MINGW32__) || defined(__MINGW64__)
   // MinGW seems to follow MSVC pre-2015 formatting for %e/%E/%g/%G which did
   // not match the C++11 specification.  There is however, this method to set
@@ -197,9 +225,7 @@ void PrintFloatingPoint(std::string partial, T d) {
       }
     }
     partial.replace(start, end, f);
-    // KLOCWORK "NNTS.MUST" possible false positive
-    // Klocwork doesn't realize c_str() returns a null-terminated string
-    ::printf("%s", partial.c_str());
+    out += partial;
 #if defined(__MINGW32__) || defined(__MINGW64__)
   } else if (static_cast<T>(0) == d) {
     // On MinGW 5.3 (other versions untested) calling printf on the value 0.0
@@ -255,16 +281,14 @@ void PrintFloatingPoint(std::string partial, T d) {
       }
 
       partial.replace(start, end, f);
-      ::printf("%s", partial.c_str());
+      out += partial;
     } else {
       // All other cases work fine with MinGW printf.
-      ::printf(partial.c_str(), d);
+      AppendFormatted(out, partial, d);
     }
 #endif
   } else {
-    // KLOCWORK "SV.FMTSTR.GENERIC" possible false positive
-    // Possible vulnerability when the printf format string comes from the user
-    ::printf(partial.c_str(), d);
+    AppendFormatted(out, partial, d);
   }
 
 #if defined(__MINGW32__) || defined(__MINGW64__)
@@ -273,69 +297,69 @@ void PrintFloatingPoint(std::string partial, T d) {
 }
 }  // namespace
 
-void builtins::printf::print(uint8_t *pack, size_t max_length,
-                             const std::vector<descriptor> &printf_calls,
-                             std::vector<uint32_t> &group_offsets) {
-  uint8_t *data;
-  const size_t num_groups = group_offsets.size();
-  for (size_t i = 0; i < num_groups; ++i) {
-    data = pack + i * max_length;
-
-    // retrieve the size in bytes written to the printf buffer for
-    // the work item
-    uint32_t size;
-    std::memcpy(&size, data, 4);
-    uint32_t read = 4;  // the 4 bytes for the size
-
-    // read the amount of overflow bytes in size
-    uint32_t overflow;
-    std::memcpy(&overflow, data + read, 4);
-    read += 4;
-
-    if (size < overflow) {
-      ASSERT(size >= overflow,
-             "The printf buffer stored length is smaller than the stored "
-             "overflow length, the printf buffer is likely to be corrupt.");
-      return;
+void builtins::printf::print(const uint8_t *data, size_t max_length,
+                             const std::vector<descriptor> &printf_calls) {
+  // Output is accumulated and written in batches of roughly this many bytes
+  // rather than calling into the C library for every specifier.
+  constexpr size_t batch_size = 64 * 1024;
+  std::string out;
+  out.reserve(batch_size);
+  auto flush = [&out]() {
+    if (!out.empty()) {
+      std::fwrite(out.data(), 1, out.size(), stdout);
+      out.clear();
     }
+  };
+
+  // retrieve the size in bytes written to the printf buffer
+  uint32_t size;
+  std::memcpy(&size, data, 4);
+  uint32_t read = 4;  // the 4 bytes for the size
+
+  // read the amount of overflow bytes in size
+  uint32_t overflow;
+  std::memcpy(&overflow, data + read, 4);
+  read += 4;
+
+  if (size < overflow) {
+    ASSERT(size >= overflow,
+           "The printf buffer stored length is smaller than the stored "
+           "overflow length, the printf buffer is likely to be corrupt.");
+    return;
+  }
 
-    // adjust the size to ignore overflow
-    size = size - overflow;
+  // adjust the size to ignore overflow
+  size = size - overflow;
 
-    if (size > max_length) {
-      ASSERT(size <= max_length,
-             "The printf buffer stored length is bigger than the size of "
-             "the buffer, the buffer is likely to be corrupt.");
-      return;
-    }
+  if (size > max_length) {
+    ASSERT(size <= max_length,
+           "The printf buffer stored length is bigger than the size of "
+           "the buffer, the buffer is likely to be corrupt.");
+    return;
+  }
 
-    // If we've printed from this buffer before, start after the previous data
-    // printed
-    read = (group_offsets[i] == 0) ? read : group_offsets[i];
-    while (read < size) {
-      // read the id of the printf call
-      uint32_t id;
-      std::memcpy(&id, data + read, 4);
-      read += 4;
-
-      if (id >= printf_calls.size()) {
-        ASSERT(id < printf_calls.size(),
-               "The printf call id does not match a printf descriptor.");
-        return;
-      }
+  while (read < size) {
+    // read the id of the printf call
+    uint32_t id;
+    std::memcpy(&id, data + read, 4);
+    read += 4;
 
-      // get the printf descriptor matching this printf call
-      const builtins::printf::descriptor &printf_desc = printf_calls[id];
+    if (id >= printf_calls.size()) {
+      ASSERT(id < printf_calls.size(),
+             "The printf call id does not match a printf descriptor.");
+      break;
+    }
 
-      // if the call doesn't have any parameters just print the format string
-      if (printf_desc.types.size() == 0) {
-        ::printf("%s", printf_desc.format_string.c_str());
-        continue;
-      }
+    // get the printf descriptor matching this printf call
+    const builtins::printf::descriptor &printf_desc = printf_calls[id];
 
+    // if the call doesn't have any parameters just print the format string
+    if (printf_desc.types.size() == 0) {
+      out += printf_desc.format_string;
+    } else {
       // if the printf call has parameters we unpack them from the buffer and
-      // print them as we go, to do that we also have to split the format string
-      // in pieces containing only one specifier at a time.
+      // format them as we go, to do that we also have to split the format
+      // string in pieces containing only one specifier at a time.
       std::string partial;
       size_t previous = 0;
       size_t stringindex = 0;
@@ -352,55 +376,57 @@ void builtins::printf::print(uint8_t *pack, size_t max_length,
         partial = printf_desc.format_string.substr(previous, pos - previous);
         previous = pos;
 
-        // unpack and print the argument
-        // KLOCWORK "SV.FMTSTR.GENERIC" possible false positive
-        // Possible vulnerability when the printf format string comes from the
-        // user
+        // unpack and format the argument
         switch (ty) {
           case builtins::printf::type::DOUBLE:
             double d;
             std::memcpy(&d, data + read, 8);
-            PrintFloatingPoint(partial, d);
+            PrintFloatingPoint(out, partial, d);
             read += 8;
             break;
           case builtins::printf::type::FLOAT:
             float f;
             std::memcpy(&f, data + read, 4);
-            PrintFloatingPoint(partial, f);
+            PrintFloatingPoint(out, partial, f);
             read += 4;
             break;
           case builtins::printf::type::LONG:
             uint64_t l;
             std::memcpy(&l, data + read, 8);
-            ::printf(partial.c_str(), l);
+            AppendFormatted(out, partial, l);
             read += 8;
             break;
           case builtins::printf::type::INT:
             uint32_t i;
             std::memcpy(&i, data + read, 4);
-            ::printf(partial.c_str(), i);
+            AppendFormatted(out, partial, i);
             read += 4;
             break;
           case builtins::printf::type::SHORT:
             uint16_t s;
             std::memcpy(&s, data + read, 2);
-            ::printf(partial.c_str(), s);
+            AppendFormatted(out, partial, s);
             read += 2;
             break;
           case builtins::printf::type::CHAR:
             uint8_t c;
             std::memcpy(&c, data + read, 1);
-            ::printf(partial.c_str(), c);
+            AppendFormatted(out, partial, c);
             read += 1;
             break;
           case builtins::printf::type::STRING:
-            ::printf(partial.c_str(), printf_desc.strings[stringindex].c_str());
+            AppendFormatted(out, partial,
+                            printf_desc.strings[stringindex].c_str());
             ++stringindex;
             break;
         }
       }
     }
-    // Set offset to start printing from next time this function is called
-    group_offsets[i] = read;
+
+    if (out.size() >= batch_size) {
+      flush();
+    }
   }
+  flush();
+  std::fflush(stdout);
 }
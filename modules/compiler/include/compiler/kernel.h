@@ -23,6 +23,7 @@
 
 #include <cargo/dynamic_array.h>
 #include <cargo/expected.h>
+#include <cargo/optional.h>
 #include <compiler/result.h>
 #include <mux/mux.hpp>
 
@@ -154,6 +155,83 @@ class Kernel {
   /// this kernel.
   virtual cargo::expected<size_t, Result> queryMaxSubGroupCount() = 0;
 
+  /// @brief Queries which autotuning candidate the next enqueue of this kernel
+  /// with the given local size should be timed with.
+  ///
+  /// Autotuning is opt-in and target specific. When it is enabled a target
+  /// **may** compile a kernel in a number of alternative configurations, the
+  /// runtime times each on real launches and reports the results back with
+  /// `reportTuningDuration` until the target settles on a winner.
+  ///
+  /// @param local_size_x Local size in the x dimension.
+  /// @param local_size_y Local size in the y dimension.
+  /// @param local_size_z Local size in the z dimension.
+  ///
+  /// @return Returns the index of the candidate to time next, or
+  /// `cargo::nullopt` if autotuning is disabled or has already finished for
+  /// this local size.
+  virtual cargo::optional<uint32_t> getNextTuningCandidate(
+      size_t local_size_x, size_t local_size_y, size_t local_size_z) {
+    (void)local_size_x;
+    (void)local_size_y;
+    (void)local_size_z;
+    return cargo::nullopt;
+  }
+
+  /// @brief Creates a binary loadable by muxCreateExecutable containing this
+  /// kernel compiled with a specific autotuning candidate configuration.
+  ///
+  /// @param specialization_options Mux execution options to specialize for.
+  /// @param candidate Index of the candidate returned by
+  /// `getNextTuningCandidate`.
+  ///
+  /// @return A valid binary object if specialization was successful,
+  /// or a status code otherwise.
+  /// @retval `Result::FEATURE_UNSUPPORTED` if the kernel can't be autotuned.
+  virtual cargo::expected<cargo::dynamic_array<uint8_t>, Result>
+  createTuningCandidateKernel(
+      const mux_ndrange_options_t &specialization_options, uint32_t candidate) {
+    (void)specialization_options;
+    (void)candidate;
+    return cargo::make_unexpected(Result::FEATURE_UNSUPPORTED);
+  }
+
+  /// @brief Reports the measured device execution time of a launch of an
+  /// autotuning candidate.
+  ///
+  /// @param local_size_x Local size in the x dimension.
+  /// @param local_size_y Local size in the y dimension.
+  /// @param local_size_z Local size in the z dimension.
+  /// @param candidate Index of the candidate which was executed.
+  /// @param duration Duration of the launch in nanoseconds.
+  virtual void reportTuningDuration(size_t local_size_x, size_t local_size_y,
+                                    size_t local_size_z, uint32_t candidate,
+                                    uint64_t duration) {
+    (void)local_size_x;
+    (void)local_size_y;
+    (void)local_size_z;
+    (void)candidate;
+    (void)duration;
+  }
+
+  /// @brief Returns a human readable description of the configuration which
+  /// autotuning selected for the given local size.
+  ///
+  /// @param local_size_x Local size in the x dimension.
+  /// @param local_size_y Local size in the y dimension.
+  /// @param local_size_z Local size in the z dimension.
+  ///
+  /// @return Returns the description, or an empty string if no decision has
+  /// been made (or autotuning is disabled).
+  virtual std::string getTuningDecision(size_t local_size_x,
+                                        size_t local_size_y,
+                                        size_t local_size_z) {
+    (void)local_size_x;
+    (void)local_size_y;
+    (void)local_size_z;
+    return {};
+  }
+
   /// @brief The name of the kernel.
   const std::string name;
 
@@ -107,7 +107,10 @@ struct Options {
         prevec_mode(PreVectorizationMode::DEFAULT),
         vectorization_mode(VectorizationMode::DEFAULT),
         llvm_stats(false),
-        single_precision_constant(false) {}
+        single_precision_constant(false),
+        uniform_work_group_size(false),
+        lazy_kernels(false),
+        build_profile(false) {}
 
   /// @brief List of preprocessor macro definition.
   std::vector<std::string> definitions;
@@ -167,6 +170,15 @@ struct Options {
   std::string source_file_in;
   /// @brief Treat double constants as single-precision constants
   bool single_precision_constant;
+  /// @brief Require the global size to be a multiple of the local size, even
+  /// if the device supports non-uniform work-groups.
+  bool uniform_work_group_size;
+  /// @brief Defer the whole program optimization pipeline to each kernel's
+  /// first creation, only honoured by targets supporting deferred compilation.
+  bool lazy_kernels;
+  /// @brief Record the time spent in each stage of building the module, see
+  /// `Module::getBuildProfile`.
+  bool build_profile;
   /// @brief List of local sizes that kernel compilation pre-caching has been
   /// requested for.
   ///
@@ -183,6 +195,18 @@ struct Options {
   };
 };
 
+/// @brief Time spent in a stage of building a module.
+struct BuildProfileEntry {
+  /// @brief Name of the stage, e.g. `finalize` or the name of an LLVM pass.
+  std::string name;
+  /// @brief Nesting depth of the stage, top-level stages have a depth of zero.
+  uint32_t depth;
+  /// @brief Number of times the stage ran.
+  uint64_t count;
+  /// @brief Total time spent in the stage, in nanoseconds.
+  uint64_t duration;
+};
+
 /// @brief An input header for program compilation.
 struct InputHeader {
   /// @brief The header source code.
@@ -657,6 +681,16 @@ class Module {
 
   /// @brief Returns the current state of the compiler module.
   virtual ModuleState getState() const = 0;
+
+  /// @brief Returns the time spent in each stage of building the module since
+  /// it was last cleared, if the `build_profile` option is set.
+  ///
+  /// Each stage is followed by the stages nested within it. Repeated runs of a
+  /// stage within the same parent stage, such as a pass run on each function,
+  /// are combined into one entry.
+  ///
+  /// @return The build profile, which is empty if it wasn't recorded.
+  virtual std::vector<BuildProfileEntry> getBuildProfile() const = 0;
 };  // class Module
 
 /// @}
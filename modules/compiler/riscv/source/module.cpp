@@ -62,22 +62,24 @@ compiler::Result RiscvModule::createBinary(
   // avoid data races by locking the LLVM global mutex.
   const std::lock_guard<std::mutex> globalLock(
       compiler::utils::getLLVMGlobalMutex());
+  const compiler::BuildProfiler::Stage stage(profiler, "binary");
 
-  // Write to an Elf object
+  // Write to Elf objects, generating code for each kernel in parallel.
   auto *TM = getTargetMachine();
-  llvm::SmallVector<char, 512> objectBinary;
-  llvm::raw_svector_ostream ostream(objectBinary);
+  llvm::SmallVector<llvm::SmallVector<char, 0>, 8> objectBinaries;
 
   /// Set up an error handler to redirect fatal errors to the build log.
   const llvm::ScopedFatalErrorHandler error_handler(
       BaseModule::llvmFatalErrorHandler, this);
 
   {
+    const compiler::BuildProfiler::Stage codegen_stage(profiler, "codegen");
     compiler::Result err = compiler::Result::FAILURE;
     llvm::CrashRecoveryContext CRC;
     llvm::CrashRecoveryContext::Enable();
     const bool crashed = !CRC.RunSafely([&] {
-      err = compiler::emitCodeGenFile(*finalized_llvm_module, TM, ostream);
+      err = compiler::emitCodeGenFiles(*finalized_llvm_module, TM,
+                                       objectBinaries);
     });
     llvm::CrashRecoveryContext::Disable();
     if (crashed) {
@@ -91,9 +93,14 @@ compiler::Result RiscvModule::createBinary(
     }
   }
 
-  llvm::ArrayRef<uint8_t> inputBinary{
-      reinterpret_cast<uint8_t *>(objectBinary.data()),
-      static_cast<std::size_t>(objectBinary.size())};
+  // The objects are always linked in the same order, so the final binary
+  // doesn't depend on the number of threads which generated them.
+  llvm::SmallVector<llvm::ArrayRef<uint8_t>, 8> inputBinaries;
+  for (const auto &objectBinary : objectBinaries) {
+    inputBinaries.emplace_back(
+        reinterpret_cast<const uint8_t *>(objectBinary.data()),
+        static_cast<std::size_t>(objectBinary.size()));
+  }
 
   llvm::SmallVector<std::string, 4> lld_args;
   // Set the entry point to the zero address to avoid a linker warning. The
@@ -102,12 +109,13 @@ compiler::Result RiscvModule::createBinary(
 
   const cargo::dynamic_array<uint8_t> finalizer_binary;
   {
+    const compiler::BuildProfiler::Stage link_stage(profiler, "binary link");
     bool linkSuccess = false;
     llvm::CrashRecoveryContext CRC;
     llvm::CrashRecoveryContext::Enable();
     const bool crashed = !CRC.RunSafely([&] {
       auto linkResult = compiler::utils::lldLinkToBinary(
-          inputBinary, getTarget().riscv_hal_device_info->linker_script,
+          inputBinaries, getTarget().riscv_hal_device_info->linker_script,
           getTarget().rt_lib, getTarget().rt_lib_size, lld_args);
       if (auto E = linkResult.takeError()) {
         const std::string errStr = toString(std::move(E));
@@ -210,9 +218,11 @@ RiscvModule::createPassMachinery() {
   const compiler::utils::DeviceInfo Info = compiler::initDeviceInfoFromMux(
       getTarget().getCompilerInfo()->device_info);
 
-  auto Callback = [Builtins](const llvm::Module &) {
+  auto *Cache = getTarget().getBuiltinsLinkCache();
+
+  auto Callback = [Builtins, Cache](const llvm::Module &) {
     return compiler::utils::BuiltinInfo(
-        compiler::utils::createCLBuiltinInfo(Builtins));
+        compiler::utils::createCLBuiltinInfo(Builtins, Cache));
   };
 
   llvm::LLVMContext &Ctx = Builtins->getContext();
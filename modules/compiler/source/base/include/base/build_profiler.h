@@ -0,0 +1,142 @@
+// Copyright (C) Codeplay Software Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+// Exceptions; you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://github.com/codeplaysoftware/oneapi-construction-kit/blob/main/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+/// @file
+///
+/// @brief Profiler recording the time spent in each stage of a module build.
+
+#ifndef COMPILER_BASE_BUILD_PROFILER_H_INCLUDED
+#define COMPILER_BASE_BUILD_PROFILER_H_INCLUDED
+
+#include <compiler/module.h>
+#include <compiler/utils/pass_machinery.h>
+#include <llvm/ADT/StringRef.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace llvm {
+class PassInstrumentationCallbacks;
+}  // namespace llvm
+
+namespace compiler {
+/// @brief Records the time spent in each stage of building a module.
+///
+/// Stages are either scoped with `BuildProfiler::Stage` or are the passes run
+/// by any pass machinery initialized while a stage is in scope, so the passes
+/// of nested pipelines such as vecz's are nested in the pass running them.
+/// Passes run on a kernel by a function pass manager are nested in a stage
+/// named after the kernel, giving the time spent on each kernel.
+///
+/// Stages are recorded when the `build_profile` option is set, and each run of
+/// a stage is also recorded as a tracer event in the `Impl` category when it
+/// is enabled. The profiler must not be used by several threads at once.
+class BuildProfiler final {
+ public:
+  /// @brief Construct a profiler.
+  ///
+  /// @param[in] enabled Whether to record the profile, usually the module's
+  /// `build_profile` option, which must outlive the profiler.
+  BuildProfiler(const bool &enabled) : enabled(enabled) {}
+
+  /// @brief Times a stage for as long as it is in scope.
+  class Stage final {
+   public:
+    /// @brief Begin the stage.
+    ///
+    /// @param[in] profiler Profiler to record the stage in.
+    /// @param[in] name Name of the stage.
+    Stage(BuildProfiler &profiler, llvm::StringRef name);
+
+    /// @brief End the stage, and any stages nested within it which were left
+    /// unfinished, e.g. by a pass crashing.
+    ~Stage();
+
+    Stage(const Stage &) = delete;
+    Stage &operator=(const Stage &) = delete;
+
+   private:
+    /// @brief Profiler the stage is recorded in.
+    BuildProfiler &profiler;
+    /// @brief Number of stages in progress when this stage began.
+    size_t depth;
+    /// @brief Hook profiling the passes run by the stage.
+    compiler::utils::ScopedInstrumentationHook hook;
+  };
+
+  /// @brief Get the recorded profile, each stage is followed by the stages
+  /// nested within it.
+  std::vector<BuildProfileEntry> getEntries() const;
+
+  /// @brief Discard the recorded profile.
+  void clear();
+
+ private:
+  /// @brief Check whether stages need to be timed.
+  bool isActive() const;
+
+  /// @brief Begin a stage nested in the innermost stage in progress.
+  void begin(llvm::StringRef name);
+
+  /// @brief Begin a pass which isn't recorded as a stage, such as a pass
+  /// manager, so that it can be ended like any other pass.
+  void beginIgnored();
+
+  /// @brief End stages until `depth` stages are in progress.
+  void endTo(size_t depth);
+
+  /// @brief Register callbacks recording the passes run through `PIC`.
+  void registerCallbacks(llvm::PassInstrumentationCallbacks &PIC);
+
+  /// @brief A stage of the profile, which aggregates every run of the stage
+  /// within its parent stage.
+  struct Node {
+    /// @brief Name of the stage.
+    std::string name;
+    /// @brief Number of times the stage ran.
+    uint64_t count = 0;
+    /// @brief Total time spent in the stage, in nanoseconds.
+    uint64_t duration = 0;
+    /// @brief Indices of the stages nested in this stage, in the order they
+    /// first ran.
+    std::vector<size_t> children;
+  };
+
+  /// @brief A stage in progress.
+  struct Frame {
+    /// @brief Index of the stage's node, or `ignored`.
+    size_t node;
+    /// @brief Time the stage began, in nanoseconds.
+    uint64_t start;
+    /// @brief Tracer timestamp the stage began at, in microseconds.
+    uint64_t trace_start;
+  };
+
+  /// @brief Node index of passes which aren't recorded.
+  static constexpr size_t ignored = ~size_t(0);
+
+  /// @brief Whether to record the profile.
+  const bool &enabled;
+  /// @brief Stages of the profile, the first node is the root of the profile
+  /// and isn't a stage itself.
+  std::vector<Node> nodes;
+  /// @brief Stages in progress, innermost last.
+  std::vector<Frame> stack;
+};
+}  // namespace compiler
+
+#endif  // COMPILER_BASE_BUILD_PROFILER_H_INCLUDED
@@ -0,0 +1,89 @@
+// Copyright (C) Codeplay Software Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+// Exceptions; you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://github.com/codeplaysoftware/oneapi-construction-kit/blob/main/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+/// @file
+///
+/// @brief Cache of link inputs after their program independent optimizations.
+
+#ifndef COMPILER_BASE_LINK_INPUT_CACHE_H_INCLUDED
+#define COMPILER_BASE_LINK_INPUT_CACHE_H_INCLUDED
+
+#include <llvm/ADT/STLFunctionalExtras.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+namespace llvm {
+class Module;
+}  // namespace llvm
+
+namespace compiler {
+/// @brief Cache of the modules linked by `BaseModule::link`, after the
+/// optimizations which don't depend on the rest of the program.
+///
+/// Applications often link the same library with a different small module
+/// many times. Inputs are looked up by the content of their bitcode and the
+/// compiler options they're optimized with, so an unchanged input is only
+/// optimized the first time it is linked with those options, whichever program
+/// it belongs to.
+///
+/// The cached modules live in the target's LLVMContext, so the cache must only
+/// be used with the compiler context locked and must be destroyed before the
+/// LLVMContext is.
+class LinkInputCache final {
+ public:
+  /// @brief Get the optimized form of a link input, optimizing a clone of it
+  /// if an input with the same content hasn't been optimized with the same
+  /// options yet.
+  ///
+  /// @param[in] input Module to look up.
+  /// @param[in] options_key Serialized compiler options `optimize` depends on.
+  /// @param[in] optimize Callback optimizing a clone of `input` in place,
+  /// returning false on failure.
+  ///
+  /// @return The optimized module, owned by the cache and only valid until the
+  /// next call, or null if `optimize` failed.
+  const llvm::Module *getOrOptimize(
+      const llvm::Module &input, const std::string &options_key,
+      llvm::function_ref<bool(llvm::Module &)> optimize);
+
+  /// @brief Maximum number of inputs to cache, the least recently used input
+  /// is evicted first.
+  static constexpr size_t max_entries = 16;
+
+ private:
+  /// @brief A cached link input.
+  struct Entry {
+    /// @brief Compiler options the input was optimized with.
+    std::string options_key;
+    /// @brief Bitcode of the input before optimization.
+    std::string bitcode;
+    /// @brief The optimized input.
+    std::unique_ptr<llvm::Module> module;
+    /// @brief Value of `uses` when the entry was last looked up.
+    uint64_t last_use;
+  };
+
+  /// @brief Cached inputs, keyed by the hash of their options and bitcode.
+  std::unordered_multimap<size_t, Entry> entries;
+  /// @brief Number of lookups made, used to find the least recently used entry.
+  uint64_t uses = 0;
+};
+}  // namespace compiler
+
+#endif  // COMPILER_BASE_LINK_INPUT_CACHE_H_INCLUDED
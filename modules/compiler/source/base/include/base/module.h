@@ -21,6 +21,7 @@
 #ifndef BASE_MODULE_H_INCLUDED
 #define BASE_MODULE_H_INCLUDED
 
+#include <base/build_profiler.h>
 #include <base/context.h>
 #include <base/target.h>
 #include <builtins/printf.h>
@@ -213,6 +214,9 @@ class BaseModule : public Module {
   /// @brief Returns the current state of the compiler module.
   ModuleState getState() const override final { return state; }
 
+  /// @see Module::getBuildProfile
+  std::vector<BuildProfileEntry> getBuildProfile() const override final;
+
   /// @brief Return a new pass machinery to be used for the compilation pipeline
   virtual std::unique_ptr<compiler::utils::PassMachinery> createPassMachinery();
 
@@ -288,6 +292,41 @@ class BaseModule : public Module {
   /// @return An object that represents a kernel contained within this module.
   virtual Kernel *createKernel(const std::string &name) = 0;
 
+  /// @brief Returns whether `finalize` left the optimization pipeline to be
+  /// run on each kernel as it is created, see the `-cl-lazy-kernels` option.
+  ///
+  /// Targets must then call `addDeferredOptimizationPasses` on each kernel
+  /// module they create from `finalized_llvm_module`, before their own kernel
+  /// passes.
+  ///
+  /// Note that `finalize` still replaces printf calls, combines fpext/fptrunc
+  /// pairs and checks for unsupported floating point types, so with deferred
+  /// optimization those passes see the unoptimized program rather than the
+  /// optimized one. In particular, a double or half which only the
+  /// optimizations would have removed can still be reported on devices without
+  /// support for it.
+  bool isOptimizationDeferred() const;
+
+  /// @brief Add the optimization passes `finalize` runs over the whole program
+  /// to a pass manager.
+  ///
+  /// @param[in,out] pm Module pass manager to add the passes to.
+  /// @param[in] pass_mach Pass machinery to build the inliner pipeline with.
+  void addOptimizationPasses(llvm::ModulePassManager &pm,
+                             compiler::utils::PassMachinery &pass_mach) const;
+
+  /// @brief Add the optimization passes `finalize` deferred to a pass manager.
+  ///
+  /// These are the passes of `addOptimizationPasses`, followed by the passes
+  /// `finalize` runs after them which are cheap enough to run again on each
+  /// kernel, so that the optimized code is cleaned up as it would have been.
+  ///
+  /// @param[in,out] pm Module pass manager to add the passes to.
+  /// @param[in] pass_mach Pass machinery to build the inliner pipeline with.
+  void addDeferredOptimizationPasses(
+      llvm::ModulePassManager &pm,
+      compiler::utils::PassMachinery &pass_mach) const;
+
   /// @brief Add a diagnostic message to the log.
   ///
   /// @param[in] message Message to add to the build log.
@@ -495,6 +534,15 @@ class BaseModule : public Module {
   /// @brief LLVM module produced by the `Module::finalize` method.
   std::unique_ptr<llvm::Module> finalized_llvm_module;
 
+  /// @brief Whether `link` took every input from the target's link input
+  /// cache, so that the program independent optimizations have already been
+  /// run on the whole module.
+  ///
+  /// They will have run before the lowering passes in `finalize` rather than
+  /// after them, so `addOptimizationPasses` only reruns the cheap cleanup
+  /// passes over the lowered module.
+  bool link_inputs_optimized = false;
+
   /// @brief Reference on the implementation of the `compiler::Target` class.
   compiler::BaseTarget &target;
 
@@ -505,7 +553,21 @@ class BaseModule : public Module {
   /// @brief Reference on the context this module belongs to.
   compiler::BaseContext &context;
 
+  /// @brief Records the time spent in each stage of building the module when
+  /// the `build_profile` option is set, targets add their own stages.
+  BuildProfiler profiler;
+
  private:
+  /// @brief Clone a module to be linked into this one, optimized through the
+  /// target's link input cache when there is one.
+  ///
+  /// Clears `link_inputs_optimized` if the clone isn't optimized.
+  ///
+  /// @param[in] input Module to clone.
+  ///
+  /// @return The clone, or null if optimizing it failed.
+  std::unique_ptr<llvm::Module> cloneLinkInput(const llvm::Module &input);
+
   /// @brief Check if the opencl.kernels metadata exists in the binary's module,
   /// and create them if they don't.
   ///
@@ -22,6 +22,7 @@
 #define BASE_PASS_PIPELINES_H_INCLUDED
 
 #include <compiler/module.h>
+#include <llvm/ADT/SmallVector.h>
 #include <llvm/IR/CallingConv.h>
 #include <llvm/IR/PassManager.h>
 
@@ -106,6 +107,27 @@ Result emitCodeGenFile(llvm::Module &M, llvm::TargetMachine *TM,
                        llvm::raw_pwrite_stream &ostream,
                        bool create_assembly = false);
 
+/// @brief Invokes the LLVM backend on partitions of a module in parallel to
+/// produce one object binary per partition
+///
+/// The module is split with `llvm::SplitModule` into as many partitions as it
+/// has kernel entry points, which are compiled on a pool of threads each in
+/// their own LLVMContext. `SplitModule` assigns groups of globals to partitions
+/// by hashing their names, not one kernel per partition, so a partition can
+/// hold several kernels or none at all. Each function is defined in exactly
+/// one partition and referenced from the others, so linking all the objects
+/// together is equivalent to linking the object created by `emitCodeGenFile`.
+/// The partitioning only depends on the module, so the objects don't depend on
+/// the number of threads used.
+///
+/// @param M Module to compile, symbols with local linkage may be externalized
+/// @param TM TargetMachine to compile for, which is copied for each thread
+/// @param objects Vector to store the object binaries in, in partition order
+/// @return Result of the backend compilation
+Result emitCodeGenFiles(
+    llvm::Module &M, llvm::TargetMachine *TM,
+    llvm::SmallVectorImpl<llvm::SmallVector<char, 0>> &objects);
+
 void encodeVectorizationMode(llvm::Function &, VectorizationMode);
 std::optional<VectorizationMode> getVectorizationMode(const llvm::Function &);
 
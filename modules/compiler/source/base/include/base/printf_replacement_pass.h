@@ -70,13 +70,9 @@ struct PrintfReplacementPass final
   /// @param[in,out] module The module.
   /// @param[in,out] ci The printf call instruction to rewrite.
   /// @param[in,out] printf_func The printf function.
-  /// @param[in] get_group_id The `get_group_id` function.
-  /// @param[in] get_num_groups The `get_num_groups` function.
   /// @param[in] printf_calls The list of printf calls accumulated by this pass
   void rewritePrintfCall(llvm::Module &module, llvm::CallInst *ci,
                          llvm::Function *printf_func,
-                         llvm::Function *get_group_id,
-                         llvm::Function *get_num_groups,
                          PrintfDescriptorVecTy &printf_calls);
 
   PrintfDescriptorVecTy *printf_calls_out_ptr;
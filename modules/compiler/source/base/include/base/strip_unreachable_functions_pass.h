@@ -0,0 +1,65 @@
+// Copyright (C) Codeplay Software Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+// Exceptions; you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://github.com/codeplaysoftware/oneapi-construction-kit/blob/main/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+/// @file
+///
+/// @brief Class StripUnreachableFunctionsPass interface.
+
+#ifndef BASE_STRIP_UNREACHABLE_FUNCTIONS_PASS_H_INCLUDED
+#define BASE_STRIP_UNREACHABLE_FUNCTIONS_PASS_H_INCLUDED
+
+#include <llvm/IR/PassManager.h>
+
+namespace compiler {
+/// @addtogroup cl_compiler
+/// @{
+
+/// @brief Pass deleting the function definitions which no kernel can reach.
+///
+/// Functions are reachable from a kernel through direct calls. Any function
+/// with another use, such as having its address taken, is conservatively kept
+/// along with the functions it reaches. Running this before the heavier passes
+/// means they don't spend time on functions which would be deleted anyway.
+///
+/// Each function deleted is reported as a `strip-unreachable-functions`
+/// optimization remark, and the totals are counted as statistics.
+class StripUnreachableFunctionsPass final
+    : public llvm::PassInfoMixin<StripUnreachableFunctionsPass> {
+ public:
+  /// @brief Constructor.
+  ///
+  /// @param KeepExported Whether to also keep the functions which another
+  /// module could link against, for modules which aren't a whole program yet,
+  /// such as compiled objects and libraries.
+  StripUnreachableFunctionsPass(bool KeepExported = false)
+      : KeepExported(KeepExported) {}
+
+  /// @brief The entry point to the pass.
+  ///
+  /// @param M The Module provided to the pass.
+  /// @param AM Manager providing analyses.
+  ///
+  /// @return Return whether or not the pass changed anything.
+  llvm::PreservedAnalyses run(llvm::Module &M, llvm::ModuleAnalysisManager &AM);
+
+ private:
+  /// @brief Whether to keep the functions another module could link against.
+  bool KeepExported;
+};
+
+/// @}
+}  // namespace compiler
+
+#endif  // BASE_STRIP_UNREACHABLE_FUNCTIONS_PASS_H_INCLUDED
@@ -17,8 +17,10 @@
 #ifndef COMPILER_BASE_TARGET_H
 #define COMPILER_BASE_TARGET_H
 
+#include <base/link_input_cache.h>
 #include <cargo/optional.h>
 #include <compiler/target.h>
+#include <compiler/utils/builtins_link_cache.h>
 #include <llvm/IR/DiagnosticInfo.h>
 #include <llvm/IR/DiagnosticPrinter.h>
 #include <mux/mux.h>
@@ -50,6 +52,16 @@ class BaseTarget : public Target {
 
   virtual llvm::Module *getBuiltins() const = 0;
 
+  /// @brief Returns the link cache of the builtins module, shared by every
+  /// module compiled for this target, or null if there isn't one.
+  virtual utils::BuiltinsLinkCache *getBuiltinsLinkCache() const {
+    return nullptr;
+  }
+
+  /// @brief Returns the cache of optimized link inputs, shared by every module
+  /// linked for this target, or null if there isn't one.
+  virtual LinkInputCache *getLinkInputCache() const { return nullptr; }
+
   NotifyCallbackFn getNotifyCallbackFn() const { return callback; }
 
   /// @brief Returns the (non-null) LLVMContext.
@@ -93,6 +105,16 @@ class BaseAOTTarget : public BaseTarget {
   /// @see BaseTarget::getBuiltins
   llvm::Module *getBuiltins() const override { return builtins.get(); };
 
+  /// @see BaseTarget::getBuiltinsLinkCache
+  utils::BuiltinsLinkCache *getBuiltinsLinkCache() const override {
+    return &builtins_link_cache;
+  }
+
+  /// @see BaseTarget::getLinkInputCache
+  LinkInputCache *getLinkInputCache() const override {
+    return &link_input_cache;
+  }
+
  protected:
   /// @brief LLVM context.
   llvm::LLVMContext llvm_context;
@@ -101,6 +123,14 @@ class BaseAOTTarget : public BaseTarget {
   /// this target provides. May be null for compiler targets without external
   /// builtin libraries.
   std::unique_ptr<llvm::Module> builtins;
+
+  /// @brief Link cache of `builtins`, mutable as the builtins module itself
+  /// is lazily materialized through a const target.
+  mutable utils::BuiltinsLinkCache builtins_link_cache;
+
+  /// @brief Optimized link inputs, declared after `llvm_context` so that they
+  /// are destroyed first.
+  mutable LinkInputCache link_input_cache;
 };
 
 }  // namespace compiler
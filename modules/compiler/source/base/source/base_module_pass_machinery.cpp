@@ -27,11 +27,13 @@
 #include <base/printf_replacement_pass.h>
 #include <base/set_convergent_attr_pass.h>
 #include <base/software_division_pass.h>
+#include <base/strip_unreachable_functions_pass.h>
 #include <compiler/utils/add_kernel_wrapper_pass.h>
 #include <compiler/utils/add_metadata_pass.h>
 #include <compiler/utils/add_scheduling_parameters_pass.h>
 #include <compiler/utils/align_module_structs_pass.h>
 #include <compiler/utils/builtin_info.h>
+#include <compiler/utils/compute_indirect_memory_access_pass.h>
 #include <compiler/utils/compute_local_memory_usage_pass.h>
 #include <compiler/utils/define_mux_builtins_pass.h>
 #include <compiler/utils/define_mux_dma_pass.h>
@@ -267,6 +269,11 @@ Expected<bool> parseReplaceMuxMathDeclsPassOptions(StringRef Params) {
                                                 "ReplaceMuxMathDeclsPass");
 }
 
+Expected<bool> parseStripUnreachableFunctionsPassOptions(StringRef Params) {
+  return compiler::utils::parseSinglePassOption(
+      Params, "keep-exported", "StripUnreachableFunctionsPass");
+}
+
 // Lookup table for calling convention enums
 std::unordered_map<std::string, CallingConv::ID> CallConvMap = {
     {"C", CallingConv::C},
@@ -0,0 +1,174 @@
+// Copyright (C) Codeplay Software Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+// Exceptions; you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://github.com/codeplaysoftware/oneapi-construction-kit/blob/main/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <base/build_profiler.h>
+#include <compiler/utils/attributes.h>
+#include <llvm/IR/Function.h>
+#include <llvm/IR/PassInstrumentation.h>
+#include <tracer/tracer.h>
+
+#include <chrono>
+
+namespace {
+uint64_t getNanoseconds() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+/// @brief Check whether a pass only runs other passes, in which case the time
+/// is attributed to the passes it runs instead.
+bool isPassContainer(llvm::StringRef pass) {
+  return llvm::isSpecialPass(pass, {"PassManager", "PassAdaptor",
+                                    "AnalysisManagerProxy",
+                                    "DevirtSCCRepeatedPass"});
+}
+}  // namespace
+
+namespace compiler {
+BuildProfiler::Stage::Stage(BuildProfiler &profiler, llvm::StringRef name)
+    : profiler(profiler),
+      depth(profiler.stack.size()),
+      hook(profiler.isActive()
+               ? compiler::utils::InstrumentationHook(
+                     [&profiler](llvm::PassInstrumentationCallbacks &PIC) {
+                       profiler.registerCallbacks(PIC);
+                     })
+               : compiler::utils::InstrumentationHook()) {
+  profiler.begin(name);
+}
+
+BuildProfiler::Stage::~Stage() { profiler.endTo(depth); }
+
+std::vector<BuildProfileEntry> BuildProfiler::getEntries() const {
+  std::vector<BuildProfileEntry> entries;
+  if (nodes.empty()) {
+    return entries;
+  }
+  // Walk the tree depth first, skipping the root.
+  std::vector<std::pair<size_t, uint32_t>> worklist;
+  for (auto it = nodes[0].children.rbegin(); it != nodes[0].children.rend();
+       ++it) {
+    worklist.emplace_back(*it, 0);
+  }
+  while (!worklist.empty()) {
+    const auto [index, depth] = worklist.back();
+    worklist.pop_back();
+    const Node &node = nodes[index];
+    entries.push_back({node.name, depth, node.count, node.duration});
+    for (auto it = node.children.rbegin(); it != node.children.rend(); ++it) {
+      worklist.emplace_back(*it, depth + 1);
+    }
+  }
+  return entries;
+}
+
+void BuildProfiler::clear() {
+  nodes.clear();
+  stack.clear();
+}
+
+bool BuildProfiler::isActive() const {
+  return enabled || tracer::isEnabled<tracer::Impl>();
+}
+
+void BuildProfiler::begin(llvm::StringRef name) {
+  if (!isActive()) {
+    beginIgnored();
+    return;
+  }
+  if (nodes.empty()) {
+    nodes.emplace_back();
+  }
+
+  // Find the innermost recorded stage to nest this one in.
+  size_t parent = 0;
+  for (auto it = stack.rbegin(); it != stack.rend(); ++it) {
+    if (it->node != ignored) {
+      parent = it->node;
+      break;
+    }
+  }
+
+  size_t node = ignored;
+  for (const size_t child : nodes[parent].children) {
+    if (nodes[child].name == name) {
+      node = child;
+      break;
+    }
+  }
+  if (node == ignored) {
+    node = nodes.size();
+    nodes.emplace_back().name = name.str();
+    nodes[parent].children.push_back(node);
+  }
+
+  const uint64_t trace_start = tracer::isEnabled<tracer::Impl>()
+                                   ? tracer::getCurrentTimestamp()
+                                   : 0;
+  stack.push_back({node, getNanoseconds(), trace_start});
+}
+
+void BuildProfiler::beginIgnored() { stack.push_back({ignored, 0, 0}); }
+
+void BuildProfiler::endTo(size_t depth) {
+  while (stack.size() > depth) {
+    const Frame frame = stack.back();
+    stack.pop_back();
+    if (frame.node == ignored) {
+      continue;
+    }
+    Node &node = nodes[frame.node];
+    node.count++;
+    node.duration += getNanoseconds() - frame.start;
+    if (tracer::isEnabled<tracer::Impl>() && frame.trace_start) {
+      tracer::recordTrace(node.name.c_str(),
+                          tracer::getCategoryName<tracer::Impl>(),
+                          frame.trace_start, tracer::getCurrentTimestamp());
+    }
+  }
+}
+
+void BuildProfiler::registerCallbacks(llvm::PassInstrumentationCallbacks &PIC) {
+  PIC.registerBeforeNonSkippedPassCallback(
+      [this](llvm::StringRef pass, llvm::Any IR) {
+        if (!isPassContainer(pass)) {
+          begin(pass);
+          return;
+        }
+        // Function pass managers run all their passes on one function, so
+        // give the time spent on each kernel.
+        const auto **F = llvm::any_cast<const llvm::Function *>(&IR);
+        if (F && pass.starts_with("PassManager") &&
+            (compiler::utils::isKernel(**F) ||
+             (*F)->getCallingConv() == llvm::CallingConv::SPIR_KERNEL)) {
+          begin((*F)->getName());
+        } else {
+          beginIgnored();
+        }
+      });
+  // Every pass which began has to end, recorded or not, so these don't check
+  // which pass ended.
+  PIC.registerAfterPassCallback(
+      [this](llvm::StringRef, llvm::Any, const llvm::PreservedAnalyses &) {
+        endTo(stack.size() - 1);
+      });
+  PIC.registerAfterPassInvalidatedCallback(
+      [this](llvm::StringRef, const llvm::PreservedAnalyses &) {
+        endTo(stack.size() - 1);
+      });
+}
+}  // namespace compiler
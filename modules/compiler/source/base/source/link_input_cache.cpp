@@ -0,0 +1,62 @@
+// Copyright (C) Codeplay Software Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+// Exceptions; you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://github.com/codeplaysoftware/oneapi-construction-kit/blob/main/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <base/link_input_cache.h>
+#include <llvm/Bitcode/BitcodeWriter.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/raw_ostream.h>
+#include <llvm/Transforms/Utils/Cloning.h>
+
+#include <algorithm>
+#include <functional>
+
+namespace compiler {
+const llvm::Module *LinkInputCache::getOrOptimize(
+    const llvm::Module &input, const std::string &options_key,
+    llvm::function_ref<bool(llvm::Module &)> optimize) {
+  std::string bitcode;
+  {
+    llvm::raw_string_ostream stream(bitcode);
+    llvm::WriteBitcodeToFile(input, stream);
+  }
+
+  const std::hash<std::string> hasher;
+  const size_t hash = hasher(options_key) ^ (hasher(bitcode) << 1);
+  auto range = entries.equal_range(hash);
+  for (auto it = range.first; it != range.second; ++it) {
+    if (it->second.options_key == options_key &&
+        it->second.bitcode == bitcode) {
+      it->second.last_use = ++uses;
+      return it->second.module.get();
+    }
+  }
+
+  auto module = llvm::CloneModule(input);
+  if (!optimize(*module)) {
+    return nullptr;
+  }
+
+  if (entries.size() >= max_entries) {
+    entries.erase(std::min_element(
+        entries.begin(), entries.end(), [](const auto &lhs, const auto &rhs) {
+          return lhs.second.last_use < rhs.second.last_use;
+        }));
+  }
+  auto it = entries.emplace(hash, Entry{options_key, std::move(bitcode),
+                                       std::move(module), ++uses});
+  return it->second.module.get();
+}
+}  // namespace compiler
@@ -30,6 +30,7 @@
 #include <base/program_metadata.h>
 #include <base/set_convergent_attr_pass.h>
 #include <base/software_division_pass.h>
+#include <base/strip_unreachable_functions_pass.h>
 #include <builtins/bakery.h>
 #include <cargo/argument_parser.h>
 #include <cargo/small_vector.h>
@@ -340,6 +341,7 @@ BaseModule::BaseModule(compiler::BaseTarget &target,
                        std::string &log)
     : target(target),
       context(context),
+      profiler(options.build_profile),
       state(ModuleState::NONE),
       num_errors(num_errors),
       log(log) {}
@@ -349,6 +351,8 @@ BaseModule::~BaseModule() {}
 void BaseModule::clear() {
   llvm_module.reset();
   kernel_map.clear();
+  link_inputs_optimized = false;
+  profiler.clear();
 
   state = ModuleState::NONE;
 }
@@ -466,6 +470,10 @@ Result BaseModule::parseOptions(cargo::string_view input_options,
                              options.single_precision_constant})) {
       return Result::OUT_OF_MEMORY;
     }
+    if (parser.add_argument({"-cl-uniform-work-group-size",
+                             options.uniform_work_group_size})) {
+      return Result::OUT_OF_MEMORY;
+    }
     std::array<cargo::string_view, 3> cl_std_choices = {
         {"CL1.1", "CL1.2", "CL3.0"}};
     if (parser.add_argument({"-cl-std=", cl_std_choices, cl_std})) {
@@ -495,6 +503,14 @@ Result BaseModule::parseOptions(cargo::string_view input_options,
       return Result::OUT_OF_MEMORY;
     }
 
+    if (parser.add_argument({"-cl-lazy-kernels", options.lazy_kernels})) {
+      return Result::OUT_OF_MEMORY;
+    }
+
+    if (parser.add_argument({"-cl-build-profile", options.build_profile})) {
+      return Result::OUT_OF_MEMORY;
+    }
+
     std::array<cargo::string_view, 4> cl_vec_choices = {
         {"none", "loop", "slp", "all"}};
     if (parser.add_argument({"-cl-vec=", cl_vec_choices, cl_vec})) {
@@ -743,8 +759,11 @@ class StripFastMathAttrs final
 };
 
 llvm::ModulePassManager BaseModule::getEarlyOpenCLCPasses() {
-  // Run the software division pass required for OpenCL C.
   llvm::ModulePassManager pm;
+  // Drop the internal functions no kernel can reach before anything else runs
+  // on them, the rest may be linked against so must be kept.
+  pm.addPass(compiler::StripUnreachableFunctionsPass(/*KeepExported*/ true));
+  // Run the software division pass required for OpenCL C.
   pm.addPass(llvm::createModuleToFunctionPassAdaptor(SoftwareDivisionPass()));
   pm.addPass(llvm::createModuleToFunctionPassAdaptor(StripFastMathAttrs()));
   pm.addPass(compiler::SetConvergentAttrPass());
@@ -755,6 +774,9 @@ llvm::ModulePassManager BaseModule::getEarlySPIRVPasses() {
   // Run the various fixup passes needed to make sure the IR we've got is spec
   // conformant.
   llvm::ModulePassManager pm;
+  // Internal functions which no kernel reaches are already dead, so delete
+  // them before the fixups below run on them.
+  pm.addPass(compiler::StripUnreachableFunctionsPass(/*KeepExported*/ true));
   // Set the opencl.ocl.version metadata if not already set. In SPIR-V this is
   // not set (by spirv-ll) and conveys the best-matching version of OpenCL C
   // for which we translate SPIR-V binaries. This covers not just how we
@@ -794,10 +816,12 @@ cargo::expected<spirv::ModuleInfo, Result> BaseModule::compileSPIRV(
     const spirv::DeviceInfo &spirv_device_info,
     cargo::optional<const spirv::SpecializationInfo &> spirv_spec_info) {
   const std::lock_guard<compiler::BaseContext> lock(context);
+  const BuildProfiler::Stage stage(profiler, "frontend");
 
   spirv::ModuleInfo module_info;
 
   {
+    const BuildProfiler::Stage translate_stage(profiler, "SPIR-V translation");
     spirv_ll::Context spvContext(&target.getLLVMContext());
 
     // Convert SPIR-V inputs to SPIRV-LL data structures.
@@ -827,10 +851,12 @@ cargo::expected<spirv::ModuleInfo, Result> BaseModule::compileSPIRV(
       spirv_ll_spec_info_optional = spirv_ll_spec_info;
     }
 
-    // Translate the SPIR-V binary into an llvm::Module.
-    auto spvModule =
-        spvContext.translate({buffer.data(), buffer.size()},
-                             spirv_ll_device_info, spirv_ll_spec_info_optional);
+    // Translate the SPIR-V binary into an llvm::Module. Functions which aren't
+    // reachable from a kernel or linkable are private and would only be
+    // deleted later, so skip translating them.
+    auto spvModule = spvContext.translate(
+        {buffer.data(), buffer.size()}, spirv_ll_device_info,
+        spirv_ll_spec_info_optional, /*reachableOnly*/ true);
     if (!spvModule) {
       // Add error message to the build log.
       log.append(spvModule.error().message + "\n");
@@ -1355,6 +1381,7 @@ void BaseModule::runOpenCLFrontendPipeline(
     const clang::CodeGenOptions &codeGenOpts,
     std::optional<llvm::ModulePassManager> early_passes,
     std::optional<llvm::ModulePassManager> late_passes) {
+  const BuildProfiler::Stage stage(profiler, "frontend pipeline");
   if (options.fast_math) {
     if (late_passes.has_value()) {
       late_passes->addPass(FastMathPass());
@@ -1387,6 +1414,7 @@ void BaseModule::FrontendDiagnosticPrinter::HandleDiagnostic(
 Result BaseModule::compileOpenCLC(
     cargo::string_view device_profile, cargo::string_view source_sv,
     cargo::array_view<compiler::InputHeader> input_headers) {
+  const BuildProfiler::Stage stage(profiler, "frontend");
   clang::CompilerInstance instance;
 
   llvm_module = compileOpenCLCToIR(instance, device_profile, source_sv,
@@ -1464,9 +1492,13 @@ std::unique_ptr<llvm::Module> BaseModule::compileOpenCLCToIR(
     }
   }
 
-  loadBuiltinsPCH(instance);
+  {
+    const BuildProfiler::Stage stage(profiler, "builtins PCH load");
+    loadBuiltinsPCH(instance);
+  }
 
   {
+    const BuildProfiler::Stage stage(profiler, "clang");
     // At this point we have already locked the LLVMContext mutex for the
     // current context we are operating on.  If, however, an OpenCL programmer
     // uses multiple cl_context in parallel they can invoke multiple compiler
@@ -1516,11 +1548,97 @@ std::unique_ptr<llvm::Module> BaseModule::compileOpenCLCToIR(
   return mod;
 }
 
+/// @brief Add the optimization passes which only look at one function or
+/// builtin call at a time, and so can be run on modules before they're linked.
+static void addProgramIndependentPasses(llvm::ModulePassManager &pm) {
+  {
+    llvm::FunctionPassManager fpm;
+    fpm.addPass(llvm::InstCombinePass());
+    fpm.addPass(llvm::ReassociatePass());
+    fpm.addPass(compiler::MemToRegPass());
+    fpm.addPass(llvm::BDCEPass());
+    fpm.addPass(llvm::ADCEPass());
+    fpm.addPass(llvm::SimplifyCFGPass());
+    pm.addPass(llvm::createModuleToFunctionPassAdaptor(std::move(fpm)));
+  }
+  pm.addPass(compiler::BuiltinSimplificationPass());
+  {
+    llvm::FunctionPassManager fpm;
+    fpm.addPass(llvm::InstCombinePass());
+    fpm.addPass(llvm::ReassociatePass());
+    fpm.addPass(llvm::BDCEPass());
+    fpm.addPass(llvm::ADCEPass());
+    fpm.addPass(llvm::SimplifyCFGPass());
+    pm.addPass(llvm::createModuleToFunctionPassAdaptor(std::move(fpm)));
+  }
+}
+
+/// @brief Serialize the compiler options which may change how a link input is
+/// optimized, to key the link input cache with.
+static std::string getLinkInputOptionsKey(const compiler::Options &options) {
+  std::string key;
+  llvm::raw_string_ostream stream(key);
+  stream << static_cast<int>(options.standard) << ','
+         << options.fp32_correctly_rounded_divide_sqrt << options.mad_enable
+         << options.no_signed_zeros << options.unsafe_math_optimizations
+         << options.denorms_may_be_zero << options.finite_math_only
+         << options.kernel_arg_info << options.debug_info << options.fast_math
+         << options.soft_math << options.scalable_vectors
+         << options.single_precision_constant
+         << options.uniform_work_group_size << ','
+         << static_cast<int>(options.prevec_mode) << ','
+         << static_cast<int>(options.vectorization_mode) << ','
+         << options.device_args;
+  for (const auto &extension : options.runtime_extensions) {
+    stream << ';' << extension;
+  }
+  for (const auto &extension : options.compiler_extensions) {
+    stream << ';' << extension;
+  }
+  stream.flush();
+  return key;
+}
+
+std::unique_ptr<llvm::Module> BaseModule::cloneLinkInput(
+    const llvm::Module &input) {
+  auto *cache = target.getLinkInputCache();
+  if (!cache || options.opt_disable) {
+    link_inputs_optimized = false;
+    return llvm::CloneModule(input);
+  }
+
+  const llvm::Module *optimized = cache->getOrOptimize(
+      input, getLinkInputOptionsKey(options), [this](llvm::Module &m) {
+        auto pass_mach = createPassMachinery();
+        initializePassMachineryForFinalize(*pass_mach);
+        static_cast<compiler::BaseModulePassMachinery &>(*pass_mach)
+            .setCompilerOptions(options);
+
+        llvm::ModulePassManager pm;
+        addProgramIndependentPasses(pm);
+
+        // Running passes touches LLVM's global state.
+        const std::lock_guard<std::mutex> globalLock(
+            compiler::utils::getLLVMGlobalMutex());
+        llvm::CrashRecoveryContext CRC;
+        llvm::CrashRecoveryContext::Enable();
+        const bool crashed =
+            !CRC.RunSafely([&] { pm.run(m, pass_mach->getMAM()); });
+        llvm::CrashRecoveryContext::Disable();
+        return !crashed;
+      });
+  if (!optimized) {
+    return nullptr;
+  }
+  return llvm::CloneModule(*optimized);
+}
+
 Result BaseModule::link(cargo::array_view<Module *> input_modules) {
   std::unique_ptr<llvm::Module> module;
 
   // We'll need to lock the LLVMContext for the whole function.
   const std::lock_guard<compiler::BaseContext> guard(context);
+  const BuildProfiler::Stage stage(profiler, "link");
 
   auto filter_func = [](const llvm::DiagnosticInfo &DI) {
     switch (DI.getSeverity()) {
@@ -1533,8 +1651,16 @@ Result BaseModule::link(cargo::array_view<Module *> input_modules) {
   };
   const ScopedDiagnosticHandler handler(*this, filter_func);
 
+  // Inputs are taken from the target's link input cache when optimizing, so
+  // that only inputs which haven't been linked before are optimized. This is
+  // cleared by `cloneLinkInput` if any input couldn't come from the cache.
+  link_inputs_optimized = true;
+
   if (ModuleState::COMPILED_OBJECT == state) {
-    module = llvm::CloneModule(*this->llvm_module);
+    module = cloneLinkInput(*this->llvm_module);
+    if (!module) {
+      return Result::LINK_PROGRAM_FAILURE;
+    }
   } else {
     module = std::unique_ptr<llvm::Module>(
         new llvm::Module("::ca_module_id", target.getLLVMContext()));
@@ -1552,7 +1678,10 @@ Result BaseModule::link(cargo::array_view<Module *> input_modules) {
           "BaseModule::link. Error linking program: Cannot clone "
           "with incompatible contexts.");
     }
-    auto clone = llvm::CloneModule(*m);
+    auto clone = cloneLinkInput(*m);
+    if (!clone) {
+      return Result::LINK_PROGRAM_FAILURE;
+    }
 
     // if any of the input programs had argument metadata, we need to ensure it
     // will be preserved
@@ -1631,6 +1760,77 @@ bool BaseModule::DiagnosticHandler::handleDiagnostics(
   return true;
 }
 
+bool BaseModule::isOptimizationDeferred() const {
+  return options.lazy_kernels &&
+         target.getCompilerInfo()->supports_deferred_compilation;
+}
+
+void BaseModule::addOptimizationPasses(
+    llvm::ModulePassManager &pm,
+    compiler::utils::PassMachinery &pass_mach) const {
+  if (options.prevec_mode != compiler::PreVectorizationMode::NONE) {
+    llvm::FunctionPassManager fpm;
+    if (options.prevec_mode == compiler::PreVectorizationMode::ALL ||
+        options.prevec_mode == compiler::PreVectorizationMode::SLP) {
+      fpm.addPass(llvm::SLPVectorizerPass());
+    }
+
+    if (options.prevec_mode == compiler::PreVectorizationMode::ALL ||
+        options.prevec_mode == compiler::PreVectorizationMode::LOOP) {
+      // Loop vectorization apparently only works on loops with a single basic
+      // block. Sometimes, Loop Rotation may be able to help us here.
+      fpm.addPass(llvm::createFunctionToLoopPassAdaptor(
+          llvm::LoopRotatePass(/*EnableHeaderDuplication*/ false)));
+      fpm.addPass(llvm::LoopVectorizePass());
+
+      // Loop vectorization also emits a scalar version of the loop, in case it
+      // wasn't a multiple of the vector size, even when the loop count is a
+      // compile-time constant that is a known multiple of the vector size.
+      // In that case we get a redundant compare and branch to clean up.
+      fpm.addPass(llvm::InstCombinePass());
+      fpm.addPass(llvm::SimplifyCFGPass());
+    }
+
+    // SLP vectorization can leave a lot of unused GEPs lying around..
+    fpm.addPass(llvm::DCEPass());
+
+    pm.addPass(llvm::createModuleToFunctionPassAdaptor(std::move(fpm)));
+  }
+
+  // Linked programs may have had these run on each of their inputs already,
+  // in which case they ran before the lowering passes in finalize rather than
+  // after them. BuiltinSimplification only looks at OpenCL builtins, which
+  // lowering leaves alone, but lowering does leave code for the cheap cleanup
+  // passes to tidy up, so rerun those.
+  if (!options.opt_disable) {
+    if (!link_inputs_optimized) {
+      addProgramIndependentPasses(pm);
+    } else {
+      llvm::FunctionPassManager fpm;
+      fpm.addPass(llvm::InstCombinePass());
+      fpm.addPass(llvm::ADCEPass());
+      fpm.addPass(llvm::SimplifyCFGPass());
+      pm.addPass(llvm::createModuleToFunctionPassAdaptor(std::move(fpm)));
+    }
+  }
+
+  if (!options.opt_disable) {
+    pm.addPass(llvm::GlobalDCEPass());
+    pm.addPass(pass_mach.getPB().buildInlinerPipeline(
+        llvm::OptimizationLevel::O3, llvm::ThinOrFullLTOPhase::None));
+  }
+}
+
+void BaseModule::addDeferredOptimizationPasses(
+    llvm::ModulePassManager &pm,
+    compiler::utils::PassMachinery &pass_mach) const {
+  addOptimizationPasses(pm, pass_mach);
+  // finalize combines fpext/fptrunc pairs after optimizing, do so again for
+  // any pairs the optimizations created.
+  pm.addPass(llvm::createModuleToFunctionPassAdaptor(
+      compiler::CombineFPExtFPTruncPass()));
+}
+
 Result BaseModule::finalize(
     ProgramInfo *program_info,
     std::vector<builtins::printf::descriptor> &printf_calls) {
@@ -1642,6 +1842,7 @@ Result BaseModule::finalize(
   // avoid data races by locking the LLVM global mutex.
   const std::lock_guard<std::mutex> globalLock(
       compiler::utils::getLLVMGlobalMutex());
+  const BuildProfiler::Stage stage(profiler, "finalize");
 
   if (!llvm_module) {
     CPL_ABORT(
@@ -1685,6 +1886,10 @@ Result BaseModule::finalize(
 
   pm.addPass(compiler::utils::VerifyReqdSubGroupSizeLegalPass());
 
+  // The module is now a whole program, so only the functions reachable from a
+  // kernel are needed, and the rest needn't be lowered or optimized.
+  pm.addPass(compiler::StripUnreachableFunctionsPass());
+
 #if LLVM_VERSION_GREATER_EQUAL(17, 0)
   const compiler::utils::ReplaceTargetExtTysOptions RTETOpts;
   pm.addPass(compiler::utils::ReplaceTargetExtTysPass(RTETOpts));
@@ -1715,62 +1920,12 @@ Result BaseModule::finalize(
 
   pm.addPass(compiler::utils::ReplaceC11AtomicFuncsPass());
 
-  if (options.prevec_mode != compiler::PreVectorizationMode::NONE) {
-    llvm::FunctionPassManager fpm;
-    if (options.prevec_mode == compiler::PreVectorizationMode::ALL ||
-        options.prevec_mode == compiler::PreVectorizationMode::SLP) {
-      fpm.addPass(llvm::SLPVectorizerPass());
-    }
-
-    if (options.prevec_mode == compiler::PreVectorizationMode::ALL ||
-        options.prevec_mode == compiler::PreVectorizationMode::LOOP) {
-      // Loop vectorization apparently only works on loops with a single basic
-      // block. Sometimes, Loop Rotation may be able to help us here.
-      fpm.addPass(llvm::createFunctionToLoopPassAdaptor(
-          llvm::LoopRotatePass(/*EnableHeaderDuplication*/ false)));
-      fpm.addPass(llvm::LoopVectorizePass());
-
-      // Loop vectorization also emits a scalar version of the loop, in case it
-      // wasn't a multiple of the vector size, even when the loop count is a
-      // compile-time constant that is a known multiple of the vector size.
-      // In that case we get a redundant compare and branch to clean up.
-      fpm.addPass(llvm::InstCombinePass());
-      fpm.addPass(llvm::SimplifyCFGPass());
-    }
-
-    // SLP vectorization can leave a lot of unused GEPs lying around..
-    fpm.addPass(llvm::DCEPass());
-
-    pm.addPass(llvm::createModuleToFunctionPassAdaptor(std::move(fpm)));
-  }
-
-  if (!options.opt_disable) {
-    {
-      llvm::FunctionPassManager fpm;
-      fpm.addPass(llvm::InstCombinePass());
-      fpm.addPass(llvm::ReassociatePass());
-      fpm.addPass(compiler::MemToRegPass());
-      fpm.addPass(llvm::BDCEPass());
-      fpm.addPass(llvm::ADCEPass());
-      fpm.addPass(llvm::SimplifyCFGPass());
-      pm.addPass(llvm::createModuleToFunctionPassAdaptor(std::move(fpm)));
-    }
-    pm.addPass(compiler::BuiltinSimplificationPass());
-    {
-      llvm::FunctionPassManager fpm;
-      fpm.addPass(llvm::InstCombinePass());
-      fpm.addPass(llvm::ReassociatePass());
-      fpm.addPass(llvm::BDCEPass());
-      fpm.addPass(llvm::ADCEPass());
-      fpm.addPass(llvm::SimplifyCFGPass());
-      pm.addPass(llvm::createModuleToFunctionPassAdaptor(std::move(fpm)));
-    }
-  }
-
-  if (!options.opt_disable) {
-    pm.addPass(llvm::GlobalDCEPass());
-    pm.addPass(pass_mach->getPB().buildInlinerPipeline(
-        llvm::OptimizationLevel::O3, llvm::ThinOrFullLTOPhase::None));
+  // With lazy kernels these are run by the target on each kernel as it is
+  // created instead, so that unused kernels are never optimized. The passes
+  // below then run before the optimizations rather than after them, see
+  // isOptimizationDeferred.
+  if (!isOptimizationDeferred()) {
+    addOptimizationPasses(pm, *pass_mach);
   }
 
   pm.addPass(
@@ -1956,6 +2111,14 @@ bool BaseModule::deserialize(cargo::array_view<const std::uint8_t> buffer) {
   }
 }
 
+std::vector<BuildProfileEntry> BaseModule::getBuildProfile() const {
+  if (!options.build_profile) {
+    return {};
+  }
+  const std::lock_guard<compiler::BaseContext> guard(context);
+  return profiler.getEntries();
+}
+
 void BaseModule::addDiagnostic(cargo::string_view message) {
   log.append(message.data(), message.size());
   log.append("\n");
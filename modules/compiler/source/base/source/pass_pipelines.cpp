@@ -31,13 +31,19 @@
 #include <compiler/utils/replace_wgc_pass.h>
 #include <compiler/utils/sub_group_usage_pass.h>
 #include <llvm/ADT/StringSwitch.h>
+#include <llvm/Bitcode/BitcodeReader.h>
+#include <llvm/Bitcode/BitcodeWriter.h>
 #include <llvm/IR/LegacyPassManager.h>
+#include <llvm/MC/TargetRegistry.h>
 #include <llvm/Passes/PassBuilder.h>
 #include <llvm/Support/CodeGen.h>
+#include <llvm/Support/CrashRecoveryContext.h>
+#include <llvm/Support/Parallel.h>
 #include <llvm/Target/TargetMachine.h>
 #include <llvm/Transforms/IPO/GlobalOpt.h>
 #include <llvm/Transforms/IPO/Inliner.h>
 #include <llvm/Transforms/IPO/Internalize.h>
+#include <llvm/Transforms/Utils/SplitModule.h>
 #include <multi_llvm/multi_llvm.h>
 
 #include <optional>
@@ -144,6 +150,69 @@ Result emitCodeGenFile(llvm::Module &M, TargetMachine *TM,
   return compiler::Result::SUCCESS;
 }
 
+Result emitCodeGenFiles(Module &M, TargetMachine *TM,
+                        SmallVectorImpl<SmallVector<char, 0>> &objects) {
+  unsigned NumPartitions = 0;
+  for (const auto &F : M) {
+    if (!F.isDeclaration() && compiler::utils::isKernelEntryPt(F)) {
+      NumPartitions++;
+    }
+  }
+
+  objects.clear();
+  if (NumPartitions <= 1) {
+    raw_svector_ostream OS(objects.emplace_back());
+    return emitCodeGenFile(M, TM, OS);
+  }
+
+  // LLVMContexts can't be shared between threads, so each partition is
+  // serialized to bitcode and parsed into a context owned by the thread
+  // compiling it.
+  SmallVector<SmallVector<char, 0>, 8> Bitcodes;
+  SplitModule(M, NumPartitions, [&](std::unique_ptr<Module> MPart) {
+    raw_svector_ostream OS(Bitcodes.emplace_back());
+    WriteBitcodeToFile(*MPart, OS);
+  });
+
+  objects.resize(Bitcodes.size());
+  SmallVector<Result, 8> Results(Bitcodes.size(), Result::FAILURE);
+  parallelFor(0, Bitcodes.size(), [&](size_t I) {
+    LLVMContext Ctx;
+    auto MPart = parseBitcodeFile(
+        MemoryBufferRef(StringRef(Bitcodes[I].data(), Bitcodes[I].size()),
+                        "partition"),
+        Ctx);
+    if (!MPart) {
+      consumeError(MPart.takeError());
+      return;
+    }
+    // TargetMachines aren't thread safe either, so create one per partition
+    // configured the same way as the one we were given.
+    std::unique_ptr<TargetMachine> PartTM(TM->getTarget().createTargetMachine(
+        TM->getTargetTriple().getTriple(), TM->getTargetCPU(),
+        TM->getTargetFeatureString(), TM->Options, TM->getRelocationModel(),
+        TM->getCodeModel(), TM->getOptLevel()));
+    if (!PartTM) {
+      return;
+    }
+    // Crash recovery only covers the thread it is run on.
+    CrashRecoveryContext CRC;
+    if (!CRC.RunSafely([&] {
+          raw_svector_ostream OS(objects[I]);
+          Results[I] = emitCodeGenFile(**MPart, PartTM.get(), OS);
+        })) {
+      Results[I] = Result::FAILURE;
+    }
+  });
+
+  for (const auto R : Results) {
+    if (R != Result::SUCCESS) {
+      return R;
+    }
+  }
+  return Result::SUCCESS;
+}
+
 void encodeVectorizationMode(Function &F, VectorizationMode mode) {
   switch (mode) {
     case VectorizationMode::AUTO:
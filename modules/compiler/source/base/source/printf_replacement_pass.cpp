@@ -15,7 +15,6 @@
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
 #include <base/printf_replacement_pass.h>
-#include <compiler/utils/builtin_info.h>
 #include <compiler/utils/device_info.h>
 #include <compiler/utils/pass_functions.h>
 #include <llvm/ADT/SmallPtrSet.h>
@@ -392,19 +391,6 @@ std::optional<std::string> getPointerToStringAsString(Value *op) {
   return std::nullopt;
 }
 
-/// @brief A small wrapper function around IRBuilder<>::CreateCall that
-///        sets calling conventions.
-/// @param[in] ir The IRBuilder to use when creating the call.
-/// @param[in] f The function to call.
-/// @param[in] args The arguments to use at the call-site.
-/// @return A call instruction that calls @p f with @p args.
-CallInst *CreateCall(IRBuilder<> &ir, Function *const f,
-                     ArrayRef<Value *> args) {
-  auto ci = ir.CreateCall(f, args);
-  ci->setCallingConv(f->getCallingConv());
-  return ci;
-}
-
 /// @brief Recursively search up the call graph and add each function
 ///        encountered into set_of_callers. Currently not needed in debug
 ///        builds, since debug passes add printf calls to all functions.
@@ -466,8 +452,8 @@ int DiagnosticInfoScrubbedPrintf::DK_ScrubbedPrintf =
 constexpr int invalid_printf_ret = -1;
 
 void compiler::PrintfReplacementPass::rewritePrintfCall(
-    Module &module, CallInst *ci, Function *printf_func, Function *get_group_id,
-    Function *get_num_groups, PrintfDescriptorVecTy &printf_calls) {
+    Module &module, CallInst *ci, Function *printf_func,
+    PrintfDescriptorVecTy &printf_calls) {
   const AtomicOrdering ordering = AtomicOrdering::SequentiallyConsistent;
 
   auto *const size_t_type = compiler::utils::getSizeType(module);
@@ -671,43 +657,12 @@ void compiler::PrintfReplacementPass::rewritePrintfCall(
   // entry block
   ir.SetInsertPoint(entry_block);
 
-  // first get the number of work group and our work group id in each dimension
-  auto x_group_nums = ir.CreateTrunc(
-      CreateCall(ir, get_num_groups, {ir.getInt32(0)}), ir.getInt32Ty());
-  auto y_group_nums = ir.CreateTrunc(
-      CreateCall(ir, get_num_groups, {ir.getInt32(1)}), ir.getInt32Ty());
-  auto z_group_nums = ir.CreateTrunc(
-      CreateCall(ir, get_num_groups, {ir.getInt32(2)}), ir.getInt32Ty());
-
-  auto x_group_id = ir.CreateTrunc(
-      CreateCall(ir, get_group_id, {ir.getInt32(0)}), ir.getInt32Ty());
-  auto y_group_id = ir.CreateTrunc(
-      CreateCall(ir, get_group_id, {ir.getInt32(1)}), ir.getInt32Ty());
-  auto z_group_id = ir.CreateTrunc(
-      CreateCall(ir, get_group_id, {ir.getInt32(2)}), ir.getInt32Ty());
-
-  // compute a unique index for our work group in the printf buffer across all
-  // dimensions:
-  //   x + y * x_size + z * (x_size * y_size)
-  auto group_addr = ir.CreateAdd(
-      x_group_id,
-      ir.CreateAdd(
-          ir.CreateMul(x_group_nums, y_group_id),
-          ir.CreateMul(z_group_id, ir.CreateMul(y_group_nums, z_group_nums))));
-
-  // compute the size available to the work group
-  // Ensure the size (and therefore the start of buffer for each work item) is
-  // aligned to 4 bytes by doing &~3, because the atomic add below assumes
-  // alignment to its type (int32).
-  auto group_buffer_size = ir.CreateAnd(
-      ir.CreateUDiv(
-          ir.getInt32(printf_buffer_size),
-          ir.CreateMul(x_group_nums, ir.CreateMul(y_group_nums, z_group_nums))),
-      ir.getInt32(~3u));
-
-  // get the chunk of buffer that this work group can use
-  auto buffer = ir.CreateGEP(buffer_elt_ty, full_buffer,
-                             ir.CreateMul(group_addr, group_buffer_size));
+  // the whole buffer is shared by all work groups, calls from any work item
+  // reserve space from the same length field so a work group can use as much
+  // of the buffer as it needs. Ensure the size is aligned to 4 bytes by doing
+  // &~3, because the atomic add below assumes alignment to its type (int32).
+  auto *buffer = full_buffer;
+  auto *buffer_size = ir.getInt32(printf_buffer_size & ~size_t(3));
 
   // offset for the printf call, we create this call now but will re-write it
   // later when we know how much we need to add
@@ -778,7 +733,7 @@ void compiler::PrintfReplacementPass::rewritePrintfCall(
   MDBuilder md(module.getContext());
   ir.CreateCondBr(
       ir.CreateICmpUGT(ir.CreateAdd(correct_add, ir.getInt32(offset)),
-                       group_buffer_size),
+                       buffer_size),
       early_return_block, store_block, md.createBranchWeights(0, 1));
 
   // early return block
@@ -818,18 +773,10 @@ PreservedAnalyses compiler::PrintfReplacementPass::run(
     return PreservedAnalyses::all();
   }
 
-  auto &BI = AM.getResult<compiler::utils::BuiltinInfoAnalysis>(module);
   const auto &DI = AM.getResult<compiler::utils::DeviceInfoAnalysis>(module);
   // Set up the double support for this run of the pass
   double_support = DI.double_capabilities != 0;
 
-  Function *get_group_id =
-      BI.getOrDeclareMuxBuiltin(compiler::utils::eMuxBuiltinGetGroupId, module);
-  assert(get_group_id && "Could not get or insert __mux_get_group_id");
-  Function *get_num_groups = BI.getOrDeclareMuxBuiltin(
-      compiler::utils::eMuxBuiltinGetNumGroups, module);
-  assert(get_num_groups && "Could not get or insert __mux_get_num_groups");
-
   SmallVector<CallInst *, 32> callsToErase;
 
   // Clone functions and add extra argument for printf(). Only functions
@@ -869,8 +816,7 @@ PreservedAnalyses compiler::PrintfReplacementPass::run(
   for (auto *user : printf_func->users()) {
     if (auto *ci = dyn_cast<CallInst>(user)) {
       // rewrite the printf calls
-      rewritePrintfCall(module, ci, printf_func, get_group_id, get_num_groups,
-                        printf_calls);
+      rewritePrintfCall(module, ci, printf_func, printf_calls);
       callsToErase.push_back(ci);
     }
   }
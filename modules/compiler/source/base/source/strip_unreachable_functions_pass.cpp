@@ -0,0 +1,104 @@
+// Copyright (C) Codeplay Software Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+// Exceptions; you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://github.com/codeplaysoftware/oneapi-construction-kit/blob/main/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+#include <base/strip_unreachable_functions_pass.h>
+#include <compiler/utils/attributes.h>
+#include <compiler/utils/metadata.h>
+#include <llvm/ADT/SmallPtrSet.h>
+#include <llvm/ADT/Statistic.h>
+#include <llvm/Analysis/OptimizationRemarkEmitter.h>
+#include <llvm/IR/InstrTypes.h>
+#include <llvm/IR/Module.h>
+
+#define DEBUG_TYPE "strip-unreachable-functions"
+
+using namespace llvm;
+
+STATISTIC(NumFunctionsStripped, "Number of unreachable functions deleted");
+STATISTIC(NumInstructionsStripped,
+          "Number of instructions in unreachable functions deleted");
+
+PreservedAnalyses compiler::StripUnreachableFunctionsPass::run(
+    Module &M, ModuleAnalysisManager &) {
+  SmallPtrSet<Function *, 16> Reachable;
+  SmallVector<Function *, 16> Worklist;
+  auto keep = [&](Function *F) {
+    if (F && Reachable.insert(F).second) {
+      Worklist.push_back(F);
+    }
+  };
+
+  SmallVector<compiler::utils::KernelInfo, 4> Kernels;
+  compiler::utils::populateKernelList(M, Kernels);
+  for (const auto &Kernel : Kernels) {
+    keep(M.getFunction(Kernel.Name));
+  }
+
+  for (auto &F : M) {
+    if (compiler::utils::isKernel(F) ||
+        (KeepExported && !F.isDeclaration() && !F.isDiscardableIfUnused()) ||
+        any_of(F.uses(), [](const Use &U) {
+          auto *const CB = dyn_cast<CallBase>(U.getUser());
+          return !CB || !CB->isCallee(&U);
+        })) {
+      keep(&F);
+    }
+  }
+
+  while (!Worklist.empty()) {
+    Function *const F = Worklist.pop_back_val();
+    for (auto &BB : *F) {
+      for (auto &I : BB) {
+        if (auto *const CB = dyn_cast<CallBase>(&I)) {
+          keep(CB->getCalledFunction());
+        }
+      }
+    }
+  }
+
+  SmallVector<Function *, 16> Unreachable;
+  for (auto &F : M) {
+    if (!F.isDeclaration() && !Reachable.contains(&F)) {
+      Unreachable.push_back(&F);
+    }
+  }
+  if (Unreachable.empty()) {
+    return PreservedAnalyses::all();
+  }
+
+  for (auto *F : Unreachable) {
+    const unsigned NumInstructions = F->getInstructionCount();
+    NumFunctionsStripped++;
+    NumInstructionsStripped += NumInstructions;
+    OptimizationRemarkEmitter ORE(F);
+    ORE.emit([&]() {
+      return OptimizationRemark(DEBUG_TYPE, "Stripped", F)
+             << "deleted '" << ore::NV("Function", F)
+             << "' as no kernel can reach it ("
+             << ore::NV("Instructions", NumInstructions) << " instructions)";
+    });
+  }
+
+  // Unreachable functions can only be called by each other, so once they are
+  // all emptied nothing uses them.
+  for (auto *F : Unreachable) {
+    F->dropAllReferences();
+  }
+  for (auto *F : Unreachable) {
+    F->eraseFromParent();
+  }
+
+  return PreservedAnalyses::none();
+}
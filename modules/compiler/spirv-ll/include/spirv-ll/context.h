@@ -180,12 +180,16 @@ class Context {
   /// @param code Array view of the SPIR-V binary stream.
   /// @param deviceInfo Information about the target device.
   /// @param specInfo Information about specialization constants.
+  /// @param reachableOnly Only translate the functions reachable from the
+  /// module's entry points or with linkage attributes, the rest are private to
+  /// the module and unused so would only be deleted after translation.
   ///
   /// @return Returns a `spirv_ll::Module` on success, otherwise a
   /// `spirv_ll::Error`.
   cargo::expected<spirv_ll::Module, spirv_ll::Error> translate(
       llvm::ArrayRef<uint32_t> code, const spirv_ll::DeviceInfo &deviceInfo,
-      cargo::optional<const spirv_ll::SpecializationInfo &> specInfo);
+      cargo::optional<const spirv_ll::SpecializationInfo &> specInfo,
+      bool reachableOnly = false);
 
   /// @brief LLVM context used for translation to LLVM IR.
   llvm::LLVMContext *llvmContext;
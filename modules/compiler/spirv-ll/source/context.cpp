@@ -14,11 +14,126 @@
 //
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
+#include <llvm/ADT/DenseSet.h>
 #include <spirv-ll/builder.h>
 #include <spirv-ll/context.h>
 #include <spirv-ll/module.h>
 #include <spirv/unified1/spirv.hpp>
 
+namespace {
+/// @brief Check whether an instruction outside of a function only annotates
+/// or describes the IDs it references, rather than using them.
+bool isAnnotation(spv::Op code) {
+  switch (code) {
+    case spv::OpSourceContinued:
+    case spv::OpSource:
+    case spv::OpSourceExtension:
+    case spv::OpName:
+    case spv::OpMemberName:
+    case spv::OpString:
+    case spv::OpLine:
+    case spv::OpNoLine:
+    case spv::OpModuleProcessed:
+    case spv::OpEntryPoint:
+    case spv::OpExecutionMode:
+    case spv::OpExecutionModeId:
+    case spv::OpDecorate:
+    case spv::OpDecorateId:
+    case spv::OpDecorateString:
+    case spv::OpMemberDecorate:
+    case spv::OpMemberDecorateString:
+    case spv::OpDecorationGroup:
+    case spv::OpGroupDecorate:
+    case spv::OpGroupMemberDecorate:
+    // Extended instructions outside of functions are debug information.
+    case spv::OpExtInst:
+      return true;
+    default:
+      return false;
+  }
+}
+
+/// @brief Find the functions reachable from the module's entry points and the
+/// functions with linkage attributes, which are the only functions the
+/// translated module can use.
+///
+/// Any operand of a reachable function's instructions which is the ID of a
+/// function makes that function reachable. This doesn't tell literals apart
+/// from IDs, so may find functions which aren't reachable, but never misses
+/// one which is.
+llvm::DenseSet<spv::Id> findReachableFunctions(
+    const spirv_ll::Module &module) {
+  llvm::DenseMap<spv::Id, spirv_ll::iterator> functions;
+  llvm::SmallVector<spv::Id, 16> worklist;
+  spirv_ll::iterator firstFunction = module.end();
+  for (auto iter = module.begin(); iter != module.end(); ++iter) {
+    const spirv_ll::OpCode op{iter};
+    switch (op.code) {
+      default:
+        break;
+      case spv::OpEntryPoint:
+        worklist.push_back(op.getValueAtOffset(2));
+        break;
+      case spv::OpDecorate:
+        if (op.getValueAtOffset(2) == spv::DecorationLinkageAttributes) {
+          worklist.push_back(op.getValueAtOffset(1));
+        }
+        break;
+      case spv::OpGroupDecorate:
+        // The group's decorations aren't looked up, so conservatively treat
+        // every target as if it had linkage attributes.
+        for (int offset = 2; offset < op.wordCount(); offset++) {
+          worklist.push_back(op.getValueAtOffset(offset));
+        }
+        break;
+      case spv::OpFunction:
+        if (firstFunction == module.end()) {
+          firstFunction = iter;
+        }
+        functions.try_emplace(op.getValueAtOffset(2), iter);
+        break;
+    }
+  }
+
+  // Functions can also be used by the global declarations, for example by
+  // function pointer constants.
+  for (auto iter = module.begin(); iter != firstFunction; ++iter) {
+    const spirv_ll::OpCode op{iter};
+    if (isAnnotation(op.code)) {
+      continue;
+    }
+    for (int offset = 1; offset < op.wordCount(); offset++) {
+      const spv::Id id = op.getValueAtOffset(offset);
+      if (functions.count(id)) {
+        worklist.push_back(id);
+      }
+    }
+  }
+
+  llvm::DenseSet<spv::Id> reachable;
+  while (!worklist.empty()) {
+    const spv::Id function = worklist.pop_back_val();
+    auto found = functions.find(function);
+    if (found == functions.end() || !reachable.insert(function).second) {
+      continue;
+    }
+    for (auto iter = std::next(found->second); iter != module.end(); ++iter) {
+      const spirv_ll::OpCode op{iter};
+      if (op.code == spv::OpFunctionEnd) {
+        break;
+      }
+      for (int offset = 1; offset < op.wordCount(); offset++) {
+        const spv::Id id = op.getValueAtOffset(offset);
+        if (functions.count(id) && !reachable.count(id)) {
+          worklist.push_back(id);
+        }
+      }
+    }
+  }
+  return reachable;
+}
+}  // namespace
+
 spirv_ll::Context::Context()
     : llvmContext(new llvm::LLVMContext), llvmContextIsOwned(true) {}
 
@@ -127,13 +242,21 @@ spirv_ll::Context::getSpecializableConstants(llvm::ArrayRef<uint32_t> code) {
 
 cargo::expected<spirv_ll::Module, spirv_ll::Error> spirv_ll::Context::translate(
     llvm::ArrayRef<uint32_t> code, const spirv_ll::DeviceInfo &deviceInfo,
-    cargo::optional<const spirv_ll::SpecializationInfo &> specInfo) {
+    cargo::optional<const spirv_ll::SpecializationInfo &> specInfo,
+    bool reachableOnly) {
   SPIRV_LL_ASSERT(llvmContext, "llvmContext must not be null");
   spirv_ll::Module module(*this, code, specInfo);
   if (!module.isValid()) {
     return cargo::make_unexpected(Error{"invalid SPIR-V module binary"});
   }
 
+  std::optional<llvm::DenseSet<spv::Id>> reachable;
+  if (reachableOnly) {
+    reachable = findReachableFunctions(module);
+  }
+  // Set while skipping the instructions of an unreachable function.
+  bool skipping = false;
+
   spirv_ll::Builder builder(*this, module, deviceInfo);
 
   using IRInsertPoint = llvm::IRBuilder<>::InsertPoint;
@@ -147,6 +270,16 @@ cargo::expected<spirv_ll::Module, spirv_ll::Error> spirv_ll::Context::translate(
   llvm::SmallVector<OpIRLocTy, 8> Phis;
 
   for (auto op : module) {
+    if (skipping) {
+      skipping = op.code != spv::OpFunctionEnd;
+      continue;
+    }
+    if (reachable && op.code == spv::OpFunction &&
+        !reachable->count(op.getValueAtOffset(2))) {
+      skipping = true;
+      continue;
+    }
+
     std::optional<llvm::Error> error;
     switch (op.code) {
         // Unsupported opcodes are ignored.
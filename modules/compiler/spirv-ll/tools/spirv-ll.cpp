@@ -116,6 +116,14 @@ int main(int argc, char **argv) {
   if (auto error = parser.add_argument({"--spec-constants", specConstants})) {
     return error;
   }
+  // -r, --reachable-only
+  bool reachableOnly = false;
+  if (auto error = parser.add_argument({"-r", reachableOnly})) {
+    return error;
+  }
+  if (auto error = parser.add_argument({"--reachable-only", reachableOnly})) {
+    return error;
+  }
 
   const std::string usage =
       "usage: " + std::string{argv[0]} + " [options] input";
@@ -151,6 +159,9 @@ optional arguments:
                         size of device address in bits
         -s, --spec-constants
                         output all specialization constants and exit
+        -r, --reachable-only
+                        only translate the functions reachable from an entry
+                        point or with linkage attributes
 )";
     return 0;
   }
@@ -207,8 +218,8 @@ optional arguments:
   // passed here, since this is a debug/test tool we can just pass an empty map.
   spirv_ll::SpecializationInfo spvSpecializationInfo;
 
-  auto spvModule =
-      spvContext.translate(spvCode, *spvDeviceInfo, spvSpecializationInfo);
+  auto spvModule = spvContext.translate(spvCode, *spvDeviceInfo,
+                                       spvSpecializationInfo, reachableOnly);
   if (!spvModule) {
     std::cerr << spvModule.error().message << "\n";
     return 1;
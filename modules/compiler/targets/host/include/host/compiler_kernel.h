@@ -25,8 +25,10 @@
 #include <compiler/module.h>
 #include <host/utils/jit_kernel.h>
 
+#include <array>
 #include <map>
 #include <unordered_set>
+#include <utility>
 
 #include "base/module.h"
 
@@ -83,13 +85,62 @@ class HostKernel : public compiler::BaseKernel {
   /// @brief No-op implementation indicating sub-groups are not supported.
   cargo::expected<size_t, compiler::Result> queryMaxSubGroupCount() override;
 
+  /// @see Kernel::getNextTuningCandidate
+  cargo::optional<uint32_t> getNextTuningCandidate(
+      size_t local_size_x, size_t local_size_y, size_t local_size_z) override;
+
+  /// @see Kernel::createTuningCandidateKernel
+  cargo::expected<cargo::dynamic_array<uint8_t>, compiler::Result>
+  createTuningCandidateKernel(
+      const mux_ndrange_options_t &specialization_options,
+      uint32_t candidate) override;
+
+  /// @see Kernel::reportTuningDuration
+  void reportTuningDuration(size_t local_size_x, size_t local_size_y,
+                            size_t local_size_z, uint32_t candidate,
+                            uint64_t duration) override;
+
+  /// @see Kernel::getTuningDecision
+  std::string getTuningDecision(size_t local_size_x, size_t local_size_y,
+                                size_t local_size_z) override;
+
  private:
+  /// @brief Key of `optimized_kernel_map`, a local size and the index of the
+  /// vectorization autotuning candidate the kernel was compiled with.
+  using OptimizedKernelKey = std::pair<std::array<size_t, 3>, uint32_t>;
+
+  /// @brief Local size key of the kernel compiled without a known local size,
+  /// used for non-uniform ND ranges.
+  static constexpr std::array<size_t, 3> unspecialized_local_size = {0, 0, 0};
+
   /// @brief Gets an `OptimizedKernel` object for the given local size.
   ///
   /// @param local_size Local size to optimize the kernel for.
+  /// @param candidate Vectorization autotuning candidate to compile with.
+  cargo::expected<const OptimizedKernel &, compiler::Result>
+  lookupOrCreateOptimizedKernel(std::array<size_t, 3> local_size,
+                                uint32_t candidate);
+
+  /// @brief Gets an `OptimizedKernel` object for the given local size, compiled
+  /// with the autotuned vectorization candidate if there is one.
+  ///
+  /// @param local_size Local size to optimize the kernel for.
   cargo::expected<const OptimizedKernel &, compiler::Result>
   lookupOrCreateOptimizedKernel(std::array<size_t, 3> local_size);
 
+  /// @brief Validates the specialization options and serializes the kernel
+  /// optimized for them.
+  ///
+  /// @param specialization_options Mux execution options to specialize for.
+  /// @param candidate Vectorization autotuning candidate to compile with, or
+  /// `cargo::nullopt` to use the autotuned candidate if there is one.
+  cargo::expected<cargo::dynamic_array<uint8_t>, compiler::Result>
+  createKernelBinary(const mux_ndrange_options_t &specialization_options,
+                     cargo::optional<uint32_t> candidate);
+
+  /// @brief Returns the hash identifying this kernel in the autotuner.
+  uint64_t getTuningHash();
+
   /// @brief LLVM module containing only the kernel function and functions it
   /// calls, not yet optimized for a local size.
   llvm::Module *module;
@@ -98,7 +149,11 @@ class HostKernel : public compiler::BaseKernel {
   ///
   /// By an "optimized module" we mean a copy of this kernel's LLVM module which
   /// has had passes that optimize for a specific local size run on it.
-  std::map<std::array<size_t, 3>, OptimizedKernel> optimized_kernel_map;
+  std::map<OptimizedKernelKey, OptimizedKernel> optimized_kernel_map;
+
+  /// @brief Hash identifying this kernel in the autotuner, computed on first
+  /// use.
+  cargo::optional<uint64_t> tuning_hash;
 
   /// @brief A set of JITDylibs created to manage JIT resources for kernels.
   std::unordered_set<std::string> kernel_jit_dylibs;
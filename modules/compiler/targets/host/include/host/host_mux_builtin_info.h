@@ -53,6 +53,11 @@ class HostBIMuxInfo : public compiler::utils::BIMuxInfoConcept {
   llvm::Value *initializeSchedulingParamForWrappedKernel(
       const compiler::utils::BuiltinInfo::SchedParamInfo &Info,
       llvm::IRBuilder<> &B, llvm::Function &IntoF, llvm::Function &) override;
+
+ private:
+  /// @brief Defines `__mux_get_local_size`, which is smaller than the enqueued
+  /// local size for the trailing work-group of a non-uniform ND range.
+  llvm::Function *defineGetLocalSize(llvm::Module &M);
 };
 
 }  // namespace host
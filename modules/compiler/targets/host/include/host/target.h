@@ -20,6 +20,7 @@
 #include <base/context.h>
 #include <base/target.h>
 #include <compiler/module.h>
+#include <host/vecz_tuner.h>
 #include <llvm/ExecutionEngine/ExecutionEngine.h>
 #include <llvm/ExecutionEngine/Orc/LLJIT.h>
 #include <llvm/ExecutionEngine/Orc/ThreadSafeModule.h>
@@ -59,6 +60,12 @@ class HostTarget : public compiler::BaseTarget {
   /// @see BaseTarget::getBuiltins
   llvm::Module *getBuiltins() const override;
 
+  /// @see BaseTarget::getBuiltinsLinkCache
+  compiler::utils::BuiltinsLinkCache *getBuiltinsLinkCache() const override;
+
+  /// @see BaseTarget::getLinkInputCache
+  compiler::LinkInputCache *getLinkInputCache() const override;
+
   /// @brief GDB Registration Event listener. Must outlive the LLJIT.
   std::unique_ptr<llvm::JITEventListener> gdb_registration_listener;
 
@@ -79,11 +86,23 @@ class HostTarget : public compiler::BaseTarget {
   /// no conflict should occur.
   uint64_t unique_identifier = 0;
 
+  /// @brief Autotuner for vectorization choices, null unless enabled with the
+  /// `CA_HOST_VECZ_AUTOTUNE` environment variable.
+  std::unique_ptr<VeczTuner> vecz_tuner;
+
   /// @brief LLVM Module containing implementations of the builtin functions
   /// this target provides. May be null for compiler targets without external
   /// builtin libraries.
   std::unique_ptr<llvm::Module> builtins;
 
+  /// @brief Link cache of `builtins`, so that each builtin and its callees
+  /// are only found once rather than for every program and specialization.
+  mutable compiler::utils::BuiltinsLinkCache builtins_link_cache;
+
+  /// @brief Optimized link inputs, declared after `llvm_ts_context` so that
+  /// they are destroyed first.
+  mutable compiler::LinkInputCache link_input_cache;
+
 #ifdef CA_ENABLE_HOST_BUILTINS
   std::unique_ptr<llvm::Module> builtins_host;
 #endif
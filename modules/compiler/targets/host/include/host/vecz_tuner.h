@@ -0,0 +1,148 @@
+// Copyright (C) Codeplay Software Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+// Exceptions; you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://github.com/codeplaysoftware/oneapi-construction-kit/blob/main/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+/// @file
+///
+/// @brief Profile-guided autotuning of vectorization choices for host kernels.
+
+#ifndef HOST_VECZ_TUNER_H_INCLUDED
+#define HOST_VECZ_TUNER_H_INCLUDED
+
+#include <cargo/array_view.h>
+#include <cargo/optional.h>
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+
+namespace llvm {
+class Module;
+}
+
+namespace host {
+
+/// @brief A single vectorization configuration tried when autotuning.
+struct VeczTuningCandidate {
+  /// @brief Stable name of the candidate, used in the tuning database.
+  const char *name;
+  /// @brief Choices string in `CODEPLAY_VECZ_CHOICES` syntax enabled on top of
+  /// the default choices, may be empty.
+  const char *choices;
+  /// @brief Right shift applied to the heuristic vectorization width, zero
+  /// keeps the heuristic width.
+  uint32_t width_shift;
+  /// @brief Whether vectorization is disabled entirely for this candidate.
+  bool scalar;
+};
+
+/// @brief Returns the candidate configurations tried when autotuning. Index
+/// zero is always the default configuration.
+cargo::array_view<const VeczTuningCandidate> getVeczTuningCandidates();
+
+/// @brief Tags a module with the autotuning candidate that its kernels should
+/// be vectorized with.
+///
+/// @param[in,out] module Module to tag.
+/// @param[in] candidate Index into `getVeczTuningCandidates`.
+void setVeczTuningCandidate(llvm::Module &module, uint32_t candidate);
+
+/// @brief Returns the autotuning candidate a module was tagged with by
+/// `setVeczTuningCandidate`, if any.
+const VeczTuningCandidate *getVeczTuningCandidate(const llvm::Module &module);
+
+/// @brief Computes a hash of a kernel suitable for keying persisted tuning
+/// decisions across processes.
+///
+/// @param[in] module Module containing the unoptimized kernel.
+/// @param[in] name Name of the kernel.
+/// @param[in] target_id String identifying the target CPU and features.
+uint64_t hashKernelForTuning(const llvm::Module &module,
+                             const std::string &name,
+                             const std::string &target_id);
+
+/// @brief Drives autotuning of vectorization choices and persists decisions.
+///
+/// Autotuning is enabled by setting the `CA_HOST_VECZ_AUTOTUNE` environment
+/// variable. Its value is the path of a file used to persist decisions across
+/// runs, or `1` to keep decisions in memory only. Each candidate is timed
+/// `samples_per_candidate` times for each kernel hash and local size, after
+/// which the fastest candidate is recorded and used for all later launches.
+class VeczTuner {
+ public:
+  /// @brief Number of timed launches of each candidate before deciding.
+  static constexpr uint32_t samples_per_candidate = 3;
+
+  /// @brief Creates a tuner if autotuning was enabled by the environment.
+  ///
+  /// @return Returns the tuner, or `nullptr` if autotuning is disabled.
+  static std::unique_ptr<VeczTuner> createFromEnvironment();
+
+  /// @brief Constructs a tuner.
+  ///
+  /// @param[in] database_path Path of the file to persist decisions to, may be
+  /// empty to keep decisions in memory only.
+  explicit VeczTuner(std::string database_path);
+
+  /// @brief Returns the candidate the next launch should be timed with, or
+  /// `cargo::nullopt` if a decision has been made.
+  cargo::optional<uint32_t> getNextCandidate(
+      uint64_t hash, std::array<size_t, 3> local_size);
+
+  /// @brief Returns the candidate to compile with when not tuning, this is the
+  /// decided candidate if there is one or the default candidate otherwise.
+  uint32_t getSelectedCandidate(uint64_t hash,
+                                std::array<size_t, 3> local_size);
+
+  /// @brief Records the measured duration of one launch of a candidate.
+  void reportDuration(uint64_t hash, std::array<size_t, 3> local_size,
+                      uint32_t candidate, uint64_t duration);
+
+  /// @brief Returns a description of the decision for a kernel and local size,
+  /// or an empty string if undecided.
+  std::string getDecision(uint64_t hash, std::array<size_t, 3> local_size);
+
+ private:
+  using key_t = std::pair<uint64_t, std::array<size_t, 3>>;
+
+  /// @brief Timing state of one kernel and local size being tuned.
+  struct TuningState {
+    /// @brief Number of samples recorded for each candidate.
+    std::array<uint32_t, 8> samples = {};
+    /// @brief Fastest duration seen for each candidate.
+    std::array<uint64_t, 8> best = {};
+    /// @brief Decided candidate, set once all candidates have been sampled.
+    cargo::optional<uint32_t> decision;
+  };
+
+  /// @brief Loads persisted decisions, must be called with `mutex` held.
+  void loadDatabase();
+
+  /// @brief Appends a decision to the database file.
+  void persistDecision(const key_t &key, uint32_t candidate);
+
+  std::mutex mutex;
+  std::string database_path;
+  bool database_loaded = false;
+  std::map<key_t, TuningState> states;
+};
+
+}  // namespace host
+
+#endif  // HOST_VECZ_TUNER_H_INCLUDED
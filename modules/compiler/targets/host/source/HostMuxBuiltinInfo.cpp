@@ -158,10 +158,17 @@ Function *HostBIMuxInfo::defineMuxBuiltin(compiler::utils::BuiltinID ID,
       return compiler::utils::BIMuxInfoConcept::defineMuxBuiltin(ID, M,
                                                                  OverloadInfo);
     case compiler::utils::eMuxBuiltinGetLocalSize:
+      return defineGetLocalSize(M);
+    case compiler::utils::eMuxBuiltinGetEnqueuedLocalSize:
       ParamIdx = SchedParamIndices::SCHED;
       DefaultVal = 1;
       WGFieldIdx = ScheduleInfoStruct::local_size;
       break;
+    case compiler::utils::eMuxBuiltinGetGlobalSize:
+      ParamIdx = SchedParamIndices::SCHED;
+      DefaultVal = 1;
+      WGFieldIdx = ScheduleInfoStruct::global_size;
+      break;
     case compiler::utils::eMuxBuiltinGetGroupId:
       ParamIdx = SchedParamIndices::MINIWG;
       DefaultVal = 0;
@@ -198,6 +205,52 @@ Function *HostBIMuxInfo::defineMuxBuiltin(compiler::utils::BuiltinID ID,
   return nullptr;
 }
 
+Function *HostBIMuxInfo::defineGetLocalSize(Module &M) {
+  Function *F = M.getFunction(compiler::utils::BuiltinInfo::getMuxBuiltinName(
+      compiler::utils::eMuxBuiltinGetLocalSize));
+  assert(F);
+  setDefaultBuiltinAttributes(*F);
+  F->setLinkage(GlobalValue::InternalLinkage);
+
+  auto *const MuxGetEnqueuedLocalSizeFn = getOrDeclareMuxBuiltin(
+      compiler::utils::eMuxBuiltinGetEnqueuedLocalSize, M);
+  auto *const MuxGetGlobalSizeFn =
+      getOrDeclareMuxBuiltin(compiler::utils::eMuxBuiltinGetGlobalSize, M);
+  auto *const MuxGetGroupIdFn =
+      getOrDeclareMuxBuiltin(compiler::utils::eMuxBuiltinGetGroupId, M);
+  assert(MuxGetEnqueuedLocalSizeFn && MuxGetGlobalSizeFn && MuxGetGroupIdFn);
+
+  IRBuilder<> B(BasicBlock::Create(M.getContext(), "", F));
+
+  // Pass on all arguments through to dependent builtins, they all have the
+  // same prototype.
+  const SmallVector<Value *, 4> Args(make_pointer_range(F->args()));
+  auto CreateCall = [&](Function *Fn) {
+    auto *const CI = B.CreateCall(Fn, Args);
+    CI->setAttributes(Fn->getAttributes());
+    CI->setCallingConv(Fn->getCallingConv());
+    return CI;
+  };
+
+  auto *const EnqueuedLocalSize = CreateCall(MuxGetEnqueuedLocalSizeFn);
+  auto *const GlobalSize = CreateCall(MuxGetGlobalSizeFn);
+  auto *const GroupId = CreateCall(MuxGetGroupIdFn);
+
+  // Non-uniform ND ranges are supported, so the last work-group in each
+  // dimension only contains the work-items left over:
+  // get_local_size(i) = min(get_enqueued_local_size(i),
+  //                         get_global_size(i) -
+  //                           get_group_id(i) * get_enqueued_local_size(i))
+  auto *const Remaining = B.CreateSub(
+      GlobalSize, B.CreateMul(GroupId, EnqueuedLocalSize), "remaining");
+  auto *const Ret =
+      B.CreateSelect(B.CreateICmpULT(Remaining, EnqueuedLocalSize), Remaining,
+                     EnqueuedLocalSize);
+
+  B.CreateRet(Ret);
+  return F;
+}
+
 Value *HostBIMuxInfo::initializeSchedulingParamForWrappedKernel(
     const compiler::utils::BuiltinInfo::SchedParamInfo &Info, IRBuilder<> &B,
     Function &IntoF, Function &) {
@@ -279,25 +332,32 @@ Value *HostBIMuxInfo::initializeSchedulingParamForWrappedKernel(
         B.CreateGEP(MiniWGInfoStructTy, AllocaI,
                     {I32Zero, B.getInt32(ScheduleInfoStruct::global_offset)});
 
-    // calculate the number of work groups we are running
+    // calculate the number of work groups we are running, rounding up to
+    // include the trailing work-group of non-uniform ND ranges
+    auto CreateNumGroups = [&](Value *GlobalSize, Value *LocalSize,
+                               const Twine &Name) {
+      auto *const Rounded = B.CreateAdd(
+          GlobalSize, B.CreateSub(LocalSize, ConstantInt::get(SizeTy, 1)));
+      return B.CreateUDiv(Rounded, LocalSize, Name);
+    };
     std::array<Value *, 3> NumGroups;
     if (auto LocalSize = compiler::utils::getLocalSizeMetadata(IntoF)) {
       NumGroups = {
-          B.CreateUDiv(GlobalSizes[0],
-                       ConstantInt::get(SizeTy, (*LocalSize)[0]),
-                       "num_groups_x"),
-          B.CreateUDiv(GlobalSizes[1],
-                       ConstantInt::get(SizeTy, (*LocalSize)[1]),
-                       "num_groups_y"),
-          B.CreateUDiv(GlobalSizes[2],
-                       ConstantInt::get(SizeTy, (*LocalSize)[2]),
-                       "num_groups_z"),
+          CreateNumGroups(GlobalSizes[0],
+                          ConstantInt::get(SizeTy, (*LocalSize)[0]),
+                          "num_groups_x"),
+          CreateNumGroups(GlobalSizes[1],
+                          ConstantInt::get(SizeTy, (*LocalSize)[1]),
+                          "num_groups_y"),
+          CreateNumGroups(GlobalSizes[2],
+                          ConstantInt::get(SizeTy, (*LocalSize)[2]),
+                          "num_groups_z"),
       };
     } else {  // use runtime scheduling info load for local size
       NumGroups = {
-          B.CreateUDiv(GlobalSizes[0], LocalSizes[0], "num_groups_x"),
-          B.CreateUDiv(GlobalSizes[1], LocalSizes[1], "num_groups_y"),
-          B.CreateUDiv(GlobalSizes[2], LocalSizes[2], "num_groups_z"),
+          CreateNumGroups(GlobalSizes[0], LocalSizes[0], "num_groups_x"),
+          CreateNumGroups(GlobalSizes[1], LocalSizes[1], "num_groups_y"),
+          CreateNumGroups(GlobalSizes[2], LocalSizes[2], "num_groups_z"),
       };
     }
 
@@ -24,6 +24,7 @@
 #include <compiler/utils/add_scheduling_parameters_pass.h>
 #include <compiler/utils/align_module_structs_pass.h>
 #include <compiler/utils/attributes.h>
+#include <compiler/utils/compute_indirect_memory_access_pass.h>
 #include <compiler/utils/compute_local_memory_usage_pass.h>
 #include <compiler/utils/define_mux_builtins_pass.h>
 #include <compiler/utils/make_function_name_unique_pass.h>
@@ -44,6 +45,7 @@
 #include <host/host_pass_machinery.h>
 #include <host/remove_byval_attributes_pass.h>
 #include <host/target.h>
+#include <host/vecz_tuner.h>
 #include <llvm/ADT/APFloat.h>
 #include <llvm/ADT/bit.h>
 #include <llvm/Analysis/TargetTransformInfo.h>
@@ -73,6 +75,12 @@ bool hostVeczPassOpts(llvm::Function &F, llvm::ModuleAnalysisManager &MAM,
     Opts.assign(1, *auto_subgroup_vf);
     return true;
   }
+  // Modules being compiled as an autotuning candidate carry the configuration
+  // to try, see HostKernel::createTuningCandidateKernel.
+  const auto *tuning_candidate = host::getVeczTuningCandidate(*F.getParent());
+  if (tuning_candidate && tuning_candidate->scalar) {
+    return false;
+  }
   const auto &DI =
       MAM.getResult<compiler::utils::DeviceInfoAnalysis>(*F.getParent());
   auto max_work_width = DI.max_work_width;
@@ -86,6 +94,14 @@ bool hostVeczPassOpts(llvm::Function &F, llvm::ModuleAnalysisManager &MAM,
     llvm::errs() << "failed to parse the CODEPLAY_VECZ_CHOICES variable\n";
     return false;
   }
+  // Choices are only applied when the whole string parses, so on failure the
+  // candidate is still vectorized with the choices set so far.
+  if (tuning_candidate && *tuning_candidate->choices &&
+      !vecz_options.choices.parseChoicesString(tuning_candidate->choices)) {
+    llvm::errs() << "failed to parse the choices of vectorization tuning "
+                    "candidate '"
+                 << tuning_candidate->name << "'\n";
+  }
 
   auto local_sizes = compiler::utils::getLocalSizeMetadata(F);
 
@@ -110,8 +126,11 @@ bool hostVeczPassOpts(llvm::Function &F, llvm::ModuleAnalysisManager &MAM,
   // and dynamic work width must not exceed the device's maximum
   // work width, so cap it before we even attempt vectorization.
   // Only try to vectorize to widths of powers of two.
-  const uint32_t SIMDWidth = llvm::bit_floor(
+  uint32_t SIMDWidth = llvm::bit_floor(
       local_size != 0 ? std::min(local_size, work_width) : work_width);
+  if (tuning_candidate) {
+    SIMDWidth = std::max(SIMDWidth >> tuning_candidate->width_shift, 1u);
+  }
 
   vecz_options.factor =
       compiler::utils::VectorizationFactor::getFixedWidth(SIMDWidth);
@@ -251,6 +270,12 @@ llvm::ModulePassManager HostPassMachinery::getKernelFinalizationPasses(
   PM.addPass(llvm::createModuleToFunctionPassAdaptor(
       compiler::utils::ReplaceAddressSpaceQualifierFunctionsPass()));
 
+  // Record which kernels only touch the memory bound to their arguments while
+  // those arguments are still passed directly, before the kernel wrapper
+  // loads them from a packed structure. The attribute is copied to each new
+  // version of the kernel.
+  PM.addPass(compiler::utils::ComputeIndirectMemoryAccessPass());
+
   addPreVeczPasses(PM, tuner);
 
   PM.addPass(vecz::RunVeczPass());
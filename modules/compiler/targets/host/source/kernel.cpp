@@ -28,6 +28,7 @@
 #include <host/module.h>
 #include <host/target.h>
 #include <host/utils/relocations.h>
+#include <host/vecz_tuner.h>
 #include <llvm/ADT/Statistic.h>
 #include <llvm/ExecutionEngine/JITSymbol.h>
 #include <llvm/ExecutionEngine/Orc/LLJIT.h>
@@ -100,6 +101,13 @@ cargo::expected<uint32_t, compiler::Result> HostKernel::getDynamicWorkWidth(
 cargo::expected<cargo::dynamic_array<uint8_t>, compiler::Result>
 HostKernel::createSpecializedKernel(
     const mux_ndrange_options_t &specialization_options) {
+  return createKernelBinary(specialization_options, cargo::nullopt);
+}
+
+cargo::expected<cargo::dynamic_array<uint8_t>, compiler::Result>
+HostKernel::createKernelBinary(
+    const mux_ndrange_options_t &specialization_options,
+    cargo::optional<uint32_t> candidate) {
   if (!specialization_options.descriptors &&
       specialization_options.descriptors_length > 0) {
     return cargo::make_unexpected(compiler::Result::INVALID_VALUE);
@@ -142,7 +150,19 @@ HostKernel::createSpecializedKernel(
   std::copy(std::begin(specialization_options.local_size),
             std::end(specialization_options.local_size),
             std::begin(local_size));
-  auto optimized_kernel = lookupOrCreateOptimizedKernel(local_size);
+  // Non-uniform ND ranges run a trailing work-group smaller than the local
+  // size, so the kernel can't be specialized for the local size. The
+  // unspecialized kernel reads the local size at runtime and its work-item
+  // loops run a vectorized main loop followed by a scalar tail.
+  for (uint32_t i = 0; i < specialization_options.dimensions; i++) {
+    if (specialization_options.global_size[i] % local_size[i] != 0) {
+      local_size = unspecialized_local_size;
+      break;
+    }
+  }
+  auto optimized_kernel =
+      candidate ? lookupOrCreateOptimizedKernel(local_size, *candidate)
+                : lookupOrCreateOptimizedKernel(local_size);
   if (!optimized_kernel) {
     return cargo::make_unexpected(optimized_kernel.error());
   }
@@ -229,10 +249,74 @@ cargo::expected<size_t, compiler::Result> HostKernel::queryMaxSubGroupCount() {
   return static_cast<size_t>(info.max_sub_group_count);
 }
 
+cargo::optional<uint32_t> HostKernel::getNextTuningCandidate(
+    size_t local_size_x, size_t local_size_y, size_t local_size_z) {
+  if (!target.vecz_tuner) {
+    return cargo::nullopt;
+  }
+  return target.vecz_tuner->getNextCandidate(
+      getTuningHash(), {local_size_x, local_size_y, local_size_z});
+}
+
+cargo::expected<cargo::dynamic_array<uint8_t>, compiler::Result>
+HostKernel::createTuningCandidateKernel(
+    const mux_ndrange_options_t &specialization_options, uint32_t candidate) {
+  if (!target.vecz_tuner) {
+    return cargo::make_unexpected(compiler::Result::FEATURE_UNSUPPORTED);
+  }
+  if (candidate >= getVeczTuningCandidates().size()) {
+    return cargo::make_unexpected(compiler::Result::INVALID_VALUE);
+  }
+  const tracer::TraceGuard<tracer::Impl> guard(__func__);
+  return createKernelBinary(specialization_options, candidate);
+}
+
+void HostKernel::reportTuningDuration(size_t local_size_x, size_t local_size_y,
+                                      size_t local_size_z, uint32_t candidate,
+                                      uint64_t duration) {
+  if (target.vecz_tuner) {
+    target.vecz_tuner->reportDuration(
+        getTuningHash(), {local_size_x, local_size_y, local_size_z}, candidate,
+        duration);
+  }
+}
+
+std::string HostKernel::getTuningDecision(size_t local_size_x,
+                                          size_t local_size_y,
+                                          size_t local_size_z) {
+  if (!target.vecz_tuner) {
+    return {};
+  }
+  return target.vecz_tuner->getDecision(
+      getTuningHash(), {local_size_x, local_size_y, local_size_z});
+}
+
+uint64_t HostKernel::getTuningHash() {
+  const std::lock_guard<compiler::Context> guard(target.getContext());
+  if (!tuning_hash) {
+    auto *const TM = target.target_machine.get();
+    tuning_hash = hashKernelForTuning(
+        *module, name,
+        (TM->getTargetCPU() + ":" + TM->getTargetFeatureString()).str());
+  }
+  return *tuning_hash;
+}
+
 cargo::expected<const OptimizedKernel &, compiler::Result>
 HostKernel::lookupOrCreateOptimizedKernel(std::array<size_t, 3> local_size) {
-  if (0 < optimized_kernel_map.count(local_size)) {
-    return optimized_kernel_map[local_size];
+  const uint32_t candidate =
+      target.vecz_tuner
+          ? target.vecz_tuner->getSelectedCandidate(getTuningHash(), local_size)
+          : 0;
+  return lookupOrCreateOptimizedKernel(local_size, candidate);
+}
+
+cargo::expected<const OptimizedKernel &, compiler::Result>
+HostKernel::lookupOrCreateOptimizedKernel(std::array<size_t, 3> local_size,
+                                          uint32_t candidate) {
+  const OptimizedKernelKey key{local_size, candidate};
+  if (0 < optimized_kernel_map.count(key)) {
+    return optimized_kernel_map[key];
   }
 
   {
@@ -242,6 +326,10 @@ HostKernel::lookupOrCreateOptimizedKernel(std::array<size_t, 3> local_size) {
     if (nullptr == optimized_module) {
       return cargo::make_unexpected(compiler::Result::OUT_OF_MEMORY);
     }
+    if (candidate != 0) {
+      // Picked up by hostVeczPassOpts when vectorizing the kernel.
+      setVeczTuningCandidate(*optimized_module, candidate);
+    }
 
     // max length of a uint64_t is 20 digits, 64 just to be comfortable with the
     // prefix of '__mux_host_'
@@ -261,7 +349,8 @@ HostKernel::lookupOrCreateOptimizedKernel(std::array<size_t, 3> local_size) {
     auto builtinInfoCallback = [&](const llvm::Module &) {
       return compiler::utils::BuiltinInfo(
           std::make_unique<HostBIMuxInfo>(),
-          compiler::utils::createCLBuiltinInfo(target.getBuiltins()));
+          compiler::utils::createCLBuiltinInfo(target.getBuiltins(),
+                                               target.getBuiltinsLinkCache()));
     };
     auto deviceInfo = compiler::initDeviceInfoFromMux(device_info);
     HostPassMachinery pass_mach(module->getContext(), TM, deviceInfo,
@@ -278,9 +367,11 @@ HostKernel::lookupOrCreateOptimizedKernel(std::array<size_t, 3> local_size) {
     // creating the kernel, but now we have more accurate local size data.
     compiler::utils::EncodeKernelMetadataPassOptions pass_opts;
     pass_opts.KernelName = name;
-    pass_opts.LocalSizes = {static_cast<uint64_t>(local_size[0]),
-                            static_cast<uint64_t>(local_size[1]),
-                            static_cast<uint64_t>(local_size[2])};
+    if (local_size != unspecialized_local_size) {
+      pass_opts.LocalSizes = {static_cast<uint64_t>(local_size[0]),
+                              static_cast<uint64_t>(local_size[1]),
+                              static_cast<uint64_t>(local_size[2])};
+    }
     pm.addPass(compiler::utils::EncodeKernelMetadataPass(pass_opts));
 
     pm.addPass(pass_mach.getKernelFinalizationPasses(unique_name));
@@ -474,11 +565,11 @@ HostKernel::lookupOrCreateOptimizedKernel(std::array<size_t, 3> local_size) {
     std::unique_ptr<host::utils::jit_kernel_s> jit_kernel(
         new host::utils::jit_kernel_s{
             name, hook, static_cast<uint32_t>(fn_metadata.local_memory_usage),
-            min_width, pref_width, sub_group_size});
+            min_width, pref_width, sub_group_size,
+            fn_metadata.may_access_memory_indirectly});
     optimized_kernel_map.emplace(
-        local_size,
-        OptimizedKernel{optimized_module_ptr, std::move(jit_kernel)});
+        key, OptimizedKernel{optimized_module_ptr, std::move(jit_kernel)});
   }
-  return optimized_kernel_map[local_size];
+  return optimized_kernel_map[key];
 }
 }  // namespace host
@@ -31,6 +31,9 @@
 #include <compiler/utils/cl_builtin_info.h>
 #include <compiler/utils/compute_local_memory_usage_pass.h>
 #include <compiler/utils/encode_kernel_metadata_pass.h>
+#ifdef HOST_LLD_LINKER
+#include <compiler/utils/lld_linker.h>
+#endif
 #include <compiler/utils/llvm_global_mutex.h>
 #include <compiler/utils/metadata.h>
 #include <compiler/utils/metadata_analysis.h>
@@ -100,6 +103,41 @@ const HostTarget &HostModule::getHostTarget() const {
 
 static cargo::expected<cargo::dynamic_array<uint8_t>, compiler::Result>
 emitBinary(llvm::Module *module, llvm::TargetMachine *target_machine) {
+#ifdef HOST_LLD_LINKER
+  // Generate code for each kernel in parallel, then merge the objects back
+  // into the single relocatable object the host loader expects. They are
+  // always linked in the same order, so the result doesn't depend on the
+  // number of threads which generated them.
+  llvm::SmallVector<llvm::SmallVector<char, 0>, 8> objects;
+  auto result = compiler::emitCodeGenFiles(*module, target_machine, objects);
+  if (result != compiler::Result::SUCCESS) {
+    return cargo::make_unexpected(result);
+  }
+
+  std::unique_ptr<llvm::MemoryBuffer> linked_object;
+  if (objects.size() > 1) {
+    llvm::SmallVector<llvm::ArrayRef<uint8_t>, 8> inputs;
+    for (const auto &object : objects) {
+      inputs.emplace_back(reinterpret_cast<const uint8_t *>(object.data()),
+                          object.size());
+    }
+    const llvm::SmallVector<std::string, 1> lld_args = {"-r"};
+    // lld isn't reentrant.
+    const std::lock_guard<std::mutex> globalLock(
+        compiler::utils::getLLVMGlobalMutex());
+    auto link_result = compiler::utils::lldLinkToBinary(
+        inputs, /*linkerScriptStr*/ "", /*linkerLib*/ nullptr,
+        /*linkerLibBytes*/ 0, lld_args);
+    if (auto error = link_result.takeError()) {
+      llvm::consumeError(std::move(error));
+      return cargo::make_unexpected(compiler::Result::LINK_PROGRAM_FAILURE);
+    }
+    linked_object = std::move(*link_result);
+  }
+  const llvm::StringRef object_code_buffer =
+      linked_object ? linked_object->getBuffer()
+                    : llvm::StringRef(objects[0].data(), objects[0].size());
+#else
   llvm::SmallVector<char, 1024> object_code_buffer;
   llvm::raw_svector_ostream stream(object_code_buffer);
 
@@ -107,6 +145,7 @@ emitBinary(llvm::Module *module, llvm::TargetMachine *target_machine) {
   if (result != compiler::Result::SUCCESS) {
     return cargo::make_unexpected(result);
   }
+#endif
 
   cargo::dynamic_array<uint8_t> binary;
   if (binary.alloc(object_code_buffer.size())) {
@@ -139,6 +178,11 @@ HostModule::hostCompileObject(HostTarget &target,
   initializePassMachineryForFinalize(host_pass_mach);
 
   llvm::ModulePassManager pm;
+  // The finalized module hasn't been optimized yet if that was deferred to
+  // kernel creation, so do it here for the whole program instead.
+  if (isOptimizationDeferred()) {
+    addDeferredOptimizationPasses(pm, host_pass_mach);
+  }
   pm.addPass(compiler::utils::TransferKernelMetadataPass());
 
   pm.addPass(host_pass_mach.getKernelFinalizationPasses());
@@ -162,6 +206,7 @@ HostModule::hostCompileObject(HostTarget &target,
     }
   }
 
+  const compiler::BuildProfiler::Stage stage(profiler, "codegen");
   auto binaryOrError =
       emitBinary(cloned_module.get(), target.target_machine.get());
 
@@ -187,6 +232,7 @@ compiler::Result HostModule::createBinary(
   std::unique_ptr<llvm::Module> clonedModule;
   {
     const std::lock_guard<compiler::Context> guard(context);
+    const compiler::BuildProfiler::Stage stage(profiler, "binary");
 
     clonedModule = llvm::CloneModule(*finalized_llvm_module.get());
 
@@ -220,6 +266,7 @@ compiler::Kernel *HostModule::createKernel(const std::string &name) {
   handler::GenericMetadata kernel_md(name, name, 0);
   {
     const std::lock_guard<compiler::Context> guard(context);
+    const compiler::BuildProfiler::Stage stage(profiler, "kernel " + name);
     kernel_module = llvm::CloneModule(*finalized_llvm_module);
 
     if (!kernel_module || !kernel_module->getFunction(name)) {
@@ -228,17 +275,36 @@ compiler::Kernel *HostModule::createKernel(const std::string &name) {
 
     llvm::ModulePassManager pm;
     auto pass_mach = createPassMachinery();
-    pass_mach->initializeStart();
-    pass_mach->initializeFinish();
+    const bool optimize = isOptimizationDeferred();
+    if (optimize) {
+      static_cast<HostPassMachinery &>(*pass_mach).setCompilerOptions(options);
+      initializePassMachineryForFinalize(*pass_mach);
+    } else {
+      pass_mach->initializeStart();
+      pass_mach->initializeFinish();
+    }
 
     // Set up the kernel metadata which informs later passes which kernel we're
     // interested in optimizing.
     const compiler::utils::EncodeKernelMetadataPassOptions pass_opts{name};
     pm.addPass(compiler::utils::EncodeKernelMetadataPass(pass_opts));
     pm.addPass(compiler::utils::ReduceToFunctionPass());
+    // Optimizing after reducing the module means only this kernel and the
+    // functions it calls are optimized, rather than the whole program.
+    if (optimize) {
+      addDeferredOptimizationPasses(pm, *pass_mach);
+    }
     pm.addPass(compiler::utils::ComputeLocalMemoryUsagePass());
 
-    pm.run(*kernel_module, pass_mach->getMAM());
+    {
+      // The optimization pipeline touches LLVM's global state.
+      std::unique_lock<std::mutex> globalLock(
+          compiler::utils::getLLVMGlobalMutex(), std::defer_lock);
+      if (optimize) {
+        globalLock.lock();
+      }
+      pm.run(*kernel_module, pass_mach->getMAM());
+    }
     // Retrieve the estimation of the amount of local memory this kernel uses.
     if (auto *f = kernel_module->getFunction(name)) {
       kernel_md = pass_mach->getFAM()
@@ -268,10 +334,11 @@ HostModule::createPassMachinery() {
   auto *TM = static_cast<HostTarget &>(target).target_machine.get();
   auto Info =
       compiler::initDeviceInfoFromMux(target.getCompilerInfo()->device_info);
-  auto Callback = [BI = target.getBuiltins()](const llvm::Module &) {
+  auto *Cache = target.getBuiltinsLinkCache();
+  auto Callback = [BI = target.getBuiltins(), Cache](const llvm::Module &) {
     return compiler::utils::BuiltinInfo(
         std::make_unique<HostBIMuxInfo>(),
-        compiler::utils::createCLBuiltinInfo(BI));
+        compiler::utils::createCLBuiltinInfo(BI, Cache));
   };
   return std::make_unique<host::HostPassMachinery>(
       target.getLLVMContext(), TM, Info, Callback,
@@ -394,6 +394,12 @@ compiler::Result HostTarget::initWithBuiltins(
     target_machine.reset(createTargetMachine(triple, CPUName, Features, ABI));
   }
 
+  // Autotuning times kernels at enqueue time, so only makes sense when
+  // compiling just in time.
+  if (orc_engine) {
+    vecz_tuner = VeczTuner::createFromEnvironment();
+  }
+
   return compiler::Result::SUCCESS;
 }
 
@@ -415,4 +421,13 @@ const llvm::LLVMContext &HostTarget::getLLVMContext() const {
 
 llvm::Module *HostTarget::getBuiltins() const { return builtins.get(); }
 
+compiler::utils::BuiltinsLinkCache *HostTarget::getBuiltinsLinkCache()
+    const {
+  return &builtins_link_cache;
+}
+
+compiler::LinkInputCache *HostTarget::getLinkInputCache() const {
+  return &link_input_cache;
+}
+
 }  // namespace host
@@ -0,0 +1,236 @@
+// Copyright (C) Codeplay Software Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+// Exceptions; you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://github.com/codeplaysoftware/oneapi-construction-kit/blob/main/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <host/vecz_tuner.h>
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Bitcode/BitcodeWriter.h>
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/Metadata.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
+namespace host {
+namespace {
+const VeczTuningCandidate candidates[] = {
+    {"default", "", 0, false},
+    {"packetize-uniform", "PacketizeUniform", 0, false},
+    {"boscc", "LinearizeBOSCC", 0, false},
+    {"vector-predication", "VectorPredication", 0, false},
+    {"half-width", "", 1, false},
+    {"scalar", "", 0, true},
+};
+
+constexpr size_t num_candidates = sizeof(candidates) / sizeof(candidates[0]);
+
+/// @brief Name of the named metadata node used to tag tuned modules.
+constexpr const char *candidate_md_name = "host.vecz_tuning_candidate";
+
+/// @brief 64-bit FNV-1a, used because it is stable across processes unlike
+/// `llvm::hash_value`.
+uint64_t fnv1a(uint64_t hash, llvm::StringRef data) {
+  for (const unsigned char c : data) {
+    hash ^= c;
+    hash *= 0x100000001b3ULL;
+  }
+  return hash;
+}
+}  // namespace
+
+cargo::array_view<const VeczTuningCandidate> getVeczTuningCandidates() {
+  return {std::begin(candidates), std::end(candidates)};
+}
+
+void setVeczTuningCandidate(llvm::Module &module, uint32_t candidate) {
+  auto &ctx = module.getContext();
+  if (auto *md = module.getNamedMetadata(candidate_md_name)) {
+    module.eraseNamedMetadata(md);
+  }
+  auto *md = module.getOrInsertNamedMetadata(candidate_md_name);
+  md->addOperand(llvm::MDNode::get(
+      ctx, llvm::ConstantAsMetadata::get(llvm::ConstantInt::get(
+               llvm::Type::getInt32Ty(ctx), candidate))));
+}
+
+const VeczTuningCandidate *getVeczTuningCandidate(const llvm::Module &module) {
+  auto *md = module.getNamedMetadata(candidate_md_name);
+  if (!md || md->getNumOperands() != 1) {
+    return nullptr;
+  }
+  auto *node = md->getOperand(0);
+  if (node->getNumOperands() != 1) {
+    return nullptr;
+  }
+  auto *index =
+      llvm::mdconst::dyn_extract<llvm::ConstantInt>(node->getOperand(0));
+  if (!index || index->getZExtValue() >= num_candidates) {
+    return nullptr;
+  }
+  return &candidates[index->getZExtValue()];
+}
+
+uint64_t hashKernelForTuning(const llvm::Module &module,
+                             const std::string &name,
+                             const std::string &target_id) {
+  llvm::SmallVector<char, 0> bitcode;
+  llvm::raw_svector_ostream stream(bitcode);
+  llvm::WriteBitcodeToFile(module, stream);
+
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  hash = fnv1a(hash, llvm::StringRef(bitcode.data(), bitcode.size()));
+  hash = fnv1a(hash, name);
+  return fnv1a(hash, target_id);
+}
+
+std::unique_ptr<VeczTuner> VeczTuner::createFromEnvironment() {
+  const char *env = std::getenv("CA_HOST_VECZ_AUTOTUNE");
+  if (!env || !*env || 0 == std::strcmp(env, "0")) {
+    return nullptr;
+  }
+  return std::unique_ptr<VeczTuner>(
+      new VeczTuner(0 == std::strcmp(env, "1") ? "" : env));
+}
+
+VeczTuner::VeczTuner(std::string database_path)
+    : database_path(std::move(database_path)) {
+  static_assert(num_candidates <= std::tuple_size<decltype(
+                                      TuningState::samples)>::value,
+                "too many tuning candidates for TuningState");
+}
+
+void VeczTuner::loadDatabase() {
+  if (database_loaded) {
+    return;
+  }
+  database_loaded = true;
+  if (database_path.empty()) {
+    return;
+  }
+  std::ifstream file(database_path);
+  std::string line;
+  while (std::getline(file, line)) {
+    // Each line is "<hash> <x> <y> <z> <candidate-name>", later lines override
+    // earlier ones for the same kernel and local size.
+    std::istringstream fields(line);
+    std::string hash_str, candidate_name;
+    key_t key;
+    if (!(fields >> hash_str >> key.second[0] >> key.second[1] >>
+          key.second[2] >> candidate_name)) {
+      continue;
+    }
+    key.first = std::strtoull(hash_str.c_str(), nullptr, 16);
+    for (uint32_t i = 0; i < num_candidates; i++) {
+      if (candidate_name == candidates[i].name) {
+        states[key].decision = i;
+        break;
+      }
+    }
+  }
+}
+
+void VeczTuner::persistDecision(const key_t &key, uint32_t candidate) {
+  if (database_path.empty()) {
+    return;
+  }
+  std::ofstream file(database_path, std::ios::app);
+  if (!file) {
+    return;
+  }
+  char hash_str[17];
+  std::snprintf(hash_str, sizeof(hash_str), "%016" PRIx64, key.first);
+  file << hash_str << ' ' << key.second[0] << ' ' << key.second[1] << ' '
+       << key.second[2] << ' ' << candidates[candidate].name << '\n';
+}
+
+cargo::optional<uint32_t> VeczTuner::getNextCandidate(
+    uint64_t hash, std::array<size_t, 3> local_size) {
+  const std::lock_guard<std::mutex> lock(mutex);
+  loadDatabase();
+  auto &state = states[{hash, local_size}];
+  if (state.decision) {
+    return cargo::nullopt;
+  }
+  // Round-robin through the candidates so that each sample of a candidate is
+  // taken under similar conditions (warm caches, thread pool spun up, ...).
+  uint32_t next = 0;
+  for (uint32_t i = 1; i < num_candidates; i++) {
+    if (state.samples[i] < state.samples[next]) {
+      next = i;
+    }
+  }
+  return next;
+}
+
+uint32_t VeczTuner::getSelectedCandidate(uint64_t hash,
+                                         std::array<size_t, 3> local_size) {
+  const std::lock_guard<std::mutex> lock(mutex);
+  loadDatabase();
+  auto state = states.find({hash, local_size});
+  if (state == states.end() || !state->second.decision) {
+    return 0;
+  }
+  return *state->second.decision;
+}
+
+void VeczTuner::reportDuration(uint64_t hash, std::array<size_t, 3> local_size,
+                               uint32_t candidate, uint64_t duration) {
+  if (candidate >= num_candidates) {
+    return;
+  }
+  const std::lock_guard<std::mutex> lock(mutex);
+  const key_t key{hash, local_size};
+  auto &state = states[key];
+  if (state.decision) {
+    return;
+  }
+  if (0 == state.samples[candidate] || duration < state.best[candidate]) {
+    state.best[candidate] = duration;
+  }
+  state.samples[candidate]++;
+
+  uint32_t fastest = 0;
+  for (uint32_t i = 0; i < num_candidates; i++) {
+    if (state.samples[i] < samples_per_candidate) {
+      return;
+    }
+    if (state.best[i] < state.best[fastest]) {
+      fastest = i;
+    }
+  }
+  state.decision = fastest;
+  persistDecision(key, fastest);
+}
+
+std::string VeczTuner::getDecision(uint64_t hash,
+                                   std::array<size_t, 3> local_size) {
+  const std::lock_guard<std::mutex> lock(mutex);
+  loadDatabase();
+  auto state = states.find({hash, local_size});
+  if (state == states.end() || !state->second.decision) {
+    return {};
+  }
+  return candidates[*state->second.decision].name;
+}
+
+}  // namespace host
@@ -0,0 +1,42 @@
+; Copyright (C) Codeplay Software Limited
+;
+; Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+; Exceptions; you may not use this file except in compliance with the License.
+; You may obtain a copy of the License at
+;
+;     https://github.com/codeplaysoftware/oneapi-construction-kit/blob/main/LICENSE.txt
+;
+; Unless required by applicable law or agreed to in writing, software
+; distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+; WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+; License for the specific language governing permissions and limitations
+; under the License.
+;
+; SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+; Check that host defines the work-group size builtins such that the trailing
+; work-group of a non-uniform ND range is smaller than the enqueued local size.
+
+; RUN: muxc --device "%default_device" --passes add-sched-params,define-mux-builtins,verify -S %s | FileCheck %s
+
+target triple = "spir64-unknown-unknown"
+target datalayout = "e-p:64:64:64-m:e-i64:64-f80:128-n8:16:32:64-S128"
+
+; CHECK: define internal i64 @__mux_get_local_size(i32 [[IDX:%.*]], ptr {{.*}}%wi-info, ptr {{.*}}%sched-info, ptr {{.*}}%mini-wg-info)
+; CHECK-DAG: [[ENQ:%.*]] = call i64 @__mux_get_enqueued_local_size(i32 [[IDX]], ptr %wi-info, ptr %sched-info, ptr %mini-wg-info)
+; CHECK-DAG: [[GSZ:%.*]] = call i64 @__mux_get_global_size(i32 [[IDX]], ptr %wi-info, ptr %sched-info, ptr %mini-wg-info)
+; CHECK-DAG: [[GID:%.*]] = call i64 @__mux_get_group_id(i32 [[IDX]], ptr %wi-info, ptr %sched-info, ptr %mini-wg-info)
+; CHECK: [[OFFSET:%.*]] = mul i64 [[GID]], [[ENQ]]
+; CHECK: [[REM:%.*]] = sub i64 [[GSZ]], [[OFFSET]]
+; CHECK: [[CMP:%.*]] = icmp ult i64 [[REM]], [[ENQ]]
+; CHECK: [[RET:%.*]] = select i1 [[CMP]], i64 [[REM]], i64 [[ENQ]]
+; CHECK: ret i64 [[RET]]
+declare i64 @__mux_get_local_size(i32)
+
+; The enqueued local size and global size are read straight from the schedule.
+; CHECK: define internal i64 @__mux_get_enqueued_local_size(
+; CHECK: getelementptr %Mux_schedule_info_s, ptr %sched-info, i32 0, i32 2,
+; CHECK: define internal i64 @__mux_get_global_size(
+; CHECK: getelementptr %Mux_schedule_info_s, ptr %sched-info, i32 0, i32 0,
+declare i64 @__mux_get_enqueued_local_size(i32)
+declare i64 @__mux_get_global_size(i32)
@@ -0,0 +1,104 @@
+; Copyright (C) Codeplay Software Limited
+;
+; Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+; Exceptions; you may not use this file except in compliance with the License.
+; You may obtain a copy of the License at
+;
+;     https://github.com/codeplaysoftware/oneapi-construction-kit/blob/main/LICENSE.txt
+;
+; Unless required by applicable law or agreed to in writing, software
+; distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+; WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+; License for the specific language governing permissions and limitations
+; under the License.
+;
+; SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+; RUN: muxc --passes compute-indirect-memory-access,verify -S %s | FileCheck %s
+
+declare spir_func i64 @__mux_get_global_id(i32)
+
+declare spir_func void @ext_fn(ptr addrspace(1))
+
+declare void @llvm.memcpy.p0.p1.i64(ptr, ptr addrspace(1), i64, i1)
+
+define spir_func void @copy_helper(ptr addrspace(1) %in, ptr addrspace(1) %out) {
+  %gid = call spir_func i64 @__mux_get_global_id(i32 0)
+  %in.gep = getelementptr float, ptr addrspace(1) %in, i64 %gid
+  %out.gep = getelementptr float, ptr addrspace(1) %out, i64 %gid
+  %v = load float, ptr addrspace(1) %in.gep, align 4
+  store float %v, ptr addrspace(1) %out.gep, align 4
+  ret void
+}
+
+define spir_func void @deref_helper(ptr addrspace(1) %in) {
+  %p = load ptr addrspace(1), ptr addrspace(1) %in, align 8
+  store float 0.0, ptr addrspace(1) %p, align 4
+  ret void
+}
+
+; Only accesses the buffers it was given, through a helper.
+; CHECK: define spir_kernel void @direct(ptr addrspace(1) %in, ptr addrspace(1) %out) [[ATTRS_DIRECT:#[0-9]+]] {
+define spir_kernel void @direct(ptr addrspace(1) %in, ptr addrspace(1) %out) #0 {
+  call spir_func void @copy_helper(ptr addrspace(1) %in, ptr addrspace(1) %out)
+  ret void
+}
+
+; Pointers spilled to and reloaded from the stack, as at -O0, are still direct.
+; CHECK: define spir_kernel void @stack(ptr addrspace(1) %in) [[ATTRS_DIRECT]] {
+define spir_kernel void @stack(ptr addrspace(1) %in) #0 {
+  %in.addr = alloca ptr addrspace(1), align 8
+  store ptr addrspace(1) %in, ptr %in.addr, align 8
+  %p = load ptr addrspace(1), ptr %in.addr, align 8
+  store float 0.0, ptr addrspace(1) %p, align 4
+  ret void
+}
+
+; A device pointer stored inside a buffer.
+; CHECK: define spir_kernel void @loaded(ptr addrspace(1) %in) [[ATTRS_INDIRECT:#[0-9]+]] {
+define spir_kernel void @loaded(ptr addrspace(1) %in) #0 {
+  %p = load ptr addrspace(1), ptr addrspace(1) %in, align 8
+  store float 0.0, ptr addrspace(1) %p, align 4
+  ret void
+}
+
+; The same, but in a called function.
+; CHECK: define spir_kernel void @loaded_in_callee(ptr addrspace(1) %in) [[ATTRS_INDIRECT]] {
+define spir_kernel void @loaded_in_callee(ptr addrspace(1) %in) #0 {
+  call spir_func void @deref_helper(ptr addrspace(1) %in)
+  ret void
+}
+
+; A pointer copied out of a buffer onto the stack before being loaded.
+; CHECK: define spir_kernel void @copied(ptr addrspace(1) %in) [[ATTRS_INDIRECT]] {
+define spir_kernel void @copied(ptr addrspace(1) %in) #0 {
+  %tmp = alloca ptr addrspace(1), align 8
+  call void @llvm.memcpy.p0.p1.i64(ptr %tmp, ptr addrspace(1) %in, i64 8, i1 false)
+  %p = load ptr addrspace(1), ptr %tmp, align 8
+  store float 0.0, ptr addrspace(1) %p, align 4
+  ret void
+}
+
+; CHECK: define spir_kernel void @from_int(i64 %addr) [[ATTRS_INDIRECT]] {
+define spir_kernel void @from_int(i64 %addr) #0 {
+  %p = inttoptr i64 %addr to ptr addrspace(1)
+  store float 0.0, ptr addrspace(1) %p, align 4
+  ret void
+}
+
+; CHECK: define spir_kernel void @indirect_call(ptr %fn) [[ATTRS_INDIRECT]] {
+define spir_kernel void @indirect_call(ptr %fn) #0 {
+  call spir_func void %fn()
+  ret void
+}
+
+; CHECK: define spir_kernel void @unknown_call(ptr addrspace(1) %in) [[ATTRS_INDIRECT]] {
+define spir_kernel void @unknown_call(ptr addrspace(1) %in) #0 {
+  call spir_func void @ext_fn(ptr addrspace(1) %in)
+  ret void
+}
+
+; CHECK-DAG: attributes [[ATTRS_DIRECT]] = { "mux-kernel"="entry-point" "mux-no-indirect-memory-access" }
+; CHECK-DAG: attributes [[ATTRS_INDIRECT]] = { "mux-kernel"="entry-point" }
+
+attributes #0 = { "mux-kernel"="entry-point" }
@@ -47,7 +47,7 @@ declare !mux_scheduled_fn !1 i64 @__mux_get_global_id(i32)
 ; CHECK: [[TMP0:%.*]] = call i64 @__mux_get_group_id(i32 [[IDX]], ptr [[WIATTRS]] [[WI]], ptr [[WGATTRS]] [[WG]])
 ; CHECK: [[TMP1:%.*]] = call i64 @__mux_get_global_offset(i32 [[IDX]], ptr [[WIATTRS]] [[WI]], ptr [[WGATTRS]] [[WG]])
 ; CHECK: [[TMP2:%.*]] = call i64 @__mux_get_local_id(i32 [[IDX]], ptr [[WIATTRS]] [[WI]], ptr [[WGATTRS]] [[WG]])
-; CHECK: [[TMP3:%.*]] = call i64 @__mux_get_local_size(i32 [[IDX]], ptr [[WIATTRS]] [[WI]], ptr [[WGATTRS]] [[WG]])
+; CHECK: [[TMP3:%.*]] = call i64 @__mux_get_enqueued_local_size(i32 [[IDX]], ptr [[WIATTRS]] [[WI]], ptr [[WGATTRS]] [[WG]])
 ; CHECK: [[TMP4:%.*]] = mul i64 [[TMP0]], [[TMP3]]
 ; CHECK: [[TMP5:%.*]] = add i64 [[TMP4]], [[TMP2]]
 ; CHECK: [[TMP6:%.*]] = add i64 [[TMP5]], [[TMP1]]
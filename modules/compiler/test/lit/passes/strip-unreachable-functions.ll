@@ -0,0 +1,70 @@
+; Copyright (C) Codeplay Software Limited
+;
+; Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+; Exceptions; you may not use this file except in compliance with the License.
+; You may obtain a copy of the License at
+;
+;     https://github.com/codeplaysoftware/oneapi-construction-kit/blob/main/LICENSE.txt
+;
+; Unless required by applicable law or agreed to in writing, software
+; distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+; WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+; License for the specific language governing permissions and limitations
+; under the License.
+;
+; SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+; RUN: muxc --passes strip-unreachable-functions,verify -S %s | FileCheck %s --check-prefixes=CHECK,PROGRAM
+; RUN: muxc --passes "strip-unreachable-functions<keep-exported>",verify -S %s | FileCheck %s --check-prefixes=CHECK,EXPORTED
+
+target triple = "spir64-unknown-unknown"
+target datalayout = "e-p:64:64:64-m:e-i64:64-f80:128-n8:16:32:64-S128"
+
+@fn_ptr = global ptr @address_taken
+
+; CHECK: define spir_kernel void @kernel()
+define spir_kernel void @kernel() {
+  call void @callee()
+  ret void
+}
+
+; CHECK: define internal void @callee()
+define internal void @callee() {
+  call void @callee_of_callee()
+  ret void
+}
+
+; CHECK: define void @callee_of_callee()
+define void @callee_of_callee() {
+  ret void
+}
+
+; Kept as it is used by something other than a call.
+; CHECK: define internal void @address_taken()
+define internal void @address_taken() {
+  call void @callee_of_address_taken()
+  ret void
+}
+
+; CHECK: define internal void @callee_of_address_taken()
+define internal void @callee_of_address_taken() {
+  ret void
+}
+
+; Unreachable functions which can be linked against are only deleted from
+; whole programs.
+; PROGRAM-NOT: define void @exported()
+; EXPORTED: define void @exported()
+define void @exported() {
+  ret void
+}
+
+; CHECK-NOT: define internal void @unreachable_recursive()
+define internal void @unreachable_recursive() {
+  call void @unreachable_recursive()
+  ret void
+}
+
+; Declarations are left for later passes.
+; CHECK: declare void @unused_declaration()
+declare void @unused_declaration()
@@ -21,6 +21,7 @@
 ; CHECK-NEXT: Source Name: kernel1
 ; CHECK-NEXT: Local Memory: 0
 ; CHECK-NEXT: Sub-group Size: vscale x 1
+; CHECK-NEXT: Indirect Memory Access: maybe
 ; CHECK-NEXT: Min Work Width: 1
 ; CHECK-NEXT: Preferred Work Width: vscale x 1
 
@@ -28,6 +29,7 @@
 ; CHECK-NEXT: Source Name: test
 ; CHECK-NEXT: Local Memory: 0
 ; CHECK-NEXT: Sub-group Size: 1
+; CHECK-NEXT: Indirect Memory Access: no
 ; CHECK-NEXT: Min Work Width: 1
 ; CHECK-NEXT: Preferred Work Width: 1
 
@@ -35,6 +37,7 @@
 ; CHECK-NEXT: Source Name: kernel3
 ; CHECK-NEXT: Local Memory: 0
 ; CHECK-NEXT: Sub-group Size: vscale x 1
+; CHECK-NEXT: Indirect Memory Access: maybe
 ; CHECK-NEXT: Min Work Width: 1
 ; CHECK-NEXT: Preferred Work Width: vscale x 1
 
@@ -42,6 +45,7 @@
 ; CHECK-NEXT: Source Name: kernel4
 ; CHECK-NEXT: Local Memory: 0
 ; CHECK-NEXT: Sub-group Size: vscale x 1
+; CHECK-NEXT: Indirect Memory Access: maybe
 ; CHECK-NEXT: Min Work Width: vscale x 1
 ; CHECK-NEXT: Preferred Work Width: vscale x 1
 
@@ -65,7 +69,7 @@ define void @kernel4() !codeplay_ca_kernel !0 !codeplay_ca_wrapper !6 {
   ret void
 }
 
-attributes #0 = { "mux-orig-fn"="test" }
+attributes #0 = { "mux-no-indirect-memory-access" "mux-orig-fn"="test" }
 
 !0 = !{i32 1}
 ; Fields for vectorization data are width, isScalable, SimdDimIdx, isVP
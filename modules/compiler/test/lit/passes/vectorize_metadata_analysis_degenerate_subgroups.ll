@@ -21,6 +21,7 @@
 ; CHECK-NEXT: Source Name: foo
 ; CHECK-NEXT: Local Memory: 0
 ; CHECK-NEXT: Sub-group Size: 0
+; CHECK-NEXT: Indirect Memory Access: maybe
 ; CHECK-NEXT: Min Work Width: 1
 ; CHECK-NEXT: Preferred Work Width: vscale x 1
 
@@ -16,8 +16,12 @@
 
 #include "compiler/module.h"
 
+#include <llvm/Support/Parallel.h>
+#include <llvm/Support/Threading.h>
+
 #include <cstdint>
 #include <cstring>
+#include <vector>
 
 #include "cargo/array_view.h"
 #include "cargo/small_vector.h"
@@ -81,6 +85,77 @@ TEST_P(CreateBinaryTest, CreateBinary) {
 
 INSTANTIATE_COMPILER_TARGET_TEST_SUITE_P(CreateBinaryTest);
 
+/// @brief Test fixture checking that binaries of programs with several kernels
+/// don't depend on how many threads generated code for them.
+struct CreateBinaryThreadsTest : CompilerModuleTest {
+  void TearDown() override {
+    llvm::parallel::strategy = llvm::hardware_concurrency();
+    CompilerModuleTest::TearDown();
+  }
+
+  /// @brief Compile the kernel source into a new module and create its binary.
+  ///
+  /// A new module is used each time as modules may cache their binary.
+  ///
+  /// @param[in] threads Number of threads to generate code with, or zero for
+  /// all of them.
+  /// @param[out] binary Contents of the binary.
+  void createBinary(unsigned threads, std::vector<std::uint8_t> &binary) {
+    llvm::parallel::strategy = llvm::hardware_concurrency(threads);
+    auto fresh_module = target->createModule(num_errors, log);
+    ASSERT_NE(nullptr, fresh_module);
+    ASSERT_EQ(compiler::Result::SUCCESS,
+              fresh_module->compileOpenCLC(
+                  mux::detectOpenCLProfile(compiler_info->device_info),
+                  KernelSource(), {}));
+    std::vector<builtins::printf::descriptor> printf_calls;
+    ASSERT_EQ(compiler::Result::SUCCESS,
+              fresh_module->finalize(nullptr, printf_calls));
+    cargo::array_view<std::uint8_t> buffer{};
+    ASSERT_EQ(compiler::Result::SUCCESS, fresh_module->createBinary(buffer));
+    binary.assign(buffer.begin(), buffer.end());
+  }
+
+  cargo::string_view KernelSource() {
+    return R"(
+constant int table[4] = {1, 2, 3, 4};
+
+int helper(int x) { return table[x & 3] * x; }
+
+kernel void a(global int *out) {
+  out[get_global_id(0)] = helper(get_global_id(0));
+}
+
+kernel void b(global int *out) {
+  out[get_global_id(0)] = helper(out[0]) + 1;
+}
+
+kernel void c(global float *out) {
+  out[get_global_id(0)] = sqrt(out[get_global_id(0)]);
+}
+
+kernel void d(global int *out, int n) {
+  for (int i = 0; i < n; i++) {
+    out[i] += helper(i);
+  }
+}
+)";
+  }
+};
+
+TEST_P(CreateBinaryThreadsTest, SameBinary) {
+  // A strategy of one thread makes llvm::parallelFor run on this thread.
+  std::vector<std::uint8_t> serial;
+  ASSERT_NO_FATAL_FAILURE(createBinary(1, serial));
+
+  std::vector<std::uint8_t> parallel;
+  ASSERT_NO_FATAL_FAILURE(createBinary(0, parallel));
+
+  EXPECT_EQ(serial, parallel);
+}
+
+INSTANTIATE_COMPILER_TARGET_TEST_SUITE_P(CreateBinaryThreadsTest);
+
 /// @brief Test fixture for testing behaviour of the
 /// compiler::Module::getOptions API.
 struct CompileOptionsTest : CompilerModuleTest {
@@ -15,8 +15,15 @@
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
 #include <compiler/utils/attributes.h>
+#include <compiler/utils/builtins_link_cache.h>
 #include <compiler/utils/metadata.h>
 #include <compiler/utils/pass_functions.h>
+#include <llvm/ADT/SmallPtrSet.h>
+#include <llvm/AsmParser/Parser.h>
+#include <llvm/Bitcode/BitcodeReader.h>
+#include <llvm/Bitcode/BitcodeWriter.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/SourceMgr.h>
 
 #include <cstdint>
 #include <cstring>
@@ -158,3 +165,100 @@ TEST_F(CompilerUtilsTest, ParseReqWGSize) {
   check("foo", {30, 1, 1});
   check("bar", {30, 20, 1});
 }
+
+TEST_F(CompilerUtilsTest, BuiltinsLinkCache) {
+  // Round trip the builtins through bitcode so they are loaded lazily, as
+  // targets load their builtins module. The source module has its own context
+  // so the struct types keep their names when loaded into ours.
+  llvm::SmallVector<char, 0> Bitcode;
+  {
+    llvm::LLVMContext SourceContext;
+    llvm::SMDiagnostic Error;
+    auto Source = llvm::parseAssemblyString(R"(
+  %A = type { i32 }
+  %B = type { i64 }
+
+  define i32 @a() {
+    %p = alloca %A
+    %r = call i32 @c()
+    ret i32 %r
+  }
+
+  define i64 @b() {
+    %p = alloca %B
+    ret i64 0
+  }
+
+  define i32 @c() {
+    ret i32 0
+  }
+  )",
+                                            Error, SourceContext);
+    ASSERT_TRUE(Source);
+    llvm::raw_svector_ostream OS(Bitcode);
+    llvm::WriteBitcodeToFile(*Source, OS);
+  }
+  auto BuiltinsOrErr = llvm::getOwningLazyBitcodeModule(
+      llvm::MemoryBuffer::getMemBuffer(
+          llvm::StringRef(Bitcode.data(), Bitcode.size()), "builtins",
+          /*RequiresNullTerminator*/ false),
+      Context);
+  ASSERT_TRUE(!!BuiltinsOrErr) << llvm::toString(BuiltinsOrErr.takeError());
+  llvm::Module &Builtins = **BuiltinsOrErr;
+  auto *const A = Builtins.getFunction("a");
+  auto *const B = Builtins.getFunction("b");
+  auto *const C = Builtins.getFunction("c");
+  ASSERT_TRUE(A && B && C);
+
+  // Compare as sets, the bitcode reader and a walk of the module can find the
+  // types in different orders.
+  auto sameTypes = [&Builtins](llvm::ArrayRef<llvm::StructType *> Types) {
+    const auto Expected = Builtins.getIdentifiedStructTypes();
+    const llvm::SmallPtrSet<llvm::StructType *, 4> TypeSet(Types.begin(),
+                                                          Types.end());
+    return Types.size() == Expected.size() &&
+           llvm::all_of(Expected, [&TypeSet](llvm::StructType *T) {
+             return TypeSet.contains(T);
+           });
+  };
+
+  BuiltinsLinkCache Cache;
+  // Lazily loaded modules report the struct types of all the bitcode, even
+  // those only used by functions which haven't been materialized.
+  auto Types = Cache.getStructTypes(Builtins);
+  EXPECT_EQ(Types.size(), 2);
+  EXPECT_TRUE(sameTypes(Types));
+
+  // Getting the callees of a builtin materializes it and its callees only.
+  llvm::SmallVector<llvm::Function *, 4> Callees;
+  Cache.getCallees(*A, Callees);
+  ASSERT_EQ(Callees.size(), 2);
+  EXPECT_EQ(Callees[0], A);
+  EXPECT_EQ(Callees[1], C);
+  EXPECT_FALSE(A->isMaterializable());
+  EXPECT_FALSE(C->isMaterializable());
+  EXPECT_TRUE(B->isMaterializable());
+
+  // Which changes the number of materializable functions, so the struct types
+  // are found again.
+  Types = Cache.getStructTypes(Builtins);
+  EXPECT_TRUE(sameTypes(Types));
+
+  // Cached callees are appended again without materializing anything else.
+  Callees.clear();
+  Cache.getCallees(*A, Callees);
+  ASSERT_EQ(Callees.size(), 2);
+  EXPECT_EQ(Callees[0], A);
+  EXPECT_EQ(Callees[1], C);
+  EXPECT_TRUE(B->isMaterializable());
+
+  // Erase the last unmaterialized builtin and materialize the rest of the
+  // module, as any other user of the builtins module can. That drops the
+  // bitcode reader, so the types are found by walking the functions and %B is
+  // gone. The cache must not return the list it found from the reader.
+  B->eraseFromParent();
+  ASSERT_FALSE(llvm::errorToBool(Builtins.materializeAll()));
+  Types = Cache.getStructTypes(Builtins);
+  EXPECT_EQ(Types.size(), 1);
+  EXPECT_TRUE(sameTypes(Types));
+}
@@ -0,0 +1,99 @@
+// Copyright (C) Codeplay Software Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+// Exceptions; you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://github.com/codeplaysoftware/oneapi-construction-kit/blob/main/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <gtest/gtest.h>
+#include <host/vecz_tuner.h>
+
+#include <array>
+#include <cstdio>
+#include <string>
+
+namespace {
+const uint64_t hash = 0x0123456789abcdefULL;
+const std::array<size_t, 3> local_size = {{16, 1, 1}};
+
+/// @brief Time every candidate until the tuner decides, `candidate_duration`
+/// gives the duration of each launch of a candidate.
+template <class F>
+void tune(host::VeczTuner &tuner, F candidate_duration) {
+  while (auto candidate = tuner.getNextCandidate(hash, local_size)) {
+    tuner.reportDuration(hash, local_size, *candidate,
+                         candidate_duration(*candidate));
+  }
+}
+}  // namespace
+
+TEST(VeczTunerTest, RoundRobin) {
+  host::VeczTuner tuner("");
+  const auto num_candidates = host::getVeczTuningCandidates().size();
+  // Every candidate is sampled once before any is sampled again.
+  for (uint32_t sample = 0; sample < host::VeczTuner::samples_per_candidate;
+       sample++) {
+    for (uint32_t candidate = 0; candidate < num_candidates; candidate++) {
+      auto next = tuner.getNextCandidate(hash, local_size);
+      ASSERT_TRUE(next);
+      EXPECT_EQ(candidate, *next);
+      EXPECT_TRUE(tuner.getDecision(hash, local_size).empty());
+      tuner.reportDuration(hash, local_size, *next, 100);
+    }
+  }
+  EXPECT_FALSE(tuner.getNextCandidate(hash, local_size));
+}
+
+TEST(VeczTunerTest, SelectsFastest) {
+  host::VeczTuner tuner("");
+  const uint32_t fastest = 3;
+  // The fastest candidate is only fastest in its best sample, so the decision
+  // is made on the best duration of each candidate.
+  uint32_t launches = 0;
+  tune(tuner, [&](uint32_t candidate) -> uint64_t {
+    launches++;
+    if (candidate == fastest) {
+      return launches == fastest + 1 ? 10 : 1000;
+    }
+    return 100;
+  });
+  EXPECT_EQ(fastest, tuner.getSelectedCandidate(hash, local_size));
+  EXPECT_EQ(host::getVeczTuningCandidates()[fastest].name,
+            tuner.getDecision(hash, local_size));
+
+  // Other local sizes are tuned separately and start from the default.
+  const std::array<size_t, 3> other_local_size = {{8, 1, 1}};
+  EXPECT_EQ(0u, tuner.getSelectedCandidate(hash, other_local_size));
+  EXPECT_TRUE(tuner.getNextCandidate(hash, other_local_size));
+}
+
+TEST(VeczTunerTest, PersistsDecision) {
+  const std::string path = testing::TempDir() + "vecz_tuner_test.db";
+  std::remove(path.c_str());
+  const uint32_t fastest = 4;
+  {
+    host::VeczTuner tuner(path);
+    tune(tuner, [&](uint32_t candidate) -> uint64_t {
+      return candidate == fastest ? 10 : 100;
+    });
+    EXPECT_EQ(fastest, tuner.getSelectedCandidate(hash, local_size));
+  }
+  {
+    // A new tuner, as in another process, uses the decision without tuning.
+    host::VeczTuner tuner(path);
+    EXPECT_FALSE(tuner.getNextCandidate(hash, local_size));
+    EXPECT_EQ(fastest, tuner.getSelectedCandidate(hash, local_size));
+    EXPECT_EQ(host::getVeczTuningCandidates()[fastest].name,
+              tuner.getDecision(hash, local_size));
+  }
+  std::remove(path.c_str());
+}
@@ -185,6 +185,20 @@ void setHasNoExplicitSubgroups(llvm::Function &F);
 /// @param[in] F Function to check.
 bool hasNoExplicitSubgroups(const llvm::Function &F);
 
+/// @brief Marks a kernel as not accessing memory indirectly
+///
+/// A kernel accesses memory indirectly if it may dereference a pointer it did
+/// not receive as an argument, e.g. one loaded from a buffer. Only set when
+/// every function reachable from the kernel has been checked.
+///
+/// @param[in] F Function in which to encode the information.
+void setHasNoIndirectMemoryAccess(llvm::Function &F);
+
+/// @brief Returns whether the kernel is known not to access memory indirectly
+///
+/// @param[in] F Function to check.
+bool hasNoIndirectMemoryAccess(const llvm::Function &F);
+
 /// @brief Returns the mux subgroup size for the current function.
 ///
 /// Currently always returns 1!
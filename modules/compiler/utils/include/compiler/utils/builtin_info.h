@@ -326,6 +326,7 @@ enum BuiltinMatFlags : int32_t {
 
 class BIMuxInfoConcept;
 class BILangInfoConcept;
+class BuiltinsLinkCache;
 
 /// @brief A class that encapsulates information and transformations concerning
 /// compiler builtin functions.
@@ -359,6 +360,10 @@ class BuiltinInfo {
   /// @brief Retrieves the optional module containing builtin definitions.
   llvm::Module *getBuiltinsModule();
 
+  /// @brief Retrieves the optional link cache shared by every module the
+  /// builtins module is linked into.
+  BuiltinsLinkCache *getBuiltinsLinkCache();
+
   /// @brief Determine general properties for the given builtin function.
   /// @param[in] F Function to analyze.
   /// @return Analyzed properties for the builtin.
@@ -791,6 +796,8 @@ class BILangInfoConcept {
 
   /// @see BuiltinInfo::getBuiltinsModule
   virtual llvm::Module *getBuiltinsModule() { return nullptr; }
+  /// @see BuiltinInfo::getBuiltinsLinkCache
+  virtual BuiltinsLinkCache *getBuiltinsLinkCache() { return nullptr; }
   /// @see BuiltinInfo::analyzeBuiltin
   virtual Builtin analyzeBuiltin(const llvm::Function &F) const = 0;
   /// @see BuiltinInfo::isBuiltinUniform
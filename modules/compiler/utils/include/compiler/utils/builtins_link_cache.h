@@ -0,0 +1,100 @@
+// Copyright (C) Codeplay Software Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+// Exceptions; you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://github.com/codeplaysoftware/oneapi-construction-kit/blob/main/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+/// @file
+///
+/// Cache of the builtins module state needed to link builtins into modules.
+
+#ifndef COMPILER_UTILS_BUILTINS_LINK_CACHE_H_INCLUDED
+#define COMPILER_UTILS_BUILTINS_LINK_CACHE_H_INCLUDED
+
+#include <llvm/ADT/ArrayRef.h>
+#include <llvm/ADT/DenseMap.h>
+#include <llvm/ADT/SmallVector.h>
+
+#include <vector>
+
+namespace llvm {
+class Function;
+class Module;
+class StructType;
+}  // namespace llvm
+
+namespace compiler {
+namespace utils {
+/// @addtogroup utils
+/// @{
+
+/// @brief Link state of a builtins module, shared by every module the builtins
+/// are linked into.
+///
+/// The builtins module is loaded lazily once per target and lives as long as
+/// it does, but `LinkBuiltinsPass` would otherwise rediscover the callees of
+/// each builtin and the struct types of the whole builtins module for every
+/// program and every kernel specialization it links. A target owning a
+/// builtins module should own one of these alongside it and expose it through
+/// `BuiltinInfo::getBuiltinsLinkCache`.
+///
+/// Like the builtins module itself, the cache must only be used with the
+/// compiler context locked.
+class BuiltinsLinkCache final {
+ public:
+  /// @brief Get a builtin and all the functions it calls, directly or
+  /// indirectly, materializing them on first use.
+  ///
+  /// @param[in] Builtin Function in the builtins module.
+  /// @param[out] Callees Appended with `Builtin` followed by its callees.
+  void getCallees(llvm::Function &Builtin,
+                  llvm::SmallVectorImpl<llvm::Function *> &Callees);
+
+  /// @brief Get the identified struct types of the builtins module.
+  ///
+  /// A lazily loaded module reports every type of its bitcode, but once it
+  /// has been fully materialized the types are found by walking its functions
+  /// instead. The list is therefore only reused while the number of
+  /// materializable functions of the module is unchanged.
+  ///
+  /// @param[in] BuiltinsModule The builtins module.
+  ///
+  /// @return The struct types, valid until the next call.
+  llvm::ArrayRef<llvm::StructType *> getStructTypes(
+      llvm::Module &BuiltinsModule);
+
+  /// @brief Materialize a builtin and collect all the functions it calls,
+  /// directly or indirectly, without caching them.
+  ///
+  /// @param[in] Builtin Function in the builtins module.
+  /// @param[out] Callees Appended with `Builtin` followed by its callees.
+  static void collectCallees(llvm::Function &Builtin,
+                             llvm::SmallVectorImpl<llvm::Function *> &Callees);
+
+ private:
+  /// @brief Builtins and their callees, in the order `collectCallees` found
+  /// them.
+  llvm::DenseMap<llvm::Function *, llvm::SmallVector<llvm::Function *, 4>>
+      CalleeMap;
+  /// @brief Identified struct types of the builtins module.
+  std::vector<llvm::StructType *> StructTypes;
+  /// @brief Number of functions of the builtins module still materializable
+  /// when `StructTypes` was found, or -1 if it hasn't been yet.
+  size_t MaterializableCount = static_cast<size_t>(-1);
+};
+
+/// @}
+}  // namespace utils
+}  // namespace compiler
+
+#endif  // COMPILER_UTILS_BUILTINS_LINK_CACHE_H_INCLUDED
@@ -31,8 +31,10 @@ namespace utils {
 
 /// @brief Convenience function for constructing a CLBuiltinInfo as a unique_ptr
 /// @param[in] builtins the Builtin module
+/// @param[in] cache Optional link cache owned alongside the Builtin module
 /// @return a std::unique_ptr to a new CLBuiltinInfo
-std::unique_ptr<BILangInfoConcept> createCLBuiltinInfo(llvm::Module *builtins);
+std::unique_ptr<BILangInfoConcept> createCLBuiltinInfo(
+    llvm::Module *builtins, BuiltinsLinkCache *cache = nullptr);
 
 /// @brief Builtin loader base class.
 class CLBuiltinLoader {
@@ -55,29 +57,42 @@ class CLBuiltinLoader {
 
   /// @brief Expose any builtins Module
   virtual llvm::Module *getBuiltinsModule() { return nullptr; }
+
+  /// @brief Expose any link cache of the builtins Module
+  virtual BuiltinsLinkCache *getBuiltinsLinkCache() { return nullptr; }
 };
 
 /// @brief Simple Builtin loader wrapping a given builtins module.
 class SimpleCLBuiltinLoader final : public CLBuiltinLoader {
  public:
-  SimpleCLBuiltinLoader(llvm::Module *builtins) : BuiltinModule(builtins) {}
+  SimpleCLBuiltinLoader(llvm::Module *builtins,
+                        BuiltinsLinkCache *cache = nullptr)
+      : BuiltinModule(builtins), LinkCache(cache) {}
 
   ~SimpleCLBuiltinLoader() = default;
 
   /// @brief Expose any builtins Module
   virtual llvm::Module *getBuiltinsModule() override { return BuiltinModule; }
 
+  /// @brief Expose any link cache of the builtins Module
+  virtual BuiltinsLinkCache *getBuiltinsLinkCache() override {
+    return LinkCache;
+  }
+
  private:
   /// @brief Loaded builtins module.
   llvm::Module *BuiltinModule;
+  /// @brief Optional link cache of the builtins module.
+  BuiltinsLinkCache *LinkCache;
 };
 
 ///  @brief A class that encapsulates information and transformations concerning
 /// compiler OpenCL builtin functions.
 class CLBuiltinInfo : public BILangInfoConcept {
  public:
-  /// @brief Constructs a CLBuiltinInfo from a given Builtins module
-  CLBuiltinInfo(llvm::Module *Builtins);
+  /// @brief Constructs a CLBuiltinInfo from a given Builtins module and its
+  /// optional link cache
+  CLBuiltinInfo(llvm::Module *Builtins, BuiltinsLinkCache *Cache = nullptr);
 
   /// @brief Constructs a CLBuiltinInfo with a user-provided loader
   CLBuiltinInfo(std::unique_ptr<CLBuiltinLoader> L) : Loader(std::move(L)) {}
@@ -85,6 +100,8 @@ class CLBuiltinInfo : public BILangInfoConcept {
   ~CLBuiltinInfo();
 
   llvm::Module *getBuiltinsModule() override;
+  /// @see BuiltinInfo::getBuiltinsLinkCache
+  BuiltinsLinkCache *getBuiltinsLinkCache() override;
 
   /// @see BuiltinInfo::isBuiltinUniform
   BuiltinUniformity isBuiltinUniform(const Builtin &B, const llvm::CallInst *CI,
@@ -26,10 +26,14 @@
 
 namespace compiler {
 namespace utils {
+class BuiltinsLinkCache;
+
 /// @brief A pass for linking builtins to the current module
 ///
 /// This pass will manually link in any functions required from a given
-/// `builtins` module, into the current module.
+/// `builtins` module, into the current module. If the `BuiltinInfo` provides
+/// a `BuiltinsLinkCache` the callees of each builtin are only found once per
+/// builtins module.
 class LinkBuiltinsPass final : public llvm::PassInfoMixin<LinkBuiltinsPass> {
  public:
   ///
@@ -38,11 +42,13 @@ class LinkBuiltinsPass final : public llvm::PassInfoMixin<LinkBuiltinsPass> {
   llvm::PreservedAnalyses run(llvm::Module &M, llvm::ModuleAnalysisManager &AM);
 
  private:
-  void cloneStructs(llvm::Module &M, llvm::Module &BuiltinsModule,
+  void cloneStructs(llvm::Module &M,
+                    llvm::ArrayRef<llvm::StructType *> BuiltinStructTypes,
                     compiler::utils::StructMap &Map);
   void cloneBuiltins(
-      llvm::Module &M, llvm::Module &BuiltinsModule,
-      llvm::SmallVectorImpl<std::pair<llvm::Function *, bool>> &BuiltinFnDecls,
+      llvm::Module &M,
+      llvm::ArrayRef<std::pair<llvm::Function *, bool>> BuiltinFnDecls,
+      compiler::utils::BuiltinsLinkCache *Cache,
       compiler::utils::StructTypeRemapper *StructMap);
 };
 }  // namespace utils
@@ -60,6 +60,20 @@ llvm::Expected<std::unique_ptr<llvm::MemoryBuffer>> lldLinkToBinary(
     const uint8_t *linkerLib, unsigned int linkerLibBytes,
     const llvm::SmallVectorImpl<std::string> &additionalLinkArgs);
 
+/// @brief link several binaries together using lld
+/// @param rawBinaries input binaries to link, in link order
+/// @param linkerScriptStr lld linker script as a string. May be empty, e.g. for
+/// relocatable links with "-r".
+/// @param linkerLib pointer to library object to link against. May be nullptr.
+/// @param linkerLibBytes size on bytes of library object
+/// @param additionalLinkArgs extra args over the basic ones
+/// @return The final linked binary on success, error on failure
+llvm::Expected<std::unique_ptr<llvm::MemoryBuffer>> lldLinkToBinary(
+    const llvm::ArrayRef<llvm::ArrayRef<uint8_t>> rawBinaries,
+    const std::string &linkerScriptStr, const uint8_t *linkerLib,
+    unsigned int linkerLibBytes,
+    const llvm::SmallVectorImpl<std::string> &additionalLinkArgs);
+
 }  // namespace utils
 }  // namespace compiler
 
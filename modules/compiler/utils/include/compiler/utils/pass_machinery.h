@@ -28,6 +28,8 @@
 #include <llvm/Passes/PassBuilder.h>
 #include <llvm/Passes/StandardInstrumentations.h>
 
+#include <functional>
+
 namespace llvm {
 class TargetMachine;
 }
@@ -39,6 +41,41 @@ namespace utils {
 /// a boolean on/off version.
 enum class DebugLogging { None, Normal, Verbose, Quiet };
 
+/// @brief Callback adding instrumentation to the callbacks of a pass
+/// machinery, e.g. to profile every pass it runs.
+using InstrumentationHook =
+    std::function<void(llvm::PassInstrumentationCallbacks &)>;
+
+/// @brief Installs an instrumentation hook on the calling thread for as long
+/// as it is in scope.
+///
+/// Every PassMachinery initialized on the thread while the hook is installed
+/// invokes it, including the machinery passes such as vecz create internally
+/// to run nested pipelines. Hooks nest, an inner hook replaces the outer one
+/// until it goes out of scope.
+class ScopedInstrumentationHook {
+ public:
+  /// @brief Install `hook`, an empty hook leaves pass machinery
+  /// uninstrumented.
+  ScopedInstrumentationHook(InstrumentationHook hook);
+
+  /// @brief Reinstall the hook which was installed before this one.
+  ~ScopedInstrumentationHook();
+
+  ScopedInstrumentationHook(const ScopedInstrumentationHook &) = delete;
+  ScopedInstrumentationHook &operator=(const ScopedInstrumentationHook &) =
+      delete;
+
+  /// @brief Get the hook installed on the calling thread, if any.
+  static const InstrumentationHook *getCurrent();
+
+ private:
+  /// @brief The installed hook.
+  InstrumentationHook hook;
+  /// @brief The hook installed before this one, if any.
+  const InstrumentationHook *previous;
+};
+
 /// @brief A class that manages the lifetime and initialization of all
 /// components required to set up a new-style LLVM pass manager.
 class PassMachinery {
@@ -54,8 +91,8 @@ class PassMachinery {
       llvm::PipelineTuningOptions PTO = llvm::PipelineTuningOptions());
 
   /// @brief Cross-registers analysis managers, adds callbacks and
-  /// instrumentation support. Calls addClassToPassNames and
-  /// registerPassCallbacks.
+  /// instrumentation support. Calls addClassToPassNames,
+  /// registerPassCallbacks and the thread's ScopedInstrumentationHook.
   void initializeFinish();
 
   /// @brief Calls buildDefaultAAPipeline and registerLLVMAnalyses.
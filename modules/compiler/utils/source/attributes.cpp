@@ -209,6 +209,18 @@ bool hasNoExplicitSubgroups(const Function &F) {
   return Attr.isValid();
 }
 
+static constexpr const char *MuxNoIndirectMemoryAccessAttrName =
+    "mux-no-indirect-memory-access";
+
+void setHasNoIndirectMemoryAccess(Function &F) {
+  F.addFnAttr(MuxNoIndirectMemoryAccessAttrName);
+}
+
+bool hasNoIndirectMemoryAccess(const Function &F) {
+  const Attribute Attr = F.getFnAttribute(MuxNoIndirectMemoryAccessAttrName);
+  return Attr.isValid();
+}
+
 unsigned getMuxSubgroupSize(const llvm::Function &) {
   // FIXME: The mux sub-group size is currently assumed to be 1 for all
   // functions, kerrnels, and targets. This helper function is just to avoid
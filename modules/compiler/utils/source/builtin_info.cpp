@@ -43,6 +43,13 @@ Module *BuiltinInfo::getBuiltinsModule() {
   return nullptr;
 }
 
+BuiltinsLinkCache *BuiltinInfo::getBuiltinsLinkCache() {
+  if (LangImpl) {
+    return LangImpl->getBuiltinsLinkCache();
+  }
+  return nullptr;
+}
+
 std::pair<BuiltinID, std::vector<Type *>> BuiltinInfo::identifyMuxBuiltin(
     const Function &F) const {
   StringRef Name = F.getName();
@@ -0,0 +1,98 @@
+// Copyright (C) Codeplay Software Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+// Exceptions; you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://github.com/codeplaysoftware/oneapi-construction-kit/blob/main/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <compiler/utils/builtins_link_cache.h>
+#include <llvm/ADT/STLExtras.h>
+#include <llvm/ADT/SmallPtrSet.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/Error.h>
+#include <multi_llvm/llvm_version.h>
+
+using namespace llvm;
+
+namespace compiler {
+namespace utils {
+void BuiltinsLinkCache::getCallees(Function &Builtin,
+                                   SmallVectorImpl<Function *> &Callees) {
+  auto [It, Inserted] = CalleeMap.try_emplace(&Builtin);
+  if (Inserted) {
+    collectCallees(Builtin, It->second);
+  }
+  Callees.append(It->second.begin(), It->second.end());
+}
+
+ArrayRef<StructType *> BuiltinsLinkCache::getStructTypes(
+    Module &BuiltinsModule) {
+  // Finding the struct types walks every materialized function, which is much
+  // more expensive than counting the functions which haven't been.
+  const size_t Count =
+      count_if(BuiltinsModule.functions(),
+               [](const Function &F) { return F.isMaterializable(); });
+  if (Count != MaterializableCount) {
+    StructTypes = BuiltinsModule.getIdentifiedStructTypes();
+    MaterializableCount = Count;
+  }
+  return StructTypes;
+}
+
+void BuiltinsLinkCache::collectCallees(Function &Builtin,
+                                       SmallVectorImpl<Function *> &Callees) {
+  SmallPtrSet<Function *, 16> Visited;
+  SmallVector<Function *, 16> Worklist{&Builtin};
+
+  while (!Worklist.empty()) {
+    auto *const F = Worklist.pop_back_val();
+
+    // if we are already tracking the callee, we can skip the function
+    if (!Visited.insert(F).second) {
+      continue;
+    }
+    Callees.push_back(F);
+
+    Module &BuiltinsModule = *F->getParent();
+    auto Error = BuiltinsModule.materialize(F);
+
+    assert(!Error && "Bitcode materialization failed!");
+
+#if LLVM_VERSION_GREATER_EQUAL(19, 0)
+    if (F->IsNewDbgInfoFormat != BuiltinsModule.IsNewDbgInfoFormat) {
+      if (BuiltinsModule.IsNewDbgInfoFormat) {
+        F->convertToNewDbgValues();
+      } else {
+        F->convertFromNewDbgValues();
+      }
+    }
+#endif
+
+    // Find any callees in the function and add them to the list.
+    for (auto &BB : *F) {
+      for (auto &I : BB) {
+        // if we have a call instruction
+        if (auto *const CI = dyn_cast<CallInst>(&I)) {
+          // and the called function is known
+          if (Function *Callee = CI->getCalledFunction()) {
+            // Assume that we have no calls in builtins to LLVM intrinsics that
+            // require libcalls.
+            Worklist.push_back(Callee);
+          }
+        }
+      }
+    }
+  }
+}
+}  // namespace utils
+}  // namespace compiler
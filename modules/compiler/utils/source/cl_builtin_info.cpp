@@ -486,12 +486,13 @@ namespace compiler {
 namespace utils {
 using namespace llvm;
 
-std::unique_ptr<BILangInfoConcept> createCLBuiltinInfo(Module *Builtins) {
-  return std::make_unique<CLBuiltinInfo>(Builtins);
+std::unique_ptr<BILangInfoConcept> createCLBuiltinInfo(
+    Module *Builtins, BuiltinsLinkCache *Cache) {
+  return std::make_unique<CLBuiltinInfo>(Builtins, Cache);
 }
 
-CLBuiltinInfo::CLBuiltinInfo(Module *builtins)
-    : Loader(std::make_unique<SimpleCLBuiltinLoader>(builtins)) {}
+CLBuiltinInfo::CLBuiltinInfo(Module *builtins, BuiltinsLinkCache *cache)
+    : Loader(std::make_unique<SimpleCLBuiltinLoader>(builtins, cache)) {}
 
 CLBuiltinInfo::~CLBuiltinInfo() = default;
 
@@ -847,6 +848,13 @@ Module *CLBuiltinInfo::getBuiltinsModule() {
   return Loader->getBuiltinsModule();
 }
 
+BuiltinsLinkCache *CLBuiltinInfo::getBuiltinsLinkCache() {
+  if (!Loader) {
+    return nullptr;
+  }
+  return Loader->getBuiltinsLinkCache();
+}
+
 Function *CLBuiltinInfo::materializeBuiltin(StringRef BuiltinName,
                                             Module *DestM,
                                             BuiltinMatFlags Flags) {
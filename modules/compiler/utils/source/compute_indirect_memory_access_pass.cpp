@@ -0,0 +1,167 @@
+// Copyright (C) Codeplay Software Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+// Exceptions; you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://github.com/codeplaysoftware/oneapi-construction-kit/blob/main/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <compiler/utils/attributes.h>
+#include <compiler/utils/builtin_info.h>
+#include <compiler/utils/compute_indirect_memory_access_pass.h>
+#include <llvm/ADT/PriorityWorklist.h>
+#include <llvm/ADT/SmallPtrSet.h>
+#include <llvm/Analysis/ValueTracking.h>
+#include <llvm/IR/InstIterator.h>
+#include <llvm/IR/Instructions.h>
+#include <llvm/IR/IntrinsicInst.h>
+
+#define DEBUG_TYPE "compute-indirect-memory-access"
+
+using namespace llvm;
+
+namespace compiler {
+namespace utils {
+
+namespace {
+bool containsPointer(const Type *Ty) {
+  if (Ty->isPtrOrPtrVectorTy()) {
+    return true;
+  }
+  if (auto *STy = dyn_cast<StructType>(Ty)) {
+    return any_of(STy->elements(), containsPointer);
+  }
+  if (auto *ATy = dyn_cast<ArrayType>(Ty)) {
+    return containsPointer(ATy->getElementType());
+  }
+  return false;
+}
+
+/// @brief Returns whether a pointer loaded through Ptr can only have been
+/// stored there by the function itself.
+///
+/// This holds for allocas which are never the destination of a memory
+/// transfer, as any pointer stored to them directly was already checked.
+bool isPrivateStorage(const Value *Ptr) {
+  auto *const Alloca = dyn_cast<AllocaInst>(getUnderlyingObject(Ptr));
+  if (!Alloca) {
+    return false;
+  }
+  SmallVector<const Value *, 8> Worklist = {Alloca};
+  SmallPtrSet<const Value *, 8> Visited;
+  while (!Worklist.empty()) {
+    const Value *V = Worklist.pop_back_val();
+    if (!Visited.insert(V).second) {
+      continue;
+    }
+    for (const User *U : V->users()) {
+      if (isa<MemTransferInst>(U)) {
+        return false;
+      }
+      if (isa<GetElementPtrInst>(U) || isa<BitCastInst>(U) ||
+          isa<AddrSpaceCastInst>(U) || isa<SelectInst>(U) || isa<PHINode>(U)) {
+        Worklist.push_back(U);
+      }
+    }
+  }
+  return true;
+}
+
+/// @brief Returns whether F may access memory indirectly, adding any
+/// functions it calls directly to Callees.
+bool mayAccessMemoryIndirectly(
+    const Function &F, const BuiltinInfo &BI,
+    SmallPriorityWorklist<const Function *, 4> &Callees) {
+  for (const Instruction &I : instructions(F)) {
+    const Value *LoadPtr = nullptr;
+    if (auto *LI = dyn_cast<LoadInst>(&I)) {
+      LoadPtr = LI->getPointerOperand();
+    } else if (auto *RMW = dyn_cast<AtomicRMWInst>(&I)) {
+      LoadPtr = RMW->getPointerOperand();
+    } else if (auto *CmpXchg = dyn_cast<AtomicCmpXchgInst>(&I)) {
+      LoadPtr = CmpXchg->getPointerOperand();
+    }
+    if (LoadPtr && containsPointer(I.getType()) && !isPrivateStorage(LoadPtr)) {
+      LLVM_DEBUG(dbgs() << "  pointer loaded from memory: " << I << "\n");
+      return true;
+    }
+
+    if (isa<IntToPtrInst>(&I)) {
+      LLVM_DEBUG(dbgs() << "  pointer cast from an integer: " << I << "\n");
+      return true;
+    }
+
+    auto *const CB = dyn_cast<CallBase>(&I);
+    if (!CB) {
+      continue;
+    }
+    auto *const Callee = CB->getCalledFunction();
+    if (!Callee) {
+      LLVM_DEBUG(dbgs() << "  indirect call: " << I << "\n");
+      return true;
+    }
+    if (auto *II = dyn_cast<IntrinsicInst>(CB)) {
+      const Intrinsic::ID IntrID = II->getIntrinsicID();
+      if ((IntrID == Intrinsic::masked_load ||
+           IntrID == Intrinsic::masked_gather) &&
+          containsPointer(II->getType())) {
+        LLVM_DEBUG(dbgs() << "  pointer loaded from memory: " << I << "\n");
+        return true;
+      }
+      continue;
+    }
+    if (!Callee->isDeclaration()) {
+      Callees.insert(Callee);
+    } else if (!BI.analyzeBuiltin(*Callee).isValid()) {
+      LLVM_DEBUG(dbgs() << "  call to unknown function: " << I << "\n");
+      return true;
+    }
+  }
+  return false;
+}
+}  // namespace
+
+PreservedAnalyses ComputeIndirectMemoryAccessPass::run(
+    Module &M, ModuleAnalysisManager &AM) {
+  auto &BI = AM.getResult<BuiltinInfoAnalysis>(M);
+
+  for (auto &F : M) {
+    if (!isKernelEntryPt(F) || F.isDeclaration()) {
+      continue;
+    }
+
+    LLVM_DEBUG(dbgs() << "Indirect memory accesses in '" << F.getName()
+                      << "':\n");
+
+    SmallPriorityWorklist<const Function *, 4> Worklist;
+    SmallPtrSet<const Function *, 4> Visited;
+    Worklist.insert(&F);
+
+    bool MayAccessIndirectly = false;
+    while (!Worklist.empty() && !MayAccessIndirectly) {
+      const Function *Fn = Worklist.pop_back_val();
+      if (!Visited.insert(Fn).second) {
+        continue;
+      }
+      MayAccessIndirectly = mayAccessMemoryIndirectly(*Fn, BI, Worklist);
+    }
+
+    if (!MayAccessIndirectly) {
+      LLVM_DEBUG(dbgs() << "  none\n");
+      setHasNoIndirectMemoryAccess(F);
+    }
+  }
+
+  return PreservedAnalyses::all();
+}
+
+}  // namespace utils
+}  // namespace compiler
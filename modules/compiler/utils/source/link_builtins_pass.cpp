@@ -29,9 +29,14 @@
 //   to link between a small and a very large LLVM module), which we would not
 //   be able to do in a pass (as the Module the pass refers to effectively dies
 //   as the linking would occur).
+// * The builtins module is shared by every program of a target, so when the
+//   target provides a BuiltinsLinkCache the callees of each builtin are only
+//   found and materialized once, rather than once per program and per kernel
+//   specialization.
 
 #include <compiler/utils/StructTypeRemapper.h>
 #include <compiler/utils/builtin_info.h>
+#include <compiler/utils/builtins_link_cache.h>
 #include <compiler/utils/link_builtins_pass.h>
 #include <compiler/utils/mangling.h>
 #include <llvm/ADT/DenseSet.h>
@@ -95,11 +100,12 @@ class GlobalVarMaterializer final : public ValueMaterializer {
 /// @param [out] Map A structure mapping from builtin structure types to the
 /// corresponding module types
 void compiler::utils::LinkBuiltinsPass::cloneStructs(
-    Module &M, Module &BuiltinsModule, compiler::utils::StructMap &Map) {
+    Module &M, ArrayRef<StructType *> BuiltinStructTypes,
+    compiler::utils::StructMap &Map) {
   for (auto *StructTy : M.getIdentifiedStructTypes()) {
     auto StructName = StructTy->getName();
 
-    for (auto *BuiltinStructTy : BuiltinsModule.getIdentifiedStructTypes()) {
+    for (auto *BuiltinStructTy : BuiltinStructTypes) {
       auto BuiltinStructName = BuiltinStructTy->getName();
 
       const char *Suffix = ".0123456789";
@@ -119,47 +125,25 @@ void compiler::utils::LinkBuiltinsPass::cloneStructs(
 }
 
 void compiler::utils::LinkBuiltinsPass::cloneBuiltins(
-    Module &M, Module &BuiltinsModule,
-    SmallVectorImpl<std::pair<Function *, bool>> &BuiltinFnDecls,
+    Module &M, ArrayRef<std::pair<Function *, bool>> BuiltinFnDecls,
+    compiler::utils::BuiltinsLinkCache *Cache,
     compiler::utils::StructTypeRemapper *StructMap) {
   // Clone the builtin and its callees.
   DenseMap<Function *, bool> Callees;
+  SmallVector<Function *, 16> BuiltinCallees;
 
-  while (!BuiltinFnDecls.empty()) {
-    auto [BuiltinFn, IsImplicit] = BuiltinFnDecls.pop_back_val();
-
-    // if we are already tracking the callee, we can skip the function
-    if (!Callees.insert({BuiltinFn, IsImplicit}).second) {
-      continue;
+  for (auto [BuiltinFn, IsImplicit] : BuiltinFnDecls) {
+    BuiltinCallees.clear();
+    if (Cache) {
+      Cache->getCallees(*BuiltinFn, BuiltinCallees);
+    } else {
+      BuiltinsLinkCache::collectCallees(*BuiltinFn, BuiltinCallees);
     }
 
-    auto Error = BuiltinsModule.materialize(BuiltinFn);
-
-    assert(!Error && "Bitcode materialization failed!");
-
-#if LLVM_VERSION_GREATER_EQUAL(19, 0)
-    if (BuiltinFn->IsNewDbgInfoFormat != BuiltinsModule.IsNewDbgInfoFormat) {
-      if (BuiltinsModule.IsNewDbgInfoFormat) {
-        BuiltinFn->convertToNewDbgValues();
-      } else {
-        BuiltinFn->convertFromNewDbgValues();
-      }
-    }
-#endif
-
-    // Find any callees in the function and add them to the list.
-    for (auto &BB : *BuiltinFn) {
-      for (auto &I : BB) {
-        // if we have a call instruction
-        if (auto *const CI = dyn_cast<CallInst>(&I)) {
-          // and the called function is known
-          if (Function *Callee = CI->getCalledFunction()) {
-            // Assume that we have no calls in builtins to LLVM intrinsics that
-            // require libcalls.
-            BuiltinFnDecls.push_back({Callee, false});
-          }
-        }
-      }
+    // The builtin itself comes first, only it may be an implicit libcall.
+    Callees[BuiltinFn] |= IsImplicit;
+    for (auto *Callee : drop_begin(BuiltinCallees)) {
+      Callees.insert({Callee, false});
     }
   }
 
@@ -242,6 +226,7 @@ PreservedAnalyses compiler::utils::LinkBuiltinsPass::run(
   if (nullptr == BuiltinsModule) {
     return PreservedAnalyses::all();
   }
+  auto *const Cache = BI.getBuiltinsLinkCache();
 
   SmallVector<std::pair<Function *, bool>> BuiltinFnDecls;
 
@@ -284,10 +269,13 @@ PreservedAnalyses compiler::utils::LinkBuiltinsPass::run(
   }
 
   StructMap Map;
-  cloneStructs(M, *BuiltinsModule, Map);
+  if (Cache) {
+    cloneStructs(M, Cache->getStructTypes(*BuiltinsModule), Map);
+  } else {
+    cloneStructs(M, BuiltinsModule->getIdentifiedStructTypes(), Map);
+  }
   StructTypeRemapper structMap(Map);
-  cloneBuiltins(M, *BuiltinsModule, BuiltinFnDecls,
-                Map.empty() ? nullptr : &structMap);
+  cloneBuiltins(M, BuiltinFnDecls, Cache, Map.empty() ? nullptr : &structMap);
 
   return PreservedAnalyses::none();
 }
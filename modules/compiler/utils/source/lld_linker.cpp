@@ -55,6 +55,16 @@ Expected<std::unique_ptr<MemoryBuffer>> lldLinkToBinary(
     const ArrayRef<uint8_t> rawBinary, const std::string &linkerScriptStr,
     const uint8_t *linkerLib, unsigned int linkerLibBytes,
     const SmallVectorImpl<std::string> &additionalLinkArgs) {
+  return lldLinkToBinary(ArrayRef<ArrayRef<uint8_t>>(rawBinary),
+                         linkerScriptStr, linkerLib, linkerLibBytes,
+                         additionalLinkArgs);
+}
+
+Expected<std::unique_ptr<MemoryBuffer>> lldLinkToBinary(
+    const ArrayRef<ArrayRef<uint8_t>> rawBinaries,
+    const std::string &linkerScriptStr, const uint8_t *linkerLib,
+    unsigned int linkerLibBytes,
+    const SmallVectorImpl<std::string> &additionalLinkArgs) {
   struct TemporaryFile {
     TemporaryFile() = default;
     TemporaryFile(const Twine &Prefix, StringRef Suffix) {
@@ -86,12 +96,20 @@ Expected<std::unique_ptr<MemoryBuffer>> lldLinkToBinary(
     std::error_code ErrorCode;
   };
 
-  const TemporaryFile objFile("lld", "o");
-  if (objFile) return errorCodeToError(objFile.getErrorCode());
+  std::vector<TemporaryFile> objFiles;
+  objFiles.reserve(rawBinaries.size());
+  for (size_t i = 0; i < rawBinaries.size(); i++) {
+    const auto &objFile = objFiles.emplace_back("lld", "o");
+    if (objFile) return errorCodeToError(objFile.getErrorCode());
+  }
   const TemporaryFile elfFile("lld", "elf");
   if (elfFile) return errorCodeToError(elfFile.getErrorCode());
-  const TemporaryFile linkerScript("lld", "ld");
-  if (linkerScript) return errorCodeToError(linkerScript.getErrorCode());
+  // Relocatable links don't take a linker script.
+  TemporaryFile linkerScript;
+  if (!linkerScriptStr.empty()) {
+    linkerScript = TemporaryFile("lld", "ld");
+    if (linkerScript) return errorCodeToError(linkerScript.getErrorCode());
+  }
   TemporaryFile linkRTFile;
   if (linkerLib) {
     linkRTFile = TemporaryFile("lld_rt", "a");
@@ -109,36 +127,46 @@ Expected<std::unique_ptr<MemoryBuffer>> lldLinkToBinary(
       }
     }
   }
-  FILE *f = fopen(objFile.getFileName(), "wb+");
-  if (!f) {
-    return createStringError(inconvertibleErrorCode(),
-                             "unable to open temporary object file");
-  }
-  if (fwrite(rawBinary.data(), 1, rawBinary.size(), f) != rawBinary.size()) {
-    return createStringError(inconvertibleErrorCode(),
-                             "unable to write binary to temporary object file");
-  }
-  if (fclose(f) != 0) {
-    return createStringError(inconvertibleErrorCode(),
-                             "unable to close temporary object file");
+  for (size_t i = 0; i < rawBinaries.size(); i++) {
+    const auto &rawBinary = rawBinaries[i];
+    FILE *f = fopen(objFiles[i].getFileName(), "wb+");
+    if (!f) {
+      return createStringError(inconvertibleErrorCode(),
+                               "unable to open temporary object file");
+    }
+    if (fwrite(rawBinary.data(), 1, rawBinary.size(), f) != rawBinary.size()) {
+      return createStringError(
+          inconvertibleErrorCode(),
+          "unable to write binary to temporary object file");
+    }
+    if (fclose(f) != 0) {
+      return createStringError(inconvertibleErrorCode(),
+                               "unable to close temporary object file");
+    }
   }
 
-  FILE *fl = fopen(linkerScript.getFileName(), "w+");
-  if (!fl) {
-    return createStringError(inconvertibleErrorCode(),
-                             "unable to open temporary linker script file");
-  }
-  if (fwrite(linkerScriptStr.c_str(), 1, linkerScriptStr.length(), fl) !=
-      linkerScriptStr.length()) {
-    return createStringError(inconvertibleErrorCode(),
-                             "unable to write to temporary linker script file");
-  }
-  if (fclose(fl) != 0) {
-    return createStringError(inconvertibleErrorCode(),
-                             "unable to close temporary linker script file");
+  if (!linkerScriptStr.empty()) {
+    FILE *fl = fopen(linkerScript.getFileName(), "w+");
+    if (!fl) {
+      return createStringError(inconvertibleErrorCode(),
+                               "unable to open temporary linker script file");
+    }
+    if (fwrite(linkerScriptStr.c_str(), 1, linkerScriptStr.length(), fl) !=
+        linkerScriptStr.length()) {
+      return createStringError(
+          inconvertibleErrorCode(),
+          "unable to write to temporary linker script file");
+    }
+    if (fclose(fl) != 0) {
+      return createStringError(inconvertibleErrorCode(),
+                               "unable to close temporary linker script file");
+    }
   }
 
-  std::vector<std::string> args = {"ld.lld", objFile.getFileName()};
+  std::vector<std::string> args = {"ld.lld"};
+  for (const auto &objFile : objFiles) {
+    args.push_back(objFile.getFileName());
+  }
 
 #if !defined(NDEBUG) || defined(CA_ENABLE_LLVM_OPTIONS_IN_RELEASE)
   if (auto *env = std::getenv("CA_LLVM_OPTIONS")) {
@@ -150,7 +178,9 @@ Expected<std::unique_ptr<MemoryBuffer>> lldLinkToBinary(
   for (const auto &arg : additionalLinkArgs) {
     args.push_back(arg);
   }
-  args.push_back((Twine("--script=") + linkerScript.getFileName()).str());
+  if (!linkerScriptStr.empty()) {
+    args.push_back((Twine("--script=") + linkerScript.getFileName()).str());
+  }
   if (linkerLib) {
     args.push_back(linkRTFile.getFileName());
   }
@@ -30,6 +30,8 @@ Printable printGenericMD(const handler::GenericMetadata &MD) {
     Out << "Source Name: " << MD.source_name << "\n";
     Out << "Local Memory: " << MD.local_memory_usage << "\n";
     Out << "Sub-group Size: " << print(MD.sub_group_size) << "\n";
+    Out << "Indirect Memory Access: "
+        << (MD.may_access_memory_indirectly ? "maybe" : "no") << "\n";
   });
 }
 
@@ -56,7 +58,9 @@ GenericMetadataAnalysis::Result GenericMetadataAnalysis::run(
           sub_group_size.getFixedValue() * vf.getKnownMin(), vf.isScalable());
     }
   }
-  return Result(kernel_name, source_name, local_memory_usage, sub_group_size);
+  Result MD(kernel_name, source_name, local_memory_usage, sub_group_size);
+  MD.may_access_memory_indirectly = !hasNoIndirectMemoryAccess(Fn);
+  return MD;
 }
 
 PreservedAnalyses GenericMetadataPrinterPass::run(Function &F,
@@ -109,9 +113,11 @@ VectorizeMetadataAnalysis::Result VectorizeMetadataAnalysis::run(
       }
     }
   }
-  return Result(std::move(GenericMD.kernel_name),
-                std::move(GenericMD.source_name), GenericMD.local_memory_usage,
-                GenericMD.sub_group_size, min_width, pref_width);
+  Result MD(std::move(GenericMD.kernel_name), std::move(GenericMD.source_name),
+            GenericMD.local_memory_usage, GenericMD.sub_group_size, min_width,
+            pref_width);
+  MD.may_access_memory_indirectly = GenericMD.may_access_memory_indirectly;
+  return MD;
 }
 
 PreservedAnalyses VectorizeMetadataPrinterPass::run(
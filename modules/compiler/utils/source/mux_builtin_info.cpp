@@ -264,10 +264,12 @@ Function *BIMuxInfoConcept::defineGetGlobalId(Module &M) {
       getOrDeclareMuxBuiltin(eMuxBuiltinGetGlobalOffset, M);
   auto *const MuxGetLocalIdFn =
       getOrDeclareMuxBuiltin(eMuxBuiltinGetLocalId, M);
-  auto *const MuxGetLocalSizeFn =
-      getOrDeclareMuxBuiltin(eMuxBuiltinGetLocalSize, M);
+  // The enqueued local size rather than the local size, as they differ in the
+  // trailing work-group of non-uniform ND ranges.
+  auto *const MuxGetEnqueuedLocalSizeFn =
+      getOrDeclareMuxBuiltin(eMuxBuiltinGetEnqueuedLocalSize, M);
   assert(MuxGetGroupIdFn && MuxGetGlobalOffsetFn && MuxGetLocalIdFn &&
-         MuxGetLocalSizeFn);
+         MuxGetEnqueuedLocalSizeFn);
 
   // Pass on all arguments through to dependent builtins. We expect that each
   // function has identical prototypes, regardless of whether scheduling
@@ -278,13 +280,14 @@ Function *BIMuxInfoConcept::defineGetGlobalId(Module &M) {
   auto *const GetGlobalOffsetCall =
       createCallHelper(B, *MuxGetGlobalOffsetFn, Args);
   auto *const GetLocalIdCall = createCallHelper(B, *MuxGetLocalIdFn, Args);
-  auto *const GetLocalSizeCall = createCallHelper(B, *MuxGetLocalSizeFn, Args);
+  auto *const GetEnqueuedLocalSizeCall =
+      createCallHelper(B, *MuxGetEnqueuedLocalSizeFn, Args);
 
-  // (get_group_id(i) * get_local_size(i))
-  auto *Ret = B.CreateMul(GetGroupIdCall, GetLocalSizeCall);
-  // (get_group_id(i) * get_local_size(i)) + get_local_id(i)
+  // (get_group_id(i) * get_enqueued_local_size(i))
+  auto *Ret = B.CreateMul(GetGroupIdCall, GetEnqueuedLocalSizeCall);
+  // (get_group_id(i) * get_enqueued_local_size(i)) + get_local_id(i)
   Ret = B.CreateAdd(Ret, GetLocalIdCall);
-  // get_global_id(i) = (get_group_id(i) * get_local_size(i)) +
+  // get_global_id(i) = (get_group_id(i) * get_enqueued_local_size(i)) +
   //                    get_local_id(i) + get_global_offset(i)
   Ret = B.CreateAdd(Ret, GetGlobalOffsetCall);
 
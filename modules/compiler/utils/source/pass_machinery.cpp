@@ -64,6 +64,22 @@ static cl::opt<DebugLogging> DebugPM(
 static cl::opt<bool> VerifyEach("verify-each",
                                 cl::desc("Verify after each transform"));
 
+/// @brief Instrumentation hook installed on the calling thread.
+static thread_local const InstrumentationHook *CurrentHook = nullptr;
+
+ScopedInstrumentationHook::ScopedInstrumentationHook(InstrumentationHook hook)
+    : hook(std::move(hook)), previous(CurrentHook) {
+  CurrentHook = &this->hook;
+}
+
+ScopedInstrumentationHook::~ScopedInstrumentationHook() {
+  CurrentHook = previous;
+}
+
+const InstrumentationHook *ScopedInstrumentationHook::getCurrent() {
+  return CurrentHook;
+}
+
 PassMachinery::PassMachinery(LLVMContext &Ctx, TargetMachine *TM,
                              bool VerifyEach, DebugLogging debugLogLevel)
     : TM(TM) {
@@ -97,6 +113,11 @@ void PassMachinery::initializeFinish() {
   // Allow registration of callbacks and instrumentation machinery
   addClassToPassNames();
   registerPassCallbacks();
+  if (const auto *Hook = ScopedInstrumentationHook::getCurrent()) {
+    if (*Hook) {
+      (*Hook)(PIC);
+    }
+  }
 
   // Register pass instrumentation
 #if LLVM_VERSION_GREATER_EQUAL(17, 0)
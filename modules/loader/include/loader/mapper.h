@@ -62,6 +62,26 @@ struct PageRange {
   /// @brief Changes the protection of the allocated memory pages.
   cargo::result protect(MemoryProtection protection);
 
+  /// @brief Changes the protection of a subrange of the allocated memory pages.
+  ///
+  /// @param offset Offset in bytes of the subrange, must be a multiple of the
+  /// page size.
+  /// @param bytes Size in bytes of the subrange, rounded up to whole pages.
+  /// @param protection Protection to apply to the subrange.
+  cargo::result protect(size_t offset, size_t bytes,
+                        MemoryProtection protection);
+
+  /// @brief Hints to the OS that a subrange of the allocated memory pages
+  /// should be backed by huge pages where possible.
+  ///
+  /// This is only a hint, and does nothing on platforms without transparent
+  /// huge pages.
+  ///
+  /// @param offset Offset in bytes of the subrange, must be a multiple of the
+  /// page size.
+  /// @param bytes Size in bytes of the subrange.
+  void adviseHugePages(size_t offset, size_t bytes);
+
   /// @brief Gets the allocated memory range.
   inline cargo::array_view<uint8_t> data() const {
     return {pages_begin, pages_end};
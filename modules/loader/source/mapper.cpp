@@ -133,6 +133,20 @@ cargo::result loader::PageRange::protect(MemoryProtection protection) {
   if (pages_end == nullptr) {
     return cargo::bad_argument;
   }
+  return protect(0, pages_end - pages_begin, protection);
+}
+
+cargo::result loader::PageRange::protect(size_t offset, size_t bytes,
+                                         MemoryProtection protection) {
+  if (pages_end == nullptr || 0 != offset % getPageSize()) {
+    return cargo::bad_argument;
+  }
+  const size_t page_count = (bytes + getPageSize() - 1) / getPageSize();
+  bytes = page_count * getPageSize();
+  if (offset + bytes > static_cast<size_t>(pages_end - pages_begin)) {
+    return cargo::bad_argument;
+  }
+  uint8_t *begin = pages_begin + offset;
 #ifdef _WIN32
   std::array<int, 8> vals;  // indexed by protection
   vals[0] = PAGE_NOACCESS;
@@ -145,8 +159,7 @@ cargo::result loader::PageRange::protect(MemoryProtection protection) {
   vals[MEM_WRITABLE | MEM_EXECUTABLE] = PAGE_EXECUTE_READWRITE;
   vals[MEM_READABLE | MEM_WRITABLE | MEM_EXECUTABLE] = PAGE_EXECUTE_READWRITE;
   DWORD oldProt;
-  if (VirtualProtect(pages_begin, pages_end - pages_begin, vals[protection],
-                     &oldProt) == 0) {
+  if (VirtualProtect(begin, bytes, vals[protection], &oldProt) == 0) {
     return cargo::bad_alloc;
   }
 #else
@@ -160,9 +173,23 @@ cargo::result loader::PageRange::protect(MemoryProtection protection) {
   if (protection & MEM_EXECUTABLE) {
     prot |= PROT_EXEC;
   }
-  if (mprotect(pages_begin, pages_end - pages_begin, prot) < 0) {
+  if (mprotect(begin, bytes, prot) < 0) {
     return cargo::bad_alloc;
   }
 #endif
   return cargo::success;
 }
+
+void loader::PageRange::adviseHugePages(size_t offset, size_t bytes) {
+  if (pages_end == nullptr || 0 != offset % getPageSize() ||
+      offset + bytes > static_cast<size_t>(pages_end - pages_begin)) {
+    return;
+  }
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+  // Failure only means the range stays on normal pages, e.g. when transparent
+  // huge pages are disabled.
+  (void)madvise(pages_begin + offset, bytes, MADV_HUGEPAGE);
+#else
+  (void)bytes;
+#endif
+}
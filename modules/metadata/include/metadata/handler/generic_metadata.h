@@ -46,6 +46,9 @@ struct GenericMetadata {
   std::string source_name;
   uint64_t local_memory_usage;
   FixedOrScalableQuantity<uint32_t> sub_group_size;
+  /// @brief Whether the kernel may dereference pointers it did not receive as
+  /// arguments, e.g. ones loaded from a buffer.
+  bool may_access_memory_indirectly = true;
 };
 
 /// @brief GenericMetadataHandler handles interacting with the metadata API such
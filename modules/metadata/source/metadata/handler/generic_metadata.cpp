@@ -111,12 +111,17 @@ bool GenericMetadataHandler::read(GenericMetadata &md) {
       md::utils::read_value<uint64_t>((uint8_t *)data + offset,
                                       md_get_endianness(ctx)) == 1;
   offset += sizeof(uint64_t);
+  const bool may_access_memory_indirectly =
+      md::utils::read_value<uint64_t>((uint8_t *)data + offset,
+                                      md_get_endianness(ctx)) != 0;
+  offset += sizeof(uint64_t);
 
   md.kernel_name = std::move(kernel_name);
   md.source_name = std::move(source_name);
   md.local_memory_usage = local_memory_used;
   md.sub_group_size = FixedOrScalableQuantity<uint32_t>(
       sub_group_size_fixed, sub_group_size_is_scalable);
+  md.may_access_memory_indirectly = may_access_memory_indirectly;
   return true;
 }
 
@@ -145,6 +150,10 @@ bool GenericMetadataHandler::write(const GenericMetadata &md) {
   if (MD_CHECK_ERR(err)) {
     return false;
   }
+  err = md_push_uint(generic_stack, md.may_access_memory_indirectly ? 1 : 0);
+  if (MD_CHECK_ERR(err)) {
+    return false;
+  }
   return true;
 }
 
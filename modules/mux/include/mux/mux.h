@@ -37,7 +37,7 @@ extern "C" {
 /// @brief Mux major version number.
 #define MUX_MAJOR_VERSION 0
 /// @brief Mux minor version number.
-#define MUX_MINOR_VERSION 80
+#define MUX_MINOR_VERSION 83
 /// @brief Mux patch version number.
 #define MUX_PATCH_VERSION 0
 /// @brief Mux combined version number.
@@ -130,6 +130,10 @@ typedef struct mux_query_counter_config_s mux_query_counter_config_t;
 /// @brief Forward declare Mux's duration query result container.
 typedef struct mux_query_duration_result_s *mux_query_duration_result_t;
 
+/// @brief Forward declare Mux's slice duration query result container.
+typedef struct mux_query_slice_duration_result_s
+    *mux_query_slice_duration_result_t;
+
 /// @brief Forward declare Mux's counter query result container.
 typedef struct mux_query_counter_result_s *mux_query_counter_result_t;
 
@@ -756,7 +760,12 @@ typedef enum mux_query_type_e {
   /// query **shall** be enabled in a command buffer at one time.
   mux_query_type_duration,
   /// @brief Query the values of an enabled set of hardware counters.
-  mux_query_type_counter
+  mux_query_type_counter,
+  /// @brief Query the start and end timestamps and the number of work-groups
+  /// of each slice a target splits an ND range into for parallel execution,
+  /// the timestamps **must** be CPU timestamps, only a single slice duration
+  /// query **shall** be enabled in a command buffer at one time.
+  mux_query_type_slice_duration
 } mux_query_type_e;
 
 /// @brief All possible query counter storage types.
@@ -1868,6 +1877,41 @@ mux_result_t muxCommandNDRange(mux_command_buffer_t command_buffer,
                                const mux_sync_point_t *sync_point_wait_list,
                                mux_sync_point_t *sync_point);
 
+/// @brief Push an N-Dimensional run command whose number of work-groups is read
+/// from a buffer to the command buffer.
+///
+/// The buffer contains three `uint32_t` work-group counts at `offset`, one per
+/// dimension, which are read when the command executes rather than when it is
+/// pushed. The global size of each dimension is its work-group count
+/// multiplied by the local size, counts of dimensions past
+/// `options.dimensions` are ignored. Entry point is optional and must return
+/// mux_error_feature_unsupported if the device doesn't report
+/// `supports_indirect_ndrange`.
+///
+/// @param[in] command_buffer The command buffer to push the N-Dimensional run
+/// command to.
+/// @param[in] kernel The kernel to execute.
+/// @param[in] options The execution options to use during the run command,
+/// `global_size` is ignored and may be null.
+/// @param[in] buffer The buffer containing the number of work-groups to
+/// execute.
+/// @param[in] offset The offset in bytes into the buffer of the work-group
+/// counts, must be a multiple of 4.
+/// @param[in] num_sync_points_in_wait_list Number of items in
+/// sync_point_wait_list.
+/// @param[in] sync_point_wait_list List of sync-points that need to complete
+/// before this command can be executed.
+/// @param[out] sync_point Returns a sync-point identifying this command, which
+/// may be passed as NULL, that other commands in the command-buffer can wait
+/// on.
+///
+/// @return mux_success, or a mux_error_* if an error occurred.
+mux_result_t muxCommandNDRangeIndirect(
+    mux_command_buffer_t command_buffer, mux_kernel_t kernel,
+    mux_ndrange_options_t options, mux_buffer_t buffer, uint64_t offset,
+    uint32_t num_sync_points_in_wait_list,
+    const mux_sync_point_t *sync_point_wait_list, mux_sync_point_t *sync_point);
+
 /// @brief Update arguments to an N-Dimensional run command within the command
 /// buffer.
 ///
@@ -2389,6 +2433,15 @@ struct mux_device_info_s {
   /// @brief Boolean value indicating if the generic address space is supported
   /// by the device.
   bool supports_generic_address_space;
+  /// @brief Boolean value indicating if the device supports ND ranges whose
+  /// global size is not a multiple of the local size.
+  ///
+  /// The trailing work-groups in each dimension are then smaller than the local
+  /// size passed to `muxCommandNDRange`.
+  bool supports_non_uniform_work_groups;
+  /// @brief Boolean value indicating if the device supports
+  /// `muxCommandNDRangeIndirect`.
+  bool supports_indirect_ndrange;
   /// @brief The number of sub-group sizes supported by the device, pointed to
   /// by sub_group_sizes.
   size_t num_sub_group_sizes;
@@ -2668,6 +2721,17 @@ struct mux_query_duration_result_s {
   uint64_t end;
 };
 
+/// @brief Mux's slice duration query result container.
+struct mux_query_slice_duration_result_s {
+  /// @brief The CPU timestamp at the start of the slice, in nanoseconds.
+  uint64_t start;
+  /// @brief The CPU timestamp at the end of the slice, in nanoseconds.
+  uint64_t end;
+  /// @brief The number of work-groups executed by the slice, zero if the slice
+  /// was not used.
+  uint64_t work_groups;
+};
+
 /// @brief Mux's counter query result container.
 struct mux_query_counter_result_s {
   /// @brief The union of possible counter query results.
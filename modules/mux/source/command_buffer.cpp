@@ -1102,6 +1102,53 @@ mux_result_t muxCommandNDRange(mux_command_buffer_t command_buffer,
   return error;
 }
 
+mux_result_t muxCommandNDRangeIndirect(
+    mux_command_buffer_t command_buffer, mux_kernel_t kernel,
+    mux_ndrange_options_t options, mux_buffer_t buffer, uint64_t offset,
+    uint32_t num_sync_points_in_wait_list,
+    const mux_sync_point_t *sync_point_wait_list,
+    mux_sync_point_t *sync_point) {
+  const tracer::TraceGuard<tracer::Mux> guard(__func__);
+
+  if (mux::objectIsInvalid(command_buffer)) {
+    return mux_error_invalid_value;
+  }
+
+  if (mux::objectIsInvalid(kernel)) {
+    return mux_error_invalid_value;
+  }
+
+  if (mux::objectIsInvalid(buffer)) {
+    return mux_error_invalid_value;
+  }
+
+  if (0 != offset % sizeof(uint32_t)) {
+    return mux_error_invalid_value;
+  }
+
+  if ((offset + (3 * sizeof(uint32_t))) > buffer->memory_requirements.size) {
+    return mux_error_invalid_value;
+  }
+
+  if (waitlistIsInvalid(num_sync_points_in_wait_list, sync_point_wait_list)) {
+    return mux_error_invalid_value;
+  }
+
+  if (!command_buffer->device->info->supports_indirect_ndrange) {
+    return mux_error_feature_unsupported;
+  }
+
+  const mux_result_t error = muxSelectCommandNDRangeIndirect(
+      command_buffer, kernel, options, buffer, offset,
+      num_sync_points_in_wait_list, sync_point_wait_list, sync_point);
+  if (mux_success == error && nullptr != sync_point) {
+    mux::setId<mux_object_id_sync_point>(command_buffer->device->info->id,
+                                         *sync_point);
+  }
+
+  return error;
+}
+
 mux_result_t muxUpdateDescriptors(mux_command_buffer_t command_buffer,
                                   mux_command_id_t command_id,
                                   uint64_t num_args, uint64_t *arg_indices,
@@ -60,6 +60,8 @@ struct query_pool : mux_query_pool_s {
       case mux_query_type_duration:
       case mux_query_type_counter:
         break;
+      case mux_query_type_slice_duration:
+        return cargo::make_unexpected(mux_error_feature_unsupported);
       default:
         return cargo::make_unexpected(mux_error_invalid_value);
     }
@@ -69,11 +69,12 @@ mux_result_t muxCreateQueryPool(
   }
 
   if (query_type != mux_query_type_duration &&
-      query_type != mux_query_type_counter) {
+      query_type != mux_query_type_counter &&
+      query_type != mux_query_type_slice_duration) {
     return mux_error_invalid_value;
   }
 
-  if (query_type == mux_query_type_duration &&
+  if (query_type != mux_query_type_counter &&
       query_counter_configs != nullptr) {
     return mux_error_invalid_value;
   }
@@ -178,6 +179,14 @@ mux_result_t muxGetQueryPoolResults(mux_queue_t queue,
     if (stride < sizeof(mux_query_counter_result_s)) {
       return mux_error_invalid_value;
     }
+  } else if (query_pool->type == mux_query_type_slice_duration) {
+    if (size < sizeof(mux_query_slice_duration_result_s) * query_count) {
+      return mux_error_invalid_value;
+    }
+
+    if (stride < sizeof(mux_query_slice_duration_result_s)) {
+      return mux_error_invalid_value;
+    }
   }
 
   if (nullptr == data) {
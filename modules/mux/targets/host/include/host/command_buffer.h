@@ -23,12 +23,14 @@
 #include <cargo/expected.h>
 
 #include <array>
+#include <memory>
 #include <mutex>
 
 #include "host/fence.h"
 #include "mux/mux.h"
 #include "mux/utils/dynamic_array.h"
 #include "mux/utils/small_vector.h"
+#include "tracer/tracer.h"
 
 namespace host {
 /// @addtogroup host
@@ -39,20 +41,33 @@ namespace host {
 ///
 /// This struct later gets cast to `void*` and passed to the lambda that threads
 /// in the threadpool execute to actually run the range.
+///
+/// Once recorded an ND range is immutable while it is shared, command buffers
+/// created by `hostCloneCommandBuffer` hold a reference to the same
+/// `ndrange_info_s` as the command buffer they were cloned from, and
+/// `hostUpdateDescriptors` copies a shared ND range before modifying it.
 struct ndrange_info_s {
   ndrange_info_s(void *packed_args,
                  mux::dynamic_array<uint8_t *> &arg_addresses,
                  mux::dynamic_array<mux_descriptor_info_t> &descriptors,
                  std::array<size_t, 3> global_size,
                  std::array<size_t, 3> global_offset,
-                 std::array<size_t, 3> local_size, size_t dimensions)
+                 std::array<size_t, 3> local_size, size_t dimensions,
+                 mux_allocator_info_t allocator_info)
       : packed_args(packed_args),
         arg_addresses(std::move(arg_addresses)),
         descriptors(std::move(descriptors)),
         global_size(global_size),
         global_offset(global_offset),
         local_size(local_size),
-        dimensions(dimensions) {}
+        dimensions(dimensions),
+        allocator_info(allocator_info) {}
+
+  ndrange_info_s(const ndrange_info_s &) = delete;
+  ndrange_info_s &operator=(const ndrange_info_s &) = delete;
+
+  /// @brief Frees the packed descriptors.
+  ~ndrange_info_s();
 
   /// @brief Packed descriptors.
   void *packed_args;
@@ -79,6 +94,9 @@ struct ndrange_info_s {
   /// @brief Dimensions in the ND range.
   size_t dimensions;
 
+  /// @brief Allocator the packed descriptors were allocated with.
+  mux_allocator_info_t allocator_info;
+
   /// @Brief Create a deep copy of the ndrange command
   cargo::expected<std::unique_ptr<ndrange_info_s>, mux_result_t> clone(
       mux_allocator_info_t allocator_info) const;
@@ -189,9 +207,23 @@ struct command_info_copy_buffer_to_image_s {
   mux_extent_3d_t extent;
 };
 
+/// @brief Maximum number of ND ranges executed as a single fused dispatch.
+constexpr uint32_t max_fused_ndranges = 8;
+
 struct command_info_ndrange_s {
   mux_kernel_t kernel;
   ndrange_info_s *ndrange_info;
+  /// @brief Number of ND range commands immediately following this one which
+  /// `hostFinalizeCommandBuffer` fused into it.
+  ///
+  /// Fused ND ranges are executed back-to-back within each slice of this
+  /// command's dispatch, and are skipped when the queue reaches them.
+  uint32_t fused_count;
+  /// @brief Buffer the work-group counts of an indirect ND range are read from
+  /// when it executes, or null if the range is in `ndrange_info`.
+  mux_buffer_t indirect_buffer;
+  /// @brief Offset in bytes into `indirect_buffer` of the work-group counts.
+  uint64_t indirect_offset;
 };
 
 struct command_info_user_callback_s {
@@ -275,6 +307,10 @@ struct command_info_s {
 
   host::command_type_e type;
 
+  /// @brief Flow of the API call which recorded the command, see
+  /// `tracer::FlowGuard`, or zero if there wasn't one.
+  uint64_t trace_flow = tracer::getCurrentFlow();
+
   // We use a union to minimize the number of allocations that need to be made.
   union {
     struct host::command_info_read_buffer_s read_command;
@@ -306,7 +342,9 @@ struct command_buffer_s final : public mux_command_buffer_s {
   ~command_buffer_s();
 
   mux::small_vector<host::command_info_s, 16> commands;
-  mux::small_vector<std::unique_ptr<host::ndrange_info_s>, 4> ndranges;
+  /// @brief ND ranges referenced by `commands`, these may be shared with
+  /// command buffers this one was cloned from or cloned to.
+  mux::small_vector<std::shared_ptr<host::ndrange_info_s>, 4> ndranges;
   mux::small_vector<host::sync_point_s *, 4> sync_points;
   std::mutex mutex;
   mux::small_vector<mux_semaphore_t, 8> signal_semaphores;
@@ -29,6 +29,10 @@
 #include "host/papi_counter.h"
 #endif
 
+#ifdef CA_HOST_ENABLE_PERF_COUNTERS
+#include "host/perf_counter.h"
+#endif
+
 namespace host {
 /// @addtogroup host
 /// @{
@@ -94,6 +98,11 @@ struct device_info_s final : public mux_device_info_s {
   cargo::dynamic_array<host_papi_counter> papi_counters;
 #endif
 
+#ifdef CA_HOST_ENABLE_PERF_COUNTERS
+  /// @brief Hardware events which perf_event allows this process to count.
+  cargo::dynamic_array<host_perf_counter> perf_counters;
+#endif
+
   /// @brief Detects the device's architecture.
   static host::arch detectHostArch();
   /// @brief Detects the device's OS.
@@ -0,0 +1,90 @@
+// Copyright (C) Codeplay Software Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+// Exceptions; you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://github.com/codeplaysoftware/oneapi-construction-kit/blob/main/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+/// @file
+/// Host's loaded ELF code images, shared between executables.
+
+#ifndef HOST_ELF_IMAGE_H_INCLUDED
+#define HOST_ELF_IMAGE_H_INCLUDED
+
+#include <cargo/expected.h>
+#include <host/executable.h>
+#include <loader/mapper.h>
+#include <mux/mux.h>
+#include <mux/utils/allocator.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace host {
+/// @addtogroup host
+/// @{
+
+/// @brief An ELF binary loaded into memory, relocated and protected.
+///
+/// All the allocated sections of the binary are laid out in a single mapping,
+/// grouped into page aligned segments by their protection so each segment can
+/// be protected with a single call. Code comes first, then read-only data,
+/// then writable data.
+///
+/// A shared image can outlive the executable, and so the `mux::allocator`, it
+/// was first loaded with. Images and their copy of the binary are therefore
+/// allocated with the system allocator rather than a `mux::allocator`.
+struct elf_image_s {
+  /// @brief Copy of the ELF binary the image was loaded from, 8 byte aligned
+  /// as required by `loader::ElfFile`. Also used to confirm a cache hit isn't
+  /// a hash collision.
+  std::vector<uint64_t> elf_contents;
+  /// @brief Length in bytes of the binary in `elf_contents`.
+  size_t binary_length = 0;
+  /// @brief Hash of the binary.
+  size_t hash = 0;
+  /// @brief Pages the sections of the binary are loaded into.
+  loader::PageRange pages;
+  /// @brief Map of kernel names to binary kernels, with hooks pointing into
+  /// `pages`.
+  kernel_variant_map kernels;
+};
+
+/// @brief Size in bytes from which the code segment of an image is advised to
+/// be backed by huge pages.
+constexpr size_t elf_image_huge_page_threshold = 2 * 1024 * 1024;
+
+/// @brief Load an ELF binary, or reuse an image already loaded from the same
+/// binary.
+///
+/// Images without writable sections are cached process wide, keyed by a hash
+/// of the binary, so all executables created from a binary share the same
+/// relocated code. The cache only holds weak references, the image is
+/// unmapped when the last executable using it is destroyed. Images with
+/// writable sections are always loaded privately, as their data must not be
+/// shared between executables.
+///
+/// @param[in] binary ELF binary to load.
+/// @param[in] binary_length Length in bytes of `binary`.
+/// @param[in] allocator Allocator used for temporary storage while loading,
+/// the image itself is not allocated with it.
+///
+/// @return Returns the loaded image, `mux_error_invalid_binary` if the binary
+/// isn't a valid host ELF binary, or `mux_error_out_of_memory`.
+cargo::expected<std::shared_ptr<const elf_image_s>, mux_result_t> loadElfImage(
+    const void *binary, uint64_t binary_length, mux::allocator allocator);
+
+/// @}
+}  // namespace host
+
+#endif  // HOST_ELF_IMAGE_H_INCLUDED
@@ -21,15 +21,12 @@
 #define HOST_EXECUTABLE_H_INCLUDED
 
 #include <memory>
+#include <string>
 #include <unordered_map>
 #include <vector>
 
 #include "host/utils/jit_kernel.h"
-#include "loader/elf.h"
-#include "loader/mapper.h"
 #include "mux/mux.h"
-#include "mux/utils/dynamic_array.h"
-#include "mux/utils/small_vector.h"
 
 namespace host {
 /// @addtogroup host
@@ -56,11 +53,16 @@ struct binary_kernel_s {
   /// * If zero, denotes a 'degenerate' sub-group (i.e., the size of the
   /// work-group at enqueue time).
   uint32_t sub_group_size;
+  /// @brief Whether the kernel may dereference pointers it did not receive as
+  /// arguments, e.g. device pointers stored inside a buffer.
+  bool may_access_memory_indirectly;
 };
 
 using kernel_variant_map =
     std::unordered_map<std::string, std::vector<::host::binary_kernel_s>>;
 
+struct elf_image_s;
+
 struct executable_s final : public mux_executable_s {
   /// @brief Create an executable from a single binary kernel outwith an ELF
   /// file.
@@ -68,18 +70,14 @@ struct executable_s final : public mux_executable_s {
   /// @param[in] device Mux device.
   /// @param[in] jit_kernel The single JIT binary kernel to be stored in this
   /// executable.
-  executable_s(mux_device_t device, utils::jit_kernel_s jit_kernel,
-               mux::allocator allocator);
+  executable_s(mux_device_t device, utils::jit_kernel_s jit_kernel);
 
   /// @brief Create an executable from a pre-compiled binary.
   ///
   /// @param[in] device Mux device.
-  /// @param[in] elf_contents Contents of ELF file.
-  /// @param[in] allocated_pages Allocated pages for loaded binary.
-  /// @param[in] binary_kernels Binary kernel map.
-  executable_s(mux_device_t device, mux::dynamic_array<uint64_t> elf_contents,
-               mux::small_vector<loader::PageRange, 4> allocated_pages,
-               host::kernel_variant_map binary_kernels);
+  /// @param[in] image Loaded image of the binary, which may be shared with
+  /// other executables created from the same binary.
+  executable_s(mux_device_t device, std::shared_ptr<const elf_image_s> image);
 
   /// @brief Deleted copy constructor.
   ///
@@ -110,14 +108,11 @@ struct executable_s final : public mux_executable_s {
   /// that kernel.
   std::string jit_kernel_name;
 
-  /// @brief ELF binary this executable was created from.
-  mux::dynamic_array<uint64_t> elf_contents;
-
-  /// @brief Pages allocated by our ELF loader for the binary.
+  /// @brief Loaded image of the ELF binary this executable was created from.
   ///
-  /// Kept around here for lifetime reasons, our executable shouldn't outlive
-  /// these.
-  mux::small_vector<loader::PageRange, 4> allocated_pages;
+  /// Kept around here for lifetime reasons, the image is unmapped once every
+  /// executable sharing it has been destroyed.
+  std::shared_ptr<const elf_image_s> image;
 
   /// @brief Map of kernel names to binary kernels contained in this executable.
   kernel_variant_map kernels;
@@ -27,6 +27,7 @@
 #include <mux/mux.h>
 #include <mux/utils/allocator.h>
 
+#include <array>
 #include <memory>
 #include <string>
 
@@ -67,6 +68,9 @@ struct kernel_variant_s {
   uint32_t min_work_width = 0;
   uint32_t pref_work_width = 0;
   uint32_t sub_group_size = 0;
+  /// @brief Whether the kernel may dereference pointers it did not receive as
+  /// arguments, e.g. device pointers stored inside a buffer.
+  bool may_access_memory_indirectly = true;
 };
 
 struct kernel_s final : public mux_kernel_s {
@@ -90,9 +94,31 @@ struct kernel_s final : public mux_kernel_s {
                                          size_t local_size_z,
                                          kernel_variant_s *out_variant_data);
 
+  /// @brief Select the kernel variant to execute an ND range with.
+  ///
+  /// When the global size is not a multiple of the local size the trailing
+  /// work-group in the x dimension is smaller than the local size, so the
+  /// selected variant must be legal for that size too.
+  ///
+  /// @param[in] global_size Global size of the ND range.
+  /// @param[in] local_size Local size of the ND range.
+  /// @param[out] out_variant_data Selected kernel variant.
+  ///
+  /// @return Returns `mux_success`, or `mux_error_failure` if no variant can
+  /// execute the ND range.
+  mux_result_t getKernelVariantForNDRange(
+      const std::array<size_t, 3> &global_size,
+      const std::array<size_t, 3> &local_size,
+      kernel_variant_s *out_variant_data);
+
   /// @brief If the kernel is a built-in kernel.
   bool is_builtin_kernel;
 
+  /// @brief If any variant of the kernel may access memory indirectly.
+  ///
+  /// Built-in kernels are conservatively assumed to.
+  bool may_access_memory_indirectly = true;
+
   /// @brief The allocator used to create this kernel, used to allocate packed
   /// args when specialization info is provided.
   mux_allocator_info_t allocator_info;
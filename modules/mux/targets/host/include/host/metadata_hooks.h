@@ -24,6 +24,7 @@
 #include <cargo/string_view.h>
 #include <host/executable.h>
 #include <loader/elf.h>
+#include <mux/utils/allocator.h>
 
 namespace host {
 constexpr const char MD_NOTES_SECTION[] = "notes";
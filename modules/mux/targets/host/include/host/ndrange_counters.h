@@ -0,0 +1,117 @@
+// Copyright (C) Codeplay Software Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+// Exceptions; you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://github.com/codeplaysoftware/oneapi-construction-kit/blob/main/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+/// @file
+/// Host's ND range slice counters, which are available without PAPI.
+
+#ifndef HOST_NDRANGE_COUNTERS_H_INCLUDED
+#define HOST_NDRANGE_COUNTERS_H_INCLUDED
+
+#include <cargo/array_view.h>
+#include <mux/mux.h>
+
+#include <cstdint>
+
+namespace host {
+/// @addtogroup host
+/// @{
+
+/// @brief UUIDs of the ND range slice counters.
+///
+/// PAPI event codes have either the preset (`0x80000000`) or native
+/// (`0x40000000`) mask bit set, so this range can't collide with them.
+enum ndrange_counter_e : uint32_t {
+  /// @brief Number of ND range commands executed.
+  ndrange_counter_ndranges = 0x00010000,
+  /// @brief Number of work-groups executed by the ND ranges.
+  ndrange_counter_work_groups,
+  /// @brief Sum over each ND range of its slowest slice, in nanoseconds.
+  ndrange_counter_slowest_slice_time,
+  /// @brief Sum over each ND range of its mean slice time, in nanoseconds.
+  ndrange_counter_mean_slice_time,
+  /// @brief Percentage of the slowest slice times the mean slice spent idle.
+  ndrange_counter_slice_imbalance,
+};
+
+/// @brief Description of an ND range slice counter.
+struct ndrange_counter_s {
+  /// @brief Unique ID of the counter, one of `ndrange_counter_e`.
+  uint32_t uuid;
+  /// @brief Short name of the counter.
+  const char *name;
+  /// @brief Description of what the counter measures.
+  const char *description;
+  /// @brief Unit of measurement of the counter.
+  mux_query_counter_unit_e unit;
+  /// @brief Data storage type of the counter.
+  mux_query_counter_storage_e storage;
+
+  /// @brief Helper function to populate a `mux_query_counter_s` with this
+  /// counter's info.
+  ///
+  /// @param out_query_counter Counter struct to populate.
+  void populateMuxQueryCounter(mux_query_counter_s *out_query_counter) const;
+
+  /// @brief Helper function to populate a `mux_query_counter_description_s`
+  /// with this counter's info.
+  ///
+  /// @param out_description Counter description struct to populate.
+  void populateMuxQueryCounterDescription(
+      mux_query_counter_description_s *out_description) const;
+};
+
+/// @brief Get the list of ND range slice counters.
+cargo::array_view<const ndrange_counter_s> getNDRangeCounters();
+
+/// @brief Check whether a counter UUID is one of the ND range slice counters.
+///
+/// @param uuid Unique ID of the counter.
+bool isNDRangeCounter(uint32_t uuid);
+
+/// @brief Slice timings of the ND ranges executed while a counter query is
+/// active, accumulated for the ND range slice counters.
+///
+/// Only slices which executed work-groups are taken into account, so an ND
+/// range with fewer work-groups than slices isn't reported as imbalanced.
+struct ndrange_statistics_s {
+  /// @brief Reset all the statistics to zero.
+  void reset() { *this = ndrange_statistics_s(); }
+
+  /// @brief Accumulate the slice timings of an ND range.
+  ///
+  /// @param slices Slice timings of the ND range, one per slice.
+  void record(
+      cargo::array_view<const mux_query_slice_duration_result_s> slices);
+
+  /// @brief Get the value of an ND range slice counter.
+  ///
+  /// @param uuid Unique ID of the counter, must be one of `ndrange_counter_e`.
+  mux_query_counter_result_s read(uint32_t uuid) const;
+
+  /// @brief Number of ND ranges recorded.
+  uint64_t ndranges = 0;
+  /// @brief Number of work-groups executed by the ND ranges.
+  uint64_t work_groups = 0;
+  /// @brief Sum of the slowest slice of each ND range, in nanoseconds.
+  uint64_t slowest_slice_time = 0;
+  /// @brief Sum of the mean slice time of each ND range, in nanoseconds.
+  uint64_t mean_slice_time = 0;
+};
+
+/// @}
+}  // namespace host
+
+#endif  // HOST_NDRANGE_COUNTERS_H_INCLUDED
@@ -0,0 +1,104 @@
+// Copyright (C) Codeplay Software Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+// Exceptions; you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://github.com/codeplaysoftware/oneapi-construction-kit/blob/main/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+/// @file
+/// Host's Linux perf_event hardware counter abstraction, used when PAPI isn't.
+
+#ifndef HOST_PERF_COUNTER_H_INCLUDED
+#define HOST_PERF_COUNTER_H_INCLUDED
+
+#include <cargo/dynamic_array.h>
+#include <cargo/expected.h>
+#include <mux/mux.h>
+#include <sys/types.h>
+
+#include <cstdint>
+
+namespace host {
+/// @addtogroup host
+/// @{
+
+/// @brief Struct containing all the information host needs to know about a
+/// hardware event counted with `perf_event_open`.
+///
+/// Counters are identified by the event code of the equivalent PAPI preset,
+/// so UUIDs are the same whichever backend host was built with.
+struct host_perf_counter final {
+  /// @brief PAPI preset event code of the counter, used as its UUID.
+  uint32_t uuid;
+  /// @brief `PERF_COUNT_HW_*` generalized hardware event of the counter.
+  uint64_t config;
+  /// @brief Event name, the name of the equivalent PAPI preset.
+  const char *name;
+  /// @brief Short description of the event.
+  const char *description;
+  /// @brief Unit of measurement the counter is counting.
+  mux_query_counter_unit_e unit;
+
+  /// @brief Helper function to populate a `mux_query_counter_s` with this
+  /// counter's info.
+  ///
+  /// @param out_query_counter Counter struct to populate.
+  void populateMuxQueryCounter(mux_query_counter_s *out_query_counter) const;
+
+  /// @brief Helper function to populate a `mux_query_counter_description_s`
+  /// with this counter's info.
+  ///
+  /// @param out_description Counter description struct to populate.
+  void populateMuxQueryCounterDescription(
+      mux_query_counter_description_s *out_description) const;
+};
+
+/// @brief Helper function that probes which hardware events can be counted
+/// by this process and returns a dynamic array of `host_perf_counter` structs.
+///
+/// Returns an empty array rather than an error when perf is unavailable, for
+/// example when `perf_event_paranoid` forbids it or there is no PMU, so host
+/// falls back to only reporting the ND range counters.
+cargo::expected<cargo::dynamic_array<host_perf_counter>, mux_result_t>
+initPerfCounters();
+
+/// @brief Open a disabled counter for a hardware event on a thread.
+///
+/// @param config `PERF_COUNT_HW_*` event to count.
+/// @param thread_id System thread ID of the thread to count, 0 for the calling
+/// thread.
+///
+/// @return Returns the file descriptor of the counter, or -1 on failure.
+int openPerfCounter(uint64_t config, pid_t thread_id);
+
+/// @brief Reset and start a counter.
+///
+/// @param fd File descriptor returned by `openPerfCounter`.
+void startPerfCounter(int fd);
+
+/// @brief Stop a counter and read its value.
+///
+/// When more counters are open than the PMU has, the kernel multiplexes them
+/// and the value is scaled up by the fraction of time the counter ran.
+///
+/// @param fd File descriptor returned by `openPerfCounter`.
+uint64_t stopPerfCounter(int fd);
+
+/// @brief Close a counter.
+///
+/// @param fd File descriptor returned by `openPerfCounter`.
+void closePerfCounter(int fd);
+
+/// @}
+}  // namespace host
+
+#endif  // HOST_PERF_COUNTER_H_INCLUDED
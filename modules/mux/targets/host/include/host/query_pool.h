@@ -24,6 +24,7 @@
 #include <cargo/array_view.h>
 #include <cargo/expected.h>
 #include <host/host.h>
+#include <host/ndrange_counters.h>
 #include <mux/utils/allocator.h>
 
 #include <cassert>
@@ -67,10 +68,10 @@ struct query_pool_s final : mux_query_pool_s {
   /// @param query_type Type of results the query pool will store.
   /// @param query_count Number of `uint64_t` query slots to allocate.
   /// @param allocator Mux allocator used for allocations.
-  /// @param query_configs Query counter configs, may be null if this is a
-  /// duration query pool.
-  /// @param queue Queue the query pool is to be used with, may be null if this
-  /// is a duration query pool.
+  /// @param query_configs Query counter configs, may be null unless this is a
+  /// counter query pool.
+  /// @param queue Queue the query pool is to be used with, may be null unless
+  /// this is a counter query pool.
   ///
   /// @return Returns a newly constructed query pool on success, or
   /// `mux_error_out_of_memory` on failure.
@@ -91,31 +92,51 @@ struct query_pool_s final : mux_query_pool_s {
     return static_cast<mux_query_duration_result_t>(this->data) + index;
   }
 
-#ifdef CA_HOST_ENABLE_PAPI_COUNTERS
-  /// @brief Start measuring all the events associated with the pool.
-  void startEvents();
+  /// @brief Get a range of slice duration queries.
+  ///
+  /// @param index Index of the first query to get.
+  /// @param count Number of queries to get.
+  ///
+  /// @return Returns a view of the slice duration query storage.
+  cargo::array_view<mux_query_slice_duration_result_s>
+  getSliceDurationQueriesAt(uint32_t index, uint32_t count) {
+    assert(this->type == mux_query_type_slice_duration &&
+           "type must be mux_query_type_slice_duration");
+    auto begin = static_cast<mux_query_slice_duration_result_t>(this->data);
+    return {begin + index, begin + index + count};
+  }
 
-  /// @brief Stop measuring events and read the results into `data`.
-  void endEvents();
+  /// @brief Start counting, resetting the results of previous queries.
+  void beginCounters();
 
-  /// @brief Delete the pool's events and their associated result buffers.
+  /// @brief Stop counting and latch the results.
+  void endCounters();
+
+  /// @brief Accumulate the slice timings of an ND range executed while the
+  /// counters are active.
+  ///
+  /// @param slices Slice timings of the ND range, one per slice.
+  void recordNDRange(
+      cargo::array_view<const mux_query_slice_duration_result_s> slices) {
+    ndrange_statistics.record(slices);
+  }
+
+  /// @brief Read the results of a range of counter queries.
+  ///
+  /// @param data Memory to write `mux_query_counter_result_s` results to.
+  /// @param stride Stride in bytes between results written to `data`.
+  /// @param query_index Index of the first query to read.
+  /// @param query_count Number of queries to read.
+  mux_result_t readCounterResults(void *data, size_t stride,
+                                  uint32_t query_index, uint32_t query_count);
+
+  /// @brief Free the counter configuration and any hardware counters of the
+  /// pool.
   ///
   /// Should only be used during object teardown.
   ///
   /// @param allocator The allocator used to allocate this query pool's memory.
-  void freeEvents(mux::allocator &allocator);
-
-  /// @brief Read results from our papi event set and return in the given
-  /// buffer.
-  ///
-  /// @param results Pointer to array of `result_count`
-  /// `mux_query_counter_result_s` structs to return the results in.
-  /// @param result_count Number results to read out.
-  /// @param query_index Offset into the pool's query slots to start reading
-  /// from.
-  mux_result_t readPapiResults(mux_query_counter_result_s *results,
-                               size_t result_count, size_t query_index);
-#endif
+  void freeCounters(mux::allocator &allocator);
 
   /// @brief Reset the query pool result storage to zeros.
   void reset();
@@ -139,10 +160,52 @@ struct query_pool_s final : mux_query_pool_s {
   query_pool_s &operator=(const query_pool_s &) = delete;
 
 #ifdef CA_HOST_ENABLE_PAPI_COUNTERS
-  /// @brief The event sets created for this query pool, one per worker thread.
+  /// @brief Start measuring all the events associated with the pool.
+  void startEvents();
+
+  /// @brief Stop measuring events and read the results into `data`.
+  void endEvents();
+
+  /// @brief Delete the pool's events and their associated result buffers.
+  ///
+  /// Should only be used during object teardown.
+  ///
+  /// @param allocator The allocator used to allocate this query pool's memory.
+  void freeEvents(mux::allocator &allocator);
+
+  /// @brief Read the result of a PAPI counter query from our event sets,
+  /// accumulated across the worker threads.
+  ///
+  /// @param query_index Index of the query to read.
+  mux_query_counter_result_s readPapiResult(size_t query_index);
+
+  /// @brief The event sets created for this query pool, one per worker thread,
+  /// empty if the pool only contains ND range counters.
   cargo::array_view<host_papi_event_info_s> papi_event_infos;
 #endif
 
+#ifdef CA_HOST_ENABLE_PERF_COUNTERS
+  /// @brief Read the result of a perf_event counter query, accumulated across
+  /// the worker threads.
+  ///
+  /// @param query_index Index of the query to read.
+  uint64_t readPerfResult(size_t query_index) const;
+
+  /// @brief Number of worker threads counted, zero if the pool only contains
+  /// ND range counters.
+  size_t perf_thread_count = 0;
+  /// @brief perf_event file descriptors, `count` for each worker thread in
+  /// turn, -1 for the ND range counters.
+  int *perf_fds = nullptr;
+  /// @brief Values read from `perf_fds` when the counters were last ended.
+  uint64_t *perf_results = nullptr;
+#endif
+
+  /// @brief UUIDs of the counters of a counter query pool, one per query.
+  uint32_t *counter_uuids = nullptr;
+  /// @brief Slice timings accumulated for the ND range counters.
+  ndrange_statistics_s ndrange_statistics;
+
   /// @brief Pointer to memory used to store query result data.
   void *data;
   /// @brief Size in bytes of memory pointed to by `data`.
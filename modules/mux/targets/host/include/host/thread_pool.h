@@ -29,6 +29,9 @@
 
 #ifdef CA_HOST_ENABLE_PAPI_COUNTERS
 #include <papi.h>
+#endif
+#if defined(CA_HOST_ENABLE_PAPI_COUNTERS) || \
+    defined(CA_HOST_ENABLE_PERF_COUNTERS)
 #include <sys/syscall.h>
 #include <unistd.h>
 #endif
@@ -146,19 +149,39 @@ struct thread_pool_s final {
     new_work.notify_all();
   }
 
-#ifdef CA_HOST_ENABLE_PAPI_COUNTERS
+#if defined(CA_HOST_ENABLE_PAPI_COUNTERS) || \
+    defined(CA_HOST_ENABLE_PERF_COUNTERS)
   /// @brief Register the calling thread's system thread ID in `thread_ids`.
   void registerPid() {
-    std::lock_guard<std::mutex> lock(thread_ids_mutex);
-    thread_ids[std::this_thread::get_id()] = syscall(SYS_gettid);
+    {
+      std::lock_guard<std::mutex> lock(thread_ids_mutex);
+      thread_ids[std::this_thread::get_id()] = syscall(SYS_gettid);
+    }
+    thread_id_registered.notify_all();
+  }
+
+  /// @brief Get the system thread ID of a worker thread.
+  ///
+  /// Waits for the worker to register its ID if it hasn't started running
+  /// yet.
+  ///
+  /// @param index Index of the worker thread in `pool`.
+  pid_t getThreadId(size_t index) {
+    const auto id = pool[index].get_id();
+    std::unique_lock<std::mutex> lock(thread_ids_mutex);
+    thread_id_registered.wait(lock, [&] { return thread_ids.count(id) != 0; });
+    return thread_ids[id];
   }
 
   /// @brief Mutex for controlling access to `thread_pids`.
   std::mutex thread_ids_mutex;
+  /// @brief A condition to signal when a worker registered its thread ID.
+  std::condition_variable thread_id_registered;
   /// @brief Mapping of cargo::thread::id to the analagous system thread pid_t.
   ///
-  /// PAPI's thread related APIs work with system thread IDs, so we need to
-  /// store them during initialization, and to be able to look them up later.
+  /// PAPI's thread related APIs and perf_event_open work with system thread
+  /// IDs, so we need to store them during initialization, and to be able to
+  /// look them up later.
   std::map<cargo::thread::id, pid_t> thread_ids;
 #endif
 
@@ -23,6 +23,10 @@
 #include <mux/utils/allocator.h>
 #include <mux/utils/helpers.h>
 
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
 #include <cstring>
 #include <memory>
 #include <new>
@@ -163,6 +167,217 @@ void populatePackedArgs(
     }
   }
 }
+enum fusion_mode_e { fusion_mode_none, fusion_mode_fuse, fusion_mode_report };
+
+/// @brief Returns whether ND range fusion was enabled by the
+/// `CA_HOST_FUSE_NDRANGES` environment variable.
+///
+/// Fusion is only correct when no work-group of a fused ND range reads memory
+/// written by a different work-group of an earlier ND range it was fused with,
+/// which can't be checked by the target, so it must be opted into.
+fusion_mode_e getFusionMode() {
+  static const fusion_mode_e mode = [] {
+    const char *env = std::getenv("CA_HOST_FUSE_NDRANGES");
+    if (nullptr == env || 0 == std::strcmp(env, "") ||
+        0 == std::strcmp(env, "0")) {
+      return fusion_mode_none;
+    }
+    return 0 == std::strcmp(env, "report") ? fusion_mode_report
+                                           : fusion_mode_fuse;
+  }();
+  return mode;
+}
+
+/// @brief Returns the reason an ND range can't be the start of a run of fused
+/// ND ranges, or `nullptr` if it can.
+///
+/// Opting into fusion only asserts that kernels access the buffers bound to
+/// them element-wise. A kernel which may dereference pointers loaded from
+/// memory, such as device pointers stored inside a buffer or USM and SVM
+/// allocations, may access memory no argument describes.
+///
+/// @param[in] ndrange ND range command to check.
+const char *getFusionBlocker(const host::command_info_ndrange_s &ndrange) {
+  // The range of an indirect ND range isn't known until it executes.
+  if (ndrange.indirect_buffer) {
+    return "indirect";
+  }
+  if (static_cast<host::kernel_s *>(ndrange.kernel)
+          ->may_access_memory_indirectly) {
+    return "kernel may access memory indirectly";
+  }
+  return nullptr;
+}
+
+/// @brief Returns the reason two ND ranges can't be fused, or `nullptr` if
+/// they can.
+///
+/// The host entry hook divides work-groups between slices based only on the
+/// number of work-groups, so ND ranges with identical ranges assign each
+/// work-group to the same slice.
+///
+/// @param[in] head First ND range of the run.
+/// @param[in] next ND range command to add to the run.
+const char *getFusionBlocker(const host::command_info_ndrange_s &head,
+                             const host::command_info_ndrange_s &next) {
+  const auto &first = *head.ndrange_info;
+  const auto &info = *next.ndrange_info;
+  if (first.dimensions != info.dimensions) {
+    return "dimensions differ";
+  }
+  if (first.global_size != info.global_size) {
+    return "global sizes differ";
+  }
+  if (first.global_offset != info.global_offset) {
+    return "global offsets differ";
+  }
+  if (first.local_size != info.local_size) {
+    return "local sizes differ";
+  }
+  if (head.fused_count + 1 >= host::max_fused_ndranges) {
+    return "fusion limit reached";
+  }
+  return nullptr;
+}
+
+/// @brief Fuse runs of adjacent ND range commands with identical ranges.
+///
+/// @param[in] host Command buffer being finalized.
+/// @param[in] report Whether to print fusion decisions to `stderr`.
+void fuseNDRanges(host::command_buffer_s *host, bool report) {
+  host::command_info_ndrange_s *head = nullptr;
+  uint64_t head_index = 0;
+  for (uint64_t i = 0; i < host->commands.size(); i++) {
+    auto &command = host->commands[i];
+    if (host::command_type_ndrange != command.type) {
+      head = nullptr;
+      continue;
+    }
+    auto &ndrange = command.ndrange_command;
+    ndrange.fused_count = 0;
+    const char *const ndrange_blocker = getFusionBlocker(ndrange);
+    const char *blocker = ndrange_blocker;
+    if (nullptr == blocker && nullptr != head) {
+      blocker = getFusionBlocker(*head, ndrange);
+      if (nullptr == blocker) {
+        head->fused_count++;
+        if (report) {
+          (void)std::fprintf(stderr,
+                             "host: ND range command %" PRIu64
+                             " fused into command %" PRIu64 "\n",
+                             i, head_index);
+        }
+        continue;
+      }
+    }
+    if (report && nullptr != blocker) {
+      (void)std::fprintf(stderr,
+                         "host: ND range command %" PRIu64 " not fused: %s\n",
+                         i, blocker);
+    }
+    // Start a new run at this ND range, unless it can't be fused at all.
+    head = nullptr == ndrange_blocker ? &ndrange : nullptr;
+    head_index = i;
+  }
+}
+
+/// @brief Push an ND range command to a command buffer.
+///
+/// @param[in] command_buffer Command buffer to push the ND range to.
+/// @param[in] kernel Kernel to execute.
+/// @param[in] options Execution options of the ND range.
+/// @param[in] indirect_buffer Buffer the work-group counts are read from when
+/// the ND range executes, or null to use `options.global_size`.
+/// @param[in] indirect_offset Offset in bytes into `indirect_buffer`.
+/// @param[out] sync_point Returns a sync-point for the command, may be null.
+///
+/// @return mux_success, or a mux_error_* if an error occurred.
+mux_result_t pushNDRange(mux_command_buffer_t command_buffer,
+                         mux_kernel_t kernel, mux_ndrange_options_t options,
+                         mux_buffer_t indirect_buffer, uint64_t indirect_offset,
+                         mux_sync_point_t *sync_point) {
+  auto host = static_cast<host::command_buffer_s *>(command_buffer);
+  const std::lock_guard<std::mutex> lock(host->mutex);
+
+  auto host_kernel = static_cast<host::kernel_s *>(kernel);
+  mux::allocator allocator(host_kernel->allocator_info);
+
+  std::array<size_t, 3> global_size;
+  std::array<size_t, 3> global_offset;
+  std::array<size_t, 3> local_size;
+
+  for (size_t i = 0; i < 3; i++) {
+    const bool in_range = i < options.dimensions;
+    // The range of an indirect ND range is only known once it executes.
+    global_size[i] = in_range && !indirect_buffer ? options.global_size[i] : 1;
+    global_offset[i] = in_range ? options.global_offset[i] : 0;
+    local_size[i] = options.local_size[i];
+  }
+
+  mux::dynamic_array<mux_descriptor_info_t> descriptors{allocator};
+  if (descriptors.alloc(options.descriptors_length)) {
+    return mux_error_out_of_memory;
+  }
+
+  // Make a copy of the descriptor so that their lifetime extends beyond this
+  // function call.
+  cargo::array_view<mux_descriptor_info_t> option_descriptors(
+      options.descriptors, options.descriptors_length);
+  std::copy(std::begin(option_descriptors), std::end(option_descriptors),
+            std::begin(descriptors));
+
+  mux::dynamic_array<size_t> offsets{allocator};
+  if (offsets.alloc(descriptors.size())) {
+    return mux_error_out_of_memory;
+  }
+
+  // Allocate memory for the packed kernel arguments and record the offset
+  // into the allocation for each argument
+  const uint64_t packed_args_alloc_size =
+      calcPackedArgsAllocSize(descriptors, offsets);
+  uint8_t *const packed_args_allocation =
+      static_cast<uint8_t *>(allocator.alloc(packed_args_alloc_size, 1));
+  if (nullptr == packed_args_allocation) {
+    return mux_error_out_of_memory;
+  }
+
+  // Store the address in packed args allocation of each argument
+  mux::dynamic_array<uint8_t *> arg_addresses{allocator};
+  if (arg_addresses.alloc(descriptors.size())) {
+    return mux_error_out_of_memory;
+  }
+  for (size_t i = 0; i < descriptors.size(); i++) {
+    arg_addresses[i] = packed_args_allocation + offsets[i];
+  }
+
+  // Store necessary argument information in the packed args allocation
+  populatePackedArgs(packed_args_allocation, descriptors);
+
+  if (host->ndranges.emplace_back(std::make_shared<host::ndrange_info_s>(
+          packed_args_allocation, arg_addresses, descriptors, global_size,
+          global_offset, local_size, options.dimensions,
+          host->allocator_info))) {
+    return mux_error_out_of_memory;
+  }
+
+  if (host->commands.push_back(host::command_info_ndrange_s{
+          kernel, host->ndranges.back().get(), 0, indirect_buffer,
+          indirect_offset})) {
+    return mux_error_out_of_memory;
+  }
+
+  if (sync_point) {
+    mux::allocator allocator(host->allocator_info);
+    auto out_sync_point = allocator.create<host::sync_point_s>(host);
+    if (nullptr == out_sync_point ||
+        host->sync_points.push_back(out_sync_point)) {
+      return mux_error_out_of_memory;
+    }
+    *sync_point = out_sync_point;
+  }
+
+  return mux_success;
+}
 }  // namespace
 
 namespace host {
@@ -182,6 +397,11 @@ command_buffer_s::~command_buffer_s() {
   hostDestroyFence(device, fence, allocator_info);
 }
 
+ndrange_info_s::~ndrange_info_s() {
+  mux::allocator allocator(allocator_info);
+  allocator.free(packed_args);
+}
+
 sync_point_s::sync_point_s(mux_command_buffer_t command_buffer) {
   this->command_buffer = command_buffer;
 }
@@ -234,7 +454,7 @@ ndrange_info_s::clone(mux_allocator_info_t allocator_info) const {
 
   return std::make_unique<host::ndrange_info_s>(
       packed_args_allocation, clone_arg_addresses, clone_descriptors,
-      global_size, global_offset, local_size, dimensions);
+      global_size, global_offset, local_size, dimensions, allocator_info);
 }
 }  // namespace host
 
@@ -909,84 +1129,21 @@ mux_result_t hostCommandNDRange(mux_command_buffer_t command_buffer,
   (void)num_sync_points_in_wait_list;
   (void)sync_point_wait_list;
 
-  auto host = static_cast<host::command_buffer_s *>(command_buffer);
-  const std::lock_guard<std::mutex> lock(host->mutex);
-
-  auto host_kernel = static_cast<host::kernel_s *>(kernel);
-  mux::allocator allocator(host_kernel->allocator_info);
-
-  std::array<size_t, 3> global_size;
-  std::array<size_t, 3> global_offset;
-  std::array<size_t, 3> local_size;
-
-  for (size_t i = 0; i < 3; i++) {
-    const bool in_range = i < options.dimensions;
-    global_size[i] = in_range ? options.global_size[i] : 1;
-    global_offset[i] = in_range ? options.global_offset[i] : 0;
-    local_size[i] = options.local_size[i];
-  }
-
-  mux::dynamic_array<mux_descriptor_info_t> descriptors{allocator};
-  if (descriptors.alloc(options.descriptors_length)) {
-    return mux_error_out_of_memory;
-  }
-
-  // Make a copy of the descriptor so that their lifetime extends beyond this
-  // function call.
-  cargo::array_view<mux_descriptor_info_t> option_descriptors(
-      options.descriptors, options.descriptors_length);
-  std::copy(std::begin(option_descriptors), std::end(option_descriptors),
-            std::begin(descriptors));
-
-  mux::dynamic_array<size_t> offsets{allocator};
-  if (offsets.alloc(descriptors.size())) {
-    return mux_error_out_of_memory;
-  }
-
-  // Allocate memory for the packed kernel arguments and record the offset
-  // into the allocation for each argument
-  const uint64_t packed_args_alloc_size =
-      calcPackedArgsAllocSize(descriptors, offsets);
-  uint8_t *const packed_args_allocation =
-      static_cast<uint8_t *>(allocator.alloc(packed_args_alloc_size, 1));
-  if (nullptr == packed_args_allocation) {
-    return mux_error_out_of_memory;
-  }
-
-  // Store the address in packed args allocation of each argument
-  mux::dynamic_array<uint8_t *> arg_addresses{allocator};
-  if (arg_addresses.alloc(descriptors.size())) {
-    return mux_error_out_of_memory;
-  }
-  for (size_t i = 0; i < descriptors.size(); i++) {
-    arg_addresses[i] = packed_args_allocation + offsets[i];
-  }
-
-  // Store necessary argument information in the packed args allocation
-  populatePackedArgs(packed_args_allocation, descriptors);
-
-  if (host->ndranges.emplace_back(std::make_unique<host::ndrange_info_s>(
-          packed_args_allocation, arg_addresses, descriptors, global_size,
-          global_offset, local_size, options.dimensions))) {
-    return mux_error_out_of_memory;
-  }
-
-  if (host->commands.push_back(
-          host::command_info_ndrange_s{kernel, host->ndranges.back().get()})) {
-    return mux_error_out_of_memory;
-  }
+  return pushNDRange(command_buffer, kernel, options, nullptr, 0, sync_point);
+}
 
-  if (sync_point) {
-    mux::allocator allocator(host->allocator_info);
-    auto out_sync_point = allocator.create<host::sync_point_s>(host);
-    if (nullptr == out_sync_point ||
-        host->sync_points.push_back(out_sync_point)) {
-      return mux_error_out_of_memory;
-    }
-    *sync_point = out_sync_point;
-  }
+mux_result_t hostCommandNDRangeIndirect(
+    mux_command_buffer_t command_buffer, mux_kernel_t kernel,
+    mux_ndrange_options_t options, mux_buffer_t buffer, uint64_t offset,
+    uint32_t num_sync_points_in_wait_list,
+    const mux_sync_point_t *sync_point_wait_list,
+    mux_sync_point_t *sync_point) {
+  // TODO CA-4364
+  (void)num_sync_points_in_wait_list;
+  (void)sync_point_wait_list;
 
-  return mux_success;
+  return pushNDRange(command_buffer, kernel, options, buffer, offset,
+                     sync_point);
 }
 
 mux_result_t hostUpdateDescriptors(mux_command_buffer_t command_buffer,
@@ -995,6 +1152,7 @@ mux_result_t hostUpdateDescriptors(mux_command_buffer_t command_buffer,
                                    mux_descriptor_info_t *descriptors) {
   // Get the command to update.
   auto *host = static_cast<host::command_buffer_s *>(command_buffer);
+  const std::lock_guard<std::mutex> lock(host->mutex);
   auto &nd_range_to_update = host->commands[command_id];
 
   // Check the command being updated is actually an ND range.
@@ -1002,6 +1160,23 @@ mux_result_t hostUpdateDescriptors(mux_command_buffer_t command_buffer,
     return mux_error_invalid_value;
   }
 
+  // The ND range may be shared with clones of this command buffer which are
+  // executing, so take a private copy before modifying it.
+  auto shared_ndrange = std::find_if(
+      host->ndranges.begin(), host->ndranges.end(),
+      [&](const std::shared_ptr<host::ndrange_info_s> &ndrange) {
+        return ndrange.get() == nd_range_to_update.ndrange_command.ndrange_info;
+      });
+  if (shared_ndrange != host->ndranges.end() &&
+      shared_ndrange->use_count() > 1) {
+    auto private_ndrange = (*shared_ndrange)->clone(host->allocator_info);
+    if (!private_ndrange) {
+      return private_ndrange.error();
+    }
+    *shared_ndrange = std::move(*private_ndrange);
+    nd_range_to_update.ndrange_command.ndrange_info = shared_ndrange->get();
+  }
+
   // Patch its arguments.
   for (unsigned i = 0; i < num_args; ++i) {
     auto index = arg_indices[i];
@@ -1197,7 +1372,14 @@ mux_result_t hostFinalizeCommandBuffer(mux_command_buffer_t command_buffer) {
   if (nullptr == command_buffer) {
     return mux_error_null_out_parameter;
   }
-  // Finalizing a command buffer is a nop on host.
+  // Finalizing a command buffer is a nop on host unless ND range fusion was
+  // requested.
+  const fusion_mode_e mode = getFusionMode();
+  if (fusion_mode_none != mode) {
+    auto *host = static_cast<host::command_buffer_s *>(command_buffer);
+    const std::lock_guard<std::mutex> lock(host->mutex);
+    fuseNDRanges(host, fusion_mode_report == mode);
+  }
   return mux_success;
 }
 
@@ -1218,39 +1400,22 @@ mux_result_t hostCloneCommandBuffer(mux_device_t device,
     return mux_error_out_of_memory;
   }
 
-  // Deep copy ndrange kernel commands so that we can update them with the
-  // MuxUpdateDescriptors() without affecting the original command-buffer.
+  // Recorded commands are immutable once shared, so the clone references the
+  // same ND ranges as the original rather than copying their descriptors and
+  // packed arguments. Only the fence is unique to the clone, any ND range
+  // later modified by muxUpdateDescriptors() is copied on write. The clone is
+  // not yet visible to any other thread so does not need to be locked.
   auto *host_command_buffer =
       static_cast<host::command_buffer_s *>(command_buffer);
   const std::lock_guard<std::mutex> lock_original(host_command_buffer->mutex);
-  const std::lock_guard<std::mutex> lock_clone{cloned_command_buffer->mutex};
-  for (const auto &command : host_command_buffer->commands) {
-    if (command.type != host::command_type_ndrange) {
-      if (cloned_command_buffer->commands.push_back(command)) {
-        return mux_error_out_of_memory;
-      }
-    } else {
-      const host::command_info_ndrange_s &ndrange_command =
-          command.ndrange_command;
-      const auto &ndrange_info = ndrange_command.ndrange_info;
-
-      auto cloned_ndrange_info = ndrange_info->clone(allocator_info);
-      if (!cloned_ndrange_info) {
-        return cloned_ndrange_info.error();
-      }
-
-      if (cloned_command_buffer->ndranges.emplace_back(
-              std::move(*cloned_ndrange_info))) {
-        return mux_error_out_of_memory;
-      }
-
-      if (cloned_command_buffer->commands.push_back(
-              host::command_info_ndrange_s{
-                  ndrange_command.kernel,
-                  cloned_command_buffer->ndranges.back().get()})) {
-        return mux_error_out_of_memory;
-      }
-    }
+  if (cloned_command_buffer->commands.assign(
+          host_command_buffer->commands.begin(),
+          host_command_buffer->commands.end()) ||
+      cloned_command_buffer->ndranges.assign(
+          host_command_buffer->ndranges.begin(),
+          host_command_buffer->ndranges.end())) {
+    allocator.destroy(cloned_command_buffer);
+    return mux_error_out_of_memory;
   }
 
   *out_command_buffer = cloned_command_buffer;
@@ -1265,10 +1430,6 @@ void hostDestroyCommandBuffer(mux_device_t device,
   mux::allocator allocator(allocator_info);
 
   auto host = static_cast<host::command_buffer_s *>(command_buffer);
-  for (auto &range : host->ndranges) {
-    allocator.free(range->packed_args);
-  }
-
   for (auto sync_point : host->sync_points) {
     allocator.destroy(sync_point);
   }
@@ -506,22 +506,27 @@ device_info_s::device_info_s(host::arch arch, host::os os, bool native,
   }
   this->builtin_kernel_declarations = builtin_kernel_list.c_str();
 
+  // The ND range slice counters are always supported, see ndrange_counters.h.
+  this->query_counter_support = true;
+  this->max_hardware_counters = 0;
 #ifdef CA_HOST_ENABLE_PAPI_COUNTERS
   auto errorOrCounterArray = initPapiCounters();
   if (errorOrCounterArray.has_value() && !errorOrCounterArray.value().empty()) {
-    this->query_counter_support = true;
     this->papi_counters = std::move(errorOrCounterArray.value());
     // 0 is the default index a system's CPU will occupy, if we ever want to run
     // host perf counters on something weirder than a desktop this may need
     // changing.
     auto component_info = PAPI_get_component_info(0);
     this->max_hardware_counters = component_info->num_cntrs;
-  } else {
-    this->query_counter_support = false;
-    this->max_hardware_counters = 0;
   }
-#else
-  this->query_counter_support = false;
+#elif defined(CA_HOST_ENABLE_PERF_COUNTERS)
+  auto errorOrCounterArray = initPerfCounters();
+  if (errorOrCounterArray.has_value()) {
+    this->perf_counters = std::move(errorOrCounterArray.value());
+    // The kernel multiplexes counters when there are more than the PMU has, so
+    // every event can be counted at once.
+    this->max_hardware_counters = this->perf_counters.size();
+  }
 #endif
   this->descriptors_updatable = true;
   this->can_clone_command_buffers = true;
@@ -529,6 +534,10 @@ device_info_s::device_info_s(host::arch arch, host::os os, bool native,
   this->sub_groups_support_ifp = false;
   this->supports_work_group_collectives = true;
   this->supports_generic_address_space = true;
+  // The last work-group in a dimension may be smaller than the local size, see
+  // HostBIMuxInfo.
+  this->supports_non_uniform_work_groups = true;
+  this->supports_indirect_ndrange = true;
 
   // A list of sub-group sizes we report. Roughly ordered according to
   // desirability.
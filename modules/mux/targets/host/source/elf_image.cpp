@@ -0,0 +1,264 @@
+// Copyright (C) Codeplay Software Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+// Exceptions; you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://github.com/codeplaysoftware/oneapi-construction-kit/blob/main/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <cargo/string_view.h>
+#include <host/elf_image.h>
+#include <host/metadata_hooks.h>
+#include <host/utils/relocations.h>
+#include <loader/relocations.h>
+#include <mux/utils/small_vector.h>
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <unordered_map>
+
+namespace {
+/// @brief Process wide cache of images without writable sections.
+struct elf_image_cache_s {
+  std::mutex mutex;
+  std::unordered_multimap<size_t, std::weak_ptr<const host::elf_image_s>>
+      images;
+};
+
+elf_image_cache_s &getElfImageCache() {
+  static elf_image_cache_s cache;
+  return cache;
+}
+
+/// @brief Find a live image loaded from the same binary, the cache mutex must
+/// be held.
+std::shared_ptr<const host::elf_image_s> findElfImage(
+    elf_image_cache_s &cache, size_t hash, const void *binary,
+    size_t binary_length) {
+  auto range = cache.images.equal_range(hash);
+  for (auto it = range.first; it != range.second; ++it) {
+    auto image = it->second.lock();
+    if (image && image->binary_length == binary_length &&
+        0 == std::memcmp(image->elf_contents.data(), binary, binary_length)) {
+      return image;
+    }
+  }
+  return nullptr;
+}
+
+/// @brief Rank of a section protection, segments are laid out in this order.
+uint32_t getSegmentRank(loader::MemoryProtection protection) {
+  switch (protection) {
+    case loader::MEM_CODE:
+      return 0;
+    case loader::MEM_RODATA:
+      return 1;
+    case loader::MEM_DATA:
+      return 2;
+    default:
+      return 3 + protection;
+  }
+}
+
+/// @brief Placement of an allocated section within an image.
+struct section_layout_s {
+  uint32_t section_index;
+  loader::MemoryProtection protection;
+  uint64_t offset;
+};
+
+/// @brief Page aligned range of an image sharing a single protection.
+struct segment_s {
+  loader::MemoryProtection protection;
+  uint64_t offset;
+  uint64_t size;
+};
+}  // namespace
+
+namespace host {
+cargo::expected<std::shared_ptr<const elf_image_s>, mux_result_t> loadElfImage(
+    const void *binary, uint64_t binary_length, mux::allocator allocator) {
+  const size_t hash = std::hash<cargo::string_view>{}(cargo::string_view{
+      static_cast<const char *>(binary), static_cast<size_t>(binary_length)});
+  auto &cache = getElfImageCache();
+  {
+    const std::lock_guard<std::mutex> lock(cache.mutex);
+    if (auto image = findElfImage(cache, hash, binary, binary_length)) {
+      return image;
+    }
+  }
+
+  auto image = std::make_shared<elf_image_s>();
+  image->hash = hash;
+  image->binary_length = binary_length;
+  image->elf_contents.resize((binary_length / sizeof(uint64_t)) + 1);
+  cargo::array_view<uint8_t> elf_bytes{
+      reinterpret_cast<uint8_t *>(image->elf_contents.data()),
+      static_cast<size_t>(binary_length)};
+  std::copy_n(static_cast<const uint8_t *>(binary),
+              static_cast<size_t>(binary_length), elf_bytes.begin());
+
+  if (!loader::ElfFile::isValidElf(elf_bytes)) {
+    return cargo::make_unexpected(mux_error_invalid_binary);
+  }
+  loader::ElfFile elf_file{elf_bytes};
+
+  auto parsed_kernels = readBinaryMetadata(&elf_file, &allocator);
+  if (!parsed_kernels) {
+    return cargo::make_unexpected(mux_error_invalid_binary);
+  }
+  image->kernels = std::move(*parsed_kernels);
+
+  // Order the allocated sections by protection so each protection forms one
+  // contiguous segment.
+  mux::small_vector<section_layout_s, 16> sections{allocator};
+  bool shareable = true;
+  for (auto &section : elf_file.sections()) {
+    if (!(section.flags() & loader::ElfFields::SectionFlags::ALLOC)) {
+      continue;
+    }
+    if (section.name().data() == MD_NOTES_SECTION) {
+      continue;
+    }
+    if (0 == section.sizeToAlloc()) {
+      continue;
+    }
+    const auto protection = loader::getSectionProtection(section);
+    if (protection & loader::MEM_WRITABLE) {
+      shareable = false;
+    }
+    if (sections.push_back({section.index(), protection, 0})) {
+      return cargo::make_unexpected(mux_error_out_of_memory);
+    }
+  }
+  std::stable_sort(
+      sections.begin(), sections.end(),
+      [](const section_layout_s &lhs, const section_layout_s &rhs) {
+        return getSegmentRank(lhs.protection) < getSegmentRank(rhs.protection);
+      });
+
+  // Lay out the sections, starting a new page at each change of protection.
+  const uint64_t page_size = loader::getPageSize();
+  mux::small_vector<segment_s, 4> segments{allocator};
+  uint64_t offset = 0;
+  for (auto &layout : sections) {
+    const auto section = elf_file.section(layout.section_index);
+    if (segments.empty() || segments.back().protection != layout.protection) {
+      offset = ((offset + page_size - 1) / page_size) * page_size;
+      if (segments.push_back({layout.protection, offset, 0})) {
+        return cargo::make_unexpected(mux_error_out_of_memory);
+      }
+    }
+    const uint64_t alignment = std::max<uint64_t>(section.alignment(), 1);
+    offset = ((offset + alignment - 1) / alignment) * alignment;
+    layout.offset = offset;
+    offset += section.sizeToAlloc();
+    segments.back().size = offset - segments.back().offset;
+  }
+
+  loader::ElfMap elf_map{&elf_file};
+  if (offset > 0) {
+    if (image->pages.allocate(offset)) {
+      return cargo::make_unexpected(mux_error_out_of_memory);
+    }
+    // Advise before the pages are first touched, so they can be faulted in as
+    // huge pages.
+    for (const auto &segment : segments) {
+      if (segment.protection == loader::MEM_CODE &&
+          segment.size >= elf_image_huge_page_threshold) {
+        image->pages.adviseHugePages(segment.offset, segment.size);
+      }
+    }
+  }
+
+  uint8_t *const base = image->pages.data().data();
+  for (auto &section : elf_file.sections()) {
+    if (!(section.flags() & loader::ElfFields::SectionFlags::ALLOC)) {
+      continue;
+    }
+    if (section.name().data() == MD_NOTES_SECTION) {
+      continue;
+    }
+
+    // We map the section whether it has a non-zero size or not, but only
+    // sections with a non-zero size are given space in the image.
+    if (section.sizeToAlloc() > 0) {
+      auto layout = std::find_if(
+          sections.begin(), sections.end(), [&](const section_layout_s &l) {
+            return l.section_index == section.index();
+          });
+      uint8_t *dataptr = base + layout->offset;
+      if (section.type() != loader::ElfFields::SectionType::NOBITS) {
+        std::copy(section.data().begin(), section.data().end(), dataptr);
+      }
+      if (elf_map.addSectionMapping(section, dataptr,
+                                    dataptr + section.sizeToAlloc(),
+                                    reinterpret_cast<uint64_t>(dataptr))) {
+        return cargo::make_unexpected(mux_error_out_of_memory);
+      }
+    } else {
+      if (elf_map.addSectionMapping(section, nullptr, nullptr, 0)) {
+        return cargo::make_unexpected(mux_error_out_of_memory);
+      }
+    }
+  }
+
+  // Populate elf_map with all callbacks so the kernel can call those
+  // functions
+  for (const auto &reloc : utils::getRelocations()) {
+    if (elf_map.addCallback(reloc.first, reloc.second)) {
+      return cargo::make_unexpected(mux_error_out_of_memory);
+    }
+  }
+
+  // If this is failing (especially on Arm32), it may be that a required
+  // callback isn't getting added. See the `elf_map.addCallback()`s above.
+  // Callbacks are resolved in `loader::ElfMap::getSymbolTargetAddress()`.
+  if (!loader::resolveRelocations(elf_file, elf_map)) {
+    return cargo::make_unexpected(mux_error_internal);
+  }
+
+  for (const auto &segment : segments) {
+    if (image->pages.protect(segment.offset, segment.size,
+                             segment.protection)) {
+      return cargo::make_unexpected(mux_error_internal);
+    }
+  }
+
+  for (auto &p : image->kernels) {
+    for (auto &variant : p.second) {
+      auto hook = elf_map.getSymbolTargetAddress(
+          {variant.kernel_name.data(), variant.kernel_name.size()});
+      if (!hook) {
+        return cargo::make_unexpected(mux_error_invalid_binary);
+      }
+      variant.hook = *hook;
+    }
+  }
+
+  if (!shareable) {
+    return std::shared_ptr<const elf_image_s>(std::move(image));
+  }
+
+  const std::lock_guard<std::mutex> lock(cache.mutex);
+  // Another thread may have loaded the same binary in the meantime, in which
+  // case use its image so the code is still only mapped once.
+  if (auto cached = findElfImage(cache, hash, binary, binary_length)) {
+    return cached;
+  }
+  for (auto it = cache.images.begin(); it != cache.images.end();) {
+    it = it->second.expired() ? cache.images.erase(it) : std::next(it);
+  }
+  cache.images.emplace(hash, image);
+  return std::shared_ptr<const elf_image_s>(std::move(image));
+}
+}  // namespace host
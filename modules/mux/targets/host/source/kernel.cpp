@@ -79,9 +79,12 @@ kernel_s::kernel_s(mux_device_t device, mux_allocator_info_t allocator_info,
   this->device = device;
   // Just select the maximum local memory size across each variant.
   local_memory_size = 0;
+  may_access_memory_indirectly = false;
   for (unsigned i = 0, e = variant_data.size(); i != e; i++) {
     local_memory_size =
         std::max(local_memory_size, variant_data[i].local_memory_used);
+    may_access_memory_indirectly |=
+        variant_data[i].may_access_memory_indirectly;
   }
   setPreferredSizes(*this);
 }
@@ -136,11 +139,13 @@ mux_result_t hostCreateKernel(mux_device_t device, mux_executable_t executable,
   cargo::small_vector<host::kernel_variant_s, 4> variants;
 
   for (const auto &v : entry->second) {
-    auto err = variants.emplace_back(host::kernel_variant_s{
+    host::kernel_variant_s variant{
         std::string(name, name_length),
         reinterpret_cast<host::kernel_variant_s::entry_hook_t>(v.hook),
         v.local_memory_used, v.min_work_width, v.pref_work_width,
-        v.sub_group_size});
+        v.sub_group_size};
+    variant.may_access_memory_indirectly = v.may_access_memory_indirectly;
+    auto err = variants.emplace_back(std::move(variant));
     if (err != cargo::success) {
       return mux_error_out_of_memory;
     }
@@ -183,13 +188,29 @@ static bool isLegalKernelVariant(const host::kernel_variant_s &variant,
 mux_result_t host::kernel_s::getKernelVariantForWGSize(
     size_t local_size_x, size_t local_size_y, size_t local_size_z,
     host::kernel_variant_s *out_variant_data) {
-  (void)local_size_y;
-  (void)local_size_z;
+  return getKernelVariantForNDRange({local_size_x, local_size_y, local_size_z},
+                                    {local_size_x, local_size_y, local_size_z},
+                                    out_variant_data);
+}
+
+mux_result_t host::kernel_s::getKernelVariantForNDRange(
+    const std::array<size_t, 3> &global_size,
+    const std::array<size_t, 3> &local_size,
+    host::kernel_variant_s *out_variant_data) {
+  const size_t local_size_x = local_size[0];
+  // Non-uniform ND ranges end with a smaller work-group, only the x dimension
+  // is vectorized so that is the only one which affects legality.
+  const size_t trailing_size_x = global_size[0] % local_size_x;
   host::kernel_variant_s *best_variant = nullptr;
   for (auto &v : variant_data) {
     // If the local size isn't a multiple of the minimum work width, we must
     // disregard this kernel.
-    if (!isLegalKernelVariant(v, local_size_x, local_size_y, local_size_z)) {
+    if (!isLegalKernelVariant(v, local_size_x, local_size[1], local_size[2])) {
+      continue;
+    }
+    if (trailing_size_x != 0 &&
+        !isLegalKernelVariant(v, trailing_size_x, local_size[1],
+                              local_size[2])) {
       continue;
     }
 
@@ -88,7 +88,8 @@ cargo::optional<kernel_variant_map> readBinaryMetadata(loader::ElfFile *elf,
         static_cast<uint32_t>(md.local_memory_usage),
         md.min_work_item_factor.getFixedValue(),
         md.pref_work_item_factor.getFixedValue(),
-        md.sub_group_size.getFixedValue()};
+        md.sub_group_size.getFixedValue(),
+        md.may_access_memory_indirectly};
     auto it = kernels.find(md.source_name);
     if (it != kernels.end()) {
       it->second.push_back(kernel);
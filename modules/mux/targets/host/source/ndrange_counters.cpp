@@ -0,0 +1,122 @@
+// Copyright (C) Codeplay Software Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+// Exceptions; you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://github.com/codeplaysoftware/oneapi-construction-kit/blob/main/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <host/ndrange_counters.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace {
+const std::array<host::ndrange_counter_s, 5> ndrange_counters = {{
+    {host::ndrange_counter_ndranges, "ndranges",
+     "Number of ND range commands executed.", mux_query_counter_unit_generic,
+     mux_query_counter_result_type_uint64},
+    {host::ndrange_counter_work_groups, "work_groups",
+     "Number of work-groups executed by ND range commands.",
+     mux_query_counter_unit_generic, mux_query_counter_result_type_uint64},
+    {host::ndrange_counter_slowest_slice_time, "slowest_slice_time",
+     "Sum of the slowest slice time of each ND range.",
+     mux_query_counter_unit_nanoseconds, mux_query_counter_result_type_uint64},
+    {host::ndrange_counter_mean_slice_time, "mean_slice_time",
+     "Sum of the mean slice time of each ND range.",
+     mux_query_counter_unit_nanoseconds, mux_query_counter_result_type_uint64},
+    {host::ndrange_counter_slice_imbalance, "slice_imbalance",
+     "Percentage of the slowest slice time the mean slice was idle for.",
+     mux_query_counter_unit_percentage, mux_query_counter_result_type_float64},
+}};
+}  // namespace
+
+namespace host {
+void ndrange_counter_s::populateMuxQueryCounter(
+    mux_query_counter_s *out_query_counter) const {
+  out_query_counter->unit = unit;
+  out_query_counter->storage = storage;
+  out_query_counter->uuid = uuid;
+  // Slice timings are taken by the worker threads, not hardware counters.
+  out_query_counter->hardware_counters = 0;
+}
+
+void ndrange_counter_s::populateMuxQueryCounterDescription(
+    mux_query_counter_description_s *out_description) const {
+  std::strncpy(out_description->name, name, 256);
+  std::strncpy(out_description->category, "ND range", 256);
+  std::strncpy(out_description->description, description, 256);
+}
+
+cargo::array_view<const ndrange_counter_s> getNDRangeCounters() {
+  return ndrange_counters;
+}
+
+bool isNDRangeCounter(uint32_t uuid) {
+  return std::any_of(ndrange_counters.begin(), ndrange_counters.end(),
+                     [uuid](const ndrange_counter_s &counter) {
+                       return counter.uuid == uuid;
+                     });
+}
+
+void ndrange_statistics_s::record(
+    cargo::array_view<const mux_query_slice_duration_result_s> slices) {
+  uint64_t slowest = 0;
+  uint64_t total = 0;
+  uint64_t used = 0;
+  for (const auto &slice : slices) {
+    if (0 == slice.work_groups) {
+      continue;
+    }
+    const uint64_t duration = slice.end - slice.start;
+    slowest = std::max(slowest, duration);
+    total += duration;
+    work_groups += slice.work_groups;
+    used++;
+  }
+  ndranges++;
+  if (used) {
+    slowest_slice_time += slowest;
+    mean_slice_time += total / used;
+  }
+}
+
+mux_query_counter_result_s ndrange_statistics_s::read(uint32_t uuid) const {
+  mux_query_counter_result_s result;
+  switch (uuid) {
+    case ndrange_counter_ndranges:
+      result.uint64 = ndranges;
+      break;
+    case ndrange_counter_work_groups:
+      result.uint64 = work_groups;
+      break;
+    case ndrange_counter_slowest_slice_time:
+      result.uint64 = slowest_slice_time;
+      break;
+    case ndrange_counter_mean_slice_time:
+      result.uint64 = mean_slice_time;
+      break;
+    case ndrange_counter_slice_imbalance:
+      result.float64 = 0.0;
+      if (slowest_slice_time) {
+        const double ratio = static_cast<double>(mean_slice_time) /
+                             static_cast<double>(slowest_slice_time);
+        result.float64 = 100.0 * (1.0 - ratio);
+      }
+      break;
+    default:
+      result.uint64 = 0;
+      break;
+  }
+  return result;
+}
+}  // namespace host
@@ -0,0 +1,130 @@
+// Copyright (C) Codeplay Software Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+// Exceptions; you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://github.com/codeplaysoftware/oneapi-construction-kit/blob/main/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <cargo/small_vector.h>
+#include <host/perf_counter.h>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace {
+/// @brief The hardware events host counts, with the event codes PAPI uses for
+/// the equivalent presets (`PAPI_PRESET_MASK | index`).
+const std::array<host::host_perf_counter, 4> perf_counters = {{
+    {0x8000003b, PERF_COUNT_HW_CPU_CYCLES, "PAPI_TOT_CYC", "Total cycles",
+     mux_query_counter_unit_cycles},
+    {0x80000032, PERF_COUNT_HW_INSTRUCTIONS, "PAPI_TOT_INS",
+     "Instructions completed", mux_query_counter_unit_generic},
+    {0x80000008, PERF_COUNT_HW_CACHE_MISSES, "PAPI_L3_TCM",
+     "Last level cache misses", mux_query_counter_unit_generic},
+    {0x8000002e, PERF_COUNT_HW_BRANCH_MISSES, "PAPI_BR_MSP",
+     "Branch instructions mispredicted", mux_query_counter_unit_generic},
+}};
+}  // namespace
+
+namespace host {
+void host_perf_counter::populateMuxQueryCounter(
+    mux_query_counter_s *out_query_counter) const {
+  out_query_counter->unit = unit;
+  out_query_counter->storage = mux_query_counter_result_type_uint64;
+  out_query_counter->uuid = uuid;
+  out_query_counter->hardware_counters = 1;
+}
+
+void host_perf_counter::populateMuxQueryCounterDescription(
+    mux_query_counter_description_s *out_description) const {
+  std::strncpy(out_description->name, name, 256);
+  std::strncpy(out_description->category, "perf_event", 256);
+  std::strncpy(out_description->description, description, 256);
+}
+
+cargo::expected<cargo::dynamic_array<host_perf_counter>, mux_result_t>
+initPerfCounters() {
+  // Only report the events we can actually open, perf_event_open fails with
+  // EACCES when perf_event_paranoid forbids user space counting, ENOENT when
+  // there is no PMU (common in virtual machines) and ENOSYS under seccomp
+  // filters which block it.
+  cargo::small_vector<host_perf_counter, 4> counter_buffer;
+  for (const auto &counter : perf_counters) {
+    const int fd = openPerfCounter(counter.config, 0);
+    if (fd < 0) {
+      continue;
+    }
+    closePerfCounter(fd);
+    if (counter_buffer.push_back(counter)) {
+      return cargo::make_unexpected(mux_error_out_of_memory);
+    }
+  }
+
+  cargo::dynamic_array<host_perf_counter> out_array;
+  if (out_array.alloc(counter_buffer.size())) {
+    return cargo::make_unexpected(mux_error_out_of_memory);
+  }
+  std::copy_n(counter_buffer.begin(), counter_buffer.size(), out_array.begin());
+  return {std::move(out_array)};
+}
+
+int openPerfCounter(uint64_t config, pid_t thread_id) {
+  perf_event_attr attr;
+  std::memset(&attr, 0, sizeof(attr));
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.size = sizeof(attr);
+  attr.config = config;
+  attr.disabled = 1;
+  // Only count the kernels and runtime, which also keeps the counters usable
+  // at perf_event_paranoid level 2.
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.read_format =
+      PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+  return static_cast<int>(syscall(SYS_perf_event_open, &attr, thread_id, -1,
+                                  -1, PERF_FLAG_FD_CLOEXEC));
+}
+
+void startPerfCounter(int fd) {
+  ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+  ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+}
+
+uint64_t stopPerfCounter(int fd) {
+  ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+  // Laid out as requested by read_format in openPerfCounter.
+  struct {
+    uint64_t value;
+    uint64_t time_enabled;
+    uint64_t time_running;
+  } data;
+  if (read(fd, &data, sizeof(data)) != sizeof(data)) {
+    return 0;
+  }
+  if (data.time_running == 0) {
+    return 0;
+  }
+  if (data.time_running < data.time_enabled) {
+    return static_cast<uint64_t>(static_cast<double>(data.value) *
+                                 static_cast<double>(data.time_enabled) /
+                                 static_cast<double>(data.time_running));
+  }
+  return data.value;
+}
+
+void closePerfCounter(int fd) { close(fd); }
+}  // namespace host
@@ -22,12 +22,52 @@
 #include <papi.h>
 #endif
 
+#ifdef CA_HOST_ENABLE_PERF_COUNTERS
+#include <host/perf_counter.h>
+
+#include <algorithm>
+
+namespace {
+const host::host_perf_counter *findPerfCounter(mux_device_info_t device_info,
+                                               uint32_t uuid) {
+  const auto &perf_counters =
+      static_cast<host::device_info_s *>(device_info)->perf_counters;
+  auto counter = std::find_if(
+      perf_counters.begin(), perf_counters.end(),
+      [uuid](const host::host_perf_counter &c) { return c.uuid == uuid; });
+  return counter != perf_counters.end() ? counter : nullptr;
+}
+}  // namespace
+#endif
+
 cargo::expected<host::query_pool_s *, mux_result_t> host::query_pool_s::create(
     mux_query_type_e query_type, uint32_t query_count, mux::allocator allocator,
     const mux_query_counter_config_t *query_configs, mux_queue_t queue) {
+  // Every counter must either be an ND range counter or, when enabled, a PAPI
+  // or perf_event hardware counter.
+  uint32_t hardware_count = 0;
+  if (query_type == mux_query_type_counter) {
+    for (uint32_t query_index = 0; query_index < query_count; query_index++) {
+      if (!isNDRangeCounter(query_configs[query_index].uuid)) {
+#if defined(CA_HOST_ENABLE_PERF_COUNTERS)
+        if (!findPerfCounter(queue->device->info,
+                             query_configs[query_index].uuid)) {
+          return cargo::make_unexpected(mux_error_invalid_value);
+        }
+#elif !defined(CA_HOST_ENABLE_PAPI_COUNTERS)
+        return cargo::make_unexpected(mux_error_invalid_value);
+#endif
+        hardware_count++;
+      }
+    }
+  }
 #ifdef CA_HOST_ENABLE_PAPI_COUNTERS
   auto host_device = static_cast<host::device_s *>(queue->device);
-  auto thread_count = host_device->thread_pool.initialized_threads;
+  // Pools which only contain ND range counters don't need any event sets.
+  auto thread_count =
+      hardware_count ? host_device->thread_pool.initialized_threads : 0;
+#elif !defined(CA_HOST_ENABLE_PERF_COUNTERS)
+  (void)queue;
 #endif
   // Calculate the result storage offset past the end of the query_pool_s.
   // FIXME: This wastes sizeof(mux_query_duration_result_s) bytes when
@@ -37,6 +77,10 @@ cargo::expected<host::query_pool_s *, mux_result_t> host::query_pool_s::create(
     query_data_offset =
         sizeof(query_pool_s) + sizeof(mux_query_duration_result_s) -
         sizeof(query_pool_s) % sizeof(mux_query_duration_result_s);
+  } else if (query_type == mux_query_type_slice_duration) {
+    query_data_offset =
+        sizeof(query_pool_s) + sizeof(mux_query_slice_duration_result_s) -
+        sizeof(query_pool_s) % sizeof(mux_query_slice_duration_result_s);
 #ifdef CA_HOST_ENABLE_PAPI_COUNTERS
   } else if (query_type == mux_query_type_counter) {
     query_data_offset = sizeof(query_pool_s) + sizeof(host_papi_event_info_s) -
@@ -49,6 +93,9 @@ cargo::expected<host::query_pool_s *, mux_result_t> host::query_pool_s::create(
   if (query_type == mux_query_type_duration) {
     query_size = sizeof(mux_query_duration_result_s) * query_count;
     query_align = alignof(mux_query_duration_result_s);
+  } else if (query_type == mux_query_type_slice_duration) {
+    query_size = sizeof(mux_query_slice_duration_result_s) * query_count;
+    query_align = alignof(mux_query_slice_duration_result_s);
 #ifdef CA_HOST_ENABLE_PAPI_COUNTERS
   } else if (query_type == mux_query_type_counter) {
     query_size = sizeof(host_papi_event_info_s) * thread_count;
@@ -70,6 +117,18 @@ cargo::expected<host::query_pool_s *, mux_result_t> host::query_pool_s::create(
   query_pool->count = query_count;
   query_pool->data = static_cast<uint8_t *>(memory) + query_data_offset;
   query_pool->size = query_size;
+  if (query_type == mux_query_type_counter) {
+    // Keep the counter UUIDs to know where to read each result from.
+    query_pool->counter_uuids = static_cast<uint32_t *>(
+        allocator.alloc(sizeof(uint32_t) * query_count));
+    if (!query_pool->counter_uuids) {
+      allocator.destroy(query_pool);
+      return cargo::make_unexpected(mux_error_out_of_memory);
+    }
+    for (uint32_t query_index = 0; query_index < query_count; query_index++) {
+      query_pool->counter_uuids[query_index] = query_configs[query_index].uuid;
+    }
+  }
 #ifdef CA_HOST_ENABLE_PAPI_COUNTERS
   if (query_type == mux_query_type_counter) {
     // Initialize the query pool's array view.
@@ -79,11 +138,8 @@ cargo::expected<host::query_pool_s *, mux_result_t> host::query_pool_s::create(
         event_info_begin, event_info_begin + thread_count);
     // Create and store a `host_papi_event_info_s` for each worker thread.
     for (size_t thread_index = 0; thread_index < thread_count; thread_index++) {
-      auto thread_id = host_device->thread_pool.pool[thread_index].get_id();
       host_papi_event_info_s event_info = {
-          PAPI_NULL,
-          host_device->thread_pool.thread_ids[thread_id],
-          {},
+          PAPI_NULL, host_device->thread_pool.getThreadId(thread_index), {},
           nullptr};
       // Each `host_papi_event_info_s` wraps a papi event set.
       int papi_result = PAPI_create_eventset(&event_info.papi_event_set);
@@ -100,8 +156,14 @@ cargo::expected<host::query_pool_s *, mux_result_t> host::query_pool_s::create(
       event_info.results = cargo::array_view<host_query_counter_result_s>(
           event_info.result_buffer, event_info.result_buffer + query_count);
 
-      // Add each requested counter to this event set.
+      // Add each requested counter to this event set, the ND range counters
+      // are not PAPI events so their result slots are left unused.
       for (uint32_t query_index = 0; query_index < query_count; query_index++) {
+        if (isNDRangeCounter(query_configs[query_index].uuid)) {
+          event_info.results[query_index].storage =
+              mux_query_counter_result_type_uint64;
+          continue;
+        }
         papi_result = PAPI_add_event(event_info.papi_event_set,
                                      query_configs[query_index].uuid);
         if (papi_result != PAPI_OK) {
@@ -135,6 +197,46 @@ cargo::expected<host::query_pool_s *, mux_result_t> host::query_pool_s::create(
       query_pool->papi_event_infos[thread_index] = std::move(event_info);
     }
   }
+#endif
+#ifdef CA_HOST_ENABLE_PERF_COUNTERS
+  if (query_type == mux_query_type_counter && hardware_count) {
+    // Count on every worker thread, the command buffer is processed on one
+    // worker while ND range slices are spread across all of them.
+    auto &thread_pool =
+        static_cast<host::device_s *>(queue->device)->thread_pool;
+    const size_t thread_count = thread_pool.initialized_threads;
+    const size_t fd_count = thread_count * query_count;
+    query_pool->perf_fds =
+        static_cast<int *>(allocator.alloc(sizeof(int) * fd_count));
+    query_pool->perf_results = static_cast<uint64_t *>(
+        allocator.alloc(sizeof(uint64_t) * fd_count));
+    if (!query_pool->perf_fds || !query_pool->perf_results) {
+      query_pool->freeCounters(allocator);
+      allocator.destroy(query_pool);
+      return cargo::make_unexpected(mux_error_out_of_memory);
+    }
+    std::fill_n(query_pool->perf_fds, fd_count, -1);
+    query_pool->perf_thread_count = thread_count;
+    for (size_t thread_index = 0; thread_index < thread_count; thread_index++) {
+      const pid_t thread_id = thread_pool.getThreadId(thread_index);
+      for (uint32_t query_index = 0; query_index < query_count; query_index++) {
+        auto counter = findPerfCounter(queue->device->info,
+                                       query_configs[query_index].uuid);
+        if (!counter) {
+          continue;
+        }
+        const int fd = host::openPerfCounter(counter->config, thread_id);
+        if (fd < 0) {
+          // perf was available when the device was created, but access to it
+          // has since been restricted.
+          query_pool->freeCounters(allocator);
+          allocator.destroy(query_pool);
+          return cargo::make_unexpected(mux_error_feature_unsupported);
+        }
+        query_pool->perf_fds[thread_index * query_count + query_index] = fd;
+      }
+    }
+  }
 #endif
   // Finally reset the result storage to zeros ready for use.
   query_pool->reset();
@@ -142,9 +244,18 @@ cargo::expected<host::query_pool_s *, mux_result_t> host::query_pool_s::create(
 }
 
 void host::query_pool_s::reset() {
-  if (type == mux_query_type_duration) {
+  if (type == mux_query_type_duration ||
+      type == mux_query_type_slice_duration) {
     std::memset(this->data, 0, this->size);
   }
+  if (type == mux_query_type_counter) {
+    ndrange_statistics.reset();
+#ifdef CA_HOST_ENABLE_PERF_COUNTERS
+    if (perf_results) {
+      std::fill_n(perf_results, perf_thread_count * count, 0);
+    }
+#endif
+  }
 #ifdef CA_HOST_ENABLE_PAPI_COUNTERS
   if (type == mux_query_type_counter) {
     for (auto &event : papi_event_infos) {
@@ -168,6 +279,22 @@ void host::query_pool_s::reset(size_t offset, size_t count) {
                     offset * sizeof(mux_query_duration_result_s),
                 0, count * sizeof(mux_query_duration_result_s));
   }
+  if (type == mux_query_type_slice_duration) {
+    std::memset(static_cast<uint8_t *>(this->data) +
+                    offset * sizeof(mux_query_slice_duration_result_s),
+                0, count * sizeof(mux_query_slice_duration_result_s));
+  }
+  if (type == mux_query_type_counter) {
+    // The ND range statistics are shared by all the counters of the pool.
+    ndrange_statistics.reset();
+#ifdef CA_HOST_ENABLE_PERF_COUNTERS
+    for (size_t thread_index = 0; thread_index < perf_thread_count;
+         thread_index++) {
+      std::fill_n(perf_results + thread_index * this->count + offset, count,
+                  0);
+    }
+#endif
+  }
 #ifdef CA_HOST_ENABLE_PAPI_COUNTERS
   if (type == mux_query_type_counter) {
     for (auto &event : papi_event_infos) {
@@ -181,6 +308,86 @@ void host::query_pool_s::reset(size_t offset, size_t count) {
 #endif
 }
 
+void host::query_pool_s::beginCounters() {
+  ndrange_statistics.reset();
+#ifdef CA_HOST_ENABLE_PAPI_COUNTERS
+  startEvents();
+#endif
+#ifdef CA_HOST_ENABLE_PERF_COUNTERS
+  for (size_t i = 0; i < perf_thread_count * count; i++) {
+    if (perf_fds[i] >= 0) {
+      host::startPerfCounter(perf_fds[i]);
+    }
+  }
+#endif
+}
+
+void host::query_pool_s::endCounters() {
+#ifdef CA_HOST_ENABLE_PAPI_COUNTERS
+  endEvents();
+#endif
+#ifdef CA_HOST_ENABLE_PERF_COUNTERS
+  for (size_t i = 0; i < perf_thread_count * count; i++) {
+    if (perf_fds[i] >= 0) {
+      perf_results[i] = host::stopPerfCounter(perf_fds[i]);
+    }
+  }
+#endif
+}
+
+mux_result_t host::query_pool_s::readCounterResults(void *data, size_t stride,
+                                                    uint32_t query_index,
+                                                    uint32_t query_count) {
+  auto results = static_cast<uint8_t *>(data);
+  for (auto index = query_index; index < query_index + query_count; index++) {
+    mux_query_counter_result_s result;
+    if (isNDRangeCounter(counter_uuids[index])) {
+      result = ndrange_statistics.read(counter_uuids[index]);
+    } else {
+#if defined(CA_HOST_ENABLE_PAPI_COUNTERS)
+      result = readPapiResult(index);
+#elif defined(CA_HOST_ENABLE_PERF_COUNTERS)
+      result.uint64 = readPerfResult(index);
+#else
+      // Only ND range counters can be created without hardware counters.
+      return mux_error_invalid_value;
+#endif
+    }
+    std::memcpy(results, &result, sizeof(mux_query_counter_result_s));
+    results += stride;
+  }
+  return mux_success;
+}
+
+void host::query_pool_s::freeCounters(mux::allocator &allocator) {
+  allocator.free(counter_uuids);
+#ifdef CA_HOST_ENABLE_PAPI_COUNTERS
+  freeEvents(allocator);
+#endif
+#ifdef CA_HOST_ENABLE_PERF_COUNTERS
+  if (perf_fds) {
+    for (size_t i = 0; i < perf_thread_count * count; i++) {
+      if (perf_fds[i] >= 0) {
+        host::closePerfCounter(perf_fds[i]);
+      }
+    }
+  }
+  allocator.free(perf_fds);
+  allocator.free(perf_results);
+#endif
+}
+
+#ifdef CA_HOST_ENABLE_PERF_COUNTERS
+uint64_t host::query_pool_s::readPerfResult(size_t query_index) const {
+  uint64_t result = 0;
+  for (size_t thread_index = 0; thread_index < perf_thread_count;
+       thread_index++) {
+    result += perf_results[thread_index * count + query_index];
+  }
+  return result;
+}
+#endif
+
 #ifdef CA_HOST_ENABLE_PAPI_COUNTERS
 void host::query_pool_s::startEvents() {
   for (const auto &event_info : papi_event_infos) {
@@ -198,26 +405,33 @@ void host::query_pool_s::endEvents() {
   }
   for (auto &event_info : papi_event_infos) {
     PAPI_stop(event_info.papi_event_set, papi_values_out.data());
+    // The values are in the order the events were added, which skips the ND
+    // range counters.
+    size_t value_index = 0;
     for (size_t i = 0; i < event_info.results.size(); i++) {
+      if (isNDRangeCounter(counter_uuids[i])) {
+        continue;
+      }
       auto &result = event_info.results[i];
+      const long long value = papi_values_out[value_index++];
       switch (result.storage) {
         case mux_query_counter_result_type_int32:
-          result.int32 = static_cast<int32_t>(papi_values_out[i]);
+          result.int32 = static_cast<int32_t>(value);
           break;
         case mux_query_counter_result_type_int64:
-          result.int64 = static_cast<int64_t>(papi_values_out[i]);
+          result.int64 = static_cast<int64_t>(value);
           break;
         case mux_query_counter_result_type_uint32:
-          result.uint32 = static_cast<uint32_t>(papi_values_out[i]);
+          result.uint32 = static_cast<uint32_t>(value);
           break;
         case mux_query_counter_result_type_uint64:
-          result.uint64 = static_cast<uint64_t>(papi_values_out[i]);
+          result.uint64 = static_cast<uint64_t>(value);
           break;
         case mux_query_counter_result_type_float32:
-          result.float32 = static_cast<float>(papi_values_out[i]);
+          result.float32 = static_cast<float>(value);
           break;
         case mux_query_counter_result_type_float64:
-          result.float64 = static_cast<double>(papi_values_out[i]);
+          result.float64 = static_cast<double>(value);
           break;
       }
     }
@@ -232,101 +446,116 @@ void host::query_pool_s::freeEvents(mux::allocator &allocator) {
   }
 }
 
-mux_result_t host::query_pool_s::readPapiResults(
-    mux_query_counter_result_s *results, size_t result_count,
+mux_query_counter_result_s host::query_pool_s::readPapiResult(
     size_t query_index) {
-  for (size_t result_index = 0; result_index < result_count; result_index++) {
-    // Before we accumulate the results from all the worker threads, zero out
-    // the output result struct. We can just check the first `event_info`'s
-    // type for the appropriate query index, they should all have the same
-    // storage type for a given index.
-    switch (papi_event_infos[0].results[query_index + result_index].storage) {
+  // Before we accumulate the results from all the worker threads, zero out
+  // the output result struct. We can just check the first `event_info`'s type
+  // for the appropriate query index, they should all have the same storage
+  // type for a given index.
+  mux_query_counter_result_s result_out;
+  switch (papi_event_infos[0].results[query_index].storage) {
+    case mux_query_counter_result_type_int32:
+      result_out.int32 = 0;
+      break;
+    case mux_query_counter_result_type_int64:
+      result_out.int64 = 0;
+      break;
+    case mux_query_counter_result_type_uint32:
+      result_out.uint32 = 0;
+      break;
+    case mux_query_counter_result_type_uint64:
+      result_out.uint64 = 0;
+      break;
+    case mux_query_counter_result_type_float32:
+      result_out.float32 = 0;
+      break;
+    case mux_query_counter_result_type_float64:
+      result_out.float64 = 0;
+      break;
+  }
+
+  // Accumulate the results from each worker thread's event info into the
+  // output result.
+  for (const auto &event_info : papi_event_infos) {
+    auto &result = event_info.results[query_index];
+    switch (result.storage) {
       case mux_query_counter_result_type_int32:
-        results[result_index].int32 = 0;
+        result_out.int32 += result.int32;
         break;
       case mux_query_counter_result_type_int64:
-        results[result_index].int64 = 0;
+        result_out.int64 += result.int64;
         break;
       case mux_query_counter_result_type_uint32:
-        results[result_index].uint32 = 0;
+        result_out.uint32 += result.uint32;
         break;
       case mux_query_counter_result_type_uint64:
-        results[result_index].uint64 = 0;
+        result_out.uint64 += result.uint64;
         break;
       case mux_query_counter_result_type_float32:
-        results[result_index].float32 = 0;
+        result_out.float32 += result.float32;
         break;
       case mux_query_counter_result_type_float64:
-        results[result_index].float64 = 0;
+        result_out.float64 += result.float64;
         break;
     }
-
-    // Accumulate the results from each worker thread's event info into the
-    // output buffer, factoring in the query index we were requested to start
-    // from.
-    for (const auto &event_info : papi_event_infos) {
-      auto &result = event_info.results[query_index + result_index];
-      switch (event_info.results[query_index + result_index].storage) {
-        case mux_query_counter_result_type_int32:
-          results[result_index].int32 += result.int32;
-          break;
-        case mux_query_counter_result_type_int64:
-          results[result_index].int64 += result.int64;
-          break;
-        case mux_query_counter_result_type_uint32:
-          results[result_index].uint32 += result.uint32;
-          break;
-        case mux_query_counter_result_type_uint64:
-          results[result_index].uint64 += result.uint64;
-          break;
-        case mux_query_counter_result_type_float32:
-          results[result_index].float32 += result.float32;
-          break;
-        case mux_query_counter_result_type_float64:
-          results[result_index].float64 += result.float64;
-          break;
-      }
-    }
   }
-  return mux_success;
+  return result_out;
 }
-
 #endif
 
 mux_result_t hostGetSupportedQueryCounters(
     mux_device_t device, mux_queue_type_e queue_type, uint32_t count,
     mux_query_counter_t *out_counters,
     mux_query_counter_description_t *out_descriptions, uint32_t *out_count) {
-#ifdef CA_HOST_ENABLE_PAPI_COUNTERS
+  (void)queue_type;
+  // The ND range counters are always available, followed by any hardware
+  // counters.
+  const auto ndrange_counters = host::getNDRangeCounters();
+#if defined(CA_HOST_ENABLE_PAPI_COUNTERS)
+  auto host_device_info = static_cast<host::device_info_s *>(device->info);
+  const auto &hardware_counters = host_device_info->papi_counters;
+#elif defined(CA_HOST_ENABLE_PERF_COUNTERS)
   auto host_device_info = static_cast<host::device_info_s *>(device->info);
+  const auto &hardware_counters = host_device_info->perf_counters;
+#else
+  (void)device;
+#endif
   if (out_count) {
-    *out_count = static_cast<uint32_t>(host_device_info->papi_counters.size());
+    size_t total = ndrange_counters.size();
+#if defined(CA_HOST_ENABLE_PAPI_COUNTERS) || \
+    defined(CA_HOST_ENABLE_PERF_COUNTERS)
+    total += hardware_counters.size();
+#endif
+    *out_count = static_cast<uint32_t>(total);
   }
 
   // We only need to enter to loop if we have either of the out buffers.
   if (out_counters || out_descriptions) {
     for (uint32_t i = 0; i < count; i++) {
+      if (i < ndrange_counters.size()) {
+        if (out_counters) {
+          ndrange_counters[i].populateMuxQueryCounter(&out_counters[i]);
+        }
+        if (out_descriptions) {
+          ndrange_counters[i].populateMuxQueryCounterDescription(
+              &out_descriptions[i]);
+        }
+        continue;
+      }
+#if defined(CA_HOST_ENABLE_PAPI_COUNTERS) || \
+    defined(CA_HOST_ENABLE_PERF_COUNTERS)
+      const auto &counter = hardware_counters[i - ndrange_counters.size()];
       if (out_counters) {
-        host_device_info->papi_counters[i].populateMuxQueryCounter(
-            &out_counters[i]);
+        counter.populateMuxQueryCounter(&out_counters[i]);
       }
       if (out_descriptions) {
-        host_device_info->papi_counters[i].populateMuxQueryCounterDescription(
-            &out_descriptions[i]);
+        counter.populateMuxQueryCounterDescription(&out_descriptions[i]);
       }
+#endif
     }
   }
 
   return mux_success;
-#else
-  (void)device;
-  (void)queue_type;
-  (void)count;
-  (void)out_counters;
-  (void)out_descriptions;
-  (void)out_count;
-  return mux_error_feature_unsupported;
-#endif
 }
 
 mux_result_t hostCreateQueryPool(
@@ -349,9 +578,7 @@ void hostDestroyQueryPool(mux_queue_t queue, mux_query_pool_t query_pool,
   (void)queue;
   mux::allocator allocator(allocator_info);
   auto host_query_pool = static_cast<host::query_pool_s *>(query_pool);
-#ifdef CA_HOST_ENABLE_PAPI_COUNTERS
-  host_query_pool->freeEvents(allocator);
-#endif
+  host_query_pool->freeCounters(allocator);
   allocator.destroy(host_query_pool);
 }
 
@@ -361,16 +588,10 @@ mux_result_t hostGetQueryCounterRequiredPasses(
     uint32_t *out_pass_count) {
   (void)queue;
   (void)query_counter_configs;
-#ifdef CA_HOST_ENABLE_PAPI_COUNTERS
   for (uint32_t i = 0; i < query_count; i++) {
     out_pass_count[i] = 1;
   }
   return mux_success;
-#else
-  (void)query_count;
-  (void)out_pass_count;
-  return mux_error_feature_unsupported;
-#endif
 }
 
 mux_result_t hostGetQueryPoolResults(mux_queue_t queue,
@@ -390,14 +611,19 @@ mux_result_t hostGetQueryPoolResults(mux_queue_t queue,
     }
     return mux_success;
   }
+  if (host_query_pool->type == mux_query_type_slice_duration) {
+    auto results = static_cast<uint8_t *>(data);
+
+    for (const auto &result :
+         host_query_pool->getSliceDurationQueriesAt(query_index, query_count)) {
+      std::memcpy(results, &result, sizeof(mux_query_slice_duration_result_s));
+      results += stride;
+    }
+    return mux_success;
+  }
   if (host_query_pool->type == mux_query_type_counter) {
-#ifdef CA_HOST_ENABLE_PAPI_COUNTERS
-    return host_query_pool->readPapiResults(
-        static_cast<mux_query_counter_result_s *>(data), query_count,
-        query_index);
-#else
-    return mux_error_feature_unsupported;
-#endif
+    return host_query_pool->readCounterResults(data, stride, query_index,
+                                               query_count);
   }
   // We somehow got passed a query pool with an invalid type.
   return mux_error_invalid_value;
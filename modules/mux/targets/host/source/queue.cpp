@@ -32,6 +32,8 @@
 #include <libimg/host.h>
 #endif
 
+#include <algorithm>
+#include <array>
 #include <cassert>
 #include <cstring>
 #include <memory>
@@ -230,47 +232,119 @@ void commandCopyBufferToImage(host::command_info_s *info) {
 #endif
 }
 
-void commandNDRange(host::queue_s *queue, host::command_info_s *info) {
-  host::command_info_ndrange_s *const ndrange = &(info->ndrange_command);
+/// @brief Kernel variants of an ND range command and the ND ranges fused into
+/// it, which are executed one after the other within each slice.
+struct ndrange_launch_s {
+  std::array<host::kernel_variant_s, host::max_fused_ndranges> variants;
+  host::command_info_ndrange_s *ndranges[host::max_fused_ndranges];
+  /// @brief Global size of the ND ranges, which all have the same range.
+  std::array<size_t, 3> global_size;
+  /// @brief Tracer flows of the ND range commands, continued by each slice.
+  uint64_t trace_flows[host::max_fused_ndranges];
+  /// @brief Timings of each slice, null unless a slice duration or counter
+  /// query is active.
+  mux_query_slice_duration_result_s *slice_timings;
+  uint32_t count;
+};
+
+/// @brief Number of work-groups the entry hook executes in a slice, see
+/// AddEntryHookPass.
+uint64_t getSliceWorkGroups(const host::schedule_info_s &schedule_info) {
+  uint64_t num_groups[3];
+  for (uint8_t k = 0; k < 3; k++) {
+    num_groups[k] = (schedule_info.global_size[k] +
+                     schedule_info.local_size[k] - 1) /
+                    schedule_info.local_size[k];
+  }
+  const uint64_t slice_size = (num_groups[0] + schedule_info.total_slices) /
+                              schedule_info.total_slices;
+  const uint64_t slice_start = slice_size * schedule_info.slice;
+  const uint64_t slice_end = std::min(num_groups[0], slice_start + slice_size);
+  if (slice_start >= slice_end) {
+    return 0;
+  }
+  return (slice_end - slice_start) * num_groups[1] * num_groups[2];
+}
 
-  auto host_kernel = static_cast<host::kernel_s *>(ndrange->kernel);
+void commandNDRange(
+    host::queue_s *queue, host::command_info_s *info,
+    cargo::array_view<mux_query_slice_duration_result_s> slice_query,
+    host::query_pool_s *counter_query) {
+  host::command_info_ndrange_s *const ndrange = &(info->ndrange_command);
 
   auto host_device = static_cast<host::device_s *>(queue->device);
 
   const size_t slices =
       host_device->thread_pool.num_threads() * slice_multiplier;
 
-  host::kernel_variant_s variant;
-  if (mux_success != host_kernel->getKernelVariantForWGSize(
-                         info->ndrange_command.ndrange_info->local_size[0],
-                         info->ndrange_command.ndrange_info->local_size[1],
-                         info->ndrange_command.ndrange_info->local_size[2],
-                         &variant)) {
-    return;
+  // Fused ND ranges are the commands immediately following this one, see
+  // hostFinalizeCommandBuffer.
+  ndrange_launch_s launch;
+  launch.count = ndrange->fused_count + 1;
+  launch.global_size = ndrange->ndrange_info->global_size;
+  if (ndrange->indirect_buffer) {
+    // Earlier commands have completed by now, so the work-group counts they
+    // wrote can be read.
+    auto *const buffer =
+        static_cast<host::buffer_s *>(ndrange->indirect_buffer);
+    uint32_t num_groups[3];
+    std::memcpy(num_groups,
+                static_cast<uint8_t *>(buffer->data) + ndrange->indirect_offset,
+                sizeof(num_groups));
+    for (size_t k = 0; k < ndrange->ndrange_info->dimensions; k++) {
+      launch.global_size[k] =
+          num_groups[k] * ndrange->ndrange_info->local_size[k];
+    }
+  }
+  for (uint32_t i = 0; i < launch.count; i++) {
+    launch.ndranges[i] = &(info[i].ndrange_command);
+    launch.trace_flows[i] = info[i].trace_flow;
+    auto host_kernel =
+        static_cast<host::kernel_s *>(launch.ndranges[i]->kernel);
+    const auto *const ndrange_info = launch.ndranges[i]->ndrange_info;
+    if (mux_success != host_kernel->getKernelVariantForNDRange(
+                           launch.global_size, ndrange_info->local_size,
+                           &launch.variants[i])) {
+      return;
+    }
   }
 
   constexpr size_t signal_count =
       host::thread_pool_s::max_num_threads * slice_multiplier;
+  // Only pay for the timestamps when somebody is going to look at them.
+  std::array<mux_query_slice_duration_result_s, signal_count> slice_timings;
+  launch.slice_timings = nullptr;
+  if (!slice_query.empty() || counter_query) {
+    std::fill_n(slice_timings.begin(), slices,
+                mux_query_slice_duration_result_s{});
+    launch.slice_timings = slice_timings.data();
+  }
   std::array<std::atomic<bool>, signal_count> signals;
   std::atomic<uint32_t> queued(0);
   host_device->thread_pool.enqueue_range(
       [](void *const in, void *const info, void *fence, size_t index) {
-        auto *const kernel_variant = static_cast<host::kernel_variant_s *>(in);
+        const tracer::TraceGuard<tracer::Impl> traceGuard("ndrange slice");
+        auto *const launch = static_cast<ndrange_launch_s *>(in);
         auto *const ndrange = static_cast<host::command_info_ndrange_s *>(info);
+        for (uint32_t i = 0; i < launch->count; i++) {
+          tracer::recordFlow<tracer::Impl>("command", launch->trace_flows[i],
+                                           tracer::FlowPhase::Step);
+        }
         auto *const ndrange_info = ndrange->ndrange_info;
         auto host_device =
             static_cast<host::device_s *>(ndrange->kernel->device);
 
         for (uint8_t k = 0; k < ndrange_info->dimensions; ++k) {
-          if (ndrange_info->global_size[k] == 0) {
+          if (launch->global_size[k] == 0) {
             return;
           }
         }
 
+        // Fused ND ranges all have the same range, so share the schedule.
         host::schedule_info_s schedule_info;
 
         for (uint8_t k = 0; k < 3; k++) {
-          schedule_info.global_size[k] = ndrange_info->global_size[k];
+          schedule_info.global_size[k] = launch->global_size[k];
           schedule_info.global_offset[k] = ndrange_info->global_offset[k];
           schedule_info.local_size[k] = ndrange_info->local_size[k];
         }
@@ -280,9 +354,23 @@ void commandNDRange(host::queue_s *queue, host::command_info_s *info) {
         schedule_info.work_dim =
             static_cast<uint32_t>(ndrange_info->dimensions);
 
-        kernel_variant->hook(ndrange_info->packed_args, &schedule_info);
+        uint64_t start = 0;
+        if (launch->slice_timings) {
+          start = utils::timestampNanoSeconds();
+        }
+
+        for (uint32_t i = 0; i < launch->count; i++) {
+          void *const packed_args =
+              launch->ndranges[i]->ndrange_info->packed_args;
+          launch->variants[i].hook(packed_args, &schedule_info);
+        }
+
+        if (launch->slice_timings) {
+          launch->slice_timings[index] = {start, utils::timestampNanoSeconds(),
+                                          getSliceWorkGroups(schedule_info)};
+        }
       },
-      &variant, ndrange, signals, &queued, slices);
+      &launch, ndrange, signals, &queued, slices);
 
   // Ensure all threads to be done with 'queued' by the time it gets destroyed.
   host_device->thread_pool.wait(&queued);
@@ -304,6 +392,25 @@ void commandNDRange(host::queue_s *queue, host::command_info_s *info) {
   // investigation is required on this to get rid of the inneficiency of the
   // extra atomic synchronisation used to guarantee the thread-safety here.
   assert(0 == queued);
+
+  if (launch.slice_timings) {
+    // Slots past the number of slices are zeroed so results of a previous ND
+    // range with more slices aren't mistaken for this one's.
+    for (size_t i = 0; i < slice_query.size(); i++) {
+      slice_query[i] = i < slices ? slice_timings[i]
+                                  : mux_query_slice_duration_result_s{};
+    }
+    if (counter_query) {
+      counter_query->recordNDRange({slice_timings.data(), slices});
+    }
+  }
+
+  // The flow of this command ends in threadPoolProcessCommands, but the fused
+  // commands are skipped there.
+  for (uint32_t i = 1; i < launch.count; i++) {
+    tracer::recordFlow<tracer::Impl>("command", launch.trace_flows[i],
+                                     tracer::FlowPhase::End);
+  }
 }
 
 void commandUserCallback(host::queue_s *queue, host::command_info_s *info,
@@ -339,20 +446,28 @@ void commandUserCallback(host::queue_s *queue, host::command_info_s *info,
   return duration_query;
 }
 
-#ifdef CA_HOST_ENABLE_PAPI_COUNTERS
-void commandBeginQuery(host::command_info_s *info) {
+[[nodiscard]] cargo::array_view<mux_query_slice_duration_result_s>
+commandBeginSliceQuery(host::command_info_s *info) {
+  host::command_info_begin_query_s *const begin_query =
+      &(info->begin_query_command);
+  return static_cast<host::query_pool_s *>(begin_query->pool)
+      ->getSliceDurationQueriesAt(begin_query->index, begin_query->count);
+}
+
+[[nodiscard]] host::query_pool_s *commandBeginCounterQuery(
+    host::command_info_s *info) {
   host::command_info_begin_query_s *const begin_query =
       &(info->begin_query_command);
   auto query_pool = static_cast<host::query_pool_s *>(begin_query->pool);
-  query_pool->startEvents();
+  query_pool->beginCounters();
+  return query_pool;
 }
 
-void commandEndQuery(host::command_info_s *info) {
+void commandEndCounterQuery(host::command_info_s *info) {
   host::command_info_end_query_s *const end_query = &(info->end_query_command);
   auto query_pool = static_cast<host::query_pool_s *>(end_query->pool);
-  query_pool->endEvents();
+  query_pool->endCounters();
 }
-#endif
 
 void commandResetQueryPool(host::command_info_s *info) {
   host::command_info_reset_query_pool_s *const reset_query_pool =
@@ -361,6 +476,45 @@ void commandResetQueryPool(host::command_info_s *info) {
   query_pool->reset(reset_query_pool->index, reset_query_pool->count);
 }
 
+/// @brief Name of a command type as it appears in traces.
+const char *getCommandName(host::command_type_e type) {
+  switch (type) {
+    case host::command_type_read_buffer:
+      return "read buffer";
+    case host::command_type_write_buffer:
+      return "write buffer";
+    case host::command_type_copy_buffer:
+      return "copy buffer";
+    case host::command_type_fill_buffer:
+      return "fill buffer";
+    case host::command_type_read_image:
+      return "read image";
+    case host::command_type_write_image:
+      return "write image";
+    case host::command_type_fill_image:
+      return "fill image";
+    case host::command_type_copy_image:
+      return "copy image";
+    case host::command_type_copy_image_to_buffer:
+      return "copy image to buffer";
+    case host::command_type_copy_buffer_to_image:
+      return "copy buffer to image";
+    case host::command_type_ndrange:
+      return "ndrange";
+    case host::command_type_user_callback:
+      return "user callback";
+    case host::command_type_begin_query:
+      return "begin query";
+    case host::command_type_end_query:
+      return "end query";
+    case host::command_type_reset_query_pool:
+      return "reset query pool";
+    case host::command_type_terminate:
+      return "terminate";
+  }
+  return "unknown";
+}
+
 void threadPoolProcessCommands(void *const v_queue,
                                void *const v_command_buffer,
                                void *const v_fence, size_t) {
@@ -368,10 +522,18 @@ void threadPoolProcessCommands(void *const v_queue,
   auto command_buffer = static_cast<host::command_buffer_s *>(v_command_buffer);
 
   mux_query_duration_result_t duration_query = nullptr;
+  cargo::array_view<mux_query_slice_duration_result_s> slice_query;
+  host::query_pool_s *counter_query = nullptr;
 
   for (uint64_t i = 0, e = command_buffer->commands.size(); i < e; i++) {
     host::command_info_s *const info = &(command_buffer->commands[i]);
 
+    // Continue the flow from the API call which recorded the command.
+    const tracer::TraceGuard<tracer::Impl> traceGuard(
+        getCommandName(info->type));
+    tracer::recordFlow<tracer::Impl>("command", info->trace_flow,
+                                     tracer::FlowPhase::Step);
+
     uint64_t start = 0;
     if (duration_query) {
       start = utils::timestampNanoSeconds();
@@ -411,7 +573,9 @@ void threadPoolProcessCommands(void *const v_queue,
         commandCopyBufferToImage(info);
         break;
       case host::command_type_ndrange:
-        commandNDRange(queue, info);
+        commandNDRange(queue, info, slice_query, counter_query);
+        // Skip the ND ranges that were executed as part of this one.
+        i += info->ndrange_command.fused_count;
         break;
       case host::command_type_user_callback:
         commandUserCallback(queue, info, command_buffer);
@@ -420,27 +584,35 @@ void threadPoolProcessCommands(void *const v_queue,
         if (info->end_query_command.pool->type == mux_query_type_duration) {
           duration_query = commandBeginQuery(info, duration_query);
         }
-#ifdef CA_HOST_ENABLE_PAPI_COUNTERS
-        if (info->end_query_command.pool->type == mux_query_type_counter) {
-          commandBeginQuery(info);
+        if (info->begin_query_command.pool->type ==
+            mux_query_type_slice_duration) {
+          slice_query = commandBeginSliceQuery(info);
+        }
+        if (info->begin_query_command.pool->type == mux_query_type_counter) {
+          counter_query = commandBeginCounterQuery(info);
         }
-#endif
         break;
       case host::command_type_end_query:
         if (info->end_query_command.pool->type == mux_query_type_duration) {
           duration_query = commandEndQuery(info, duration_query);
         }
-#ifdef CA_HOST_ENABLE_PAPI_COUNTERS
+        if (info->end_query_command.pool->type ==
+            mux_query_type_slice_duration) {
+          slice_query = {};
+        }
         if (info->end_query_command.pool->type == mux_query_type_counter) {
-          commandEndQuery(info);
+          commandEndCounterQuery(info);
+          counter_query = nullptr;
         }
-#endif
         break;
       case host::command_type_reset_query_pool:
         commandResetQueryPool(info);
         break;
     }
 
+    tracer::recordFlow<tracer::Impl>("command", info->trace_flow,
+                                     tracer::FlowPhase::End);
+
     if (duration_query) {
       auto end = utils::timestampNanoSeconds();
       duration_query->start = start;
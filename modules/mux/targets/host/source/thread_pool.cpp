@@ -63,7 +63,8 @@ void threadFuncBody(host::thread_pool_s *const me,
 
 /// The function for each cargo::thread to call.
 void threadFunc(host::thread_pool_s *const me) {
-#ifdef CA_HOST_ENABLE_PAPI_COUNTERS
+#if defined(CA_HOST_ENABLE_PAPI_COUNTERS) || \
+    defined(CA_HOST_ENABLE_PERF_COUNTERS)
   me->registerPid();
 #endif
   host::thread_pool_work_item_s item;
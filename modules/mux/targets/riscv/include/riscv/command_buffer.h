@@ -62,6 +62,9 @@ struct command_read_buffer_s {
   uint64_t size;
 
   void operator()(riscv::device_s *device, bool &error);
+
+  /// @brief Submit the read to the HAL without waiting for it to complete.
+  [[nodiscard]] hal::hal_event_t submit(riscv::device_s *device);
 };
 
 struct command_write_buffer_s {
@@ -71,6 +74,9 @@ struct command_write_buffer_s {
   uint64_t size;
 
   void operator()(riscv::device_s *device, bool &error);
+
+  /// @brief Submit the write to the HAL without waiting for it to complete.
+  [[nodiscard]] hal::hal_event_t submit(riscv::device_s *device);
 };
 
 struct command_copy_buffer_s {
@@ -105,6 +111,23 @@ struct command_ndrange_s {
   size_t dimensions;
 
   void operator()(riscv::queue_s *queue, bool &error);
+
+  /// @brief Submit the kernel to the HAL without waiting for it to complete.
+  ///
+  /// On success the kernel's program stays pinned in the program cache until
+  /// released by the caller once the event has been waited on.
+  ///
+  /// @param[in] queue Queue the kernel is executed on.
+  /// @param[out] hal_ndrange Storage for the ND range passed to the HAL, must
+  /// remain valid until the returned event has been waited on.
+  [[nodiscard]] hal::hal_event_t submit(riscv::queue_s *queue,
+                                        hal::hal_ndrange_t &hal_ndrange);
+
+  /// @brief Select the kernel variant to run and find it in its loaded
+  /// program, pinning the program in the program cache.
+  [[nodiscard]] bool prepare(riscv::device_s *device,
+                             program_cache_s::entry_point_s &entry_point,
+                             hal::hal_ndrange_t &hal_ndrange);
 };
 
 struct command_user_callback_s {
@@ -21,6 +21,7 @@
 #define RISCV_DEVICE_H_INCLUDED
 
 #include "mux/hal/device.h"
+#include "riscv/program_cache.h"
 #include "riscv/queue.h"
 #include "riscv/riscv.h"
 
@@ -37,6 +38,9 @@ struct device_s final : mux::hal::device {
 
   /// @brief Riscv's single queue for command execution.
   riscv::queue_s queue;
+
+  /// @brief Programs kept loaded on the HAL device between kernel launches.
+  riscv::program_cache_s program_cache;
 };
 /// @}
 }  // namespace riscv
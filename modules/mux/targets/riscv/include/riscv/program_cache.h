@@ -0,0 +1,143 @@
+// Copyright (C) Codeplay Software Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+// Exceptions; you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://github.com/codeplaysoftware/oneapi-construction-kit/blob/main/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+/// @file
+///
+/// @brief Cache of programs resident on a RISC-V HAL device.
+
+#ifndef RISCV_PROGRAM_CACHE_H_INCLUDED
+#define RISCV_PROGRAM_CACHE_H_INCLUDED
+
+#include <string>
+#include <utility>
+
+#include "cargo/array_view.h"
+#include "cargo/expected.h"
+#include "cargo/mutex.h"
+#include "cargo/small_vector.h"
+#include "cargo/string_view.h"
+#include "hal.h"
+#include "mux/mux.h"
+
+namespace riscv {
+/// @addtogroup riscv
+/// @{
+
+/// @brief Keeps programs loaded on a HAL device between kernel launches.
+///
+/// Loading and relocating an ELF with `program_load` is expensive compared to
+/// short running kernels, so rather than loading and freeing the program
+/// around every ND range the cache keeps programs resident, keyed by the
+/// executable object code they were loaded from, along with the kernel
+/// handles resolved from them. Programs are evicted in least recently used
+/// order once the total size of resident object code would exceed the
+/// capacity, and must be explicitly evicted when their executable is
+/// destroyed. Programs are pinned while a kernel from them may be executing,
+/// pinned programs are never evicted to make room so the capacity may be
+/// exceeded until they are released.
+///
+/// Only the `hal::hal_device_t` interface is used, so the cache can be
+/// exercised in isolation with a mock HAL device.
+class program_cache_s {
+ public:
+  /// @brief A program and kernel handle pair ready for `kernel_exec`.
+  struct entry_point_s {
+    hal::hal_program_t program;
+    hal::hal_kernel_t kernel;
+  };
+
+  /// @brief Construct an empty cache.
+  ///
+  /// @param[in] capacity Maximum number of bytes of object code to keep
+  /// resident, zero means unbounded.
+  explicit program_cache_s(uint64_t capacity = 0) : capacity(capacity) {}
+
+  program_cache_s(const program_cache_s &) = delete;
+  program_cache_s &operator=(const program_cache_s &) = delete;
+
+  /// @brief Set the maximum number of bytes of object code to keep resident.
+  ///
+  /// Takes effect on the next call to `acquire`.
+  void setCapacity(uint64_t new_capacity);
+
+  /// @brief Get the program containing a kernel, loading it if required.
+  ///
+  /// On success the program is pinned, `release` must be called with the same
+  /// object code once the kernel has finished executing.
+  ///
+  /// @param[in] hal_device HAL device to load the program on.
+  /// @param[in] object_code ELF object code of the executable, this is also
+  /// used as the key of the cached program.
+  /// @param[in] kernel_name Name of the kernel (variant) to find.
+  ///
+  /// @return Returns the loaded program and kernel, or `mux_error_failure` if
+  /// either could not be loaded or found.
+  cargo::expected<entry_point_s, mux_result_t> acquire(
+      hal::hal_device_t &hal_device, cargo::array_view<uint8_t> object_code,
+      cargo::string_view kernel_name);
+
+  /// @brief Unpin a program previously returned by `acquire`.
+  ///
+  /// @param[in] object_code Object code the program was loaded from.
+  void release(const uint8_t *object_code);
+
+  /// @brief Free the program loaded from some object code, if resident.
+  ///
+  /// Must be called before the object code is freed, as a later allocation
+  /// could otherwise reuse its address and alias the cached program.
+  ///
+  /// @param[in] hal_device HAL device the program was loaded on.
+  /// @param[in] object_code Object code the program was loaded from.
+  void evict(hal::hal_device_t &hal_device, const uint8_t *object_code);
+
+  /// @brief Free all resident programs.
+  ///
+  /// @param[in] hal_device HAL device the programs were loaded on.
+  void clear(hal::hal_device_t &hal_device);
+
+ private:
+  struct entry_s {
+    /// @brief Object code the program was loaded from, used as the key.
+    const uint8_t *object_code;
+    /// @brief Size of the object code, used as an estimate of the device
+    /// memory the program occupies.
+    uint64_t size;
+    /// @brief Handle of the loaded program.
+    hal::hal_program_t program;
+    /// @brief Value of `tick` the last time the program was acquired.
+    uint64_t last_use;
+    /// @brief Number of `acquire` calls not yet matched by `release`.
+    uint32_t pins;
+    /// @brief Kernel handles already resolved in the program.
+    cargo::small_vector<std::pair<std::string, hal::hal_kernel_t>, 4> kernels;
+  };
+
+  /// @brief Free unpinned programs in least recently used order until `size`
+  /// more bytes fit within the capacity.
+  void makeRoom(hal::hal_device_t &hal_device, uint64_t size)
+      CARGO_TS_REQUIRES(mutex);
+
+  cargo::mutex mutex;
+  uint64_t capacity CARGO_TS_GUARDED_BY(mutex);
+  uint64_t resident CARGO_TS_GUARDED_BY(mutex) = 0;
+  uint64_t tick CARGO_TS_GUARDED_BY(mutex) = 0;
+  cargo::small_vector<entry_s, 8> entries CARGO_TS_GUARDED_BY(mutex);
+};
+
+/// @}
+}  // namespace riscv
+
+#endif  // RISCV_PROGRAM_CACHE_H_INCLUDED
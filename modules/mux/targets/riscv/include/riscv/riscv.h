@@ -1077,6 +1077,41 @@ mux_result_t riscvCommandNDRange(mux_command_buffer_t command_buffer,
                                  const mux_sync_point_t *sync_point_wait_list,
                                  mux_sync_point_t *sync_point);
 
+/// @brief Push an N-Dimensional run command whose number of work-groups is read
+/// from a buffer to the command buffer.
+///
+/// The buffer contains three `uint32_t` work-group counts at `offset`, one per
+/// dimension, which are read when the command executes rather than when it is
+/// pushed. The global size of each dimension is its work-group count
+/// multiplied by the local size, counts of dimensions past
+/// `options.dimensions` are ignored. Entry point is optional and must return
+/// mux_error_feature_unsupported if the device doesn't report
+/// `supports_indirect_ndrange`.
+///
+/// @param[in] command_buffer The command buffer to push the N-Dimensional run
+/// command to.
+/// @param[in] kernel The kernel to execute.
+/// @param[in] options The execution options to use during the run command,
+/// `global_size` is ignored and may be null.
+/// @param[in] buffer The buffer containing the number of work-groups to
+/// execute.
+/// @param[in] offset The offset in bytes into the buffer of the work-group
+/// counts, must be a multiple of 4.
+/// @param[in] num_sync_points_in_wait_list Number of items in
+/// sync_point_wait_list.
+/// @param[in] sync_point_wait_list List of sync-points that need to complete
+/// before this command can be executed.
+/// @param[out] sync_point Returns a sync-point identifying this command, which
+/// may be passed as NULL, that other commands in the command-buffer can wait
+/// on.
+///
+/// @return mux_success, or a mux_error_* if an error occurred.
+mux_result_t riscvCommandNDRangeIndirect(
+    mux_command_buffer_t command_buffer, mux_kernel_t kernel,
+    mux_ndrange_options_t options, mux_buffer_t buffer, uint64_t offset,
+    uint32_t num_sync_points_in_wait_list,
+    const mux_sync_point_t *sync_point_wait_list, mux_sync_point_t *sync_point);
+
 /// @brief Update arguments to an N-Dimensional run command within the command
 /// buffer.
 ///
@@ -16,6 +16,9 @@
 
 #include "riscv/command_buffer.h"
 
+#include <algorithm>
+#include <array>
+
 #include "mux/mux.h"
 #include "riscv/fence.h"
 #include "utils/system.h"
@@ -29,6 +32,11 @@ void command_read_buffer_s::operator()(riscv::device_s *device, bool &error) {
   device->profiler.update_counters(*device->hal_device);
 }
 
+hal::hal_event_t command_read_buffer_s::submit(riscv::device_s *device) {
+  return device->hal_device->mem_read_async(host_pointer,
+                                            buffer->targetPtr + offset, size);
+}
+
 void command_write_buffer_s::operator()(riscv::device_s *device, bool &error) {
   if (!device->hal_device->mem_write(buffer->targetPtr + offset, host_pointer,
                                      size)) {
@@ -37,6 +45,11 @@ void command_write_buffer_s::operator()(riscv::device_s *device, bool &error) {
   device->profiler.update_counters(*device->hal_device);
 }
 
+hal::hal_event_t command_write_buffer_s::submit(riscv::device_s *device) {
+  return device->hal_device->mem_write_async(buffer->targetPtr + offset,
+                                             host_pointer, size);
+}
+
 void command_copy_buffer_s::operator()(riscv::device_s *device, bool &error) {
   if (!device->hal_device->mem_copy(dst_buffer->targetPtr + dst_offset,
                                     src_buffer->targetPtr + src_offset, size)) {
@@ -53,52 +66,74 @@ void command_fill_buffer_s::operator()(riscv::device_s *device, bool &error) {
   device->profiler.update_counters(*device->hal_device);
 }
 
-void command_ndrange_s::operator()(riscv::queue_s *queue, bool &error) {
-  auto device = static_cast<riscv::device_s *>(queue->device);
+bool command_ndrange_s::prepare(riscv::device_s *device,
+                                program_cache_s::entry_point_s &entry_point,
+                                hal::hal_ndrange_t &hal_ndrange) {
   hal::hal_device_t *hal_device = device->hal_device;
   assert(kernel && hal_device);
   // ensure the elf file is loaded
   if (kernel->object_code.empty()) {
-    error = true;
-    return;
-  }
-  hal::hal_program_t program = hal_device->program_load(
-      kernel->object_code.data(), kernel->object_code.size());
-  if (program == hal::hal_invalid_program) {
-    error = true;
-    return;
+    return false;
   }
   // decide on which kernel to execute
   mux::hal::kernel_variant_s variant;
   if (mux_success !=
       kernel->getKernelVariantForWGSize(local_size[0], local_size[1],
                                         local_size[2], &variant)) {
-    error = true;
-    return;
+    return false;
   }
-  // find the kernel entry point
-  auto hal_kernel =
-      hal_device->program_find_kernel(program, variant.variant_name.data());
-  if (hal_kernel == hal::hal_invalid_kernel) {
+  // find the kernel entry point, the program stays loaded on the device after
+  // execution so later launches of kernels from the same executable skip
+  // loading it again
+  auto acquired = device->program_cache.acquire(
+      *hal_device, kernel->object_code, variant.variant_name);
+  if (!acquired) {
+    return false;
+  }
+  entry_point = *acquired;
+  // copy across the ndrange to run
+  hal_ndrange = {{global_offset[0], global_offset[1], global_offset[2]},
+                 {global_size[0], global_size[1], global_size[2]},
+                 {local_size[0], local_size[1], local_size[2]}};
+  return true;
+}
+
+void command_ndrange_s::operator()(riscv::queue_s *queue, bool &error) {
+  auto device = static_cast<riscv::device_s *>(queue->device);
+  program_cache_s::entry_point_s entry_point;
+  hal::hal_ndrange_t hal_ndrange;
+  if (!prepare(device, entry_point, hal_ndrange)) {
     error = true;
     return;
   }
-  // copy across the ndrange to run
-  const hal::hal_ndrange_t hal_ndrange = {
-      {global_offset[0], global_offset[1], global_offset[2]},
-      {global_size[0], global_size[1], global_size[2]},
-      {local_size[0], local_size[1], local_size[2]}};
   // execute the kernel
-  bool success =
-      hal_device->kernel_exec(program, hal_kernel, &hal_ndrange, kernel_args,
-                              num_kernel_args, dimensions);
-  hal_device->program_free(program);
-  if (!success) {
+  if (!device->hal_device->kernel_exec(entry_point.program, entry_point.kernel,
+                                       &hal_ndrange, kernel_args,
+                                       num_kernel_args, dimensions)) {
     error = true;
   }
+  device->program_cache.release(kernel->object_code.data());
   device->profiler.update_counters(*device->hal_device, kernel->name.data());
 }
 
+hal::hal_event_t command_ndrange_s::submit(riscv::queue_s *queue,
+                                           hal::hal_ndrange_t &hal_ndrange) {
+  auto device = static_cast<riscv::device_s *>(queue->device);
+  program_cache_s::entry_point_s entry_point;
+  if (!prepare(device, entry_point, hal_ndrange)) {
+    return hal::hal_invalid_event;
+  }
+  // kernel_args point into memory owned by the command buffer, so they stay
+  // valid until the event is waited on
+  const hal::hal_event_t event = device->hal_device->kernel_exec_async(
+      entry_point.program, entry_point.kernel, &hal_ndrange, kernel_args,
+      num_kernel_args, dimensions);
+  if (event == hal::hal_invalid_event) {
+    device->program_cache.release(kernel->object_code.data());
+  }
+  return event;
+}
+
 void command_user_callback_s::operator()(
     riscv::queue_s *queue, riscv::command_buffer_s *command_buffer) {
   user_function(queue, command_buffer, user_data);
@@ -162,11 +197,252 @@ command_buffer_s::~command_buffer_s() {
   riscv::fence_s::destroy(device, fence, mux::allocator(allocator_info));
 }
 
+namespace {
+/// @brief Range of target or host memory accessed by a command.
+struct access_range_s {
+  uint64_t begin;
+  uint64_t end;
+  bool writes;
+};
+
+bool overlaps(const access_range_s &a, const access_range_s &b) {
+  return (a.writes || b.writes) && a.begin < b.end && b.begin < a.end;
+}
+
+/// @brief Calls `f` with each range of target memory a command may access.
+///
+/// Kernels are conservatively assumed to read and write the whole of every
+/// buffer bound to them from the bound offset onwards.
+template <class F>
+void forEachTargetRange(const riscv::command_s &command, F &&f) {
+  switch (command.type) {
+    case riscv::command_type_read_buffer: {
+      const auto &read = command.read_buffer;
+      const uint64_t begin = read.buffer->targetPtr + read.offset;
+      f(access_range_s{begin, begin + read.size, false});
+    } break;
+    case riscv::command_type_write_buffer: {
+      const auto &write = command.write_buffer;
+      const uint64_t begin = write.buffer->targetPtr + write.offset;
+      f(access_range_s{begin, begin + write.size, true});
+    } break;
+    case riscv::command_type_ndrange: {
+      const auto &ndrange = command.ndrange;
+      for (uint32_t i = 0; i < ndrange.num_kernel_args; i++) {
+        const auto &descriptor = ndrange.descriptors[i];
+        if (descriptor.type != mux_descriptor_info_type_buffer) {
+          continue;
+        }
+        auto *buffer =
+            static_cast<riscv::buffer_s *>(descriptor.buffer_descriptor.buffer);
+        f(access_range_s{
+            buffer->targetPtr + descriptor.buffer_descriptor.offset,
+            buffer->targetPtr + buffer->memory_requirements.size, true});
+      }
+    } break;
+    default:
+      break;
+  }
+}
+
+/// @brief Returns the range of host memory a command accesses, kernels don't
+/// access host memory so return an empty range.
+access_range_s getHostRange(const riscv::command_s &command) {
+  switch (command.type) {
+    case riscv::command_type_read_buffer: {
+      const auto &read = command.read_buffer;
+      const auto begin = reinterpret_cast<uintptr_t>(read.host_pointer);
+      return {begin, begin + read.size, true};
+    }
+    case riscv::command_type_write_buffer: {
+      const auto &write = command.write_buffer;
+      const auto begin = reinterpret_cast<uintptr_t>(write.host_pointer);
+      return {begin, begin + write.size, false};
+    }
+    default:
+      return {0, 0, false};
+  }
+}
+
+/// @brief Returns true if `later` must not start before `earlier` completes.
+bool hasHazard(const riscv::command_s &earlier, const riscv::command_s &later) {
+  if (overlaps(getHostRange(earlier), getHostRange(later))) {
+    return true;
+  }
+  // Kernels from the same program share its program scope variables, which
+  // aren't bound as arguments so assume any two of them conflict.
+  if (earlier.type == riscv::command_type_ndrange &&
+      later.type == riscv::command_type_ndrange &&
+      earlier.ndrange.kernel->object_code.data() ==
+          later.ndrange.kernel->object_code.data()) {
+    return true;
+  }
+  bool hazard = false;
+  forEachTargetRange(earlier, [&](const access_range_s &a) {
+    forEachTargetRange(later, [&](const access_range_s &b) {
+      hazard |= overlaps(a, b);
+    });
+  });
+  return hazard;
+}
+
+/// @brief Overlaps buffer transfers with kernel execution on HAL devices that
+/// support asynchronous operations.
+///
+/// Up to `max_in_flight` reads, writes and kernels are submitted before the
+/// oldest is waited on, so a transfer can proceed while the previous kernel is
+/// still running. A command is only submitted once every in flight command it
+/// conflicts with has completed, other commands must call `drain` first and
+/// run synchronously. Outstanding events are waited on when the pipeline is
+/// destroyed so that early returns never leak events. Each in flight kernel
+/// keeps its program pinned in the program cache, and its ND range in a slot
+/// of the pipeline, until it has been waited on.
+class pipeline_s {
+ public:
+  /// @brief Double buffer, one command executing while the next transfers.
+  static constexpr size_t max_in_flight = 2;
+
+  explicit pipeline_s(riscv::queue_s *queue)
+      : queue(queue),
+        device(static_cast<riscv::device_s *>(queue->device)),
+        enabled(device->hal_device->async_supported()) {}
+
+  pipeline_s(const pipeline_s &) = delete;
+  pipeline_s &operator=(const pipeline_s &) = delete;
+
+  ~pipeline_s() { (void)drain(); }
+
+  /// @brief Returns true if a command may be submitted to the pipeline.
+  bool accepts(const riscv::command_s &command) const {
+    if (!enabled) {
+      return false;
+    }
+    switch (command.type) {
+      case riscv::command_type_read_buffer:
+      case riscv::command_type_write_buffer:
+      case riscv::command_type_ndrange:
+        return true;
+      default:
+        return false;
+    }
+  }
+
+  /// @brief Submit a command once its dependencies have completed.
+  ///
+  /// @return Returns `false` if the command or a command it waited on failed.
+  [[nodiscard]] bool submit(riscv::command_s &command) {
+    bool success = true;
+    // Commands are retired in submission order, so waiting on the youngest
+    // conflicting command also waits on everything submitted before it, which
+    // means retiring the `i + 1` oldest commands.
+    for (size_t i = num_in_flight; i-- > 0;) {
+      if (hasHazard(*inFlight(i).command, command)) {
+        for (size_t retired = 0; retired <= i; retired++) {
+          success &= retire();
+        }
+        break;
+      }
+    }
+    if (num_in_flight == max_in_flight) {
+      success &= retire();
+    }
+    if (!success) {
+      return false;
+    }
+
+    in_flight_s &slot = inFlight(num_in_flight);
+    hal::hal_event_t event = hal::hal_invalid_event;
+    switch (command.type) {
+      case riscv::command_type_read_buffer:
+        event = command.read_buffer.submit(device);
+        break;
+      case riscv::command_type_write_buffer:
+        event = command.write_buffer.submit(device);
+        break;
+      case riscv::command_type_ndrange:
+        event = command.ndrange.submit(queue, slot.ndrange);
+        break;
+      default:
+        break;
+    }
+    if (event == hal::hal_invalid_event) {
+      return false;
+    }
+    slot.command = &command;
+    slot.event = event;
+    num_in_flight++;
+    return true;
+  }
+
+  /// @brief Wait for all in flight commands to complete.
+  ///
+  /// @return Returns `false` if any of the commands failed.
+  [[nodiscard]] bool drain() {
+    bool success = true;
+    while (num_in_flight) {
+      success &= retire();
+    }
+    return success;
+  }
+
+ private:
+  struct in_flight_s {
+    const riscv::command_s *command;
+    hal::hal_event_t event;
+    /// @brief ND range of a kernel, the HAL may read it until the event has
+    /// completed so slots are never moved while in flight.
+    hal::hal_ndrange_t ndrange;
+  };
+
+  /// @brief Returns the slot of the `i`th oldest in flight command.
+  in_flight_s &inFlight(size_t i) {
+    return slots[(oldest + i) % max_in_flight];
+  }
+
+  /// @brief Wait for the oldest in flight command to complete.
+  bool retire() {
+    const in_flight_s &slot = inFlight(0);
+    oldest = (oldest + 1) % max_in_flight;
+    num_in_flight--;
+    const bool success = device->hal_device->event_wait(slot.event);
+    if (slot.command->type == riscv::command_type_ndrange) {
+      const auto *kernel = slot.command->ndrange.kernel;
+      device->program_cache.release(kernel->object_code.data());
+      device->profiler.update_counters(*device->hal_device,
+                                       kernel->name.data());
+    } else {
+      device->profiler.update_counters(*device->hal_device);
+    }
+    return success;
+  }
+
+  riscv::queue_s *queue;
+  riscv::device_s *device;
+  bool enabled;
+  std::array<in_flight_s, max_in_flight> slots;
+  size_t oldest = 0;
+  size_t num_in_flight = 0;
+};
+}  // namespace
+
 mux_result_t command_buffer_s::execute(riscv::queue_s *queue) {
   riscv::device_s *riscv_device = static_cast<riscv::device_s *>(device);
   mux_query_duration_result_t duration_query = nullptr;
+  pipeline_s pipeline(queue);
 
   for (riscv::command_s &command : commands) {
+    // Duration queries time each command individually, so only overlap
+    // commands outside of them.
+    if (!duration_query && pipeline.accepts(command)) {
+      if (!pipeline.submit(command)) {
+        return mux_error_fence_failure;
+      }
+      continue;
+    }
+    if (!pipeline.drain()) {
+      return mux_error_fence_failure;
+    }
+
     uint64_t start = 0;
     if (duration_query) {
       start = utils::timestampNanoSeconds();
@@ -218,6 +494,10 @@ mux_result_t command_buffer_s::execute(riscv::queue_s *queue) {
     }
   }
 
+  if (!pipeline.drain()) {
+    return mux_error_fence_failure;
+  }
+
   return mux_success;
 }
 }  // namespace riscv
@@ -873,6 +1153,16 @@ mux_result_t riscvCommandNDRange(mux_command_buffer_t command_buffer,
   return mux_success;
 }
 
+mux_result_t riscvCommandNDRangeIndirect(mux_command_buffer_t, mux_kernel_t,
+                                         mux_ndrange_options_t, mux_buffer_t,
+                                         uint64_t, uint32_t,
+                                         const mux_sync_point_t *,
+                                         mux_sync_point_t *) {
+  // The work-group counts would have to be read back from the device before
+  // the ND range could be submitted to the HAL.
+  return mux_error_feature_unsupported;
+}
+
 mux_result_t riscvUpdateDescriptors(mux_command_buffer_t command_buffer,
                                     mux_command_id_t command_id,
                                     uint64_t num_args, uint64_t *arg_indices,
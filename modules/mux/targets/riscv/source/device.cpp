@@ -58,6 +58,10 @@ mux_result_t riscvCreateDevices(uint64_t devices_length,
     rv_device->hal = hal;
     rv_device->hal_device = hal_device;
     rv_device->profiler.setup_counters(*hal_device);
+    // Bound resident programs to a share of device memory, leaving the rest
+    // for buffers.
+    rv_device->program_cache.setCapacity(
+        hal_device->get_info()->global_memory_avail / 4);
     const char *csv_path = std::getenv("CA_PROFILE_CSV_PATH");
     if (!csv_path) {
       csv_path = "/tmp/riscv.csv";
@@ -74,6 +78,7 @@ void riscvDestroyDevice(mux_device_t device,
   riscv::device_s *riscvDevice = static_cast<riscv::device_s *>(device);
   riscvDevice->profiler.write_summary();
   if (riscvDevice->hal && riscvDevice->hal_device) {
+    riscvDevice->program_cache.clear(*riscvDevice->hal_device);
     riscvDevice->hal->device_delete(riscvDevice->hal_device);
     riscvDevice->hal_device = nullptr;
   }
@@ -153,6 +153,8 @@ device_info_s::device_info_s()
   this->max_hardware_counters = std::numeric_limits<int>::max();
   this->supports_work_group_collectives = true;
   this->supports_generic_address_space = true;
+  this->supports_non_uniform_work_groups = false;
+  this->supports_indirect_ndrange = false;
 
   // A list of sub-group sizes we report. Roughly ordered according to
   // desirability.
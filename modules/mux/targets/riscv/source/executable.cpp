@@ -119,7 +119,12 @@ cargo::expected<riscv::executable_s *, mux_result_t> executable_s::create(
 
 void executable_s::destroy(device_s *device, executable_s *executable,
                            mux::allocator allocator) {
-  (void)device;
+  // The program cache is keyed by object code address, so the program must be
+  // freed before the object code can be reused by another executable.
+  if (device->hal_device) {
+    device->program_cache.evict(*device->hal_device,
+                                executable->object_code.data());
+  }
   allocator.destroy(executable);
 }
 }  // namespace riscv
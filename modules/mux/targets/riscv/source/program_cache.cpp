@@ -0,0 +1,134 @@
+// Copyright (C) Codeplay Software Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+// Exceptions; you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://github.com/codeplaysoftware/oneapi-construction-kit/blob/main/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "riscv/program_cache.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace riscv {
+void program_cache_s::setCapacity(uint64_t new_capacity) {
+  const cargo::lock_guard<cargo::mutex> lock(mutex);
+  capacity = new_capacity;
+}
+
+cargo::expected<program_cache_s::entry_point_s, mux_result_t>
+program_cache_s::acquire(hal::hal_device_t &hal_device,
+                         cargo::array_view<uint8_t> object_code,
+                         cargo::string_view kernel_name) {
+  const cargo::lock_guard<cargo::mutex> lock(mutex);
+  auto entry = std::find_if(entries.begin(), entries.end(),
+                            [&](const entry_s &e) {
+                              return e.object_code == object_code.data();
+                            });
+  if (entry == entries.end()) {
+    const uint64_t size = object_code.size();
+    makeRoom(hal_device, size);
+    const hal::hal_program_t program =
+        hal_device.program_load(object_code.data(), size);
+    if (program == hal::hal_invalid_program) {
+      return cargo::make_unexpected(mux_error_failure);
+    }
+    if (entries.emplace_back(
+            entry_s{object_code.data(), size, program, 0, 0, {}})) {
+      hal_device.program_free(program);
+      return cargo::make_unexpected(mux_error_out_of_memory);
+    }
+    resident += size;
+    entry = entries.end() - 1;
+  }
+  entry->last_use = ++tick;
+
+  auto kernel = std::find_if(
+      entry->kernels.begin(), entry->kernels.end(),
+      [&](const std::pair<std::string, hal::hal_kernel_t> &k) {
+        return kernel_name == cargo::string_view(k.first);
+      });
+  if (kernel != entry->kernels.end()) {
+    entry->pins++;
+    return entry_point_s{entry->program, kernel->second};
+  }
+
+  // The HAL requires a null terminated name.
+  std::string name = cargo::as<std::string>(kernel_name);
+  const hal::hal_kernel_t hal_kernel =
+      hal_device.program_find_kernel(entry->program, name.c_str());
+  if (hal_kernel == hal::hal_invalid_kernel) {
+    return cargo::make_unexpected(mux_error_failure);
+  }
+  // Failing to cache the handle only costs a lookup on the next launch.
+  (void)entry->kernels.emplace_back(std::move(name), hal_kernel);
+  entry->pins++;
+  return entry_point_s{entry->program, hal_kernel};
+}
+
+void program_cache_s::release(const uint8_t *object_code) {
+  const cargo::lock_guard<cargo::mutex> lock(mutex);
+  auto entry = std::find_if(
+      entries.begin(), entries.end(),
+      [&](const entry_s &e) { return e.object_code == object_code; });
+  assert(entry != entries.end() && entry->pins && "program is not pinned");
+  if (entry != entries.end() && entry->pins) {
+    entry->pins--;
+  }
+}
+
+void program_cache_s::evict(hal::hal_device_t &hal_device,
+                            const uint8_t *object_code) {
+  const cargo::lock_guard<cargo::mutex> lock(mutex);
+  auto entry = std::find_if(
+      entries.begin(), entries.end(),
+      [&](const entry_s &e) { return e.object_code == object_code; });
+  if (entry != entries.end()) {
+    assert(!entry->pins && "evicting a program which may be executing");
+    hal_device.program_free(entry->program);
+    resident -= entry->size;
+    entries.erase(entry);
+  }
+}
+
+void program_cache_s::clear(hal::hal_device_t &hal_device) {
+  const cargo::lock_guard<cargo::mutex> lock(mutex);
+  for (auto &entry : entries) {
+    assert(!entry.pins && "freeing a program which may be executing");
+    hal_device.program_free(entry.program);
+  }
+  entries.clear();
+  resident = 0;
+}
+
+void program_cache_s::makeRoom(hal::hal_device_t &hal_device, uint64_t size) {
+  if (0 == capacity) {
+    return;
+  }
+  // A program larger than the capacity is still loaded, it just evicts
+  // everything else that isn't pinned by a kernel in flight.
+  while (resident + size > capacity) {
+    auto lru = entries.end();
+    for (auto it = entries.begin(); it != entries.end(); ++it) {
+      if (!it->pins && (lru == entries.end() || it->last_use < lru->last_use)) {
+        lru = it;
+      }
+    }
+    if (lru == entries.end()) {
+      break;
+    }
+    hal_device.program_free(lru->program);
+    resident -= lru->size;
+    entries.erase(lru);
+  }
+}
+}  // namespace riscv
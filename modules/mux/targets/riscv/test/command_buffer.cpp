@@ -0,0 +1,230 @@
+// Copyright (C) Codeplay Software Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+// Exceptions; you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://github.com/codeplaysoftware/oneapi-construction-kit/blob/main/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "riscv/command_buffer.h"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <string>
+#include <vector>
+
+#include "mock_hal_device.h"
+#include "mux/utils/helpers.h"
+#include "riscv/buffer.h"
+
+namespace {
+/// @brief Executes command buffers on a riscv device backed by an
+/// asynchronous mock HAL device, so kernels stay in flight while later
+/// commands are submitted.
+struct CommandBufferTest : ::testing::Test {
+  CommandBufferTest()
+      : device(nullptr, mux::allocator(allocator_info)),
+        command_buffer(&device, allocator_info, createFence()),
+        kernel_a(createKernel(a)),
+        kernel_b(createKernel(b)) {
+    device.hal_device = &hal_device;
+    hal_device.async = true;
+    buffer_x.targetPtr = 0x1000;
+    buffer_y.targetPtr = 0x2000;
+  }
+
+  ~CommandBufferTest() { device.program_cache.clear(hal_device); }
+
+  mux_fence_t createFence() {
+    auto fence = riscv::fence_s::create<riscv::fence_s>(
+        &device, mux::allocator(allocator_info));
+    return fence ? *fence : nullptr;
+  }
+
+  riscv::kernel_s createKernel(std::array<uint8_t, 64> &object_code) {
+    mux::hal::kernel_variant_s variant;
+    variant.variant_name = "kernel";
+    variant.min_work_width = 1;
+    variant.pref_work_width = 1;
+    cargo::small_vector<mux::hal::kernel_variant_s, 4> variants;
+    EXPECT_EQ(cargo::success, variants.push_back(variant));
+    return riscv::kernel_s(&device, "kernel", object_code,
+                           mux::allocator(allocator_info),
+                           std::move(variants));
+  }
+
+  /// @brief Record a one dimensional ND range of `kernel`, optionally taking
+  /// `buffer` as its only argument.
+  void ndrange(riscv::kernel_s &kernel, size_t global_size,
+               riscv::buffer_s *buffer = nullptr) {
+    riscv::command_ndrange_s ndrange{};
+    ndrange.kernel = &kernel;
+    ndrange.global_size = {global_size, 1, 1};
+    ndrange.global_offset = {0, 0, 0};
+    ndrange.local_size = {1, 1, 1};
+    ndrange.dimensions = 1;
+    if (buffer) {
+      ASSERT_LT(num_args, descriptors.size());
+      mux_descriptor_info_t &descriptor = descriptors[num_args];
+      descriptor.type = mux_descriptor_info_type_buffer;
+      descriptor.buffer_descriptor = {buffer, 0};
+      hal::hal_arg_t &arg = args[num_args];
+      arg.kind = hal::hal_arg_address;
+      arg.space = hal::hal_space_global;
+      arg.size = sizeof(hal::hal_addr_t);
+      arg.address = buffer->targetPtr;
+      ndrange.descriptors = &descriptor;
+      ndrange.kernel_args = &arg;
+      ndrange.num_kernel_args = 1;
+      num_args++;
+    }
+    const cargo::lock_guard<cargo::mutex> lock(command_buffer.mutex);
+    EXPECT_EQ(cargo::success,
+              command_buffer.commands.push_back(riscv::command_s(ndrange)));
+  }
+
+  /// @brief Record a write of `host` to the whole of `buffer`.
+  void writeBuffer(riscv::buffer_s &buffer, std::array<uint8_t, 64> &host) {
+    const riscv::command_write_buffer_s write{&buffer, 0, host.data(),
+                                              host.size()};
+    const cargo::lock_guard<cargo::mutex> lock(command_buffer.mutex);
+    EXPECT_EQ(cargo::success,
+              command_buffer.commands.push_back(riscv::command_s(write)));
+  }
+
+  /// @brief Record a read of the whole of `buffer` to `host`.
+  void readBuffer(riscv::buffer_s &buffer, std::array<uint8_t, 64> &host) {
+    const riscv::command_read_buffer_s read{&buffer, 0, host.data(),
+                                            host.size()};
+    const cargo::lock_guard<cargo::mutex> lock(command_buffer.mutex);
+    EXPECT_EQ(cargo::success,
+              command_buffer.commands.push_back(riscv::command_s(read)));
+  }
+
+  mux_result_t execute() {
+    const cargo::lock_guard<cargo::mutex> lock(command_buffer.mutex);
+    return command_buffer.execute(&device.queue);
+  }
+
+  mux_allocator_info_t allocator_info = {mux::alloc, mux::free, nullptr};
+  mock_hal_device_t hal_device;
+  riscv::device_s device;
+  riscv::command_buffer_s command_buffer;
+  std::array<uint8_t, 64> a = {};
+  std::array<uint8_t, 64> b = {};
+  riscv::kernel_s kernel_a;
+  riscv::kernel_s kernel_b;
+  riscv::buffer_s buffer_x{{64, 16, mux::hal::memory::HEAP_BUFFER}};
+  riscv::buffer_s buffer_y{{64, 16, mux::hal::memory::HEAP_BUFFER}};
+  std::array<uint8_t, 64> host_x = {};
+  std::array<uint8_t, 64> host_y = {};
+  /// @brief Kernel arguments of recorded ND ranges, which the command buffer
+  /// refers to rather than owns.
+  std::array<mux_descriptor_info_t, 4> descriptors = {};
+  std::array<hal::hal_arg_t, 4> args = {};
+  size_t num_args = 0;
+};
+}  // namespace
+
+TEST_F(CommandBufferTest, OverlapKernels) {
+  ndrange(kernel_a, 4);
+  ndrange(kernel_b, 8);
+  ASSERT_EQ(mux_success, execute());
+  EXPECT_EQ(2u, hal_device.num_kernel_exec);
+  EXPECT_EQ(2u, hal_device.max_in_flight);
+  EXPECT_EQ(0u, hal_device.num_nd_range_changed);
+}
+
+TEST_F(CommandBufferTest, EvictWhileInFlight) {
+  // Only one program fits, so loading the second kernel's program would evict
+  // the first while it is still executing if it weren't pinned.
+  device.program_cache.setCapacity(a.size());
+  ndrange(kernel_a, 4);
+  ndrange(kernel_b, 8);
+  ASSERT_EQ(mux_success, execute());
+  EXPECT_EQ(2u, hal_device.num_program_load);
+  EXPECT_EQ(0u, hal_device.num_freed_in_flight);
+  EXPECT_EQ(0u, hal_device.num_nd_range_changed);
+
+  // Nothing is in flight once execution completes, so both programs are
+  // evicted as normal to make room for another.
+  {
+    const cargo::lock_guard<cargo::mutex> lock(command_buffer.mutex);
+    command_buffer.commands.clear();
+  }
+  std::array<uint8_t, 64> c = {};
+  riscv::kernel_s kernel_c = createKernel(c);
+  ndrange(kernel_c, 4);
+  ASSERT_EQ(mux_success, execute());
+  EXPECT_EQ(3u, hal_device.num_program_load);
+  EXPECT_EQ(2u, hal_device.num_program_free);
+  EXPECT_EQ(0u, hal_device.num_freed_in_flight);
+}
+
+TEST_F(CommandBufferTest, SameProgramDoesNotOverlap) {
+  // Kernels from the same program may share program scope variables.
+  ndrange(kernel_a, 4);
+  ndrange(kernel_a, 8);
+  ASSERT_EQ(mux_success, execute());
+  EXPECT_EQ(2u, hal_device.num_kernel_exec);
+  EXPECT_EQ(1u, hal_device.max_in_flight);
+  EXPECT_EQ(0u, hal_device.num_program_conflicts);
+}
+
+TEST_F(CommandBufferTest, KernelWaitsForWrite) {
+  // Read after write, the kernel must not start until its input is written.
+  writeBuffer(buffer_x, host_x);
+  ndrange(kernel_a, 4, &buffer_x);
+  ASSERT_EQ(mux_success, execute());
+  const std::vector<std::string> expected = {
+      "submit write", "complete write", "submit kernel", "complete kernel"};
+  EXPECT_EQ(expected, hal_device.history);
+  EXPECT_EQ(1u, hal_device.max_in_flight);
+}
+
+TEST_F(CommandBufferTest, WriteWaitsForKernel) {
+  // Write after read, the kernel must finish with the buffer before it is
+  // overwritten.
+  ndrange(kernel_a, 4, &buffer_x);
+  writeBuffer(buffer_x, host_x);
+  ASSERT_EQ(mux_success, execute());
+  const std::vector<std::string> expected = {
+      "submit kernel", "complete kernel", "submit write", "complete write"};
+  EXPECT_EQ(expected, hal_device.history);
+  EXPECT_EQ(1u, hal_device.max_in_flight);
+}
+
+TEST_F(CommandBufferTest, ReadWaitsForKernel) {
+  // Read after write, the result is only read back once the kernel is done.
+  ndrange(kernel_a, 4, &buffer_x);
+  readBuffer(buffer_x, host_x);
+  ASSERT_EQ(mux_success, execute());
+  const std::vector<std::string> expected = {
+      "submit kernel", "complete kernel", "submit read", "complete read"};
+  EXPECT_EQ(expected, hal_device.history);
+  EXPECT_EQ(1u, hal_device.max_in_flight);
+}
+
+TEST_F(CommandBufferTest, OverlapTransferWithKernel) {
+  // The write to buffer_y is independent of the first kernel so proceeds while
+  // it runs, but the second kernel reads buffer_y so waits for the write.
+  ndrange(kernel_a, 4, &buffer_x);
+  writeBuffer(buffer_y, host_y);
+  ndrange(kernel_b, 4, &buffer_y);
+  ASSERT_EQ(mux_success, execute());
+  const std::vector<std::string> expected = {
+      "submit kernel",  "submit write",  "complete kernel",
+      "complete write", "submit kernel", "complete kernel"};
+  EXPECT_EQ(expected, hal_device.history);
+  EXPECT_EQ(2u, hal_device.max_in_flight);
+  EXPECT_EQ(0u, hal_device.num_nd_range_changed);
+}
@@ -0,0 +1,90 @@
+// Copyright (C) Codeplay Software Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+// Exceptions; you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://github.com/codeplaysoftware/oneapi-construction-kit/blob/main/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "allocator.h"
+
+namespace {
+struct HalAllocatorTest : ::testing::Test {
+  static constexpr hal::hal_addr_t base = hal::hal_addr_t(1) << 20;
+  static constexpr hal::hal_size_t size = hal::hal_size_t(1) << 20;
+
+  hal::allocator_t allocator{base, size};
+};
+}  // namespace
+
+TEST_F(HalAllocatorTest, WholeHeap) {
+  ASSERT_EQ(base, allocator.alloc(size));
+  EXPECT_EQ(0u, allocator.available());
+  EXPECT_EQ(hal::hal_nullptr, allocator.alloc(1));
+  allocator.free(base);
+  EXPECT_EQ(size, allocator.available());
+  EXPECT_EQ(base, allocator.alloc(size));
+}
+
+TEST_F(HalAllocatorTest, TooLarge) {
+  EXPECT_EQ(hal::hal_nullptr, allocator.alloc(size + 1));
+  EXPECT_EQ(size, allocator.available());
+}
+
+// The only free block is in a size class above that of the request but below
+// the one which fits any alignment padding, so it must be inspected.
+TEST_F(HalAllocatorTest, NearCapacityAligned) {
+  ASSERT_EQ(base, allocator.alloc(size - 32, 64));
+  allocator.free(base);
+  ASSERT_EQ(base, allocator.alloc(size - 4096, 4096));
+  allocator.free(base);
+  EXPECT_EQ(base, allocator.alloc(size - 1, size));
+}
+
+TEST_F(HalAllocatorTest, NearCapacityMisaligned) {
+  const hal::hal_addr_t small = allocator.alloc(16);
+  ASSERT_EQ(base, small);
+  // the free block now starts 16 bytes into the heap, so the first aligned
+  // address is skipped over
+  const hal::hal_addr_t large = allocator.alloc(size - 8192, 4096);
+  ASSERT_EQ(base + 4096, large);
+  EXPECT_EQ(hal::hal_nullptr, allocator.alloc(size - 4096, 4096));
+  allocator.free(large);
+  allocator.free(small);
+  EXPECT_EQ(size, allocator.available());
+}
+
+TEST_F(HalAllocatorTest, AlignmentLargerThanHeap) {
+  EXPECT_EQ(hal::hal_nullptr, allocator.alloc(1, size * 2));
+  EXPECT_EQ(size, allocator.available());
+}
+
+TEST_F(HalAllocatorTest, LargeAlignmentAfterFragmentation) {
+  std::vector<hal::hal_addr_t> blocks;
+  for (hal::hal_addr_t ptr; (ptr = allocator.alloc(1000)) != hal::hal_nullptr;) {
+    blocks.push_back(ptr);
+  }
+  // free every other block, none of which is large enough for the request,
+  // then the blocks between the first 13 to leave one free block which only
+  // fits the request at its aligned start
+  for (size_t i = 0; i < blocks.size(); i += 2) {
+    allocator.free(blocks[i]);
+  }
+  for (size_t i = 1; i < 12; i += 2) {
+    allocator.free(blocks[i]);
+  }
+  EXPECT_EQ(base, allocator.alloc(8192, 8192));
+  EXPECT_EQ(hal::hal_nullptr, allocator.alloc(8192, 8192));
+}
@@ -0,0 +1,208 @@
+// Copyright (C) Codeplay Software Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+// Exceptions; you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://github.com/codeplaysoftware/oneapi-construction-kit/blob/main/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+/// @file
+///
+/// @brief HAL device which records the operations performed on it.
+
+#ifndef RISCV_TEST_MOCK_HAL_DEVICE_H_INCLUDED
+#define RISCV_TEST_MOCK_HAL_DEVICE_H_INCLUDED
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "hal.h"
+
+/// @brief HAL device which only counts calls, no kernels are run and no memory
+/// is allocated.
+///
+/// Every call to `program_load` returns a new program handle, and kernel
+/// handles are assigned per program and name. When `async` is set kernels and
+/// transfers submitted with the `*_async` operations stay in flight until
+/// their event is waited on, at which point the device checks that a kernel's
+/// program is still loaded and its ND range is still readable. Asynchronous
+/// operations are recorded in `history` as they are submitted and completed.
+struct mock_hal_device_t : hal::hal_device_t {
+  mock_hal_device_t() : hal::hal_device_t(nullptr) {}
+
+  hal::hal_kernel_t program_find_kernel(hal::hal_program_t program,
+                                        const char *name) override {
+    num_find_kernel++;
+    if (loaded.count(program) == 0) {
+      return hal::hal_invalid_kernel;
+    }
+    auto &kernel = kernels[{program, name}];
+    if (kernel == hal::hal_invalid_kernel) {
+      kernel = kernels.size();
+    }
+    return kernel;
+  }
+
+  hal::hal_program_t program_load(const void *, hal::hal_size_t) override {
+    num_program_load++;
+    if (fail_program_load) {
+      return hal::hal_invalid_program;
+    }
+    const hal::hal_program_t program = ++last_program;
+    loaded.insert(program);
+    return program;
+  }
+
+  bool kernel_exec(hal::hal_program_t program, hal::hal_kernel_t,
+                   const hal::hal_ndrange_t *, const hal::hal_arg_t *,
+                   uint32_t, uint32_t) override {
+    num_kernel_exec++;
+    return loaded.count(program) != 0;
+  }
+
+  bool program_free(hal::hal_program_t program) override {
+    num_program_free++;
+    return loaded.erase(program) != 0;
+  }
+
+  bool async_supported() const override { return async; }
+
+  hal::hal_event_t kernel_exec_async(hal::hal_program_t program,
+                                     hal::hal_kernel_t kernel,
+                                     const hal::hal_ndrange_t *nd_range,
+                                     const hal::hal_arg_t *args,
+                                     uint32_t num_args,
+                                     uint32_t work_dim) override {
+    if (!async) {
+      return hal::hal_device_t::kernel_exec_async(program, kernel, nd_range,
+                                                  args, num_args, work_dim);
+    }
+    num_kernel_exec++;
+    if (loaded.count(program) == 0) {
+      return hal::hal_invalid_event;
+    }
+    for (auto &pending : in_flight) {
+      if (pending.second.program == program) {
+        num_program_conflicts++;
+      }
+    }
+    return submit({"kernel", program, nd_range, *nd_range});
+  }
+
+  hal::hal_event_t mem_read_async(void *dst, hal::hal_addr_t src,
+                                  hal::hal_size_t size) override {
+    if (!async) {
+      return hal::hal_device_t::mem_read_async(dst, src, size);
+    }
+    return submit({"read", hal::hal_invalid_program, nullptr, {}});
+  }
+
+  hal::hal_event_t mem_write_async(hal::hal_addr_t dst, const void *src,
+                                   hal::hal_size_t size) override {
+    if (!async) {
+      return hal::hal_device_t::mem_write_async(dst, src, size);
+    }
+    return submit({"write", hal::hal_invalid_program, nullptr, {}});
+  }
+
+  bool event_wait(hal::hal_event_t event) override {
+    if (event == hal::hal_completed_event) {
+      return true;
+    }
+    auto pending = in_flight.find(event);
+    if (pending == in_flight.end()) {
+      return false;
+    }
+    const operation_s operation = pending->second;
+    in_flight.erase(pending);
+    history.push_back(std::string("complete ") + operation.name);
+    if (!operation.nd_range) {
+      return true;
+    }
+    if (loaded.count(operation.program) == 0) {
+      num_freed_in_flight++;
+    }
+    if (0 != std::memcmp(operation.nd_range, &operation.submitted,
+                         sizeof(hal::hal_ndrange_t))) {
+      num_nd_range_changed++;
+    }
+    return true;
+  }
+
+  hal::hal_addr_t mem_alloc(hal::hal_size_t, hal::hal_size_t) override {
+    return hal::hal_nullptr;
+  }
+
+  bool mem_free(hal::hal_addr_t) override { return false; }
+
+  bool mem_read(void *, hal::hal_addr_t, hal::hal_size_t) override {
+    return false;
+  }
+
+  bool mem_write(hal::hal_addr_t, const void *, hal::hal_size_t) override {
+    return false;
+  }
+
+  /// @brief Returns true if a program is loaded and has not been freed.
+  bool isLoaded(hal::hal_program_t program) const {
+    return loaded.count(program) != 0;
+  }
+
+  bool async = false;
+  bool fail_program_load = false;
+  unsigned num_program_load = 0;
+  unsigned num_program_free = 0;
+  unsigned num_find_kernel = 0;
+  unsigned num_kernel_exec = 0;
+  /// @brief Kernels submitted while one from the same program was in flight.
+  unsigned num_program_conflicts = 0;
+  /// @brief Kernels whose program was freed before they were waited on.
+  unsigned num_freed_in_flight = 0;
+  /// @brief Kernels whose ND range changed before they were waited on.
+  unsigned num_nd_range_changed = 0;
+  /// @brief Largest number of kernels and transfers in flight at once.
+  size_t max_in_flight = 0;
+  /// @brief Asynchronous operations in the order they were submitted and
+  /// completed, e.g. "submit write" followed by "complete write".
+  std::vector<std::string> history;
+
+ private:
+  struct operation_s {
+    /// @brief One of "kernel", "read" or "write".
+    const char *name;
+    hal::hal_program_t program;
+    /// @brief ND range of a kernel, null for transfers.
+    const hal::hal_ndrange_t *nd_range;
+    hal::hal_ndrange_t submitted;
+  };
+
+  hal::hal_event_t submit(const operation_s &operation) {
+    const hal::hal_event_t event = ++last_event;
+    in_flight[event] = operation;
+    max_in_flight = std::max<size_t>(max_in_flight, in_flight.size());
+    history.push_back(std::string("submit ") + operation.name);
+    return event;
+  }
+
+  hal::hal_program_t last_program = hal::hal_invalid_program;
+  hal::hal_event_t last_event = hal::hal_invalid_event;
+  std::set<hal::hal_program_t> loaded;
+  std::map<hal::hal_event_t, operation_s> in_flight;
+  std::map<std::pair<hal::hal_program_t, std::string>, hal::hal_kernel_t>
+      kernels;
+};
+
+#endif  // RISCV_TEST_MOCK_HAL_DEVICE_H_INCLUDED
@@ -0,0 +1,152 @@
+// Copyright (C) Codeplay Software Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+// Exceptions; you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://github.com/codeplaysoftware/oneapi-construction-kit/blob/main/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "riscv/program_cache.h"
+
+#include <gtest/gtest.h>
+
+#include <array>
+
+#include "mock_hal_device.h"
+
+namespace {
+struct ProgramCacheTest : ::testing::Test {
+  void TearDown() override { cache.clear(device); }
+
+  /// @brief Acquire and release a kernel as a launch would, failing the test
+  /// if it could not be loaded.
+  riscv::program_cache_s::entry_point_s acquire(
+      std::array<uint8_t, 64> &object_code, const char *kernel_name) {
+    auto entry_point = cache.acquire(device, object_code, kernel_name);
+    EXPECT_TRUE(entry_point);
+    if (!entry_point) {
+      return {};
+    }
+    cache.release(object_code.data());
+    return *entry_point;
+  }
+
+  mock_hal_device_t device;
+  riscv::program_cache_s cache;
+  std::array<uint8_t, 64> a = {};
+  std::array<uint8_t, 64> b = {};
+  std::array<uint8_t, 64> c = {};
+};
+}  // namespace
+
+TEST_F(ProgramCacheTest, Hit) {
+  const auto first = acquire(a, "foo");
+  const auto second = acquire(a, "foo");
+  EXPECT_EQ(1u, device.num_program_load);
+  EXPECT_EQ(1u, device.num_find_kernel);
+  EXPECT_EQ(first.program, second.program);
+  EXPECT_EQ(first.kernel, second.kernel);
+  EXPECT_EQ(0u, device.num_program_free);
+}
+
+TEST_F(ProgramCacheTest, HitOtherKernel) {
+  const auto foo = acquire(a, "foo");
+  const auto bar = acquire(a, "bar");
+  EXPECT_EQ(1u, device.num_program_load);
+  EXPECT_EQ(2u, device.num_find_kernel);
+  EXPECT_EQ(foo.program, bar.program);
+  EXPECT_NE(foo.kernel, bar.kernel);
+}
+
+TEST_F(ProgramCacheTest, Miss) {
+  const auto first = acquire(a, "foo");
+  const auto second = acquire(b, "foo");
+  EXPECT_EQ(2u, device.num_program_load);
+  EXPECT_NE(first.program, second.program);
+  EXPECT_TRUE(device.isLoaded(first.program));
+  EXPECT_TRUE(device.isLoaded(second.program));
+}
+
+TEST_F(ProgramCacheTest, MissLoadFails) {
+  device.fail_program_load = true;
+  EXPECT_FALSE(cache.acquire(device, a, "foo"));
+  device.fail_program_load = false;
+  // A failed load must not be cached.
+  acquire(a, "foo");
+  EXPECT_EQ(2u, device.num_program_load);
+}
+
+TEST_F(ProgramCacheTest, EvictLeastRecentlyUsed) {
+  cache.setCapacity(a.size() + b.size());
+  const auto first = acquire(a, "foo");
+  acquire(b, "foo");
+  // Touch the first program so the second is the least recently used.
+  acquire(a, "foo");
+  acquire(c, "foo");
+  EXPECT_EQ(3u, device.num_program_load);
+  EXPECT_EQ(1u, device.num_program_free);
+  EXPECT_TRUE(device.isLoaded(first.program));
+
+  // The first program is still resident, the second must be loaded again.
+  acquire(a, "foo");
+  EXPECT_EQ(3u, device.num_program_load);
+  acquire(b, "foo");
+  EXPECT_EQ(4u, device.num_program_load);
+  EXPECT_EQ(2u, device.num_program_free);
+}
+
+TEST_F(ProgramCacheTest, EvictLargerThanCapacity) {
+  cache.setCapacity(a.size() / 2);
+  acquire(a, "foo");
+  acquire(b, "foo");
+  EXPECT_EQ(2u, device.num_program_load);
+  EXPECT_EQ(1u, device.num_program_free);
+}
+
+TEST_F(ProgramCacheTest, EvictSkipsPinned) {
+  cache.setCapacity(a.size());
+  auto pinned = cache.acquire(device, a, "foo");
+  ASSERT_TRUE(pinned);
+  // The first program may still be executing so it must stay loaded, even
+  // though the capacity is exceeded.
+  acquire(b, "foo");
+  EXPECT_EQ(0u, device.num_program_free);
+  EXPECT_TRUE(device.isLoaded(pinned->program));
+
+  // Once released it is the least recently used program.
+  cache.release(a.data());
+  acquire(c, "foo");
+  EXPECT_EQ(2u, device.num_program_free);
+  EXPECT_FALSE(device.isLoaded(pinned->program));
+}
+
+TEST_F(ProgramCacheTest, Evict) {
+  const auto first = acquire(a, "foo");
+  cache.evict(device, a.data());
+  EXPECT_EQ(1u, device.num_program_free);
+  EXPECT_FALSE(device.isLoaded(first.program));
+  // Evicting object code that isn't resident does nothing.
+  cache.evict(device, a.data());
+  EXPECT_EQ(1u, device.num_program_free);
+
+  acquire(a, "foo");
+  EXPECT_EQ(2u, device.num_program_load);
+  EXPECT_EQ(2u, device.num_find_kernel);
+}
+
+TEST_F(ProgramCacheTest, Clear) {
+  acquire(a, "foo");
+  acquire(b, "foo");
+  cache.clear(device);
+  EXPECT_EQ(2u, device.num_program_free);
+  acquire(a, "foo");
+  EXPECT_EQ(3u, device.num_program_load);
+}
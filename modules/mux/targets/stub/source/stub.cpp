@@ -373,6 +373,15 @@ mux_result_t stubCommandNDRange(mux_command_buffer_t command_buffer,
   return mux_error_feature_unsupported;
 }
 
+mux_result_t stubCommandNDRangeIndirect(
+    mux_command_buffer_t command_buffer, mux_kernel_t kernel,
+    mux_ndrange_options_t options, mux_buffer_t buffer, uint64_t offset,
+    uint32_t num_sync_points_in_wait_list,
+    const mux_sync_point_t *sync_point_wait_list,
+    mux_sync_point_t *sync_point) {
+  return mux_error_feature_unsupported;
+}
+
 mux_result_t stubUpdateDescriptors(mux_command_buffer_t command_buffer,
                                    mux_command_id_t command_id,
                                    uint64_t num_args, uint64_t *arg_indices,
@@ -41,6 +41,25 @@ TEST_P(muxCreateExecutableTest, Default) {
   muxDestroyExecutable(device, executable, allocator);
 }
 
+TEST_P(muxCreateExecutableTest, SameBinary) {
+  // Targets may share the loaded binary between executables, so each must stay
+  // usable after the other is destroyed.
+  mux_executable_t first;
+  ASSERT_SUCCESS(muxCreateExecutable(device, buffer.data(), buffer.size(),
+                                     allocator, &first));
+  mux_executable_t second;
+  ASSERT_SUCCESS(muxCreateExecutable(device, buffer.data(), buffer.size(),
+                                     allocator, &second));
+
+  muxDestroyExecutable(device, first, allocator);
+
+  mux_kernel_t kernel;
+  ASSERT_SUCCESS(muxCreateKernel(device, second, "nop", strlen("nop"),
+                                 allocator, &kernel));
+  muxDestroyKernel(device, kernel, allocator);
+  muxDestroyExecutable(device, second, allocator);
+}
+
 TEST_P(muxCreateExecutableTest, InvalidSource) {
   mux_executable_t executable;
   const uint64_t length = 1;
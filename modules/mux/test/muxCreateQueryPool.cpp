@@ -66,6 +66,28 @@ TEST_P(muxCreateQueryPoolTest, DefaultCounter) {
   }
 }
 
+TEST_P(muxCreateQueryPoolTest, DefaultSliceDuration) {
+  // Slice duration queries are optional, but must be reported as unsupported.
+  mux_query_pool_t query_pool;
+  const mux_result_t error =
+      muxCreateQueryPool(queue, mux_query_type_slice_duration, 4, nullptr,
+                         allocator, &query_pool);
+  if (mux_error_feature_unsupported == error) {
+    GTEST_SKIP();
+  }
+  ASSERT_SUCCESS(error);
+  muxDestroyQueryPool(queue, query_pool, allocator);
+}
+
+TEST_P(muxCreateQueryPoolTest, InvalidSliceDurationConfigs) {
+  const mux_query_counter_config_t query_counter_config = {};
+  mux_query_pool_t query_pool;
+  ASSERT_ERROR_EQ(mux_error_invalid_value,
+                  muxCreateQueryPool(queue, mux_query_type_slice_duration, 1,
+                                     &query_counter_config, allocator,
+                                     &query_pool));
+}
+
 TEST_P(muxCreateQueryPoolTest, InvalidDevice) {
   mux_query_pool_t query_pool;
   ASSERT_ERROR_EQ(mux_error_invalid_value,
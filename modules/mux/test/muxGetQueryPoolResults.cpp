@@ -15,6 +15,7 @@
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
 #include <cstdint>
+#include <cstring>
 
 #include "common.h"
 #include "mux/mux.h"
@@ -624,3 +625,97 @@ TEST_P(muxGetQueryPoolResultsMultipleCountersCounterTest, InvalidQueryCount) {
                              sizeof(mux_query_counter_result_s), results.data(),
                              sizeof(mux_query_counter_result_s)));
 }
+
+// Host reports its Linux perf_event hardware counters in the "perf_event"
+// category, but only the ones the kernel allows the process to open, so this
+// skips on other devices and wherever perf_event is unavailable.
+struct muxGetQueryPoolResultsPerfEventCounterTest
+    : muxGetQueryPoolResultsCounterTest {
+  void SetUp() override {
+    // Don't run `muxGetQueryPoolResultsCounterTest::SetUp` as it records and
+    // dispatches command buffers.
+    RETURN_ON_FATAL_FAILURE(DeviceCompilerTest::SetUp());
+    if (!device->info->query_counter_support) {
+      GTEST_SKIP();
+    }
+
+    ASSERT_SUCCESS(muxGetQueue(device, mux_queue_type_compute, 0, &queue));
+    uint32_t count;
+    ASSERT_SUCCESS(muxGetSupportedQueryCounters(device, mux_queue_type_compute,
+                                                0, nullptr, nullptr, &count));
+    counters.resize(count);
+    descriptions.resize(count);
+    ASSERT_SUCCESS(muxGetSupportedQueryCounters(device, mux_queue_type_compute,
+                                                count, counters.data(),
+                                                descriptions.data(), nullptr));
+
+    std::vector<mux_query_counter_config_t> counters_to_enable;
+    for (size_t i = 0; i < counters.size(); i++) {
+      if (0 == std::strcmp(descriptions[i].category, "perf_event")) {
+        counters_to_enable.push_back({counters[i].uuid, nullptr});
+        descriptions_enabled.push_back(descriptions[i]);
+      }
+    }
+    if (counters_to_enable.empty()) {
+      GTEST_SKIP();
+    }
+    query_count = counters_to_enable.size();
+
+    ASSERT_SUCCESS(muxCreateQueryPool(queue, mux_query_type_counter,
+                                      query_count, counters_to_enable.data(),
+                                      allocator, &query_pool));
+
+    // Create a kernel workload for profiling.
+    const char *nop_opencl_c = "kernel void nop() {}";
+    ASSERT_SUCCESS(createMuxExecutable(nop_opencl_c, &executable));
+    ASSERT_SUCCESS(muxCreateKernel(device, executable, "nop", strlen("nop"),
+                                   allocator, &kernel));
+    const size_t global_offset = 0;
+    const size_t global_size = 8;
+    size_t local_size[3] = {1, 1, 1};
+
+    mux_ndrange_options_t nd_range_options{};
+    std::memcpy(nd_range_options.local_size, local_size, sizeof(local_size));
+    nd_range_options.global_offset = &global_offset;
+    nd_range_options.global_size = &global_size;
+    nd_range_options.dimensions = 1;
+
+    ASSERT_SUCCESS(
+        muxCreateCommandBuffer(device, callback, allocator, &command_buffer));
+    ASSERT_SUCCESS(muxCreateFence(device, allocator, &fence));
+    ASSERT_SUCCESS(muxCommandBeginQuery(command_buffer, query_pool, 0,
+                                        query_count, 0, nullptr, nullptr));
+    ASSERT_SUCCESS(muxCommandNDRange(command_buffer, kernel, nd_range_options,
+                                     0, nullptr, nullptr));
+    ASSERT_SUCCESS(muxCommandEndQuery(command_buffer, query_pool, 0,
+                                      query_count, 0, nullptr, nullptr));
+    ASSERT_SUCCESS(muxDispatch(queue, command_buffer, fence, nullptr, 0,
+                               nullptr, 0, nullptr, nullptr));
+    ASSERT_SUCCESS(muxTryWait(queue, UINT64_MAX, fence));
+  }
+
+  std::vector<mux_query_counter_description_t> descriptions_enabled;
+};
+
+INSTANTIATE_DEVICE_TEST_SUITE_P(muxGetQueryPoolResultsPerfEventCounterTest);
+
+TEST_P(muxGetQueryPoolResultsPerfEventCounterTest, Default) {
+  std::vector<mux_query_counter_result_s> results(query_count);
+
+  ASSERT_SUCCESS(muxGetQueryPoolResults(
+      queue, query_pool, query_index, query_count,
+      sizeof(mux_query_counter_result_s) * results.size(), results.data(),
+      sizeof(mux_query_counter_result_s)));
+  for (size_t i = 0; i < query_count; i++) {
+    const auto *name = descriptions_enabled[i].name;
+    std::cout << "       name: " << name << "\n";
+    std::cout << "      value: " << results[i].uint64 << "\n";
+    // The worker threads run user space code around the ND range while the
+    // counters are enabled, so these can never legitimately read zero. Cache
+    // misses and branch mispredictions can.
+    if (0 == std::strcmp(name, "PAPI_TOT_CYC") ||
+        0 == std::strcmp(name, "PAPI_TOT_INS")) {
+      EXPECT_LT(0u, results[i].uint64) << name;
+    }
+  }
+}
@@ -34,20 +34,63 @@ namespace tracer {
 /// @param end the end timestamp.
 ///
 /// This function is the real meat of tracer - it'll record a trace event to the
-/// .trace file for this execution of the process. The trace produced is
-/// viewable via chrome's tracing mode:
-/// * open chrome and go to chrome://tracing
+/// calling thread's binary event buffer, which is only appended to by that
+/// thread. At process exit the buffers of all threads are written to the file
+/// named by the `CA_TRACE_FILE` environment variable in the Chrome trace event
+/// JSON format, viewable via chrome's tracing mode or Perfetto:
+/// * open chrome and go to chrome://tracing, or open https://ui.perfetto.dev
 /// * open the tracing file
-///   * on Windows these are located at
-///   `%APPDATA%\\.ComputeAortaTracer\\*.trace`
-///   * on Linux these are located at `$HOME/.ComputeAortaTracer/*.trace`
 /// * enjoy the tracing information produced!
+///
+/// `name` and `cat` are interned, so need only be valid during the call.
 void recordTrace(const char *name, const char *cat, uint64_t start,
                  uint64_t end);
 
 /// @return Returns the current time stamp in Microseconds.
 uint64_t getCurrentTimestamp();
 
+/// @brief Phase of a flow event.
+///
+/// Flow events draw arrows between the trace events enclosing them, possibly
+/// on different threads, e.g. from an OpenCL entry point to the command it
+/// recorded and the thread pool slices which executed the command.
+enum class FlowPhase : uint8_t {
+  /// @brief First event of the flow.
+  Begin,
+  /// @brief Intermediate event of the flow.
+  Step,
+  /// @brief Last event of the flow.
+  End,
+};
+
+/// @brief Record a flow event at the current time.
+/// @param name name of the flow.
+/// @param cat the category of the flow.
+/// @param id identifier of the flow, as returned by `createFlow`.
+/// @param phase phase of the flow event.
+void recordFlow(const char *name, const char *cat, uint64_t id,
+                FlowPhase phase);
+
+/// @return Returns a new flow identifier, never zero.
+uint64_t createFlow();
+
+/// @return Returns the flow of the calling thread set by `FlowGuard`, or zero
+/// if there isn't one.
+uint64_t getCurrentFlow();
+
+/// @brief Set the flow of the calling thread.
+/// @param id identifier of the flow, or zero for none.
+/// @return Returns the previous flow of the calling thread.
+uint64_t setCurrentFlow(uint64_t id);
+
+/// @return Returns a mask of the categories enabled at runtime.
+///
+/// Categories compiled in are all enabled by default when `CA_TRACE_FILE` is
+/// set, the `CA_TRACE_CATEGORIES` environment variable can restrict them to a
+/// comma separated list of category names, e.g. `OpenCL,Mux`. Nothing is
+/// enabled when `CA_TRACE_FILE` is not set.
+uint32_t getEnabledCategories();
+
 // Tracer configs defined here so we don't need various defines to be
 // defined in just to be able to use the functionality.
 
@@ -76,34 +119,59 @@ struct BenchmarkCategory {
 template <class T>
 inline const char *getCategoryName();
 
-/// @brief Helper to generate the types and category names
-#define TRACER_GUARD_CATEGORY(type, enabled)                             \
+template <class T>
+inline uint32_t getCategoryMask();
+
+/// @brief Helper to generate the types, category names and runtime masks.
+#define TRACER_GUARD_CATEGORY(type, enabled, index)                      \
   struct type : public BenchmarkCategory<static_cast<bool>(enabled)> {}; \
   template <>                                                            \
   inline const char *getCategoryName<type>() {                           \
     return #type;                                                        \
+  }                                                                      \
+  template <>                                                            \
+  inline uint32_t getCategoryMask<type>() {                              \
+    return 1u << (index);                                                \
   }
 
-TRACER_GUARD_CATEGORY(OpenCL, CA_TRACE_CL)
-TRACER_GUARD_CATEGORY(Core, CA_TRACE_CORE)
-TRACER_GUARD_CATEGORY(Mux, CA_TRACE_MUX)
-TRACER_GUARD_CATEGORY(Impl, CA_TRACE_IMPLEMENTATION)
+TRACER_GUARD_CATEGORY(OpenCL, CA_TRACE_CL, 0)
+TRACER_GUARD_CATEGORY(Core, CA_TRACE_CORE, 1)
+TRACER_GUARD_CATEGORY(Mux, CA_TRACE_MUX, 2)
+TRACER_GUARD_CATEGORY(Impl, CA_TRACE_IMPLEMENTATION, 3)
 
 #undef TRACER_GUARD_CATEGORY
 
+/// @brief Check whether a category is both compiled in and enabled at runtime.
+template <typename Category>
+inline bool isEnabled() {
+  return Category::enabled &&
+         (getEnabledCategories() & getCategoryMask<Category>());
+}
+
+/// @brief Record a flow event if `Category` is enabled.
+/// @param name name of the flow.
+/// @param id identifier of the flow, events with a zero `id` are ignored.
+/// @param phase phase of the flow event.
+template <typename Category>
+inline void recordFlow(const char *name, uint64_t id, FlowPhase phase) {
+  if (isEnabled<Category>() && 0 != id) {
+    recordFlow(name, getCategoryName<Category>(), id, phase);
+  }
+}
+
 /// @brief A scoped timer. Construct the TracerGuard object with one of the
 /// category types. eg: tracer::TraceGuard<OpenCL>("function");
 template <typename Category>
 struct TraceGuard {
   TraceGuard(const char *name) : trace_name(nullptr), start_time(0) {
-    if (Category::enabled) {
+    if (isEnabled<Category>()) {
       trace_name = name;
       start_time = getCurrentTimestamp();
     }
   };
 
   ~TraceGuard() {
-    if (Category::enabled) {
+    if (Category::enabled && trace_name) {
       const uint64_t end_time = getCurrentTimestamp();
       const char *cat_name = getCategoryName<Category>();
       recordTrace(trace_name, cat_name, start_time, end_time);
@@ -114,6 +182,31 @@ struct TraceGuard {
   uint64_t start_time;
 };
 
+/// @brief A scoped flow. Construct the FlowGuard object inside a TraceGuard to
+/// begin a flow from that trace, commands recorded by the calling thread while
+/// the guard is alive continue the flow. eg:
+/// tracer::FlowGuard<OpenCL>("clEnqueueNDRangeKernel");
+template <typename Category>
+struct FlowGuard {
+  FlowGuard(const char *name) : previous_flow(0), enabled(false) {
+    if (isEnabled<Category>()) {
+      enabled = true;
+      const uint64_t id = createFlow();
+      recordFlow(name, getCategoryName<Category>(), id, FlowPhase::Begin);
+      previous_flow = setCurrentFlow(id);
+    }
+  }
+
+  ~FlowGuard() {
+    if (Category::enabled && enabled) {
+      setCurrentFlow(previous_flow);
+    }
+  }
+
+  uint64_t previous_flow;
+  bool enabled;
+};
+
 /// @}
 }  // namespace tracer
 
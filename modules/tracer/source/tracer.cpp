@@ -17,27 +17,28 @@
 #include <tracer/tracer.h>
 #include <utils/system.h>
 
+#include <array>
+#include <atomic>
 #include <cinttypes>
 #include <cstdio>
+#include <cstdlib>
 #include <cstring>
-#include <ctime>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <new>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #if defined(__linux__)
-#include <fcntl.h>
-#include <sys/mman.h>
-#include <sys/stat.h>
 #include <sys/syscall.h>
-#include <sys/types.h>
 #include <unistd.h>
 #elif defined(_MSC_VER) || defined(__MINGW32__) || defined(__MINGW64__)
-#include <direct.h>
 #include <windows.h>
 #elif defined(__APPLE__) || defined(__QNX__) || defined(__MCOS_POSIX__)
 // These platforms are known to be unsupported, and have a stub implementation.
 #endif
-#include <atomic>
-#include <mutex>
 
 namespace {
 
@@ -49,234 +50,327 @@ const int pid = static_cast<int>(GetCurrentProcessId());
 thread_local const int tid = static_cast<int>(GetCurrentThreadId());
 #elif defined(__APPLE__) || defined(__QNX__) || defined(__MCOS_POSIX__)
 // These platforms are known to be unsupported, and have a stub implementation.
+#define TRACER_STUB_IMPLEMENTATION
+const int pid = 0;
+thread_local const int tid = 0;
 #else
 #error Platform not supported!
 #endif
 
-#if defined(__linux__)
-struct TracerVirtualMemFileImpl {
-  explicit TracerVirtualMemFileImpl()
-      : export_file(std::getenv("CA_TRACE_FILE")) {
-    const uint64_t start = tracer::getCurrentTimestamp();
+/// @brief Binary trace event, only formatted as JSON when the trace is
+/// written at exit.
+struct Event {
+  /// @brief Start of a complete event, or the time of a flow event.
+  uint64_t timestamp;
+  /// @brief Duration of a complete event, or the identifier of a flow event.
+  uint64_t value;
+  /// @brief Interned name of the event.
+  uint32_t name;
+  /// @brief Interned category of the event.
+  uint32_t category;
+  /// @brief Chrome trace event phase, e.g. 'X' for a complete event.
+  char phase;
+};
+
+/// @brief Fixed size block of events, chained into a per-thread list.
+struct Chunk {
+  static constexpr size_t capacity = 4096;
+  std::array<Event, capacity> events;
+  /// @brief Number of events written, only stored by the owning thread.
+  std::atomic<size_t> size{0};
+  std::atomic<Chunk *> next{nullptr};
+};
+
+/// @brief Events recorded by a single thread.
+///
+/// Only the owning thread appends events, so recording doesn't require any
+/// locks or shared atomic read-modify-write operations.
+struct ThreadBuffer {
+  explicit ThreadBuffer(int tid) : tid(tid) {}
+
+  /// @brief Interned string cached by the address it was passed with.
+  struct CachedString {
+    const char *pointer = nullptr;
+    const std::string *string = nullptr;
+    uint32_t id = 0;
+  };
+
+  const int tid;
+  std::atomic<Chunk *> first{nullptr};
+  /// @brief Chunk events are appended to, only accessed by the owning thread.
+  Chunk *last = nullptr;
+  /// @brief Direct mapped cache of interned strings, only accessed by the
+  /// owning thread.
+  std::array<CachedString, 64> string_cache;
+};
 
+thread_local ThreadBuffer *thread_buffer = nullptr;
+thread_local uint64_t current_flow = 0;
+
+class Tracer {
+ public:
+  Tracer() {
+#ifndef TRACER_STUB_IMPLEMENTATION
+    const char *export_file = std::getenv("CA_TRACE_FILE");
     if ((nullptr == export_file) || (0 == std::strlen(export_file))) {
       return;
     }
-    tmp_name = "/tmp/ca_" + std::to_string(pid) + ".tracer";
-    const int f = open(tmp_name.c_str(), O_RDWR | O_CREAT, S_IRUSR | S_IWUSR);
 
-    if (f == 0) {
-      (void)fprintf(stderr, "Could not open %s temp file for tracing.\n",
-                    tmp_name.c_str());
+    // KLOCWORK "SV.TAINTED.PATH_TRAVERSAL" possible false positive
+    // Opening a file based on an environment variable is a security issue.
+    // Here, it's mitigated by the fact that tracer is a debug feature, not a
+    // release feature.
+    file = std::fopen(export_file, "w");
+    if (nullptr == file) {
+      (void)std::fprintf(stderr, "Could not open '%s' for tracing.\n",
+                         export_file);
       return;
     }
 
     size_t requested_mb = 1024;
-
     const char *mb_str = std::getenv("CA_TRACE_FILE_BUFFER_MB");
-
     if (nullptr != mb_str && std::strlen(mb_str)) {
       /* seems good to have a max, 75GB */
       constexpr size_t max_mb = 76800;
-      requested_mb = std::min<size_t>(std::stoul(mb_str), max_mb);
-      requested_mb = std::max<size_t>(requested_mb, 0);
-    }
-
-    // MB to bytes
-    const size_t bytes = 1048576 * requested_mb;
-    max_offset = bytes;
-
-    /* resize the file */
-    lseek64(f, bytes, SEEK_SET);
-    auto written = write(f, "", 1);
-    if (0 == written) {
-      (void)fprintf(stderr, "Failed to resize %s.\n", tmp_name.c_str());
-      (void)remove(tmp_name.c_str());
-      return;
+      requested_mb =
+          std::min<size_t>(std::strtoul(mb_str, nullptr, 10), max_mb);
     }
-    lseek64(f, 0, SEEK_SET);
-
-    void *mapping = mmap(0, bytes, PROT_WRITE, MAP_SHARED, f, 0);
-    map = static_cast<char *>(mapping);
-    close(f);
+    max_chunks = (1048576 * requested_mb) / sizeof(Chunk);
 
-    if (map == MAP_FAILED) {
-      (void)fprintf(stderr, "Failed to map tmp file:%s.\n", strerror(errno));
-      (void)remove(tmp_name.c_str());
+    uint32_t enabled = ~0u;
+    if (const char *list = std::getenv("CA_TRACE_CATEGORIES")) {
+      enabled = parseCategories(list);
     }
+    categories.store(enabled, std::memory_order_relaxed);
+#endif
+  }
 
-    // Buffer to keep things stack allocated.
-    char buf[256]{};
-
-    int consumed = std::snprintf(buf, sizeof(buf),
-                                 "{\n\t\"otherData\":{},\n\t\"traceEvents\":[");
-    writeToMemMap(buf, consumed);
-    std::memset((void *)buf, 0, sizeof(buf));
-
-    // Insert dummy value so we can ignore JSON's comma requirements.
-    const uint64_t end = tracer::getCurrentTimestamp();
-
-    consumed = std::snprintf(
-        buf, sizeof(buf),
-        "\n\t\t{\"name\":\"%s\", "
-        "\"cat\":\"%s\",\"ph\":\"X\",\"pid\":%d,\"tid\":%d,\"ts\":%" PRIu64
-        ","
-        "\"dur\":%" PRIu64 "}",
-        "tracer-startup", "tracer-startup", pid, tid, start, end - start);
-
-    writeToMemMap(buf, consumed);
-  };
-
-  ~TracerVirtualMemFileImpl() {
-    if (0 != map) {
-      const char *ending = "\n\t]\n}\n";
+  Tracer(const Tracer &) = delete;
+  Tracer &operator=(const Tracer &) = delete;
 
-      if (std::strlen(ending) + offset > max_offset) {
-        (void)fprintf(stderr,
-                      "Trace overflow, failed to write data, increase "
-                      "CA_TRACE_FILE_BUFFER_MB");
-      }
+  /// @brief Stop recording and write the trace file.
+  ///
+  /// Threads may still be running at exit, events they record after this are
+  /// dropped. Neither the buffers nor the tracer are freed for this reason.
+  void finish();
 
-      writeToMemMap(ending, std::strlen(ending));
+  /// @brief Append an event to the calling thread's buffer.
+  void record(char phase, const char *name, const char *category,
+              uint64_t timestamp, uint64_t value);
 
-      // Copy mem-mapped file into a proper file.
-      // This reduces the footprint, and stops to some file issues, with editors
-      // opening up empty and/or very large files.
-      FILE *file = fopen(export_file, "w");
+  std::atomic<uint32_t> categories{0};
+  std::atomic<uint64_t> next_flow{1};
 
-      if (nullptr != file) {
-        bool write_error =
-            fwrite(map, sizeof(map[0]), offset.load(), file) != offset.load();
-        write_error |= fclose(file);
+ private:
+  static uint32_t parseCategories(const char *list);
+  ThreadBuffer *getThreadBuffer();
+  Chunk *allocChunk(ThreadBuffer &buffer);
+  uint32_t intern(ThreadBuffer &buffer, const char *str);
+  void writeString(uint32_t id);
+
+  FILE *file = nullptr;
+  size_t max_chunks = 0;
+  std::atomic<size_t> allocated_chunks{0};
+  std::atomic<uint64_t> dropped_events{0};
+
+  std::mutex buffers_mutex;
+  std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+
+  std::mutex strings_mutex;
+  std::deque<std::string> strings;
+  std::unordered_map<std::string, uint32_t> string_ids;
+};
 
-        if (write_error) {
-          (void)fprintf(stderr, "Trace file could not be shrunk down.");
+uint32_t Tracer::parseCategories(const char *list) {
+  const std::array<std::pair<const char *, uint32_t>, 4> names{{
+      {tracer::getCategoryName<tracer::OpenCL>(),
+       tracer::getCategoryMask<tracer::OpenCL>()},
+      {tracer::getCategoryName<tracer::Core>(),
+       tracer::getCategoryMask<tracer::Core>()},
+      {tracer::getCategoryName<tracer::Mux>(),
+       tracer::getCategoryMask<tracer::Mux>()},
+      {tracer::getCategoryName<tracer::Impl>(),
+       tracer::getCategoryMask<tracer::Impl>()},
+  }};
+
+  uint32_t enabled = 0;
+  const char *begin = list;
+  while (true) {
+    const char *end = std::strchr(begin, ',');
+    const size_t length = end ? size_t(end - begin) : std::strlen(begin);
+    if (length) {
+      bool found = false;
+      for (const auto &name : names) {
+        if (std::strlen(name.first) == length &&
+            0 == std::strncmp(name.first, begin, length)) {
+          enabled |= name.second;
+          found = true;
         }
       }
-
-      munmap(map, max_offset);
-      map = nullptr;
-      (void)remove(tmp_name.c_str());
+      if (!found) {
+        (void)std::fprintf(stderr,
+                           "Unknown category '%.*s' in CA_TRACE_CATEGORIES.\n",
+                           static_cast<int>(length), begin);
+      }
     }
+    if (!end) {
+      break;
+    }
+    begin = end + 1;
   }
+  return enabled;
+}
 
-  void doTrace(const char *name, const char *category, uint64_t start,
-               uint64_t end) {
-    // Buffer to keep stack allocated.
-    char buf[256]{};
-    const int consumed = std::snprintf(
-        buf, sizeof(buf),
-        ",\n\t\t{\"name\":\"%s\", "
-        "\"cat\":\"%s\",\"ph\":\"X\",\"pid\":%d,\"tid\":%d,\"ts\":%" PRIu64
-        ","
-        "\"dur\":%" PRIu64 "}",
-        name, category, pid, tid, start, end - start);
-    writeToMemMap(buf, consumed);
-  }
-
- private:
-  void writeToMemMap(const char *buf, int size) {
-    if (map == nullptr || size <= 0) {
-      return;
+ThreadBuffer *Tracer::getThreadBuffer() {
+  if (nullptr == thread_buffer) {
+    std::unique_ptr<ThreadBuffer> buffer(new (std::nothrow) ThreadBuffer(tid));
+    if (!buffer) {
+      return nullptr;
     }
+    // Registering happens once per thread, recording events never locks.
+    const std::lock_guard<std::mutex> lock(buffers_mutex);
+    buffers.push_back(std::move(buffer));
+    thread_buffer = buffers.back().get();
+  }
+  return thread_buffer;
+}
 
-    const uint64_t insert_pt = offset.fetch_add(size);
-
-    if ((insert_pt + size) < max_offset) {
-      std::memcpy((void *)&map[insert_pt], (const void *)buf, size);
-    }
+Chunk *Tracer::allocChunk(ThreadBuffer &buffer) {
+  if (allocated_chunks.fetch_add(1, std::memory_order_relaxed) >= max_chunks) {
+    return nullptr;
+  }
+  auto *chunk = new (std::nothrow) Chunk;
+  if (nullptr == chunk) {
+    return nullptr;
   }
+  if (buffer.last) {
+    buffer.last->next.store(chunk, std::memory_order_release);
+  } else {
+    buffer.first.store(chunk, std::memory_order_release);
+  }
+  buffer.last = chunk;
+  return chunk;
+}
 
-  uint64_t max_offset{0};
-  char *map{nullptr};
-  const char *export_file{nullptr};
-  std::string tmp_name{""};
-  std::atomic<uint64_t> offset{0};
-};
+uint32_t Tracer::intern(ThreadBuffer &buffer, const char *str) {
+  // Names are almost always string literals, so look them up by address and
+  // only compare the contents in case the address was reused.
+  auto &cached = buffer.string_cache[(reinterpret_cast<uintptr_t>(str) >> 3) %
+                                     buffer.string_cache.size()];
+  if (cached.pointer == str && *cached.string == str) {
+    return cached.id;
+  }
 
-#elif defined(_WIN32)
-/*
- *  TracerFileImpl creates a file and appends to it while holding a mutex.
- */
-struct TracerFileImpl {
-  explicit TracerFileImpl() {
-    uint64_t start = tracer::getCurrentTimestamp();
+  const std::lock_guard<std::mutex> lock(strings_mutex);
+  auto found = string_ids.find(str);
+  if (found == string_ids.end()) {
+    strings.emplace_back(str);
+    found = string_ids
+                .emplace(strings.back(), static_cast<uint32_t>(
+                                             strings.size() - 1))
+                .first;
+  }
+  cached = {str, &strings[found->second], found->second};
+  return found->second;
+}
 
-    const char *env = std::getenv("CA_TRACE_FILE");
+void Tracer::record(char phase, const char *name, const char *category,
+                    uint64_t timestamp, uint64_t value) {
+  ThreadBuffer *buffer = getThreadBuffer();
+  if (nullptr == buffer) {
+    dropped_events.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
 
-    // If we couldn't find an env variable for the user folder or the returned
-    // value was an empty string, bail out.
-    if ((nullptr == env) || (0 == std::strlen(env))) {
+  Chunk *chunk = buffer->last;
+  size_t size = chunk ? chunk->size.load(std::memory_order_relaxed)
+                      : Chunk::capacity;
+  if (Chunk::capacity == size) {
+    chunk = allocChunk(*buffer);
+    if (nullptr == chunk) {
+      dropped_events.fetch_add(1, std::memory_order_relaxed);
       return;
     }
+    size = 0;
+  }
 
-    // KLOCWORK "SV.TAINTED.PATH_TRAVERSAL" possible false positive
-    // Opening a file based on an environment variable is a security issue.
-    // Here, it's mitigated by the fact that tracer is a debug feature, not a
-    // release feature.
-    file = fopen(env, "w");
+  chunk->events[size] = {timestamp, value, intern(*buffer, name),
+                         intern(*buffer, category), phase};
+  // Publish the event to `finish`, which may run while threads still record.
+  chunk->size.store(size + 1, std::memory_order_release);
+}
 
-    if (nullptr == file) {
-      (void)fprintf(stderr, "Could not open '%s' for tracing.\n", env);
-      return;
+void Tracer::writeString(uint32_t id) {
+  (void)std::fputc('"', file);
+  for (const char c : strings[id]) {
+    if ('"' == c || '\\' == c) {
+      (void)std::fputc('\\', file);
+      (void)std::fputc(c, file);
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      (void)std::fprintf(file, "\\u%04x", static_cast<unsigned>(c));
+    } else {
+      (void)std::fputc(c, file);
     }
-
-    // Now we have a file handle, we need to output the start of the JSON
-    // tracing format.
-    fprintf(file, "{\n\t\"otherData\":{},\n\t\"traceEvents\":[");
-
-    // Insert dummy value so we can ignore JSON's comma requirements.
-    uint64_t end = tracer::getCurrentTimestamp();
-
-    fprintf(file,
-            "\n\t\t{\"name\":\"%s\", "
-            "\"cat\":\"%s\",\"ph\":\"X\",\"pid\":%d,\"tid\":%d,\"ts\":%" PRIu64
-            ","
-            "\"dur\":%" PRIu64 "}",
-            "tracer-startup", "tracer-startup", pid, tid, start, end - start);
   }
+  (void)std::fputc('"', file);
+}
 
-  ~TracerFileImpl() {
-    if (nullptr != file) {
-      // Lastly we close our traceEvents member, and the main JSON object.
-      fprintf(file, "\n\t]\n}\n");
-
-      // And close the file.
-      fclose(file);
+void Tracer::finish() {
+  if (nullptr == file) {
+    return;
+  }
+  categories.store(0, std::memory_order_relaxed);
+
+  const std::lock_guard<std::mutex> buffers_lock(buffers_mutex);
+  const std::lock_guard<std::mutex> strings_lock(strings_mutex);
+
+  (void)std::fprintf(file,
+                     "{\n\t\"otherData\":{\"droppedEvents\":%" PRIu64
+                     "},\n\t\"traceEvents\":[",
+                     dropped_events.load());
+  const char *separator = "\n";
+  for (const auto &buffer : buffers) {
+    for (Chunk *chunk = buffer->first.load(std::memory_order_acquire); chunk;
+         chunk = chunk->next.load(std::memory_order_acquire)) {
+      const size_t size = chunk->size.load(std::memory_order_acquire);
+      for (size_t i = 0; i < size; i++) {
+        const Event &event = chunk->events[i];
+        (void)std::fprintf(file, "%s\t\t{\"name\":", separator);
+        writeString(event.name);
+        (void)std::fprintf(file, ",\"cat\":");
+        writeString(event.category);
+        (void)std::fprintf(
+            file, ",\"ph\":\"%c\",\"pid\":%d,\"tid\":%d,\"ts\":%" PRIu64,
+            event.phase, pid, buffer->tid, event.timestamp);
+        if ('X' == event.phase) {
+          (void)std::fprintf(file, ",\"dur\":%" PRIu64 "}", event.value);
+        } else {
+          // Flow ends bind to the enclosing slice rather than the next one.
+          (void)std::fprintf(file, ",\"id\":%" PRIu64 "%s}", event.value,
+                             'f' == event.phase ? ",\"bp\":\"e\"" : "");
+        }
+        separator = ",\n";
+      }
     }
   }
+  (void)std::fprintf(file, "\n\t]\n}\n");
 
-  void doTrace(const char *name, const char *category, uint64_t start,
-               uint64_t end) {
-    std::lock_guard<std::mutex> lock(mtx);
-
-    if (nullptr != file) {
-      fprintf(
-          file,
-          ",\n\t\t{\"name\":\"%s\", "
-          "\"cat\":\"%s\",\"ph\":\"X\",\"pid\":%d,\"tid\":%d,\"ts\":%" PRIu64
-          ","
-          "\"dur\":%" PRIu64 "}",
-          name, category, pid, tid, start, end - start);
-    }
+  if (std::fclose(file)) {
+    (void)std::fprintf(stderr, "Trace file could not be written.\n");
   }
+  file = nullptr;
+}
 
-  std::mutex mtx;
-  FILE *file{nullptr};
-};
-#elif defined(__APPLE__) || defined(__QNX__) || defined(__MCOS_POSIX__)
-// These platforms are known to be unsupported, and have a stub implementation.
-struct TracerVirtualMemFileImpl {
-  void doTrace(const char *, const char *, uint64_t, uint64_t) {}
-};
-#endif
+Tracer &getTracer() {
+  // Intentionally leaked, see Tracer::finish.
+  static Tracer *const tracer = new Tracer;
+  return *tracer;
+}
 
-#if defined(__linux__) || defined(__APPLE__) || defined(__QNX__) || \
-    defined(__MCOS_POSIX__)
-TracerVirtualMemFileImpl trace_impl;
-#elif defined(_WIN32) || defined(__MINGW32__) || defined(__MINGW64__)
-TracerFileImpl trace_impl;
-#endif
+/// @brief Writes the trace when the process exits.
+struct TraceWriter {
+  ~TraceWriter() { getTracer().finish(); }
+} trace_writer;
 
 }  // namespace
 
@@ -284,7 +378,35 @@ uint64_t tracer::getCurrentTimestamp() {
   return utils::timestampMicroSeconds();
 }
 
+uint32_t tracer::getEnabledCategories() {
+  return getTracer().categories.load(std::memory_order_relaxed);
+}
+
 void tracer::recordTrace(const char *name, const char *category, uint64_t start,
                          uint64_t end) {
-  trace_impl.doTrace(name, category, start, end);
+  if (getEnabledCategories()) {
+    getTracer().record('X', name, category, start, end - start);
+  }
+}
+
+uint64_t tracer::createFlow() {
+  return getTracer().next_flow.fetch_add(1, std::memory_order_relaxed);
+}
+
+void tracer::recordFlow(const char *name, const char *category, uint64_t id,
+                        FlowPhase phase) {
+  if (0 == id || 0 == getEnabledCategories()) {
+    return;
+  }
+  const char phases[] = {'s', 't', 'f'};
+  getTracer().record(phases[static_cast<uint8_t>(phase)], name, category,
+                     getCurrentTimestamp(), id);
+}
+
+uint64_t tracer::getCurrentFlow() { return current_flow; }
+
+uint64_t tracer::setCurrentFlow(uint64_t id) {
+  const uint64_t previous = current_flow;
+  current_flow = id;
+  return previous;
 }
@@ -48,6 +48,9 @@ struct jit_kernel_s {
   /// * If zero, denotes a 'degenerate' sub-group (i.e., the size of the
   /// work-group at enqueue time).
   uint32_t sub_group_size;
+  /// @brief Whether the kernel may dereference pointers it did not receive as
+  /// arguments, e.g. device pointers stored inside a buffer.
+  bool may_access_memory_indirectly;
 };
 
 /// @brief Detects whether this binary buffer contains a JIT kernel hook and
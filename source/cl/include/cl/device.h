@@ -32,8 +32,11 @@
 #include <compiler/info.h>
 #include <mux/mux.h>
 
+#include <memory>
 #include <string>
 
+class printf_buffer_pool_t;
+
 /// @addtogroup cl
 /// @{
 
@@ -245,6 +248,9 @@ struct _cl_device_id final : public cl::base<_cl_device_id> {
   /// @brief Maximum size of the internal buffer that holds the output of
   /// printf calls from a kernel, minimum 1MB for the FULL profile.
   size_t printf_buffer_size;
+  /// @brief Pool of `printf_buffer_size` byte buffers reused by enqueues of
+  /// kernels which call printf.
+  std::unique_ptr<printf_buffer_pool_t> printf_buffer_pool;
   /// @brief CL_TRUE if the device's preference is for the user to be
   /// responsible for synchronisation.
   cl_bool preferred_interop_user_sync;
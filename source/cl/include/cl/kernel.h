@@ -134,6 +134,52 @@ class MuxKernelWrapper {
   cargo::expected<SpecializedKernel, compiler::Result> createSpecializedKernel(
       const mux_ndrange_options_t &specialization_options);
 
+  /// @brief If this kernel supports autotuning, returns the candidate the next
+  /// enqueue with the given local size should be timed with.
+  ///
+  /// @param local_size_x Local size in the x dimension.
+  /// @param local_size_y Local size in the y dimension.
+  /// @param local_size_z Local size in the z dimension.
+  ///
+  /// @return The candidate to time, or `cargo::nullopt` if no autotuning is
+  /// taking place.
+  cargo::optional<uint32_t> getNextTuningCandidate(size_t local_size_x,
+                                                   size_t local_size_y,
+                                                   size_t local_size_z);
+
+  /// @brief Performs deferred compilation of an autotuning candidate and
+  /// returns a Mux executable-kernel pair containing it.
+  ///
+  /// @param specialization_options Mux execution options to specialize for.
+  /// @param candidate Candidate returned by `getNextTuningCandidate`.
+  ///
+  /// @return A valid SpecializedKernel object if specialization was successful,
+  /// or a status code otherwise.
+  cargo::expected<SpecializedKernel, compiler::Result>
+  createTuningCandidateKernel(
+      const mux_ndrange_options_t &specialization_options, uint32_t candidate);
+
+  /// @brief Reports the measured duration of a launch of an autotuning
+  /// candidate.
+  ///
+  /// @param local_size_x Local size in the x dimension.
+  /// @param local_size_y Local size in the y dimension.
+  /// @param local_size_z Local size in the z dimension.
+  /// @param candidate Candidate which was launched.
+  /// @param duration Duration of the launch in nanoseconds.
+  void reportTuningDuration(size_t local_size_x, size_t local_size_y,
+                            size_t local_size_z, uint32_t candidate,
+                            uint64_t duration);
+
+  /// @brief Returns a description of the configuration autotuning selected for
+  /// the given local size, or an empty string if there is none.
+  ///
+  /// @param local_size_x Local size in the x dimension.
+  /// @param local_size_y Local size in the y dimension.
+  /// @param local_size_z Local size in the z dimension.
+  std::string getTuningDecision(size_t local_size_x, size_t local_size_y,
+                                size_t local_size_z);
+
   /// @brief If this kernel does not support specialization, this returns the
   /// generic Mux kernel that is not specialized for any particular config.
   mux_kernel_t getPrecompiledKernel() const;
@@ -209,6 +255,11 @@ class MuxKernelWrapper {
   const size_t local_memory_size;
 
  private:
+  /// @brief Loads a binary created by the deferred kernel into a Mux
+  /// executable-kernel pair.
+  cargo::expected<SpecializedKernel, compiler::Result> loadSpecializedKernel(
+      const cargo::dynamic_array<uint8_t> &binary);
+
   mux_device_t mux_device;
   mux_allocator_info_t mux_allocator_info;
   mux_kernel_t precompiled_kernel;
@@ -444,6 +495,15 @@ struct _cl_kernel final : public cl::base<_cl_kernel> {
                         const size_t *global_work_size,
                         const size_t *local_work_size);
 
+  /// @brief Check if the kernel may be enqueued on a device with a global size
+  /// which is not a multiple of the local size.
+  ///
+  /// @param[in] device Device on which the kernel will be enqueued.
+  ///
+  /// @return Returns true if the device supports non-uniform work-groups and
+  /// the kernel's program was built to allow them, false otherwise.
+  bool supportsNonUniformWorkGroups(cl_device_id device) const;
+
   /// @brief Validate kernel arguments.
   ///
   /// Checks that all kernel arguments are valid.
@@ -455,7 +515,9 @@ struct _cl_kernel final : public cl::base<_cl_kernel> {
   /// @brief Choose an appropriate local work group size.
   ///
   /// Should be called in the case the user doesn't request a local size and
-  /// kernel does not have a reqd_work_group_size attribute.
+  /// kernel does not have a reqd_work_group_size attribute. When non-uniform
+  /// work-groups are supported the preferred local size is kept even if it
+  /// doesn't divide the global size.
   ///
   /// @param[in] device Device on which to execute this kernel.
   /// @param[in] global_size Global work size.
@@ -636,6 +698,28 @@ CL_API_ENTRY cl_int CL_API_CALL EnqueueNDRangeKernel(
     const size_t *local_work_size, cl_uint num_events_in_wait_list,
     const cl_event *event_wait_list, cl_event *event);
 
+/// @brief Enqueue a kernel whose work-group counts are read from a buffer when
+/// the command executes.
+///
+/// @param[in] command_queue Command queue to queue the invocation on.
+/// @param[in] kernel Kernel to invoke on the queue.
+/// @param[in] work_dim Number of dimensions of the ND range.
+/// @param[in] local_work_size Local work group size, may be null.
+/// @param[in] indirect_buffer Buffer containing three `cl_uint` work-group
+/// counts, the global size is the work-group count times the local size.
+/// @param[in] indirect_offset Byte offset of the work-group counts into
+/// `indirect_buffer`, must be a multiple of four.
+/// @param[in] num_events_in_wait_list Number of events in list to wait for.
+/// @param[in] event_wait_list List of events to wait for.
+/// @param[out] event Return event if not null.
+///
+/// @return Return error code.
+cl_int EnqueueNDRangeKernelIndirect(
+    cl_command_queue command_queue, cl_kernel kernel, cl_uint work_dim,
+    const size_t *local_work_size, cl_mem indirect_buffer,
+    size_t indirect_offset, cl_uint num_events_in_wait_list,
+    const cl_event *event_wait_list, cl_event *event);
+
 /// @brief Enqueue a single kernel invocation.
 ///
 /// @param[in] command_queue Command queue to queue the invocation on.
@@ -25,27 +25,74 @@
 #include <builtins/printf.h>
 #include <mux/mux.hpp>
 
-#include <array>
+#include <memory>
+#include <mutex>
+#include <utility>
 #include <vector>
 
-/// @brief Allocate Mux memory and bind buffer for printf output based on local
-/// and global execution size of a kernel.
+/// @brief Pool of printf buffers owned by a device, reused across kernel
+/// enqueues rather than allocating device memory for every launch.
+class printf_buffer_pool_t final {
+ public:
+  /// @brief Constructor.
+  ///
+  /// @param[in] device Device to allocate printf buffers for.
+  explicit printf_buffer_pool_t(cl_device_id device) : device(device) {}
+
+  printf_buffer_pool_t(const printf_buffer_pool_t &) = delete;
+  printf_buffer_pool_t &operator=(const printf_buffer_pool_t &) = delete;
+
+  /// @brief Destructor, frees all pooled buffers.
+  ~printf_buffer_pool_t();
+
+  /// @brief Get a printf buffer, allocating a new one if the pool is empty.
+  ///
+  /// @param[out] memory Mux memory backing the buffer.
+  /// @param[out] buffer Mux buffer of `printf_buffer_size` bytes bound to
+  /// `memory`.
+  ///
+  /// @return Returns CL_SUCCESS, or CL_OUT_OF_RESOURCES if allocating failed.
+  cl_int acquire(mux_memory_t &memory, mux_buffer_t &buffer);
+
+  /// @brief Return a printf buffer to the pool once its printf callback can no
+  /// longer run.
+  ///
+  /// @param[in] memory Mux memory backing the buffer.
+  /// @param[in] buffer Mux buffer returned by `acquire`.
+  void release(mux_memory_t memory, mux_buffer_t buffer);
+
+ private:
+  cl_device_id device;
+  std::mutex mutex;
+  std::vector<std::pair<mux_memory_t, mux_buffer_t>> buffers;
+};
+
+/// @brief Get a Mux buffer for printf output from the device's pool and record
+/// a command resetting it ahead of the kernel which will print to it.
+///
+/// All work-groups of the ND-Range share the whole buffer, so the amount of
+/// output one work-group may produce doesn't depend on the number of
+/// work-groups. Resetting the buffer with a command rather than on the host
+/// means the buffer is reset each time a command-buffer is enqueued.
+///
+/// Output is only decoded once the ND-Range has completed, so it is bounded by
+/// the device's `printf_buffer_size` rather than drained while the kernel runs.
+///
+/// On success the reset command refers to the buffer, which must therefore only
+/// be returned to the pool once `command_buffer` has completed or been thrown
+/// away, never destroyed directly. Wrapping it in a `printf_info_t` owned by
+/// the command-buffer's completion takes care of this.
 ///
 /// @param[in] device Device to allocate memory for
-/// @param[in] local_work_size Local size of the ND-Range
-/// @param[in] global_work_size Global size of the ND-Range
-/// @param[out] num_groups Total number of workgroups in the ND-Range
-/// @param[out] buffer_group_size Bytes per workgroup in the allocated buffer
-/// @param[out] printf_memory Mux memory allocated by the function
-/// @param[out] printf_buffer Mux buffer bound to Mux memory object.
+/// @param[in] command_buffer Command-buffer the kernel will be recorded to
+/// @param[out] printf_memory Mux memory the buffer is bound to
+/// @param[out] printf_buffer Mux buffer for the kernel's printf argument
 ///
 /// @return Returns CL_SUCCESS, or an OpenCL error code on failure.
-cl_int createPrintfBuffer(
-    cl_device_id device,
-    const std::array<size_t, cl::max::WORK_ITEM_DIM> &local_work_size,
-    const std::array<size_t, cl::max::WORK_ITEM_DIM> &global_work_size,
-    size_t &num_groups, size_t &buffer_group_size, mux_memory_t &printf_memory,
-    mux_buffer_t &printf_buffer);
+cl_int createPrintfBuffer(cl_device_id device,
+                          mux_command_buffer_t command_buffer,
+                          mux_memory_t &printf_memory,
+                          mux_buffer_t &printf_buffer);
 
 /// @brief Structure passed to callback performing printf on host.
 struct printf_info_t final {
@@ -55,43 +102,23 @@ struct printf_info_t final {
   mux_memory_t memory;
   /// @brief Mux buffer bound to memory
   mux_buffer_t buffer;
-  /// @brief Size in bytes of the printf buffer per work-group chunk
-  size_t buffer_group_size;
-  /// @brief Offset into the buffer chunk for each work-group to start printing
-  /// from
-  std::vector<uint32_t> group_offsets;
   /// @brief Details of printf calls in the kernel program
   std::vector<builtins::printf::descriptor> &printf_calls;
-  /// @brief Destructor for freeing mux allocated resources
+  /// @brief Destructor for returning the buffer to the device's pool, only
+  /// safe once the command-buffer using the buffer can no longer run.
   ~printf_info_t();
 };
 
 /// @brief Record a user callback command to the Mux command-buffer to perform
 /// host printing from Mux buffer used for device-side printf.
 ///
-/// This overload with a raw pointer printf_info_t frees the heap allocated
-/// data in the callback.
+/// The callback doesn't take ownership of `printf_info`, which must outlive
+/// every execution of `command_buffer`.
 ///
 /// @param[in] command_buffer Command-Buffer to record callback command to
-/// @param[in] printf_info Heap allocated struct containing info needed in
-/// callback
+/// @param[in] printf_info Struct containing info needed in callback
 ///
 /// @return mux_success on completion, or a Mux error code on failure.
 mux_result_t createPrintfCallback(mux_command_buffer_t command_buffer,
                                   printf_info_t *printf_info);
-
-/// @brief Record a user callback command to the Mux command-buffer to perform
-/// host printing from Mux buffer used for device-side printf.
-///
-/// This overload with a smart pointer printf_info_t *does not* free the heap
-/// allocated data in the callback.
-///
-/// @param[in] command_buffer Command-Buffer to record callback command to
-/// @param[in] printf_info Heap allocated struct containing info needed in
-/// callback
-///
-/// @return mux_success on completion, or a Mux error code on failure.
-mux_result_t createPrintfCallback(
-    mux_command_buffer_t command_buffer,
-    const std::unique_ptr<printf_info_t> &printf_info);
 #endif  // CL_PRINTF_H_INCLUDED
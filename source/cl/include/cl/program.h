@@ -32,6 +32,8 @@
 #include <cl/kernel.h>
 #include <extension/config.h>
 
+#include <memory>
+#include <mutex>
 #include <unordered_map>
 
 namespace cl {
@@ -115,9 +117,15 @@ struct device_program {
     ///
     /// @param executable Mux executable to create kernels from.
     /// @param binary OpenCL binary that this Mux executable was loaded from.
-    Binary(mux::unique_ptr<mux_executable_t> executable,
-           cargo::dynamic_array<uint8_t> binary)
-        : kernels(std::move(executable)), binary(std::move(binary)) {}
+    /// @param kernel_sections Sections of `binary` holding the information of
+    /// each kernel.
+    Binary(
+        mux::unique_ptr<mux_executable_t> executable,
+        cargo::dynamic_array<uint8_t> binary,
+        cargo::dynamic_array<cargo::array_view<const uint8_t>> kernel_sections)
+        : kernels(std::move(executable)),
+          binary(std::move(binary)),
+          kernel_sections(std::move(kernel_sections)) {}
 
     /// @brief An object that manages Mux kernels created from the Mux
     /// executable created when the binary is loaded.
@@ -126,6 +134,20 @@ struct device_program {
     /// @brief Binary used to create the Mux executable. Cached so it can be
     /// returned as part of clGetProgramInfo.
     cargo::dynamic_array<uint8_t> binary;
+
+    /// @brief Sections of `binary` holding the information of each kernel, in
+    /// the same order as `program_info`. Empty if the binary stores it inline,
+    /// in which case `program_info` is fully populated when loaded.
+    cargo::dynamic_array<cargo::array_view<const uint8_t>> kernel_sections;
+
+    /// @brief Kernel information deserialized from `kernel_sections` on first
+    /// use, as only the kernel names are populated in `program_info`.
+    mutable cargo::dynamic_array<std::unique_ptr<compiler::KernelInfo>>
+        kernel_infos;
+
+    /// @brief We need to guard against deserializing kernel information in
+    /// parallel, as kernels can be created in parallel.
+    mutable std::mutex kernel_infos_mutex;
   };
 
   /// @brief Builtin Kernels program state.
@@ -186,8 +208,13 @@ struct device_program {
   /// @param executable Mux executable to create kernels from.
   /// @param binary_buffer OpenCL binary that this Mux executable was loaded
   /// from.
-  void initializeAsBinary(mux::unique_ptr<mux_executable_t> executable,
-                          cargo::dynamic_array<uint8_t> binary_buffer);
+  /// @param kernel_sections Sections of `binary_buffer` holding the
+  /// information of each kernel, or empty if `program_info` is fully
+  /// populated.
+  void initializeAsBinary(
+      mux::unique_ptr<mux_executable_t> executable,
+      cargo::dynamic_array<uint8_t> binary_buffer,
+      cargo::dynamic_array<cargo::array_view<const uint8_t>> kernel_sections);
 
   /// @brief Initialize this device program as a collection of builtin kernels.
   void initializeAsBuiltin();
@@ -225,6 +252,18 @@ struct device_program {
   cargo::expected<std::unique_ptr<MuxKernelWrapper>, cl_int> createKernel(
       cl_device_id device, const std::string &kernel_name);
 
+  /// @brief Get the information of a kernel in `program_info`.
+  ///
+  /// The information of kernels loaded from a binary is deserialized on first
+  /// use, so this must be used rather than reading `program_info` directly for
+  /// anything other than the kernel names.
+  ///
+  /// @param name Name of the kernel.
+  ///
+  /// @return Returns the kernel information, or nullptr if there is no such
+  /// kernel or its information could not be deserialized.
+  const compiler::KernelInfo *getKernelInfo(cargo::string_view name) const;
+
   /// @brief Calculates the size of the binary representation of this device
   /// program.
   ///
@@ -44,6 +44,15 @@ constexpr char OCL_MD_EXECUTABLE_BLOCK[] = "OpenCL_executable";
 constexpr char OCL_MD_IS_EXECUTABLE_BLOCK[] = "OpenCL_is_executable";
 constexpr char OCL_MD_PRINTF_INFO_BLOCK[] = "OpenCL_printf_info";
 constexpr char OCL_MD_PROGRAM_INFO_BLOCK[] = "OpenCL_program_info";
+constexpr char OCL_MD_SECTIONS_BLOCK[] = "OpenCL_sections";
+constexpr char OCL_MD_KERNEL_INFO_BLOCK[] = "OpenCL_kernel_info";
+
+/// @brief Alignment of the sections which follow the metadata of a binary.
+///
+/// Binaries containing an `OpenCL_sections` block store the executable and the
+/// metadata of each kernel as sections after the metadata, rather than inside
+/// it, so they can be referenced in place instead of being copied out.
+constexpr size_t OCL_BINARY_SECTION_ALIGNMENT = 64;
 
 /// @brief Userdata used when reading metadata from a serialized program.
 struct OpenCLReadUserdata {
@@ -80,18 +89,35 @@ bool serializeBinary(
 
 /// @brief Deserializes an OpenCL program binary.
 ///
+/// Nothing is copied out of `binary`, `executable` and `kernel_sections` refer
+/// to it and are only valid for as long as it is.
+///
 /// @param[in] binary Binary buffer of the binary.
 /// @param[out] printf_calls Printf descriptor list returned by the compiler.
-/// @param[out] program_info Program information returned by the compiler.
+/// @param[out] program_info Program information returned by the compiler. If
+/// `kernel_sections` isn't empty only the kernel names are populated, the rest
+/// of each kernel's information is read with `deserializeKernelInfo`.
+/// @param[out] kernel_sections The section holding the information of each
+/// kernel in `program_info`, empty for binaries which store it inline.
 /// @param[out] executable The executable contained within the OpenCL binary.
 /// @param[out] is_executable If the program is executable.
 ///
 /// @return true if the binary was deserialized successfully, false
-bool deserializeBinary(cargo::array_view<const uint8_t> binary,
-                       std::vector<builtins::printf::descriptor> &printf_calls,
-                       compiler::ProgramInfo &program_info,
-                       cargo::dynamic_array<uint8_t> &executable,
-                       bool &is_executable);
+bool deserializeBinary(
+    cargo::array_view<const uint8_t> binary,
+    std::vector<builtins::printf::descriptor> &printf_calls,
+    compiler::ProgramInfo &program_info,
+    cargo::dynamic_array<cargo::array_view<const uint8_t>> &kernel_sections,
+    cargo::array_view<const uint8_t> &executable, bool &is_executable);
+
+/// @brief Deserializes the information of a kernel from its section.
+///
+/// @param[in] section Kernel section returned by `deserializeBinary`.
+/// @param[out] kernel_info Kernel information to populate.
+///
+/// @return true if the kernel was deserialized successfully, false
+bool deserializeKernelInfo(cargo::array_view<const uint8_t> section,
+                           compiler::KernelInfo &kernel_info);
 
 /// @brief Get OpenCL Metadata Write Hooks.
 ///
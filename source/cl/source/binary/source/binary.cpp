@@ -24,10 +24,12 @@
 #include <compiler/limits.h>
 #include <compiler/loader.h>
 #include <metadata/detail/md_ctx.h>
+#include <metadata/detail/utils.h>
 
 #include <algorithm>
 #include <cassert>
 #include <cstdlib>
+#include <cstring>
 #include <fstream>
 #include <iomanip>
 #include <memory>
@@ -52,36 +54,9 @@ auto md_init_unique(md_hooks *hooks, void *userdata) {
   return std::unique_ptr<md_ctx_, decltype(deleter)>(ctx, std::move(deleter));
 }
 
-bool serializeExecutable(OpenCLWriteUserdata *cl_userdata, md_ctx ctx) {
-  md_stack stack = md_create_block(ctx, OCL_MD_EXECUTABLE_BLOCK);
-  if (!stack) {
-    return false;
-  }
-
-  if (cl_userdata->is_executable) {
-    const int err = md_push_bytes(stack, cl_userdata->mux_executable.data(),
-                                  cl_userdata->mux_executable.size());
-    if (MD_CHECK_ERR(err)) {
-      return false;
-    }
-  } else {
-    cargo::dynamic_array<uint8_t> buf;
-    auto *compiler_module = cl_userdata->compiler_module;
-    if (buf.alloc(compiler_module->size())) {
-      return false;
-    }
-    compiler_module->serialize(buf.data());
-    const int err = md_push_bytes(stack, buf.data(), buf.size());
-    if (MD_CHECK_ERR(err)) {
-      return false;
-    }
-  }
-
-  const int err = md_finalize_block(stack);
-  if (MD_CHECK_ERR(err)) {
-    return false;
-  }
-  return true;
+size_t alignSection(size_t offset) {
+  return (offset + OCL_BINARY_SECTION_ALIGNMENT - 1) &
+         ~(OCL_BINARY_SECTION_ALIGNMENT - 1);
 }
 
 bool serializeIsExecutable(md_ctx ctx, bool is_executable) {
@@ -182,211 +157,280 @@ bool serializePrintfInfo(
   return true;
 }
 
-bool serializeProgramInfo(md_ctx ctx, const compiler::ProgramInfo &program_info,
-                          bool has_kernel_arg_info) {
-  md_stack stack = md_create_block(ctx, OCL_MD_PROGRAM_INFO_BLOCK);
-  if (!stack) {
+bool serializeOpenCLKernelInfo(md_stack stack, int kernels_arr_idx,
+                               const compiler::KernelInfo &kernel,
+                               bool has_kernel_arg_info) {
+  // Layout
+  // kernel -> [ n_args, has_full_md, [arg_info], [work_widths (x,y,z)],
+  // reqd_sub_group_size, kernel_name ]
+  const int indv_kernel_idx = md_push_array(stack, 6);
+  if (MD_CHECK_ERR(indv_kernel_idx)) {
     return false;
   }
-  int err = md_set_out_fmt(stack, md_fmt::MD_FMT_MSGPACK);
+
+  // number of arguments
+  const int n_args_idx = md_push_uint(stack, kernel.getNumArguments());
+  if (MD_CHECK_ERR(n_args_idx)) {
+    return false;
+  }
+  int err = md_array_append(stack, indv_kernel_idx, n_args_idx);
   if (MD_CHECK_ERR(err)) {
     return false;
   }
+  md_pop(stack);
 
-  // Layout
-  // [[kernel], [kernel], ...]
-  // kernel -> [ n_args, has_full_md, [arg_info], [work_widths (x,y,z)],
-  // kernel_name ]
-
-  const int kernels_arr_idx =
-      md_push_array(stack, program_info.getNumKernels());
-  if (MD_CHECK_ERR(kernels_arr_idx)) {
+  // Full metadata
+  const bool store_arg_metadata = has_kernel_arg_info && kernel.argument_info;
+  const int full_metadata_idx = md_push_uint(stack, store_arg_metadata ? 1 : 0);
+  if (MD_CHECK_ERR(full_metadata_idx)) {
     return false;
   }
-  for (const auto &kernel : program_info) {
-    const int indv_kernel_idx = md_push_array(stack, 5);
-    if (MD_CHECK_ERR(indv_kernel_idx)) {
-      return false;
-    }
+  err = md_array_append(stack, indv_kernel_idx, full_metadata_idx);
+  if (MD_CHECK_ERR(err)) {
+    return false;
+  }
+  md_pop(stack);
 
-    // number of arguments
-    const int n_args_idx = md_push_uint(stack, kernel.getNumArguments());
-    if (MD_CHECK_ERR(n_args_idx)) {
+  // Arg Info
+  const int kernel_arg_arr_idx = md_push_array(stack, kernel.getNumArguments());
+  if (MD_CHECK_ERR(kernel_arg_arr_idx)) {
+    return false;
+  }
+  for (size_t arg_idx = 0, e = kernel.getNumArguments(); arg_idx < e;
+       ++arg_idx) {
+    // argument kind
+    const int arg_kind_idx = md_push_uint(
+        stack, static_cast<uint64_t>(kernel.argument_types[arg_idx].kind));
+    if (MD_CHECK_ERR(arg_kind_idx)) {
       return false;
     }
-    err = md_array_append(stack, indv_kernel_idx, n_args_idx);
+    err = md_array_append(stack, kernel_arg_arr_idx, arg_kind_idx);
     if (MD_CHECK_ERR(err)) {
       return false;
     }
     md_pop(stack);
 
-    // Full metadata
-    const bool store_arg_metadata = has_kernel_arg_info && kernel.argument_info;
-    const int full_metadata_idx =
-        md_push_uint(stack, store_arg_metadata ? 1 : 0);
-    if (MD_CHECK_ERR(full_metadata_idx)) {
+    // address space
+    const int arg_addr_space_idx = md_push_uint(
+        stack,
+        static_cast<uint64_t>(kernel.argument_types[arg_idx].address_space));
+    if (MD_CHECK_ERR(arg_addr_space_idx)) {
       return false;
     }
-    err = md_array_append(stack, indv_kernel_idx, full_metadata_idx);
+    err = md_array_append(stack, kernel_arg_arr_idx, arg_addr_space_idx);
     if (MD_CHECK_ERR(err)) {
       return false;
     }
     md_pop(stack);
 
-    // Arg Info
-    const int kernel_arg_arr_idx =
-        md_push_array(stack, kernel.getNumArguments());
-    if (MD_CHECK_ERR(kernel_arg_arr_idx)) {
-      return false;
-    }
-    for (size_t arg_idx = 0, e = kernel.getNumArguments(); arg_idx < e;
-         ++arg_idx) {
-      // argument kind
-      const int arg_kind_idx = md_push_uint(
-          stack, static_cast<uint64_t>(kernel.argument_types[arg_idx].kind));
-      if (MD_CHECK_ERR(arg_kind_idx)) {
+    if (store_arg_metadata) {
+      const auto &arg_info = kernel.argument_info.value()[arg_idx];
+
+      // address qualifier
+      const int addr_qual_idx = md_push_uint(stack, arg_info.address_qual);
+      if (MD_CHECK_ERR(addr_qual_idx)) {
         return false;
       }
-      err = md_array_append(stack, kernel_arg_arr_idx, arg_kind_idx);
+      err = md_array_append(stack, kernel_arg_arr_idx, addr_qual_idx);
       if (MD_CHECK_ERR(err)) {
         return false;
       }
       md_pop(stack);
 
-      // address space
-      const int arg_addr_space_idx = md_push_uint(
-          stack,
-          static_cast<uint64_t>(kernel.argument_types[arg_idx].address_space));
-      if (MD_CHECK_ERR(arg_addr_space_idx)) {
+      // access qualifier
+      const int access_qualifier =
+          md_push_uint(stack, static_cast<uint64_t>(arg_info.access_qual));
+      if (MD_CHECK_ERR(access_qualifier)) {
         return false;
       }
-      err = md_array_append(stack, kernel_arg_arr_idx, arg_addr_space_idx);
+      err = md_array_append(stack, kernel_arg_arr_idx, access_qualifier);
       if (MD_CHECK_ERR(err)) {
         return false;
       }
       md_pop(stack);
 
-      if (store_arg_metadata) {
-        const auto &arg_info = kernel.argument_info.value()[arg_idx];
-
-        // address qualifier
-        const int addr_qual_idx = md_push_uint(stack, arg_info.address_qual);
-        if (MD_CHECK_ERR(addr_qual_idx)) {
-          return false;
-        }
-        err = md_array_append(stack, kernel_arg_arr_idx, addr_qual_idx);
-        if (MD_CHECK_ERR(err)) {
-          return err;
-        }
-        md_pop(stack);
-
-        // access qualifier
-        const int access_qualifier =
-            md_push_uint(stack, static_cast<uint64_t>(arg_info.access_qual));
-        if (MD_CHECK_ERR(access_qualifier)) {
-          return false;
-        }
-        err = md_array_append(stack, kernel_arg_arr_idx, access_qualifier);
-        if (MD_CHECK_ERR(err)) {
-          return err;
-        }
-        md_pop(stack);
-
-        // arg type qualifier
-        const int arg_type_qual_idx = md_push_uint(stack, arg_info.type_qual);
-        if (MD_CHECK_ERR(arg_type_qual_idx)) {
-          return false;
-        }
-        err = md_array_append(stack, kernel_arg_arr_idx, arg_type_qual_idx);
-        if (MD_CHECK_ERR(err)) {
-          return err;
-        }
-        md_pop(stack);
-
-        // type name
-        const int type_name_idx =
-            md_push_zstr(stack, arg_info.type_name.c_str());
-        if (MD_CHECK_ERR(type_name_idx)) {
-          return false;
-        }
-        err = md_array_append(stack, kernel_arg_arr_idx, type_name_idx);
-        if (MD_CHECK_ERR(err)) {
-          return err;
-        }
-        md_pop(stack);
-
-        // arg name
-        const int arg_name_idx = md_push_zstr(stack, arg_info.name.c_str());
-        if (MD_CHECK_ERR(arg_name_idx)) {
-          return false;
-        }
-        err = md_array_append(stack, kernel_arg_arr_idx, arg_name_idx);
-        if (MD_CHECK_ERR(err)) {
-          return err;
-        }
-        md_pop(stack);
+      // arg type qualifier
+      const int arg_type_qual_idx = md_push_uint(stack, arg_info.type_qual);
+      if (MD_CHECK_ERR(arg_type_qual_idx)) {
+        return false;
       }
-    }
+      err = md_array_append(stack, kernel_arg_arr_idx, arg_type_qual_idx);
+      if (MD_CHECK_ERR(err)) {
+        return false;
+      }
+      md_pop(stack);
 
-    err = md_array_append(stack, indv_kernel_idx, kernel_arg_arr_idx);
-    if (MD_CHECK_ERR(err)) {
-      return false;
-    }
-    md_pop(stack);
+      // type name
+      const int type_name_idx = md_push_zstr(stack, arg_info.type_name.c_str());
+      if (MD_CHECK_ERR(type_name_idx)) {
+        return false;
+      }
+      err = md_array_append(stack, kernel_arg_arr_idx, type_name_idx);
+      if (MD_CHECK_ERR(err)) {
+        return false;
+      }
+      md_pop(stack);
 
-    // work group sizes
-    const int work_size_arr_idx = md_push_array(stack, 3);
-    if (MD_CHECK_ERR(work_size_arr_idx)) {
-      return false;
-    }
-    for (size_t i = 0; i < 3; ++i) {
-      const int work_size_idx =
-          md_push_uint(stack, kernel.getReqdWGSizeOrZero()[i]);
-      if (MD_CHECK_ERR(work_size_idx)) {
+      // arg name
+      const int arg_name_idx = md_push_zstr(stack, arg_info.name.c_str());
+      if (MD_CHECK_ERR(arg_name_idx)) {
         return false;
       }
-      err = md_array_append(stack, work_size_arr_idx, work_size_idx);
+      err = md_array_append(stack, kernel_arg_arr_idx, arg_name_idx);
       if (MD_CHECK_ERR(err)) {
         return false;
       }
       md_pop(stack);
     }
-    err = md_array_append(stack, indv_kernel_idx, work_size_arr_idx);
-    if (MD_CHECK_ERR(err)) {
-      return false;
-    }
-    md_pop(stack);
+  }
 
-    // required sub-group size
-    const int reqd_sub_group_size_idx =
-        md_push_uint(stack, kernel.reqd_sub_group_size.value_or(0));
-    if (MD_CHECK_ERR(reqd_sub_group_size_idx)) {
+  err = md_array_append(stack, indv_kernel_idx, kernel_arg_arr_idx);
+  if (MD_CHECK_ERR(err)) {
+    return false;
+  }
+  md_pop(stack);
+
+  // work group sizes
+  const int work_size_arr_idx = md_push_array(stack, 3);
+  if (MD_CHECK_ERR(work_size_arr_idx)) {
+    return false;
+  }
+  for (size_t i = 0; i < 3; ++i) {
+    const int work_size_idx =
+        md_push_uint(stack, kernel.getReqdWGSizeOrZero()[i]);
+    if (MD_CHECK_ERR(work_size_idx)) {
       return false;
     }
-    err = md_array_append(stack, indv_kernel_idx, reqd_sub_group_size_idx);
+    err = md_array_append(stack, work_size_arr_idx, work_size_idx);
     if (MD_CHECK_ERR(err)) {
       return false;
     }
     md_pop(stack);
+  }
+  err = md_array_append(stack, indv_kernel_idx, work_size_arr_idx);
+  if (MD_CHECK_ERR(err)) {
+    return false;
+  }
+  md_pop(stack);
 
-    // kernel name
-    const int kernel_name_idx = md_push_zstr(stack, kernel.name.c_str());
-    if (MD_CHECK_ERR(kernel_name_idx)) {
-      return false;
-    }
-    err = md_array_append(stack, indv_kernel_idx, kernel_name_idx);
-    if (MD_CHECK_ERR(err)) {
+  // required sub-group size
+  const int reqd_sub_group_size_idx =
+      md_push_uint(stack, kernel.reqd_sub_group_size.value_or(0));
+  if (MD_CHECK_ERR(reqd_sub_group_size_idx)) {
+    return false;
+  }
+  err = md_array_append(stack, indv_kernel_idx, reqd_sub_group_size_idx);
+  if (MD_CHECK_ERR(err)) {
+    return false;
+  }
+  md_pop(stack);
+
+  // kernel name
+  const int kernel_name_idx = md_push_zstr(stack, kernel.name.c_str());
+  if (MD_CHECK_ERR(kernel_name_idx)) {
+    return false;
+  }
+  err = md_array_append(stack, indv_kernel_idx, kernel_name_idx);
+  if (MD_CHECK_ERR(err)) {
+    return false;
+  }
+  md_pop(stack);
+
+  // add the kernel to the array
+  err = md_array_append(stack, kernels_arr_idx, indv_kernel_idx);
+  if (MD_CHECK_ERR(err)) {
+    return false;
+  }
+  md_pop(stack);
+  return true;
+}
+
+bool serializeKernelSection(const compiler::KernelInfo &kernel,
+                            bool has_kernel_arg_info,
+                            cargo::dynamic_array<uint8_t> &section) {
+  OpenCLWriteUserdata cl_userdata{&section, {}, true, nullptr};
+  md_hooks cl_hooks = getOpenCLMetadataWriteHooks();
+
+  auto ctx = md_init_unique(&cl_hooks, &cl_userdata);
+  if (!ctx.get()) {
+    return false;
+  }
+
+  md_stack stack = md_create_block(ctx.get(), OCL_MD_KERNEL_INFO_BLOCK);
+  if (!stack) {
+    return false;
+  }
+  int err = md_set_out_fmt(stack, md_fmt::MD_FMT_MSGPACK);
+  if (MD_CHECK_ERR(err)) {
+    return false;
+  }
+
+  // Layout
+  // [[kernel]], the same as a program info block with a single kernel.
+  const int kernels_arr_idx = md_push_array(stack, 1);
+  if (MD_CHECK_ERR(kernels_arr_idx)) {
+    return false;
+  }
+  if (!serializeOpenCLKernelInfo(stack, kernels_arr_idx, kernel,
+                                 has_kernel_arg_info)) {
+    return false;
+  }
+  err = md_finalize_block(stack);
+  if (MD_CHECK_ERR(err)) {
+    return false;
+  }
+  err = md_finalize_ctx(ctx.get());
+  if (MD_CHECK_ERR(err)) {
+    return false;
+  }
+  return true;
+}
+
+bool serializeSections(
+    md_ctx ctx, size_t sections_size, size_t executable_size,
+    const compiler::ProgramInfo &program_info,
+    cargo::array_view<const size_t> kernel_offsets,
+    cargo::array_view<const cargo::dynamic_array<uint8_t>> kernel_sections) {
+  md_stack stack = md_create_block(ctx, OCL_MD_SECTIONS_BLOCK);
+  if (!stack) {
+    return false;
+  }
+  int err = md_set_out_fmt(stack, md_fmt::MD_FMT_MSGPACK);
+  if (MD_CHECK_ERR(err)) {
+    return false;
+  }
+
+  // Layout
+  // [sections_size, executable_offset, executable_size]
+  // [[kernel_name, kernel_offset, kernel_size], ...]
+  // Offsets are from the start of the sections, which end the binary.
+  err = md_pushf(stack, "[u,u,u]", static_cast<uint64_t>(sections_size),
+                 static_cast<uint64_t>(0),
+                 static_cast<uint64_t>(executable_size));
+  if (MD_CHECK_ERR(err)) {
+    return false;
+  }
+
+  const int kernels_arr_idx = md_push_array(stack, kernel_sections.size());
+  if (MD_CHECK_ERR(kernels_arr_idx)) {
+    return false;
+  }
+  for (size_t kernel_idx = 0; kernel_idx < kernel_sections.size();
+       ++kernel_idx) {
+    const int kernel_idx_v = md_pushf(
+        stack, "[z,u,u]", program_info.getKernel(kernel_idx)->name.c_str(),
+        static_cast<uint64_t>(kernel_offsets[kernel_idx]),
+        static_cast<uint64_t>(kernel_sections[kernel_idx].size()));
+    if (MD_CHECK_ERR(kernel_idx_v)) {
       return false;
     }
-    md_pop(stack);
-
-    // add the kernel to the array
-    err = md_array_append(stack, kernels_arr_idx, indv_kernel_idx);
+    err = md_array_append(stack, kernels_arr_idx, kernel_idx_v);
     if (MD_CHECK_ERR(err)) {
       return false;
     }
     md_pop(stack);
   }
+
   err = md_finalize_block(stack);
   if (MD_CHECK_ERR(err)) {
     return false;
@@ -394,23 +438,116 @@ bool serializeProgramInfo(md_ctx ctx, const compiler::ProgramInfo &program_info,
   return true;
 }
 
-bool deserializeExecutable(md_ctx ctx,
-                           cargo::dynamic_array<uint8_t> &executable) {
-  md_stack executable_stack = md_get_block(ctx, OCL_MD_EXECUTABLE_BLOCK);
-  if (!executable_stack) {
+bool deserializeExecutable(cargo::array_view<const uint8_t> binary,
+                           cargo::array_view<const uint8_t> &executable) {
+  // Binaries without sections store the executable in a raw bytes block, which
+  // is stored verbatim so can also be referenced in place.
+  md::CAMD_Header header;
+  if (!md::utils::decode_md_header(binary.data(), header, binary.size())) {
     return false;
   }
-  size_t exec_len;
-  char *exec_bytes;
-  const int err = md_loadf(executable_stack, "s", &exec_len, &exec_bytes);
-  if (MD_CHECK_ERR(err)) {
+  std::vector<md::CAMD_BlockInfo> infos;
+  if (!md::utils::decode_md_block_info_list(
+          md::utils::get_block_list_start(binary.data(), header), header,
+          infos, binary.size())) {
     return false;
   }
-  if (executable.alloc(exec_len)) {
+  for (const auto &info : infos) {
+    if (std::strcmp(md::utils::get_block_info_name(binary.data(), info),
+                    OCL_MD_EXECUTABLE_BLOCK) != 0) {
+      continue;
+    }
+    const auto fmt = md::utils::get_fmt(info.flags);
+    if (!fmt || fmt.value() != md_fmt::MD_FMT_RAW_BYTES ||
+        info.offset > binary.size() ||
+        info.size > binary.size() - info.offset) {
+      return false;
+    }
+    executable = {md::utils::get_block_start(binary.data(), info), info.size};
+    return true;
+  }
+  return false;
+}
+
+bool deserializeSections(
+    md_ctx ctx, cargo::array_view<const uint8_t> binary,
+    compiler::ProgramInfo &program_info,
+    cargo::dynamic_array<cargo::array_view<const uint8_t>> &kernel_sections,
+    cargo::array_view<const uint8_t> &executable) {
+  md_stack stack = md_get_block(ctx, OCL_MD_SECTIONS_BLOCK);
+  if (!stack) {
     return false;
   }
-  std::memcpy(executable.data(), exec_bytes, exec_len);
-  std::free(exec_bytes);
+
+  auto getUint = [](md_value array, size_t idx, uint64_t &value) {
+    md_value value_v;
+    return !MD_CHECK_ERR(md_get_array_idx(array, idx, &value_v)) &&
+           !MD_CHECK_ERR(md_get_uint(value_v, &value));
+  };
+
+  md_value layout_v = md_get_value(stack, 0);
+  uint64_t sections_size;
+  if (!layout_v || !getUint(layout_v, 0, sections_size) ||
+      sections_size > binary.size()) {
+    return false;
+  }
+  const uint8_t *sections = binary.end() - sections_size;
+  auto getSection = [&](md_value array, size_t idx,
+                        cargo::array_view<const uint8_t> &section) {
+    uint64_t offset;
+    uint64_t size;
+    if (!getUint(array, idx, offset) || !getUint(array, idx + 1, size) ||
+        offset > sections_size || size > sections_size - offset) {
+      return false;
+    }
+    section = {sections + offset, size};
+    return true;
+  };
+  if (!getSection(layout_v, 1, executable)) {
+    return false;
+  }
+
+  md_value kernels_v = md_get_value(stack, 1);
+  if (!kernels_v) {
+    return false;
+  }
+  const int n_kernels = md_get_array_size(kernels_v);
+  if (MD_CHECK_ERR(n_kernels)) {
+    return false;
+  }
+  if (!program_info.resizeFromNumKernels(static_cast<uint32_t>(n_kernels)) ||
+      kernel_sections.alloc(n_kernels)) {
+    return false;
+  }
+
+  // Only the kernel names are read here, everything else is deserialized from
+  // the kernel's section on first use.
+  for (size_t kernel_idx = 0; kernel_idx < static_cast<size_t>(n_kernels);
+       ++kernel_idx) {
+    md_value kernel_v;
+    int err = md_get_array_idx(kernels_v, kernel_idx, &kernel_v);
+    if (MD_CHECK_ERR(err)) {
+      return false;
+    }
+    md_value kernel_name_v;
+    err = md_get_array_idx(kernel_v, 0, &kernel_name_v);
+    if (MD_CHECK_ERR(err)) {
+      return false;
+    }
+    char *kernel_name;
+    size_t kernel_name_len;
+    err = md_get_zstr(kernel_name_v, &kernel_name, &kernel_name_len);
+    if (MD_CHECK_ERR(err)) {
+      return false;
+    }
+    program_info.getKernel(kernel_idx)->name =
+        std::string(kernel_name, kernel_name_len);
+    std::free(kernel_name);
+
+    if (!getSection(kernel_v, 1, kernel_sections[kernel_idx])) {
+      return false;
+    }
+  }
   return true;
 }
 
@@ -518,261 +655,268 @@ bool deserializeOpenCLPrintfCalls(
   return true;
 }
 
-bool deserializeOpenCLProgramInfo(md_ctx ctx,
-                                  compiler::ProgramInfo &program_info) {
-  md_stack stack = md_get_block(ctx, OCL_MD_PROGRAM_INFO_BLOCK);
-  if (!stack) {
+bool deserializeOpenCLKernelInfo(md_value kernels_v, size_t kernel_idx,
+                                  compiler::KernelInfo &kernel_info) {
+  // get the kernel info value
+  md_value kernel_info_v;
+  int err = md_get_array_idx(kernels_v, kernel_idx, &kernel_info_v);
+  if (MD_CHECK_ERR(err)) {
     return false;
   }
 
-  md_value kernels_v = md_get_value(stack, 0);
-  if (!kernels_v) {
+  // number of arguments
+  md_value n_args_v;
+  err = md_get_array_idx(kernel_info_v, 0, &n_args_v);
+  if (MD_CHECK_ERR(err)) {
     return false;
   }
-
-  const int n_kernels = md_get_array_size(kernels_v);
-  if (MD_CHECK_ERR(n_kernels)) {
+  uint64_t numArguments;
+  err = md_get_uint(n_args_v, &numArguments);
+  if (MD_CHECK_ERR(err)) {
     return false;
   }
 
-  if (!program_info.resizeFromNumKernels(static_cast<uint32_t>(n_kernels))) {
+  // has full metadata?
+  md_value full_metadata_v;
+  err = md_get_array_idx(kernel_info_v, 1, &full_metadata_v);
+  if (MD_CHECK_ERR(err)) {
     return false;
   }
-
-  for (size_t kernel_idx = 0; kernel_idx < static_cast<size_t>(n_kernels);
-       ++kernel_idx) {
-    auto *kernelInfo = program_info.getKernel(kernel_idx);
-
-    // get the kernel info value
-    md_value kernel_info_v;
-    int err = md_get_array_idx(kernels_v, kernel_idx, &kernel_info_v);
-    if (MD_CHECK_ERR(err)) {
+  uint64_t full_metadata_int;
+  err = md_get_uint(full_metadata_v, &full_metadata_int);
+  if (MD_CHECK_ERR(err)) {
+    return false;
+  }
+  const bool hasArgMetadata = full_metadata_int == 1;
+  if (hasArgMetadata) {
+    kernel_info.argument_info.emplace();
+    if (kernel_info.argument_info->resize(numArguments)) {
       return false;
     }
+  }
 
-    // number of arguments
-    md_value n_args_v;
-    err = md_get_array_idx(kernel_info_v, 0, &n_args_v);
+  if (kernel_info.argument_types.alloc(numArguments)) {
+    return false;
+  }
+
+  // arg info array
+  md_value arg_info_arr_v;
+  err = md_get_array_idx(kernel_info_v, 2, &arg_info_arr_v);
+  if (MD_CHECK_ERR(err)) {
+    return false;
+  }
+  const int arg_info_array_len = md_get_array_size(arg_info_arr_v);
+  if (MD_CHECK_ERR(arg_info_array_len)) {
+    return false;
+  }
+
+  size_t cur_arg_array_idx = 0;
+  size_t kernel_arg_idx = 0;
+  while (cur_arg_array_idx < static_cast<size_t>(arg_info_array_len)) {
+    // argument kind
+    md_value arg_kind_v;
+    err = md_get_array_idx(arg_info_arr_v, cur_arg_array_idx, &arg_kind_v);
     if (MD_CHECK_ERR(err)) {
       return false;
     }
-    uint64_t numArguments;
-    err = md_get_uint(n_args_v, &numArguments);
+    uint64_t arg_kind;
+    err = md_get_uint(arg_kind_v, &arg_kind);
     if (MD_CHECK_ERR(err)) {
       return false;
     }
-
-    // has full metadata?
-    md_value full_metadata_v;
-    err = md_get_array_idx(kernel_info_v, 1, &full_metadata_v);
+    kernel_info.argument_types[kernel_arg_idx].kind =
+        static_cast<compiler::ArgumentKind>(arg_kind);
+    ++cur_arg_array_idx;
+
+    // arg address space
+    md_value arg_addr_space_v;
+    err = md_get_array_idx(arg_info_arr_v, cur_arg_array_idx,
+                           &arg_addr_space_v);
     if (MD_CHECK_ERR(err)) {
       return false;
     }
-    uint64_t full_metadata_int;
-    err = md_get_uint(full_metadata_v, &full_metadata_int);
+    uint64_t arg_addr_space;
+    err = md_get_uint(arg_addr_space_v, &arg_addr_space);
     if (MD_CHECK_ERR(err)) {
       return false;
     }
-    const bool hasArgMetadata = full_metadata_int == 1;
+    kernel_info.argument_types[kernel_arg_idx].address_space =
+        static_cast<compiler::AddressSpace>(arg_addr_space);
+    ++cur_arg_array_idx;
+
     if (hasArgMetadata) {
-      kernelInfo->argument_info.emplace();
-      if (kernelInfo->argument_info->resize(numArguments)) {
+      auto &arg_info = kernel_info.argument_info.value()[kernel_arg_idx];
+
+      // arg address qualifier
+      md_value arg_address_qual_v;
+      err = md_get_array_idx(arg_info_arr_v, cur_arg_array_idx,
+                             &arg_address_qual_v);
+      if (MD_CHECK_ERR(err)) {
         return false;
       }
-    }
-
-    if (kernelInfo->argument_types.alloc(numArguments)) {
-      return false;
-    }
-
-    // arg info array
-    md_value arg_info_arr_v;
-    err = md_get_array_idx(kernel_info_v, 2, &arg_info_arr_v);
-    if (MD_CHECK_ERR(err)) {
-      return false;
-    }
-    const int arg_info_array_len = md_get_array_size(arg_info_arr_v);
-    if (MD_CHECK_ERR(arg_info_array_len)) {
-      return false;
-    }
+      uint64_t arg_address_qual;
+      err = md_get_uint(arg_address_qual_v, &arg_address_qual);
+      if (MD_CHECK_ERR(err)) {
+        return false;
+      }
+      arg_info.address_qual =
+          static_cast<compiler::AddressSpace>(arg_address_qual);
+      ++cur_arg_array_idx;
 
-    size_t cur_arg_array_idx = 0;
-    size_t kernel_arg_idx = 0;
-    while (cur_arg_array_idx < static_cast<size_t>(arg_info_array_len)) {
-      // argument kind
-      md_value arg_kind_v;
-      err = md_get_array_idx(arg_info_arr_v, cur_arg_array_idx, &arg_kind_v);
+      // arg access qualifier
+      md_value arg_access_qual_v;
+      err = md_get_array_idx(arg_info_arr_v, cur_arg_array_idx,
+                             &arg_access_qual_v);
       if (MD_CHECK_ERR(err)) {
         return false;
       }
-      uint64_t arg_kind;
-      err = md_get_uint(arg_kind_v, &arg_kind);
+      uint64_t arg_access_qual;
+      err = md_get_uint(arg_access_qual_v, &arg_access_qual);
       if (MD_CHECK_ERR(err)) {
         return false;
       }
-      kernelInfo->argument_types[kernel_arg_idx].kind =
-          static_cast<compiler::ArgumentKind>(arg_kind);
+      arg_info.access_qual =
+          static_cast<compiler::KernelArgAccess>(arg_access_qual);
       ++cur_arg_array_idx;
 
-      // arg address space
-      md_value arg_addr_space_v;
+      // arg type qualifier
+      md_value arg_type_qual_v;
       err = md_get_array_idx(arg_info_arr_v, cur_arg_array_idx,
-                             &arg_addr_space_v);
+                             &arg_type_qual_v);
       if (MD_CHECK_ERR(err)) {
         return false;
       }
-      uint64_t arg_addr_space;
-      err = md_get_uint(arg_addr_space_v, &arg_addr_space);
+      uint64_t arg_type_qual;
+      err = md_get_uint(arg_type_qual_v, &arg_type_qual);
       if (MD_CHECK_ERR(err)) {
         return false;
       }
-      kernelInfo->argument_types[kernel_arg_idx].address_space =
-          static_cast<compiler::AddressSpace>(arg_addr_space);
+      arg_info.type_qual =
+          static_cast<cl_kernel_arg_type_qualifier>(arg_type_qual);
       ++cur_arg_array_idx;
 
-      if (hasArgMetadata) {
-        auto &arg_info = kernelInfo->argument_info.value()[kernel_arg_idx];
-
-        // arg address qualifier
-        md_value arg_address_qual_v;
-        err = md_get_array_idx(arg_info_arr_v, cur_arg_array_idx,
-                               &arg_address_qual_v);
-        if (MD_CHECK_ERR(err)) {
-          return false;
-        }
-        uint64_t arg_address_qual;
-        err = md_get_uint(arg_address_qual_v, &arg_address_qual);
-        if (MD_CHECK_ERR(err)) {
-          return false;
-        }
-        arg_info.address_qual =
-            static_cast<compiler::AddressSpace>(arg_address_qual);
-        ++cur_arg_array_idx;
-
-        // arg access qualifier
-        md_value arg_access_qual_v;
-        err = md_get_array_idx(arg_info_arr_v, cur_arg_array_idx,
-                               &arg_access_qual_v);
-        if (MD_CHECK_ERR(err)) {
-          return false;
-        }
-        uint64_t arg_access_qual;
-        err = md_get_uint(arg_access_qual_v, &arg_access_qual);
-        if (MD_CHECK_ERR(err)) {
-          return false;
-        }
-        arg_info.access_qual =
-            static_cast<compiler::KernelArgAccess>(arg_access_qual);
-        ++cur_arg_array_idx;
-
-        // arg type qualifier
-        md_value arg_type_qual_v;
-        err = md_get_array_idx(arg_info_arr_v, cur_arg_array_idx,
-                               &arg_type_qual_v);
-        if (MD_CHECK_ERR(err)) {
-          return false;
-        }
-        uint64_t arg_type_qual;
-        err = md_get_uint(arg_type_qual_v, &arg_type_qual);
-        if (MD_CHECK_ERR(err)) {
-          return false;
-        }
-        arg_info.type_qual =
-            static_cast<cl_kernel_arg_type_qualifier>(arg_type_qual);
-        ++cur_arg_array_idx;
-
-        // arg type name
-        md_value arg_type_name_v;
-        err = md_get_array_idx(arg_info_arr_v, cur_arg_array_idx,
-                               &arg_type_name_v);
-        if (MD_CHECK_ERR(err)) {
-          return false;
-        }
-        char *type_name;
-        size_t type_name_len;
-        err = md_get_zstr(arg_type_name_v, &type_name, &type_name_len);
-        if (MD_CHECK_ERR(err)) {
-          return false;
-        }
-        arg_info.type_name = std::string(type_name, type_name_len);
-        std::free(type_name);
-        ++cur_arg_array_idx;
-
-        // arg name
-        md_value arg_name_v;
-        err = md_get_array_idx(arg_info_arr_v, cur_arg_array_idx, &arg_name_v);
-        if (MD_CHECK_ERR(err)) {
-          return false;
-        }
-        char *arg_name;
-        size_t arg_name_len;
-        err = md_get_zstr(arg_name_v, &arg_name, &arg_name_len);
-        if (MD_CHECK_ERR(err)) {
-          return false;
-        }
-        arg_info.name = std::string(arg_name, arg_name_len);
-        std::free(arg_name);
-        ++cur_arg_array_idx;
+      // arg type name
+      md_value arg_type_name_v;
+      err = md_get_array_idx(arg_info_arr_v, cur_arg_array_idx,
+                             &arg_type_name_v);
+      if (MD_CHECK_ERR(err)) {
+        return false;
       }
-      ++kernel_arg_idx;
-    }
+      char *type_name;
+      size_t type_name_len;
+      err = md_get_zstr(arg_type_name_v, &type_name, &type_name_len);
+      if (MD_CHECK_ERR(err)) {
+        return false;
+      }
+      arg_info.type_name = std::string(type_name, type_name_len);
+      std::free(type_name);
+      ++cur_arg_array_idx;
 
-    // work group sizes
-    md_value work_size_arr_v;
-    err = md_get_array_idx(kernel_info_v, 3, &work_size_arr_v);
-    if (MD_CHECK_ERR(err)) {
-      return false;
-    }
-    std::array<size_t, 3> reqd_wg_size;
-    for (size_t j = 0; j < 3; ++j) {
-      md_value work_size_v;
-      err = md_get_array_idx(work_size_arr_v, j, &work_size_v);
+      // arg name
+      md_value arg_name_v;
+      err = md_get_array_idx(arg_info_arr_v, cur_arg_array_idx, &arg_name_v);
       if (MD_CHECK_ERR(err)) {
         return false;
       }
-      uint64_t work_size;
-      err = md_get_uint(work_size_v, &work_size);
+      char *arg_name;
+      size_t arg_name_len;
+      err = md_get_zstr(arg_name_v, &arg_name, &arg_name_len);
       if (MD_CHECK_ERR(err)) {
         return false;
       }
-      reqd_wg_size[j] = work_size;
-    }
-    if (!std::all_of(reqd_wg_size.begin(), reqd_wg_size.end(),
-                     [](size_t v) { return v == 0; })) {
-      kernelInfo->reqd_work_group_size = reqd_wg_size;
+      arg_info.name = std::string(arg_name, arg_name_len);
+      std::free(arg_name);
+      ++cur_arg_array_idx;
     }
+    ++kernel_arg_idx;
+  }
 
-    // required sub-group size
+  // work group sizes
+  md_value work_size_arr_v;
+  err = md_get_array_idx(kernel_info_v, 3, &work_size_arr_v);
+  if (MD_CHECK_ERR(err)) {
+    return false;
+  }
+  std::array<size_t, 3> reqd_wg_size;
+  for (size_t j = 0; j < 3; ++j) {
     md_value work_size_v;
-    err = md_get_array_idx(kernel_info_v, 4, &work_size_v);
+    err = md_get_array_idx(work_size_arr_v, j, &work_size_v);
     if (MD_CHECK_ERR(err)) {
       return false;
     }
-
-    uint64_t reqd_sub_group_size;
-    err = md_get_uint(work_size_v, &reqd_sub_group_size);
+    uint64_t work_size;
+    err = md_get_uint(work_size_v, &work_size);
     if (MD_CHECK_ERR(err)) {
       return false;
     }
+    reqd_wg_size[j] = work_size;
+  }
+  if (!std::all_of(reqd_wg_size.begin(), reqd_wg_size.end(),
+                   [](size_t v) { return v == 0; })) {
+    kernel_info.reqd_work_group_size = reqd_wg_size;
+  }
 
-    if (reqd_sub_group_size) {
-      kernelInfo->reqd_sub_group_size = reqd_sub_group_size;
-    }
+  // required sub-group size
+  md_value work_size_v;
+  err = md_get_array_idx(kernel_info_v, 4, &work_size_v);
+  if (MD_CHECK_ERR(err)) {
+    return false;
+  }
 
-    // kernel name
-    md_value kernel_name_v;
-    err = md_get_array_idx(kernel_info_v, 5, &kernel_name_v);
-    if (MD_CHECK_ERR(err)) {
-      return false;
-    }
-    char *kernel_name;
-    size_t kernel_name_len;
-    err = md_get_zstr(kernel_name_v, &kernel_name, &kernel_name_len);
-    if (MD_CHECK_ERR(err)) {
+  uint64_t reqd_sub_group_size;
+  err = md_get_uint(work_size_v, &reqd_sub_group_size);
+  if (MD_CHECK_ERR(err)) {
+    return false;
+  }
+
+  if (reqd_sub_group_size) {
+    kernel_info.reqd_sub_group_size = reqd_sub_group_size;
+  }
+
+  // kernel name
+  md_value kernel_name_v;
+  err = md_get_array_idx(kernel_info_v, 5, &kernel_name_v);
+  if (MD_CHECK_ERR(err)) {
+    return false;
+  }
+  char *kernel_name;
+  size_t kernel_name_len;
+  err = md_get_zstr(kernel_name_v, &kernel_name, &kernel_name_len);
+  if (MD_CHECK_ERR(err)) {
+    return false;
+  }
+  kernel_info.name = std::string(kernel_name, kernel_name_len);
+  std::free(kernel_name);
+  return true;
+}
+
+bool deserializeOpenCLProgramInfo(md_ctx ctx,
+                                  compiler::ProgramInfo &program_info) {
+  md_stack stack = md_get_block(ctx, OCL_MD_PROGRAM_INFO_BLOCK);
+  if (!stack) {
+    return false;
+  }
+
+  md_value kernels_v = md_get_value(stack, 0);
+  if (!kernels_v) {
+    return false;
+  }
+
+  const int n_kernels = md_get_array_size(kernels_v);
+  if (MD_CHECK_ERR(n_kernels)) {
+    return false;
+  }
+
+  if (!program_info.resizeFromNumKernels(static_cast<uint32_t>(n_kernels))) {
+    return false;
+  }
+
+  for (size_t kernel_idx = 0; kernel_idx < static_cast<size_t>(n_kernels);
+       ++kernel_idx) {
+    if (!deserializeOpenCLKernelInfo(kernels_v, kernel_idx,
+                                     *program_info.getKernel(kernel_idx))) {
       return false;
     }
-    kernelInfo->name = std::string(kernel_name, kernel_name_len);
-    std::free(kernel_name);
   }
   return true;
 }
@@ -831,7 +975,40 @@ bool serializeBinary(
     const compiler::ProgramInfo &program_info, bool kernel_arg_info,
     compiler::Module *compiler_module) {
   const bool is_executable = compiler_module == nullptr;
-  OpenCLWriteUserdata cl_userdata{&binary, mux_binary, is_executable,
+
+  // The first section is the executable, or the serialized compiler module if
+  // the program isn't executable yet.
+  cargo::dynamic_array<uint8_t> module_buffer;
+  cargo::array_view<const uint8_t> executable = mux_binary;
+  if (!is_executable) {
+    if (module_buffer.alloc(compiler_module->size())) {
+      return false;
+    }
+    compiler_module->serialize(module_buffer.data());
+    executable = {module_buffer.data(), module_buffer.size()};
+  }
+
+  // Followed by a section holding the metadata of each kernel, so the runtime
+  // only needs to deserialize the kernels which are used.
+  cargo::dynamic_array<cargo::dynamic_array<uint8_t>> kernel_sections;
+  cargo::dynamic_array<size_t> kernel_offsets;
+  const size_t num_kernels = is_executable ? program_info.getNumKernels() : 0;
+  if (kernel_sections.alloc(num_kernels) || kernel_offsets.alloc(num_kernels)) {
+    return false;
+  }
+  size_t sections_size = executable.size();
+  for (size_t kernel_idx = 0; kernel_idx < num_kernels; ++kernel_idx) {
+    if (!serializeKernelSection(*program_info.getKernel(kernel_idx),
+                                kernel_arg_info, kernel_sections[kernel_idx])) {
+      return false;
+    }
+    kernel_offsets[kernel_idx] = alignSection(sections_size);
+    sections_size =
+        kernel_offsets[kernel_idx] + kernel_sections[kernel_idx].size();
+  }
+
+  cargo::dynamic_array<uint8_t> metadata;
+  OpenCLWriteUserdata cl_userdata{&metadata, mux_binary, is_executable,
                                   compiler_module};
   md_hooks cl_hooks = getOpenCLMetadataWriteHooks();
 
@@ -840,7 +1017,8 @@ bool serializeBinary(
     return false;
   }
 
-  if (!serializeExecutable(&cl_userdata, ctx.get())) {
+  if (!serializeSections(ctx.get(), sections_size, executable.size(),
+                         program_info, kernel_offsets, kernel_sections)) {
     return false;
   }
 
@@ -852,21 +1030,34 @@ bool serializeBinary(
     if (!serializePrintfInfo(ctx.get(), printf_calls)) {
       return false;
     }
-
-    if (!serializeProgramInfo(ctx.get(), program_info, kernel_arg_info)) {
-      return false;
-    }
   }
 
   md_finalize_ctx(ctx.get());
+
+  // The sections end the binary, starting at an aligned offset after the
+  // metadata.
+  const size_t sections_offset = alignSection(metadata.size());
+  if (binary.alloc(sections_offset + sections_size)) {
+    return false;
+  }
+  std::fill(binary.begin(), binary.end(), 0);
+  std::copy(metadata.begin(), metadata.end(), binary.begin());
+  uint8_t *sections = binary.data() + sections_offset;
+  std::copy(executable.begin(), executable.end(), sections);
+  for (size_t kernel_idx = 0; kernel_idx < num_kernels; ++kernel_idx) {
+    std::copy(kernel_sections[kernel_idx].begin(),
+              kernel_sections[kernel_idx].end(),
+              sections + kernel_offsets[kernel_idx]);
+  }
   return true;
 }
 
-bool deserializeBinary(cargo::array_view<const uint8_t> binary,
-                       std::vector<builtins::printf::descriptor> &printf_calls,
-                       compiler::ProgramInfo &program_info,
-                       cargo::dynamic_array<uint8_t> &executable,
-                       bool &is_executable) {
+bool deserializeBinary(
+    cargo::array_view<const uint8_t> binary,
+    std::vector<builtins::printf::descriptor> &printf_calls,
+    compiler::ProgramInfo &program_info,
+    cargo::dynamic_array<cargo::array_view<const uint8_t>> &kernel_sections,
+    cargo::array_view<const uint8_t> &executable, bool &is_executable) {
   OpenCLReadUserdata cl_userdata{binary};
   md_hooks cl_hooks = getOpenCLMetadataReadHooks();
 
@@ -875,22 +1066,36 @@ bool deserializeBinary(cargo::array_view<const uint8_t> binary,
     return false;
   }
 
-  if (!deserializeExecutable(ctx.get(), executable)) {
-    return false;
-  }
-
   auto is_executable_result = deserializeIsExecutable(ctx.get());
   if (!is_executable_result.has_value()) {
     return false;
   }
   is_executable = is_executable_result.value();
 
-  if (is_executable_result.value()) {
-    if (!deserializeOpenCLPrintfCalls(ctx.get(), printf_calls)) {
+  // Binaries which predate sections store everything in the metadata.
+  if (!md_get_block(ctx.get(), OCL_MD_SECTIONS_BLOCK)) {
+    if (!deserializeExecutable(binary, executable)) {
       return false;
     }
+    if (is_executable) {
+      if (!deserializeOpenCLPrintfCalls(ctx.get(), printf_calls)) {
+        return false;
+      }
 
-    if (!deserializeOpenCLProgramInfo(ctx.get(), program_info)) {
+      if (!deserializeOpenCLProgramInfo(ctx.get(), program_info)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  if (!deserializeSections(ctx.get(), binary, program_info, kernel_sections,
+                           executable)) {
+    return false;
+  }
+
+  if (is_executable) {
+    if (!deserializeOpenCLPrintfCalls(ctx.get(), printf_calls)) {
       return false;
     }
   }
@@ -898,6 +1103,27 @@ bool deserializeBinary(cargo::array_view<const uint8_t> binary,
   return true;
 }
 
+bool deserializeKernelInfo(cargo::array_view<const uint8_t> section,
+                           compiler::KernelInfo &kernel_info) {
+  OpenCLReadUserdata cl_userdata{section};
+  md_hooks cl_hooks = getOpenCLMetadataReadHooks();
+
+  auto ctx = md_init_unique(&cl_hooks, &cl_userdata);
+  if (!ctx.get()) {
+    return false;
+  }
+
+  md_stack stack = md_get_block(ctx.get(), OCL_MD_KERNEL_INFO_BLOCK);
+  if (!stack) {
+    return false;
+  }
+  md_value kernels_v = md_get_value(stack, 0);
+  if (!kernels_v) {
+    return false;
+  }
+  return deserializeOpenCLKernelInfo(kernels_v, 0, kernel_info);
+}
+
 md_hooks getOpenCLMetadataWriteHooks() {
   md_hooks cl_hooks{};
   cl_hooks.write = [](void *userdata, const void *data, size_t n) -> md_err {
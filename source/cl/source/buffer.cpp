@@ -327,6 +327,7 @@ CL_API_ENTRY cl_int CL_API_CALL cl::EnqueueWriteBufferRect(
     cl_uint num_events_in_wait_list, const cl_event *event_wait_list,
     cl_event *event) {
   const tracer::TraceGuard<tracer::OpenCL> guard("clEnqueueWriteBufferRect");
+  const tracer::FlowGuard<tracer::OpenCL> flow("clEnqueueWriteBufferRect");
   OCL_CHECK(!command_queue, return CL_INVALID_COMMAND_QUEUE);
   OCL_CHECK(!buffer, return CL_INVALID_MEM_OBJECT);
   OCL_CHECK(!buffer_origin || !host_origin || !region || !ptr,
@@ -472,6 +473,7 @@ CL_API_ENTRY cl_int CL_API_CALL cl::EnqueueReadBufferRect(
     cl_uint num_events_in_wait_list, const cl_event *event_wait_list,
     cl_event *event) {
   const tracer::TraceGuard<tracer::OpenCL> guard("clEnqueueReadBufferRect");
+  const tracer::FlowGuard<tracer::OpenCL> flow("clEnqueueReadBufferRect");
   OCL_CHECK(!command_queue, return CL_INVALID_COMMAND_QUEUE);
   OCL_CHECK(!buffer, return CL_INVALID_MEM_OBJECT);
   OCL_CHECK(!buffer_origin || !host_origin || !region || !ptr,
@@ -615,6 +617,7 @@ CL_API_ENTRY cl_int CL_API_CALL cl::EnqueueCopyBufferRect(
     size_t dst_slice_pitch, cl_uint num_events_in_wait_list,
     const cl_event *event_wait_list, cl_event *event) {
   const tracer::TraceGuard<tracer::OpenCL> guard("clEnqueueCopyBufferRect");
+  const tracer::FlowGuard<tracer::OpenCL> flow("clEnqueueCopyBufferRect");
 
   // Set pitch defaults if needed before we validate.
   if (src_row_pitch == 0) {
@@ -833,6 +836,7 @@ cl::EnqueueWriteBuffer(cl_command_queue command_queue, cl_mem buffer,
                        const void *ptr, cl_uint num_events_in_wait_list,
                        const cl_event *event_wait_list, cl_event *event) {
   const tracer::TraceGuard<tracer::OpenCL> guard("clEnqueueWriteBuffer");
+  const tracer::FlowGuard<tracer::OpenCL> flow("clEnqueueWriteBuffer");
   OCL_CHECK(!command_queue, return CL_INVALID_COMMAND_QUEUE);
   OCL_CHECK(!buffer, return CL_INVALID_MEM_OBJECT);
   OCL_CHECK(!(command_queue->context), return CL_INVALID_CONTEXT);
@@ -920,6 +924,7 @@ CL_API_ENTRY cl_int CL_API_CALL cl::EnqueueReadBuffer(
     size_t offset, size_t size, void *ptr, cl_uint num_events_in_wait_list,
     const cl_event *event_wait_list, cl_event *event) {
   const tracer::TraceGuard<tracer::OpenCL> guard("clEnqueueReadBuffer");
+  const tracer::FlowGuard<tracer::OpenCL> flow("clEnqueueReadBuffer");
   OCL_CHECK(!command_queue, return CL_INVALID_COMMAND_QUEUE);
   OCL_CHECK(!buffer, return CL_INVALID_MEM_OBJECT);
   OCL_CHECK(!(command_queue->context), return CL_INVALID_CONTEXT);
@@ -1004,6 +1009,7 @@ cl::EnqueueCopyBuffer(cl_command_queue command_queue, cl_mem src_buffer,
                       size_t size, cl_uint num_events_in_wait_list,
                       const cl_event *event_wait_list, cl_event *event) {
   const tracer::TraceGuard<tracer::OpenCL> guard("clEnqueueCopyBuffer");
+  const tracer::FlowGuard<tracer::OpenCL> flow("clEnqueueCopyBuffer");
   OCL_CHECK(!command_queue, return CL_INVALID_COMMAND_QUEUE);
 
   cl_int error = cl::validate::CopyBufferArguments(
@@ -1076,6 +1082,7 @@ cl::EnqueueFillBuffer(cl_command_queue command_queue, cl_mem buffer,
                       size_t size, cl_uint num_events_in_wait_list,
                       const cl_event *event_wait_list, cl_event *event) {
   const tracer::TraceGuard<tracer::OpenCL> guard("clEnqueueFillBuffer");
+  const tracer::FlowGuard<tracer::OpenCL> flow("clEnqueueFillBuffer");
   OCL_CHECK(!command_queue, return CL_INVALID_COMMAND_QUEUE);
   cl_int error = cl::validate::FillBufferArguments(
       command_queue, buffer, pattern, pattern_size, offset, size);
@@ -23,6 +23,7 @@
 #include <cl/limits.h>
 #include <cl/macros.h>
 #include <cl/platform.h>
+#include <cl/printf.h>
 #include <cl/validate.h>
 #include <compiler/context.h>
 #include <compiler/limits.h>
@@ -184,6 +185,7 @@ _cl_device_id::_cl_device_id(cl_platform_id platform,
                     1, 16)
               : 0),
       printf_buffer_size(compiler::PRINTF_BUFFER_SIZE),
+      printf_buffer_pool(new printf_buffer_pool_t(this)),
       preferred_interop_user_sync(CL_TRUE),
       profile(),
       profiling_timer_resolution(5),  // Get from Mux?
@@ -217,7 +219,8 @@ _cl_device_id::_cl_device_id(cl_platform_id platform,
       pipe_max_packet_size(0),
       max_global_variable_size(0),
       global_variable_prefered_total_size(0),
-      non_uniform_work_group_support(0),
+      non_uniform_work_group_support(
+          mux_device->info->supports_non_uniform_work_groups),
       max_read_write_image_args(0),
       image_pitch_alignment(0),
       image_base_address_alignment(0),
@@ -338,6 +341,7 @@ _cl_device_id::_cl_device_id(cl_platform_id platform,
 }
 
 _cl_device_id::~_cl_device_id() {
+  printf_buffer_pool.reset();
   muxDestroyDevice(mux_device, mux_allocator);
   cl::releaseInternal(platform);
 }
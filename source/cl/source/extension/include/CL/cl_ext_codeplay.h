@@ -37,6 +37,49 @@ typedef CL_API_ENTRY cl_int(CL_API_CALL *clSetKernelExecInfoCODEPLAY_fn)(
     size_t param_value_size,
     const void *param_value) CL_API_SUFFIX__VERSION_1_2;
 
+/*********************************
+ * cl_codeplay_indirect_dispatch *
+ *********************************/
+
+/// @brief Enqueue a kernel whose work-group counts are read from a buffer when
+/// the command executes, rather than being fixed at enqueue time.
+///
+/// @param[in] command_queue A valid host command-queue.
+/// @param[in] kernel A valid kernel object.
+/// @param[in] work_dim The number of dimensions used to specify the work-items
+/// in the work-group.
+/// @param[in] local_work_size Array of work_dim unsigned values that describe
+/// the number of work-items that make up a work-group, may be NULL.
+/// @param[in] indirect_buffer Buffer containing three cl_uint work-group
+/// counts, counts past work_dim are ignored. The global work size of each
+/// dimension is its work-group count multiplied by its local work size.
+/// @param[in] indirect_offset Byte offset of the work-group counts into
+/// indirect_buffer, must be a multiple of four.
+/// @param[in] num_events_in_wait_list Number of events in event_wait_list.
+/// @param[in] event_wait_list Events that need to complete before this
+/// command can be executed.
+/// @param[out] event Returns an event object that identifies this command, may
+/// be NULL.
+///
+/// @return CL_SUCCESS if the function is executed successfully.
+/// Otherwise, it returns the errors of clEnqueueNDRangeKernel or:
+/// * CL_INVALID_OPERATION if the device does not support the extension.
+/// * CL_INVALID_MEM_OBJECT if indirect_buffer is not a valid buffer object.
+/// * CL_INVALID_VALUE if indirect_offset is not a multiple of four or the
+/// work-group counts are out of the bounds of indirect_buffer.
+extern CL_API_ENTRY cl_int CL_API_CALL clEnqueueNDRangeKernelIndirectCODEPLAY(
+    cl_command_queue command_queue, cl_kernel kernel, cl_uint work_dim,
+    const size_t *local_work_size, cl_mem indirect_buffer,
+    size_t indirect_offset, cl_uint num_events_in_wait_list,
+    const cl_event *event_wait_list, cl_event *event);
+
+typedef CL_API_ENTRY cl_int(
+    CL_API_CALL *clEnqueueNDRangeKernelIndirectCODEPLAY_fn)(
+    cl_command_queue command_queue, cl_kernel kernel, cl_uint work_dim,
+    const size_t *local_work_size, cl_mem indirect_buffer,
+    size_t indirect_offset, cl_uint num_events_in_wait_list,
+    const cl_event *event_wait_list, cl_event *event);
+
 /************************************
  * cl_codeplay_performance_counter   *
  ************************************/
@@ -140,6 +183,30 @@ typedef struct cl_performance_counter_result_codeplay {
   };
 } cl_performance_counter_result_codeplay;
 
+/************************************
+ * cl_codeplay_extra_build_options   *
+ ************************************/
+
+/// @brief Accepted as `param_name` parameter to `clGetProgramBuildInfo`.
+///
+/// Returns a `cl_program_build_profile_entry_codeplay[]` describing the time
+/// spent in each stage of building the program for the device, if it was
+/// built with the `-cl-build-profile` option, and no entries otherwise.
+#define CL_PROGRAM_BUILD_PROFILE_CODEPLAY 0x4263
+
+/// @brief Describes the time spent in a stage of building a program.
+typedef struct cl_program_build_profile_entry_codeplay {
+  /// @brief Defines the name of the stage, truncated to fit.
+  char name[256];
+  /// @brief Defines the nesting depth of the stage, top-level stages have a
+  /// depth of zero and each stage is followed by the stages nested within it.
+  cl_uint depth;
+  /// @brief Defines the number of times the stage ran.
+  cl_ulong count;
+  /// @brief Defines the total time spent in the stage, in nanoseconds.
+  cl_ulong duration;
+} cl_program_build_profile_entry_codeplay;
+
 /******************
  * cl_codeplay_wfv *
  ******************/
@@ -147,6 +214,10 @@ typedef struct cl_performance_counter_result_codeplay {
 /// @brief Accepted as `param_name` parameter to `clGetKernelWFVInfoCODEPLAY`.
 #define CL_KERNEL_WFV_STATUS_CODEPLAY 0x1
 #define CL_KERNEL_WFV_WIDTHS_CODEPLAY 0x2
+/// @brief Returns a `char[]` naming the vectorization configuration selected by
+/// autotuning for the local size, or an empty string if autotuning is disabled
+/// or has not yet made a decision.
+#define CL_KERNEL_WFV_TUNING_DECISION_CODEPLAY 0x3
 
 /// @brief Indicates that whole function vectorization succeeded.
 #define CL_WFV_SUCCESS_CODEPLAY 0
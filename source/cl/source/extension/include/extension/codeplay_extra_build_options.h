@@ -32,6 +32,12 @@ class codeplay_extra_build_options final : public extension {
  public:
   /// @brief Default constructor.
   codeplay_extra_build_options();
+
+  /// @copydoc extension::extension::GetProgramBuildInfo
+  cl_int GetProgramBuildInfo(cl_program program, cl_device_id device,
+                             cl_program_build_info param_name,
+                             size_t param_value_size, void *param_value,
+                             size_t *param_value_size_ret) const override;
 };
 
 /// @}
@@ -14,8 +14,15 @@
 //
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
+#include <CL/cl_ext_codeplay.h>
+#include <cl/context.h>
+#include <cl/macros.h>
+#include <cl/program.h>
 #include <extension/codeplay_extra_build_options.h>
 
+#include <cstring>
+#include <mutex>
+
 extension::codeplay_extra_build_options::codeplay_extra_build_options()
     : extension("cl_codeplay_extra_build_options",
 #ifdef OCL_EXTENSION_cl_codeplay_extra_build_options
@@ -25,3 +32,44 @@ extension::codeplay_extra_build_options::codeplay_extra_build_options()
 #endif
                     CA_CL_EXT_VERSION(0, 6, 0)) {
 }
+
+cl_int extension::codeplay_extra_build_options::GetProgramBuildInfo(
+    cl_program program, cl_device_id device, cl_program_build_info param_name,
+    size_t param_value_size, void *param_value,
+    size_t *param_value_size_ret) const {
+#ifdef OCL_EXTENSION_cl_codeplay_extra_build_options
+  if (CL_PROGRAM_BUILD_PROFILE_CODEPLAY == param_name) {
+    std::vector<compiler::BuildProfileEntry> profile;
+    {
+      const std::lock_guard<std::mutex> guard(program->context->mutex);
+      auto it = program->programs.find(device);
+      if (it != program->programs.end() &&
+          it->second.type == cl::device_program_type::COMPILER_MODULE) {
+        profile = it->second.compiler_module.module->getBuildProfile();
+      }
+    }
+
+    const size_t value_size =
+        sizeof(cl_program_build_profile_entry_codeplay) * profile.size();
+    OCL_SET_IF_NOT_NULL(param_value_size_ret, value_size);
+    if (param_value) {
+      OCL_CHECK(param_value_size < value_size, return CL_INVALID_VALUE);
+      auto entries =
+          static_cast<cl_program_build_profile_entry_codeplay *>(param_value);
+      for (size_t index = 0; index < profile.size(); index++) {
+        const auto &stage = profile[index];
+        const size_t name_size = sizeof(entries[index].name);
+        std::strncpy(entries[index].name, stage.name.c_str(), name_size - 1);
+        entries[index].name[name_size - 1] = '\0';
+        entries[index].depth = stage.depth;
+        entries[index].count = stage.count;
+        entries[index].duration = stage.duration;
+      }
+    }
+    return CL_SUCCESS;
+  }
+#endif
+  return extension::GetProgramBuildInfo(program, device, param_name,
+                                        param_value_size, param_value,
+                                        param_value_size_ret);
+}
@@ -0,0 +1,85 @@
+// Copyright (C) Codeplay Software Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+// Exceptions; you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://github.com/codeplaysoftware/oneapi-construction-kit/blob/main/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <CL/cl_ext_codeplay.h>
+#include <cl/device.h>
+#include <cl/kernel.h>
+#include <extension/codeplay_indirect_dispatch.h>
+
+#include <cstring>
+
+extension::codeplay_indirect_dispatch::codeplay_indirect_dispatch()
+    : extension("cl_codeplay_indirect_dispatch",
+#ifdef OCL_EXTENSION_cl_codeplay_indirect_dispatch
+                usage_category::DEVICE
+#else
+                usage_category::DISABLED
+#endif
+                    CA_CL_EXT_VERSION(0, 1, 0)) {
+}
+
+void *
+extension::codeplay_indirect_dispatch::GetExtensionFunctionAddressForPlatform(
+    cl_platform_id platform, const char *func_name) const {
+  OCL_UNUSED(platform);
+#ifndef OCL_EXTENSION_cl_codeplay_indirect_dispatch
+  OCL_UNUSED(func_name);
+  return nullptr;
+#else
+  OCL_CHECK(nullptr == func_name, return nullptr);
+  if (0 == std::strcmp("clEnqueueNDRangeKernelIndirectCODEPLAY", func_name)) {
+    return (void *)&clEnqueueNDRangeKernelIndirectCODEPLAY;
+  }
+  return nullptr;
+#endif
+}
+
+cl_int extension::codeplay_indirect_dispatch::GetDeviceInfo(
+    cl_device_id device, cl_device_info param_name, size_t param_value_size,
+    void *param_value, size_t *param_value_size_ret) const {
+#ifdef OCL_EXTENSION_cl_codeplay_indirect_dispatch
+  // Don't report the extension in `CL_DEVICE_EXTENSIONS` for devices which
+  // can't read the work-group counts from a buffer.
+  if (!device->mux_device->info->supports_indirect_ndrange) {
+    return CL_INVALID_DEVICE;
+  }
+#endif
+  return extension::GetDeviceInfo(device, param_name, param_value_size,
+                                  param_value, param_value_size_ret);
+}
+
+cl_int CL_API_CALL clEnqueueNDRangeKernelIndirectCODEPLAY(
+    cl_command_queue command_queue, cl_kernel kernel, cl_uint work_dim,
+    const size_t *local_work_size, cl_mem indirect_buffer,
+    size_t indirect_offset, cl_uint num_events_in_wait_list,
+    const cl_event *event_wait_list, cl_event *event) {
+#ifndef OCL_EXTENSION_cl_codeplay_indirect_dispatch
+  OCL_UNUSED(command_queue);
+  OCL_UNUSED(kernel);
+  OCL_UNUSED(work_dim);
+  OCL_UNUSED(local_work_size);
+  OCL_UNUSED(indirect_buffer);
+  OCL_UNUSED(indirect_offset);
+  OCL_UNUSED(num_events_in_wait_list);
+  OCL_UNUSED(event_wait_list);
+  OCL_UNUSED(event);
+  return CL_INVALID_OPERATION;
+#else
+  return cl::EnqueueNDRangeKernelIndirect(
+      command_queue, kernel, work_dim, local_work_size, indirect_buffer,
+      indirect_offset, num_events_in_wait_list, event_wait_list, event);
+#endif
+}
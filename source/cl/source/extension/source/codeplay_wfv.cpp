@@ -131,6 +131,8 @@ cl_int CL_API_CALL clGetKernelWFVInfoCODEPLAY(
   }
 
   size_t size;
+  cl_context context = kernel->program->context;
+  std::string tuning_decision;
 
   switch (param_name) {
     default:
@@ -141,6 +143,14 @@ cl_int CL_API_CALL clGetKernelWFVInfoCODEPLAY(
     case CL_KERNEL_WFV_WIDTHS_CODEPLAY:
       size = sizeof(size_t) * work_dim;
       break;
+    case CL_KERNEL_WFV_TUNING_DECISION_CODEPLAY: {
+      const std::lock_guard<std::mutex> context_guard(context->mutex);
+      tuning_decision = kernel->device_kernel_map[device]->getTuningDecision(
+          final_local_work_size[0], final_local_work_size[1],
+          final_local_work_size[2]);
+      size = tuning_decision.size() + 1;
+      break;
+    }
   }
 
   if (param_value != nullptr) {
@@ -148,7 +158,14 @@ cl_int CL_API_CALL clGetKernelWFVInfoCODEPLAY(
       return CL_INVALID_VALUE;
     }
 
-    cl_context context = kernel->program->context;
+    if (CL_KERNEL_WFV_TUNING_DECISION_CODEPLAY == param_name) {
+      std::copy_n(tuning_decision.c_str(), size,
+                  static_cast<char *>(param_value));
+      if (param_value_size_ret != nullptr) {
+        *param_value_size_ret = size;
+      }
+      return CL_SUCCESS;
+    }
 
     // The maximum work width represents the number of work-items the kernel
     // will be able to handle per invocation, after whole-function vectorization
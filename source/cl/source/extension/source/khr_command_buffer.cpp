@@ -824,17 +824,25 @@ cl_int _cl_command_buffer_khr::commandNDRangeKernel(
   // create the printf buffer argument if necessary
   mux_buffer_t printf_buffer = nullptr;
   mux_memory_t printf_memory = nullptr;
-  size_t num_groups = 0;
-  size_t buffer_group_size = 0;
 
   auto &device_program = kernel->program->programs[device];
   if (device_program.printf_calls.size() != 0) {
-    const cl_int err = createPrintfBuffer(
-        device, final_local_work_size, final_global_size, num_groups,
-        buffer_group_size, printf_memory, printf_buffer);
+    // Reserve room to track the printf buffer first, once the command buffer
+    // resets it the buffer may only return to the pool on command-buffer
+    // destruction, even if recording fails below.
+    if (printf_buffers.reserve(printf_buffers.size() + 1)) {
+      return CL_OUT_OF_HOST_MEMORY;
+    }
+    const cl_int err = createPrintfBuffer(device, mux_command_buffer,
+                                          printf_memory, printf_buffer);
     if (err) {
       return err;
     }
+    std::unique_ptr<printf_info_t> printf_info(new printf_info_t{
+        device, printf_memory, printf_buffer, device_program.printf_calls});
+    if (cargo::success != printf_buffers.emplace_back(std::move(printf_info))) {
+      return CL_OUT_OF_HOST_MEMORY;
+    }
   }
 
   const cl_uint device_index = kernel->program->context->getDeviceIndex(device);
@@ -851,14 +859,6 @@ cl_int _cl_command_buffer_khr::commandNDRangeKernel(
     auto result = kernel->device_kernel_map[device]->createSpecializedKernel(
         mux_execution_options);
     if (!result.has_value()) {
-      if (printf_buffer) {
-        muxDestroyBuffer(device->mux_device, printf_buffer,
-                         device->mux_allocator);
-      }
-      if (printf_memory) {
-        muxFreeMemory(device->mux_device, printf_memory, device->mux_allocator);
-      }
-
       return cl::getErrorFrom(result.error());
     }
 
@@ -884,14 +884,6 @@ cl_int _cl_command_buffer_khr::commandNDRangeKernel(
       mux_command_buffer, mux_kernel, mux_execution_options, wait_list_length,
       wait_list_length ? command_wait_list->data() : nullptr, out_sync_point);
   if (mux_success != mux_error) {
-    if (printf_buffer) {
-      muxDestroyBuffer(device->mux_device, printf_buffer,
-                       device->mux_allocator);
-    }
-    if (printf_memory) {
-      muxFreeMemory(device->mux_device, printf_memory, device->mux_allocator);
-    }
-
     auto error = cl::getErrorFrom(mux_error);
     return error;
   }
@@ -906,17 +898,9 @@ cl_int _cl_command_buffer_khr::commandNDRangeKernel(
   // enqueue a user callback that reads the printf buffer and print the data
   // out.
   if (device_program.printf_calls.size() != 0) {
-    std::unique_ptr<printf_info_t> printf_info(new printf_info_t{
-        device, printf_memory, printf_buffer, buffer_group_size,
-        std::vector<uint32_t>(num_groups, 0), device_program.printf_calls});
-
-    mux_error = createPrintfCallback(mux_command_buffer, printf_info);
+    mux_error =
+        createPrintfCallback(mux_command_buffer, printf_buffers.back().get());
     OCL_ASSERT(mux_success == mux_error, "muxCommand failed!");
-
-    // Destroy printf buffers on command-buffer destruction
-    if (cargo::success != printf_buffers.emplace_back(std::move(printf_info))) {
-      return CL_OUT_OF_HOST_MEMORY;
-    }
   }
 
   auto retain = [this](cl_mem mem) { return this->retain(mem); };
@@ -1316,6 +1300,7 @@ CL_API_ENTRY cl_int CL_API_CALL clCommandCopyBufferKHR(
     const cl_sync_point_khr *sync_point_wait_list,
     cl_sync_point_khr *sync_point, cl_mutable_command_khr *mutable_handle) {
   const tracer::TraceGuard<tracer::OpenCL> guard("clCommandCopyBufferKHR");
+  const tracer::FlowGuard<tracer::OpenCL> flow("clCommandCopyBufferKHR");
 
   OCL_CHECK(!command_buffer, return CL_INVALID_COMMAND_BUFFER_KHR);
   OCL_CHECK(command_buffer->is_finalized, return CL_INVALID_OPERATION);
@@ -1351,6 +1336,7 @@ CL_API_ENTRY cl_int CL_API_CALL clCommandCopyBufferRectKHR(
     const cl_sync_point_khr *sync_point_wait_list,
     cl_sync_point_khr *sync_point, cl_mutable_command_khr *mutable_handle) {
   const tracer::TraceGuard<tracer::OpenCL> guard("clCommandCopyBufferRectKHR");
+  const tracer::FlowGuard<tracer::OpenCL> flow("clCommandCopyBufferRectKHR");
 
   OCL_CHECK(!command_buffer, return CL_INVALID_COMMAND_BUFFER_KHR);
   OCL_CHECK(command_buffer->is_finalized, return CL_INVALID_OPERATION);
@@ -1435,6 +1421,7 @@ CL_API_ENTRY cl_int CL_API_CALL clCommandCopyImageKHR(
     const cl_sync_point_khr *sync_point_wait_list,
     cl_sync_point_khr *sync_point, cl_mutable_command_khr *mutable_handle) {
   const tracer::TraceGuard<tracer::OpenCL> guard("clCommandCopyImageKHR");
+  const tracer::FlowGuard<tracer::OpenCL> flow("clCommandCopyImageKHR");
 
   OCL_CHECK(!command_buffer, return CL_INVALID_COMMAND_BUFFER_KHR);
   OCL_CHECK(command_buffer->is_finalized, return CL_INVALID_OPERATION);
@@ -1503,6 +1490,7 @@ CL_API_ENTRY cl_int CL_API_CALL clCommandFillBufferKHR(
     const cl_sync_point_khr *sync_point_wait_list,
     cl_sync_point_khr *sync_point, cl_mutable_command_khr *mutable_handle) {
   const tracer::TraceGuard<tracer::OpenCL> guard("clCommandFillBufferKHR");
+  const tracer::FlowGuard<tracer::OpenCL> flow("clCommandFillBufferKHR");
 
   OCL_CHECK(!command_buffer, return CL_INVALID_COMMAND_BUFFER_KHR);
   OCL_CHECK(command_buffer->is_finalized, return CL_INVALID_OPERATION);
@@ -1535,6 +1523,7 @@ CL_API_ENTRY cl_int CL_API_CALL clCommandFillImageKHR(
     const cl_sync_point_khr *sync_point_wait_list,
     cl_sync_point_khr *sync_point, cl_mutable_command_khr *mutable_handle) {
   const tracer::TraceGuard<tracer::OpenCL> guard("clCommandFillImageKHR");
+  const tracer::FlowGuard<tracer::OpenCL> flow("clCommandFillImageKHR");
 
   OCL_CHECK(!command_buffer, return CL_INVALID_COMMAND_BUFFER_KHR);
   OCL_CHECK(command_buffer->is_finalized, return CL_INVALID_OPERATION);
@@ -1568,6 +1557,7 @@ CL_API_ENTRY cl_int CL_API_CALL clCommandNDRangeKernelKHR(
     const cl_sync_point_khr *sync_point_wait_list,
     cl_sync_point_khr *sync_point, cl_mutable_command_khr *mutable_handle) {
   const tracer::TraceGuard<tracer::OpenCL> guard("clCommandNDRangeKernelKHR");
+  const tracer::FlowGuard<tracer::OpenCL> flow("clCommandNDRangeKernelKHR");
 
   OCL_CHECK(!command_buffer, return CL_INVALID_COMMAND_BUFFER_KHR);
   OCL_CHECK(command_buffer->is_finalized, return CL_INVALID_OPERATION);
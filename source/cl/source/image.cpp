@@ -405,6 +405,7 @@ CL_API_ENTRY cl_int CL_API_CALL cl::EnqueueReadImage(
     size_t slice_pitch, void *ptr, cl_uint num_events_in_wait_list,
     const cl_event *event_wait_list, cl_event *event) {
   const tracer::TraceGuard<tracer::OpenCL> guard("clEnqueueReadImage");
+  const tracer::FlowGuard<tracer::OpenCL> flow("clEnqueueReadImage");
   OCL_CHECK(!command_queue, return CL_INVALID_COMMAND_QUEUE);
   OCL_CHECK(!command_queue->device->image_support, return CL_INVALID_OPERATION);
   OCL_CHECK(!(command_queue->context), return CL_INVALID_CONTEXT);
@@ -505,6 +506,7 @@ CL_API_ENTRY cl_int CL_API_CALL cl::EnqueueWriteImage(
     size_t input_slice_pitch, const void *ptr, cl_uint num_events_in_wait_list,
     const cl_event *event_wait_list, cl_event *event) {
   const tracer::TraceGuard<tracer::OpenCL> guard("clEnqueueWriteImage");
+  const tracer::FlowGuard<tracer::OpenCL> flow("clEnqueueWriteImage");
   OCL_CHECK(!command_queue, return CL_INVALID_COMMAND_QUEUE);
   OCL_CHECK(!command_queue->device->image_support, return CL_INVALID_OPERATION);
   OCL_CHECK(!(command_queue->context), return CL_INVALID_CONTEXT);
@@ -605,6 +607,7 @@ CL_API_ENTRY cl_int CL_API_CALL cl::EnqueueFillImage(
     const size_t *origin, const size_t *region, cl_uint num_events_in_wait_list,
     const cl_event *event_wait_list, cl_event *event) {
   const tracer::TraceGuard<tracer::OpenCL> guard("clEnqueueFillImage");
+  const tracer::FlowGuard<tracer::OpenCL> flow("clEnqueueFillImage");
   OCL_CHECK(!command_queue, return CL_INVALID_COMMAND_QUEUE);
 
   cl_int error = cl::validate::FillImageArguments(command_queue, image_,
@@ -665,6 +668,7 @@ CL_API_ENTRY cl_int CL_API_CALL cl::EnqueueCopyImage(
     cl_uint num_events_in_wait_list, const cl_event *event_wait_list,
     cl_event *event) {
   const tracer::TraceGuard<tracer::OpenCL> guard("clEnqueueCopyImage");
+  const tracer::FlowGuard<tracer::OpenCL> flow("clEnqueueCopyImage");
   OCL_CHECK(!command_queue, return CL_INVALID_COMMAND_QUEUE);
 
   cl_int error = cl::validate::CopyImageArguments(
@@ -735,6 +739,7 @@ CL_API_ENTRY cl_int CL_API_CALL cl::EnqueueCopyImageToBuffer(
     cl_uint num_events_in_wait_list, const cl_event *event_wait_list,
     cl_event *event) {
   const tracer::TraceGuard<tracer::OpenCL> guard("clEnqueueCopyImageToBuffer");
+  const tracer::FlowGuard<tracer::OpenCL> flow("clEnqueueCopyImageToBuffer");
 
   OCL_CHECK(!command_queue, return CL_INVALID_COMMAND_QUEUE);
   cl_int error = cl::validate::CopyImageToBufferArguments(
@@ -803,6 +808,7 @@ CL_API_ENTRY cl_int CL_API_CALL cl::EnqueueCopyBufferToImage(
     cl_uint num_events_in_wait_list, const cl_event *event_wait_list,
     cl_event *event) {
   const tracer::TraceGuard<tracer::OpenCL> guard("clEnqueueCopyBufferToImage");
+  const tracer::FlowGuard<tracer::OpenCL> flow("clEnqueueCopyBufferToImage");
 
   OCL_CHECK(!command_queue, return CL_INVALID_COMMAND_QUEUE);
   cl_int error = cl::validate::CopyBufferToImageArguments(
@@ -28,6 +28,7 @@
 #include <cl/sampler.h>
 #include <cl/validate.h>
 
+#include <algorithm>
 #include <array>
 
 #include "cargo/expected.h"
@@ -231,6 +232,10 @@ namespace {
 /// @param num_events_in_wait_list Number of events in `event_wait_list`.
 /// @param event_wait_list List of evetns to wait on.
 /// @param return_event Kernel execution event.
+/// @param indirect_buffer Buffer containing the work-group counts of an
+/// indirect ND range, or null if `global_work_size` is used.
+/// @param indirect_offset Byte offset of the work-group counts into
+/// `indirect_buffer`.
 ///
 /// @return Returns appropriate OpenCL error code.
 cl_int PushExecuteKernel(
@@ -239,7 +244,8 @@ cl_int PushExecuteKernel(
     const std::array<size_t, cl::max::WORK_ITEM_DIM> &global_work_size,
     const std::array<size_t, cl::max::WORK_ITEM_DIM> &local_work_size,
     const cl_uint num_events_in_wait_list,
-    const cl_event *const event_wait_list, cl_event return_event) {
+    const cl_event *const event_wait_list, cl_event return_event,
+    cl_mem indirect_buffer = nullptr, size_t indirect_offset = 0) {
   const std::lock_guard<std::mutex> lock(
       command_queue->context->getCommandQueueMutex());
   auto mux_command_buffer = command_queue->getCommandBuffer(
@@ -276,20 +282,31 @@ cl_int PushExecuteKernel(
   // create the printf buffer argument if necessary
   mux_buffer_t printf_buffer = nullptr;
   mux_memory_t printf_memory = nullptr;
-  size_t num_groups = 0;
-  size_t buffer_group_size = 0;
+  std::shared_ptr<printf_info_t> printf_info;
   if (device_program.printf_calls.size() != 0) {
-    const cl_int err = createPrintfBuffer(
-        device, local_work_size, global_work_size, num_groups,
-        buffer_group_size, printf_memory, printf_buffer);
+    const cl_int err = createPrintfBuffer(device, *mux_command_buffer,
+                                          printf_memory, printf_buffer);
     if (err) {
       if (nullptr != return_event) {
         return_event->complete(CL_OUT_OF_RESOURCES);
       }
       return err;
     }
+    printf_info.reset(new printf_info_t{device, printf_memory, printf_buffer,
+                                        device_program.printf_calls});
   }
 
+  // The command buffer now resets the printf buffer, so on failure the buffer
+  // can only go back to the pool once the command buffer has completed or been
+  // thrown away.
+  auto release_printf_info = [&]() {
+    if (printf_info) {
+      (void)command_queue->registerDispatchCallback(
+          *mux_command_buffer, nullptr,
+          [printf_info]() mutable { printf_info.reset(); });
+    }
+  };
+
   std::unique_ptr<mux_descriptor_info_t[]> descriptor_info_storage;
   const cl_uint device_index = kernel->program->context->getDeviceIndex(device);
   const mux_ndrange_options_t mux_execution_options =
@@ -301,57 +318,83 @@ cl_int PushExecuteKernel(
   mux_kernel_t mux_specialized_kernel = nullptr;
   mux_executable_t mux_specialized_executable = nullptr;
   mux_kernel_t kernel_to_execute = nullptr;
-  if (kernel->device_kernel_map[device]->supportsDeferredCompilation()) {
-    auto result = kernel->device_kernel_map[device]->createSpecializedKernel(
-        mux_execution_options);
+  auto *device_kernel = kernel->device_kernel_map[device].get();
+  cargo::optional<uint32_t> tuning_candidate;
+  mux_query_pool_t tuning_queries = nullptr;
+  if (device_kernel->supportsDeferredCompilation()) {
+    // Timing an autotuning candidate needs a duration query of its own, which
+    // would clobber the event's profiling query, so only tune on queues
+    // without profiling enabled.
+    if (!(command_queue->properties & CL_QUEUE_PROFILING_ENABLE)) {
+      tuning_candidate = device_kernel->getNextTuningCandidate(
+          local_work_size[0], local_work_size[1], local_work_size[2]);
+    }
+    auto result = tuning_candidate
+                      ? device_kernel->createTuningCandidateKernel(
+                            mux_execution_options, *tuning_candidate)
+                      : device_kernel->createSpecializedKernel(
+                            mux_execution_options);
     if (!result.has_value()) {
-      if (printf_buffer) {
-        muxDestroyBuffer(mux_device, printf_buffer, mux_allocator);
-      }
-      if (printf_memory) {
-        muxFreeMemory(mux_device, printf_memory, mux_allocator);
-      }
+      release_printf_info();
       return cl::getErrorFrom(result.error());
     }
 
     mux_specialized_kernel = result->mux_kernel.release();
     mux_specialized_executable = result->mux_executable.release();
     kernel_to_execute = mux_specialized_kernel;
+
+    // If the query pool can't be created the candidate still runs, it just
+    // doesn't contribute a sample.
+    if (tuning_candidate &&
+        mux_success != muxCreateQueryPool(command_queue->mux_queue,
+                                          mux_query_type_duration, 1, nullptr,
+                                          mux_allocator, &tuning_queries)) {
+      tuning_queries = nullptr;
+    }
   } else {
     // Execute the precompiled kernel.
-    kernel_to_execute =
-        kernel->device_kernel_map[device]->getPrecompiledKernel();
+    kernel_to_execute = device_kernel->getPrecompiledKernel();
   }
 
-  mux_result_t mux_error =
-      muxCommandNDRange(*mux_command_buffer, kernel_to_execute,
-                        mux_execution_options, 0, nullptr, nullptr);
+  mux_result_t mux_error = mux_success;
+  if (tuning_queries) {
+    mux_error = muxCommandBeginQuery(*mux_command_buffer, tuning_queries, 0, 1,
+                                     0, nullptr, nullptr);
+  }
+  if (mux_success == mux_error) {
+    if (indirect_buffer) {
+      auto *buffer = static_cast<cl_mem_buffer>(indirect_buffer);
+      mux_error = muxCommandNDRangeIndirect(
+          *mux_command_buffer, kernel_to_execute, mux_execution_options,
+          buffer->mux_buffers[device_index], indirect_offset, 0, nullptr,
+          nullptr);
+    } else {
+      mux_error =
+          muxCommandNDRange(*mux_command_buffer, kernel_to_execute,
+                            mux_execution_options, 0, nullptr, nullptr);
+    }
+  }
+  if (tuning_queries && mux_success == mux_error) {
+    mux_error = muxCommandEndQuery(*mux_command_buffer, tuning_queries, 0, 1, 0,
+                                   nullptr, nullptr);
+  }
   if (mux_success != mux_error) {
     auto error = cl::getErrorFrom(mux_error);
+    if (nullptr != tuning_queries) {
+      muxDestroyQueryPool(command_queue->mux_queue, tuning_queries,
+                          mux_allocator);
+    }
     if (nullptr != return_event) {
       return_event->complete(error);
     }
-    if (nullptr != printf_buffer) {
-      muxDestroyBuffer(mux_device, printf_buffer, mux_allocator);
-    }
-    if (nullptr != printf_memory) {
-      muxFreeMemory(mux_device, printf_memory, mux_allocator);
-    }
+    release_printf_info();
     return error;
   }
 
   // enqueue a user callback that reads the printf buffer and print the data
-  // out.
-  if (device_program.printf_calls.size() != 0) {
-    printf_info_t *printf_info =
-        new printf_info_t{device,
-                          printf_memory,
-                          printf_buffer,
-                          buffer_group_size,
-                          std::vector<uint32_t>(num_groups, 0),
-                          device_program.printf_calls};
-
-    mux_error = createPrintfCallback(*mux_command_buffer, printf_info);
+  // out, the dispatch callback below returns the buffer to the pool.
+  if (printf_info) {
+    mux_error = createPrintfCallback(*mux_command_buffer, printf_info.get());
     OCL_ASSERT(mux_success == mux_error, "muxCommand failed!");
   }
 
@@ -365,8 +408,17 @@ cl_int PushExecuteKernel(
   };
 
   if (auto error = kernel->retainMems(command_queue, retain)) {
+    release_printf_info();
     return error;
   }
+  if (indirect_buffer) {
+    if (auto error = static_cast<cl_mem_buffer>(indirect_buffer)->synchronize(
+            command_queue)) {
+      release_printf_info();
+      return error;
+    }
+    retain(indirect_buffer);
+  }
 
   // don't release the kernel until it has been executed
   kernel_release_guard.dismiss();
@@ -374,10 +426,25 @@ cl_int PushExecuteKernel(
   return command_queue->registerDispatchCallback(
       *mux_command_buffer, return_event,
       [kernel, mems_to_release, mux_device, mux_specialized_kernel,
-       mux_specialized_executable, mux_allocator]() {
+       mux_specialized_executable, mux_allocator, device_kernel,
+       local_work_size, tuning_candidate, tuning_queries, printf_info,
+       mux_queue = command_queue->mux_queue]() mutable {
         for (auto mem : mems_to_release) {
           cl::releaseInternal(mem);
         }
+        if (tuning_queries) {
+          mux_query_duration_result_s duration;
+          if (mux_success ==
+              muxGetQueryPoolResults(mux_queue, tuning_queries, 0, 1,
+                                     sizeof(mux_query_duration_result_s),
+                                     &duration,
+                                     sizeof(mux_query_duration_result_s))) {
+            device_kernel->reportTuningDuration(
+                local_work_size[0], local_work_size[1], local_work_size[2],
+                *tuning_candidate, duration.end - duration.start);
+          }
+          muxDestroyQueryPool(mux_queue, tuning_queries, mux_allocator);
+        }
         if (mux_specialized_kernel) {
           muxDestroyKernel(mux_device, mux_specialized_kernel, mux_allocator);
         }
@@ -385,6 +452,8 @@ cl_int PushExecuteKernel(
           muxDestroyExecutable(mux_device, mux_specialized_executable,
                                mux_allocator);
         }
+        // The printf callback has run, or never will.
+        printf_info.reset();
         cl::releaseInternal(kernel);
       });
 }
@@ -457,14 +526,63 @@ MuxKernelWrapper::createSpecializedKernel(
   if (!specialized_kernel.has_value()) {
     return cargo::make_unexpected(specialized_kernel.error());
   }
+  return loadSpecializedKernel(*specialized_kernel);
+}
+
+cargo::optional<uint32_t> MuxKernelWrapper::getNextTuningCandidate(
+    size_t local_size_x, size_t local_size_y, size_t local_size_z) {
+  if (!deferred_kernel) {
+    return cargo::nullopt;
+  }
+  return deferred_kernel->getNextTuningCandidate(local_size_x, local_size_y,
+                                                 local_size_z);
+}
+
+cargo::expected<MuxKernelWrapper::SpecializedKernel, compiler::Result>
+MuxKernelWrapper::createTuningCandidateKernel(
+    const mux_ndrange_options_t &specialization_options, uint32_t candidate) {
+  if (!deferred_kernel) {
+    return cargo::make_unexpected(compiler::Result::FAILURE);
+  }
+
+  auto candidate_kernel = deferred_kernel->createTuningCandidateKernel(
+      specialization_options, candidate);
+  if (!candidate_kernel.has_value()) {
+    return cargo::make_unexpected(candidate_kernel.error());
+  }
+  return loadSpecializedKernel(*candidate_kernel);
+}
+
+void MuxKernelWrapper::reportTuningDuration(size_t local_size_x,
+                                            size_t local_size_y,
+                                            size_t local_size_z,
+                                            uint32_t candidate,
+                                            uint64_t duration) {
+  if (deferred_kernel) {
+    deferred_kernel->reportTuningDuration(local_size_x, local_size_y,
+                                          local_size_z, candidate, duration);
+  }
+}
 
+std::string MuxKernelWrapper::getTuningDecision(size_t local_size_x,
+                                                size_t local_size_y,
+                                                size_t local_size_z) {
+  if (!deferred_kernel) {
+    return {};
+  }
+  return deferred_kernel->getTuningDecision(local_size_x, local_size_y,
+                                            local_size_z);
+}
+
+cargo::expected<MuxKernelWrapper::SpecializedKernel, compiler::Result>
+MuxKernelWrapper::loadSpecializedKernel(
+    const cargo::dynamic_array<uint8_t> &binary) {
   // Create a mux executable and kernel that contains this specialized binary.
   mux_result_t result;
   mux_executable_t mux_executable;
   mux_kernel_t mux_kernel;
-  result = muxCreateExecutable(mux_device, specialized_kernel->data(),
-                               specialized_kernel->size(), mux_allocator_info,
-                               &mux_executable);
+  result = muxCreateExecutable(mux_device, binary.data(), binary.size(),
+                               mux_allocator_info, &mux_executable);
   if (result != mux_success) {
     if (result == mux_error_out_of_memory) {
       return cargo::make_unexpected(compiler::Result::OUT_OF_MEMORY);
@@ -653,8 +771,7 @@ bool _cl_kernel::GetArgInfo() {
 
     // Note: We can't just use `this->info` here, as that instance of
     // `ProgramInfo` may not have `argument_info` populated.
-    const compiler::KernelInfo *info =
-        device_program.program_info->getKernelByName(name);
+    const compiler::KernelInfo *info = device_program.getKernelInfo(name);
     if (nullptr == info) {
       continue;
     }
@@ -1436,7 +1553,8 @@ cl_int _cl_kernel::checkWorkSizes(cl_device_id device, cl_uint work_dim,
 #endif
     if (local_work_size) {
       OCL_CHECK(0 == local_work_size[i], return CL_INVALID_WORK_GROUP_SIZE);
-      if (global_work_size != nullptr) {
+      if (global_work_size != nullptr &&
+          !supportsNonUniformWorkGroups(device)) {
         OCL_CHECK(0 != (global_work_size[i] % local_work_size[i]),
                   return CL_INVALID_WORK_GROUP_SIZE);
       }
@@ -1473,6 +1591,7 @@ std::array<size_t, cl::max::WORK_ITEM_DIM> _cl_kernel::getDefaultLocalSize(
     return prefered_sizes;
   }
 
+  const bool non_uniform = supportsNonUniformWorkGroups(device);
   for (cl_uint i = 0; i < work_dim; ++i) {
     // If global size does not divide equally by the local size (which is
     // defaulting to the preferred local size as advertised through the
@@ -1480,6 +1599,10 @@ std::array<size_t, cl::max::WORK_ITEM_DIM> _cl_kernel::getDefaultLocalSize(
     // check if its acceptable otherwise we set it to 1 instead.
     if (0 == (global_work_size[i] % prefered_sizes[i])) {
       local_sizes[i] = prefered_sizes[i];
+    } else if (non_uniform) {
+      // Keep the preferred local size so the bulk of the range runs full
+      // (vectorized) work-groups, only the trailing work-group is smaller.
+      local_sizes[i] = std::min(prefered_sizes[i], global_work_size[i]);
     } else {
       // Keep halving the `preferred_local_size` until we either get a value
       // that fits or `1`.
@@ -1494,6 +1617,29 @@ std::array<size_t, cl::max::WORK_ITEM_DIM> _cl_kernel::getDefaultLocalSize(
   return local_sizes;
 }
 
+bool _cl_kernel::supportsNonUniformWorkGroups(cl_device_id device) const {
+  if (!device->non_uniform_work_group_support) {
+    return false;
+  }
+  // The required work-group size is compiled into the kernel, so every
+  // work-group must be that size.
+  if (info->reqd_work_group_size.has_value()) {
+    return false;
+  }
+  // Only OpenCL C 3.0 programs allow non-uniform work-groups, and only when
+  // not disabled by -cl-uniform-work-group-size. Binaries don't record the
+  // options they were built with so stay uniform.
+  auto device_program = program->programs.find(device);
+  if (device_program == program->programs.end() ||
+      device_program->second.type != cl::device_program_type::COMPILER_MODULE) {
+    return false;
+  }
+  const auto &options =
+      device_program->second.compiler_module.module->getOptions();
+  return compiler::Standard::OpenCLC30 == options.standard &&
+         !options.uniform_work_group_size;
+}
+
 cl_int _cl_kernel::checkKernelArgs() {
   for (size_t i = 0, e = info->getNumArguments(); i < e; i++) {
     OCL_CHECK(compiler::ArgumentKind::UNKNOWN == saved_args[i].type.kind,
@@ -1509,6 +1655,7 @@ CL_API_ENTRY cl_int CL_API_CALL cl::EnqueueNDRangeKernel(
     const size_t *local_work_size, cl_uint num_events_in_wait_list,
     const cl_event *event_wait_list, cl_event *event) {
   const tracer::TraceGuard<tracer::OpenCL> guard("clEnqueueNDRangeKernel");
+  const tracer::FlowGuard<tracer::OpenCL> flow("clEnqueueNDRangeKernel");
   OCL_CHECK(!command_queue, return CL_INVALID_COMMAND_QUEUE);
   OCL_CHECK(!kernel, return CL_INVALID_KERNEL);
   OCL_CHECK(!(kernel->program), return CL_INVALID_PROGRAM_EXECUTABLE);
@@ -1621,12 +1768,137 @@ CL_API_ENTRY cl_int CL_API_CALL cl::EnqueueNDRangeKernel(
   return CL_SUCCESS;
 }
 
+cl_int cl::EnqueueNDRangeKernelIndirect(
+    cl_command_queue command_queue, cl_kernel kernel, cl_uint work_dim,
+    const size_t *local_work_size, cl_mem indirect_buffer,
+    size_t indirect_offset, cl_uint num_events_in_wait_list,
+    const cl_event *event_wait_list, cl_event *event) {
+  const tracer::TraceGuard<tracer::OpenCL> guard(
+      "clEnqueueNDRangeKernelIndirectCODEPLAY");
+  const tracer::FlowGuard<tracer::OpenCL> flow(
+      "clEnqueueNDRangeKernelIndirectCODEPLAY");
+  OCL_CHECK(!command_queue, return CL_INVALID_COMMAND_QUEUE);
+  OCL_CHECK(!kernel, return CL_INVALID_KERNEL);
+  OCL_CHECK(!(kernel->program), return CL_INVALID_PROGRAM_EXECUTABLE);
+  OCL_CHECK(!(command_queue->context), return CL_INVALID_CONTEXT);
+  OCL_CHECK(!(kernel->program->context), return CL_INVALID_CONTEXT);
+  OCL_CHECK(command_queue->context != kernel->program->context,
+            return CL_INVALID_CONTEXT);
+  OCL_CHECK(!command_queue->device->mux_device->info->supports_indirect_ndrange,
+            return CL_INVALID_OPERATION);
+  OCL_CHECK((0 == work_dim) || (cl::max::WORK_ITEM_DIM < work_dim) ||
+                (command_queue->device->max_work_item_dimensions < work_dim),
+            return CL_INVALID_WORK_DIMENSION);
+
+  // The work-group counts are three 32-bit integers read by the device when
+  // the command executes.
+  OCL_CHECK(!indirect_buffer || CL_MEM_OBJECT_BUFFER != indirect_buffer->type,
+            return CL_INVALID_MEM_OBJECT);
+  OCL_CHECK(command_queue->context != indirect_buffer->context,
+            return CL_INVALID_CONTEXT);
+  OCL_CHECK(0 != (indirect_offset % sizeof(cl_uint)), return CL_INVALID_VALUE);
+  OCL_CHECK(indirect_buffer->size < sizeof(cl_uint) * 3 ||
+                indirect_buffer->size - sizeof(cl_uint) * 3 < indirect_offset,
+            return CL_INVALID_VALUE);
+
+  // Check the required work group size (if it exists).
+  if (auto error = kernel->checkReqdWorkGroupSize(work_dim, local_work_size)) {
+    return error;
+  }
+
+  // The global size isn't known until the command executes, but it is always a
+  // multiple of the local size so only the local size needs checking.
+  if (auto error = kernel->checkWorkSizes(command_queue->device, work_dim,
+                                          nullptr, nullptr, local_work_size)) {
+    return error;
+  }
+
+  std::array<size_t, cl::max::WORK_ITEM_DIM> final_local_work_size{1, 1, 1};
+  if (local_work_size) {
+    std::copy_n(local_work_size, work_dim, std::begin(final_local_work_size));
+  } else {
+    const auto preferred_local_size =
+        kernel->getDefaultLocalSize(command_queue->device, nullptr, work_dim);
+    std::copy_n(preferred_local_size.begin(), work_dim,
+                std::begin(final_local_work_size));
+  }
+
+  // Kernels are specialized for a single work-group, the global size passed
+  // to mux is ignored for an indirect ND range.
+  const std::array<size_t, cl::max::WORK_ITEM_DIM> final_global_offset{0, 0,
+                                                                       0};
+  const std::array<size_t, cl::max::WORK_ITEM_DIM> final_global_size =
+      final_local_work_size;
+
+  // Check the current kernel arguments are valid.
+  if (auto error = kernel->checkKernelArgs()) {
+    return error;
+  }
+
+  // Validate the event wait list.
+  if (auto error =
+          cl::validate::EventWaitList(num_events_in_wait_list, event_wait_list,
+                                      command_queue->context, event)) {
+    return error;
+  }
+
+  // Handle the signal event.
+  cl_event return_event = nullptr;
+  cl_int error = 0;
+#ifdef OCL_EXTENSION_cl_intel_unified_shared_memory
+  // We need to lock the context for the remainder of the function as we need to
+  // ensure any blocking operations such clMemBlockingFreeINTEL are entirely in
+  // sync as createBlockingEventForKernel adds to USM lists assuming that they
+  // reflect already queued events.
+  const std::lock_guard<std::mutex> context_guard(
+      command_queue->context->usm_mutex);
+  error = extension::usm::createBlockingEventForKernel(
+      command_queue, kernel, CL_COMMAND_NDRANGE_KERNEL, return_event);
+  OCL_CHECK(error != CL_SUCCESS, return error);
+
+  // Manually retain _cl_event since there might not be a USM allocation used in
+  // the kernel to do retain for us
+  cl::retainInternal(return_event);
+  if (nullptr != event) {
+    *event = return_event;
+  } else {
+    // If the user didn't pass an output event there won't be a user
+    // call `clReleaseEvent()`, so we manually decrement the external
+    // reference count instead on command completion
+    cl::releaseExternal(return_event);
+  }
+#else
+  if (nullptr != event) {
+    auto new_event =
+        _cl_event::create(command_queue, CL_COMMAND_NDRANGE_KERNEL);
+    if (!new_event) {
+      return new_event.error();
+    }
+    return_event = *new_event;
+    *event = return_event;
+  }
+#endif
+
+  error =
+      // NOLINTNEXTLINE(clang-analyzer-cplusplus.NewDelete)
+      PushExecuteKernel(command_queue, kernel, work_dim, final_global_offset,
+                        final_global_size, final_local_work_size,
+                        num_events_in_wait_list, event_wait_list, return_event,
+                        indirect_buffer, indirect_offset);
+  if (error) {
+    return error;
+  }
+
+  return CL_SUCCESS;
+}
+
 CL_API_ENTRY cl_int CL_API_CALL cl::EnqueueTask(cl_command_queue command_queue,
                                                 cl_kernel kernel,
                                                 cl_uint num_events_in_wait_list,
                                                 const cl_event *event_wait_list,
                                                 cl_event *event) {
   const tracer::TraceGuard<tracer::OpenCL> guard("clEnqueueTask");
+  const tracer::FlowGuard<tracer::OpenCL> flow("clEnqueueTask");
   // Redmine issue 5014
   OCL_CHECK(!command_queue, return CL_INVALID_COMMAND_QUEUE);
   OCL_CHECK(!kernel, return CL_INVALID_KERNEL);
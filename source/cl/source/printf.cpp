@@ -35,73 +35,34 @@ void PerformPrintf(mux_queue_t, mux_command_buffer_t, void *const user_data) {
   OCL_UNUSED(error);
 
   // Unpack and print the data
-  builtins::printf::print(pack, printf_info->buffer_group_size,
-                          printf_info->printf_calls,
-                          printf_info->group_offsets);
+  builtins::printf::print(pack, printf_buffer_size, printf_info->printf_calls);
 
   error = muxUnmapMemory(mux_device, printf_info->memory);
   OCL_ASSERT(mux_success == error, "muxUnmapMemory failed!");
 }
-
-// Callback function for printing data using PerformPrintf, and then freeing
-// the printf resources afterwards. We can do this when we know the callback
-// won't be called again, i.e. the clEnqueueNDRangeKernel command was made
-// rather than clCommandNDRangeKernelKHR, which could be enqueued multiple
-// times.
-void PrintfAndFree(mux_queue_t queue, mux_command_buffer_t command_buffer,
-                   void *const user_data) {
-  PerformPrintf(queue, command_buffer, user_data);
-
-  // Destroy resources as part of callback
-  auto printf_info = static_cast<printf_info_t *>(user_data);
-  delete printf_info;
-}
 }  // namespace
 
 printf_info_t::~printf_info_t() {
-  if (buffer) {
-    muxDestroyBuffer(device->mux_device, buffer, device->mux_allocator);
-  }
-
-  if (memory) {
-    muxFreeMemory(device->mux_device, memory, device->mux_allocator);
-  }
-}
-
-mux_result_t createPrintfCallback(mux_command_buffer_t command_buffer,
-                                  printf_info_t *printf_info) {
-  return muxCommandUserCallback(command_buffer, PrintfAndFree, printf_info, 0,
-                                nullptr, nullptr);
+  device->printf_buffer_pool->release(memory, buffer);
 }
 
-mux_result_t createPrintfCallback(
-    mux_command_buffer_t command_buffer,
-    const std::unique_ptr<printf_info_t> &printf_info) {
-  return muxCommandUserCallback(command_buffer, PerformPrintf,
-                                printf_info.get(), 0, nullptr, nullptr);
+printf_buffer_pool_t::~printf_buffer_pool_t() {
+  for (auto &pooled : buffers) {
+    muxDestroyBuffer(device->mux_device, pooled.second, device->mux_allocator);
+    muxFreeMemory(device->mux_device, pooled.first, device->mux_allocator);
+  }
 }
 
-cl_int createPrintfBuffer(
-    cl_device_id device,
-    const std::array<size_t, cl::max::WORK_ITEM_DIM> &local_work_size,
-    const std::array<size_t, cl::max::WORK_ITEM_DIM> &global_work_size,
-    size_t &num_groups, size_t &buffer_group_size, mux_memory_t &printf_memory,
-    mux_buffer_t &printf_buffer) {
-  // Number of group is total number of work items divided by the size of a
-  // work group
-  num_groups =
-      (global_work_size[0] * global_work_size[1] * global_work_size[2]) /
-      (local_work_size[0] * local_work_size[1] * local_work_size[2]);
-
-  OCL_ASSERT(num_groups > 0, "There must be at least one work group!");
-
-  // Ensure the buffer start of each work item is aligned to 4 bytes.
-  buffer_group_size = (device->printf_buffer_size / num_groups) & ~3u;
-
-  // if we have less than 8 bytes per work group, we can't print anything,
-  // and the kernel will crash, so just abort
-  if (buffer_group_size < 8) {
-    return CL_OUT_OF_RESOURCES;
+cl_int printf_buffer_pool_t::acquire(mux_memory_t &memory,
+                                     mux_buffer_t &buffer) {
+  {
+    const std::lock_guard<std::mutex> lock(mutex);
+    if (!buffers.empty()) {
+      memory = buffers.back().first;
+      buffer = buffers.back().second;
+      buffers.pop_back();
+      return CL_SUCCESS;
+    }
   }
 
   // allocate the memory for the printf buffer
@@ -112,58 +73,59 @@ cl_int createPrintfBuffer(
   mux_result_t mux_error = muxAllocateMemory(
       mux_device, device->printf_buffer_size, 1,
       mux_memory_property_host_visible, mux_allocation_type_alloc_device,
-      alignment, device->mux_allocator, &printf_memory);
+      alignment, mux_allocator, &memory);
   if (mux_error) {
     return CL_OUT_OF_RESOURCES;
   }
 
-  // We need to initialize the first 8 bytes of the printf buffer so that
-  // the first printf call can get a valid offset
-  uint32_t *buffer;
-  mux_error = muxMapMemory(mux_device, printf_memory, 0,
-                           device->printf_buffer_size, (void **)&buffer);
+  // create the printf buffer
+  mux_error = muxCreateBuffer(mux_device, device->printf_buffer_size,
+                              mux_allocator, &buffer);
   if (mux_error) {
-    muxFreeMemory(mux_device, printf_memory, mux_allocator);
+    muxFreeMemory(mux_device, memory, mux_allocator);
     return CL_OUT_OF_RESOURCES;
   }
 
-  // initialize the buffer chunk for each work group
-  for (size_t group_id = 0; group_id < num_groups; ++group_id) {
-    // index into the 32 bits array
-    const size_t index = (group_id * buffer_group_size) / sizeof(uint32_t);
-
-    // 8 bytes for the size of the length value plus the size of the
-    // overflow count
-    buffer[index] = 8;
-    // 0 bytes of overflow
-    buffer[index + 1] = 0;
-  }
-
-  mux_error = muxFlushMappedMemoryToDevice(mux_device, printf_memory, 0,
-                                           device->printf_buffer_size);
+  // and bind it to the printf memory without offset
+  mux_error = muxBindBufferMemory(mux_device, memory, buffer, 0);
   if (mux_error) {
-    muxFreeMemory(mux_device, printf_memory, mux_allocator);
+    muxDestroyBuffer(mux_device, buffer, mux_allocator);
+    muxFreeMemory(mux_device, memory, mux_allocator);
     return CL_OUT_OF_RESOURCES;
   }
-  mux_error = muxUnmapMemory(mux_device, printf_memory);
-  if (mux_error) {
-    muxFreeMemory(mux_device, printf_memory, mux_allocator);
-    return CL_OUT_OF_RESOURCES;
+  return CL_SUCCESS;
+}
+
+void printf_buffer_pool_t::release(mux_memory_t memory, mux_buffer_t buffer) {
+  if (!buffer || !memory) {
+    return;
   }
+  const std::lock_guard<std::mutex> lock(mutex);
+  buffers.emplace_back(memory, buffer);
+}
 
-  // create the printf buffer
-  mux_error = muxCreateBuffer(mux_device, device->printf_buffer_size,
-                              mux_allocator, &printf_buffer);
-  if (mux_error) {
-    muxFreeMemory(mux_device, printf_memory, mux_allocator);
-    return CL_OUT_OF_RESOURCES;
+mux_result_t createPrintfCallback(mux_command_buffer_t command_buffer,
+                                  printf_info_t *printf_info) {
+  return muxCommandUserCallback(command_buffer, PerformPrintf, printf_info, 0,
+                                nullptr, nullptr);
+}
+
+cl_int createPrintfBuffer(cl_device_id device,
+                          mux_command_buffer_t command_buffer,
+                          mux_memory_t &printf_memory,
+                          mux_buffer_t &printf_buffer) {
+  if (auto error =
+          device->printf_buffer_pool->acquire(printf_memory, printf_buffer)) {
+    return error;
   }
 
-  // and bind it to the printf memory without offset
-  mux_error = muxBindBufferMemory(mux_device, printf_memory, printf_buffer, 0);
-  if (mux_error) {
-    muxDestroyBuffer(mux_device, printf_buffer, mux_allocator);
-    muxFreeMemory(mux_device, printf_memory, mux_allocator);
+  // Initialize the first 8 bytes of the printf buffer so that the first printf
+  // call can get a valid offset: 8 bytes for the size of the length value plus
+  // the size of the overflow count, and 0 bytes of overflow.
+  const uint32_t header[2] = {8, 0};
+  if (muxCommandFillBuffer(command_buffer, printf_buffer, 0, sizeof(header),
+                           header, sizeof(header), 0, nullptr, nullptr)) {
+    device->printf_buffer_pool->release(printf_memory, printf_buffer);
     return CL_OUT_OF_RESOURCES;
   }
   return CL_SUCCESS;
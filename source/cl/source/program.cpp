@@ -99,11 +99,13 @@ cl::device_program::~device_program() { clear(); }
 
 void cl::device_program::initializeAsBinary(
     mux::unique_ptr<mux_executable_t> executable,
-    cargo::dynamic_array<uint8_t> binary_buffer) {
+    cargo::dynamic_array<uint8_t> binary_buffer,
+    cargo::dynamic_array<cargo::array_view<const uint8_t>> kernel_sections) {
   clear();
   type = cl::device_program_type::BINARY;
   // As 'binary' is defined in a union, it must be explicitly constructed.
-  new (&binary) Binary(std::move(executable), std::move(binary_buffer));
+  new (&binary) Binary(std::move(executable), std::move(binary_buffer),
+                       std::move(kernel_sections));
 }
 
 void cl::device_program::initializeAsBuiltin() {
@@ -320,10 +322,20 @@ cargo::array_view<uint8_t> cl::device_program::binarySerialize() {
 bool cl::device_program::binaryDeserialize(
     cl_device_id device, compiler::Target *compiler_target,
     cargo::array_view<const uint8_t> buffer) {
-  cargo::dynamic_array<uint8_t> executable;
+  // Keep a single copy of the binary, it is returned by clGetProgramInfo and
+  // both the executable and the kernel sections are referenced in place.
+  cargo::dynamic_array<uint8_t> binary_copy;
+  if (binary_copy.alloc(buffer.size())) {
+    return false;
+  }
+  std::memcpy(binary_copy.data(), buffer.data(), buffer.size());
+
+  cargo::array_view<const uint8_t> executable;
+  cargo::dynamic_array<cargo::array_view<const uint8_t>> kernel_sections;
   bool is_executable = false;
   program_info.emplace();
-  if (!binary::deserializeBinary(buffer, printf_calls, *program_info,
+  if (!binary::deserializeBinary({binary_copy.data(), binary_copy.size()},
+                                 printf_calls, *program_info, kernel_sections,
                                  executable, is_executable)) {
     reportError("Failed to deserialize binary");
     return false;
@@ -338,18 +350,12 @@ bool cl::device_program::binaryDeserialize(
       return false;
     };
 
-    // cache the binary
-    cargo::dynamic_array<uint8_t> binary;
-    if (binary.alloc(buffer.size())) {
-      return false;
-    }
-    std::memcpy(binary.data(), buffer.data(), buffer.size());
-
-    // Initialize as binary.
+    // Initialize as binary, moving the binary doesn't invalidate the sections
+    // referencing it.
     initializeAsBinary(
         mux::unique_ptr<mux_executable_t>{
             mux_executable, {device->mux_device, device->mux_allocator}},
-        std::move(binary));
+        std::move(binary_copy), std::move(kernel_sections));
   } else {
     // Note that as we are handling binary deserialization above, this case is
     // for handling the case where an OpenCL binary has been serialized after
@@ -357,8 +363,7 @@ bool cl::device_program::binaryDeserialize(
     // an intermediate state of compilation).
     if (device->compiler_available) {
       initializeAsCompilerModule(compiler_target);
-      if (!compiler_module.module->deserialize(
-              {executable.data(), executable.size()})) {
+      if (!compiler_module.module->deserialize(executable)) {
         // Error message is already reported by deserialize if there's a
         // failure.
         return false;
@@ -373,6 +378,42 @@ bool cl::device_program::binaryDeserialize(
   return true;
 }
 
+const compiler::KernelInfo *cl::device_program::getKernelInfo(
+    cargo::string_view name) const {
+  if (!program_info) {
+    return nullptr;
+  }
+  if (type != cl::device_program_type::BINARY ||
+      binary.kernel_sections.empty()) {
+    return program_info->getKernelByName(name);
+  }
+
+  for (size_t kernel_index = 0, e = program_info->getNumKernels();
+       kernel_index < e; kernel_index++) {
+    if (program_info->getKernel(kernel_index)->name != name) {
+      continue;
+    }
+    const std::lock_guard<std::mutex> lock(binary.kernel_infos_mutex);
+    if (binary.kernel_infos.empty() &&
+        binary.kernel_infos.alloc(binary.kernel_sections.size())) {
+      return nullptr;
+    }
+    auto &kernel_info = binary.kernel_infos[kernel_index];
+    if (!kernel_info) {
+      std::unique_ptr<compiler::KernelInfo> new_kernel_info(
+          new (std::nothrow) compiler::KernelInfo());
+      if (!new_kernel_info ||
+          !binary::deserializeKernelInfo(binary.kernel_sections[kernel_index],
+                                         *new_kernel_info)) {
+        return nullptr;
+      }
+      kernel_info = std::move(new_kernel_info);
+    }
+    return kernel_info.get();
+  }
+  return nullptr;
+}
+
 void cl::device_program::clear() {
   switch (type) {
     case cl::device_program_type::NONE:
@@ -868,11 +909,15 @@ cargo::optional<const compiler::KernelInfo *> _cl_program::getKernelInfo(
       OCL_ASSERT(device_program.program_info, "Program info was null!");
       auto &program_info = *device_program.program_info;
 
-      auto isRequestedKernel = [&](const compiler::KernelInfo &kernel_info) {
-        if (device_program.type == cl::device_program_type::BUILTIN) {
-          return name.find(kernel_info.name) != std::string::npos;
+      if (device_program.type != cl::device_program_type::BUILTIN) {
+        if (auto *kernel_info = device_program.getKernelInfo(name)) {
+          return kernel_info;
         }
-        return kernel_info.name == name;
+        continue;
+      }
+
+      auto isRequestedKernel = [&](const compiler::KernelInfo &kernel_info) {
+        return name.find(kernel_info.name) != std::string::npos;
       };
 
       auto found = std::find_if(program_info.begin(), program_info.end(),
@@ -0,0 +1,161 @@
+// Copyright (C) Codeplay Software Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+// Exceptions; you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://github.com/codeplaysoftware/oneapi-construction-kit/blob/main/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <BenchCL/environment.h>
+#include <BenchCL/error.h>
+#include <CL/cl.h>
+#include <CL/cl_ext.h>
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <string>
+
+namespace {
+/// @brief Element-wise stages of the pipeline, each reads the output of the
+/// previous stage at the same index.
+const char *const pipeline_source = R"CL(
+  kernel void scale(global float *data, float factor) {
+    size_t gid = get_global_id(0);
+    data[gid] = data[gid] * factor;
+  }
+
+  kernel void offset(global float *data, float amount) {
+    size_t gid = get_global_id(0);
+    data[gid] = data[gid] + amount;
+  }
+
+  kernel void clamp_unit(global float *data) {
+    size_t gid = get_global_id(0);
+    data[gid] = clamp(data[gid], 0.0f, 1.0f);
+  }
+
+  kernel void square(global float *data) {
+    size_t gid = get_global_id(0);
+    data[gid] = data[gid] * data[gid];
+  }
+)CL";
+
+const std::array<const char *, 4> pipeline_stages = {"scale", "offset",
+                                                     "clamp_unit", "square"};
+}  // namespace
+
+// Measures enqueuing a finalized command buffer containing a pipeline of
+// element-wise kernels over the same item count. With a second argument of 1
+// every stage has the same range, so when run with CA_HOST_FUSE_NDRANGES=1 the
+// host target fuses them into a single dispatch (CA_HOST_FUSE_NDRANGES=report
+// prints the decisions). With 0 the local size alternates between stages, so
+// each stage is always a separate dispatch, as a baseline in the same run.
+void CommandBufferElementwisePipeline(benchmark::State &state) {
+  const cl_platform_id platform = benchcl::env::get()->platform;
+  const cl_device_id device = benchcl::env::get()->device;
+
+  size_t extensions_size = 0;
+  ASSERT_EQ_ERRCODE(CL_SUCCESS,
+                    clGetDeviceInfo(device, CL_DEVICE_EXTENSIONS, 0, nullptr,
+                                    &extensions_size));
+  std::string extensions(extensions_size, '\0');
+  ASSERT_EQ_ERRCODE(CL_SUCCESS, clGetDeviceInfo(device, CL_DEVICE_EXTENSIONS,
+                                                extensions_size,
+                                                &extensions[0], nullptr));
+  if (extensions.find("cl_khr_command_buffer") == std::string::npos) {
+    state.SkipWithError("cl_khr_command_buffer is not supported");
+    return;
+  }
+
+#define GET_EXTENSION_FUNCTION(FUNCTION)                 \
+  auto FUNCTION = reinterpret_cast<FUNCTION##_fn>(       \
+      clGetExtensionFunctionAddressForPlatform(platform, \
+                                               #FUNCTION))
+  GET_EXTENSION_FUNCTION(clCreateCommandBufferKHR);
+  GET_EXTENSION_FUNCTION(clCommandNDRangeKernelKHR);
+  GET_EXTENSION_FUNCTION(clFinalizeCommandBufferKHR);
+  GET_EXTENSION_FUNCTION(clEnqueueCommandBufferKHR);
+  GET_EXTENSION_FUNCTION(clReleaseCommandBufferKHR);
+#undef GET_EXTENSION_FUNCTION
+
+  cl_int status = CL_SUCCESS;
+  cl_context context =
+      clCreateContext(nullptr, 1, &device, nullptr, nullptr, &status);
+  ASSERT_EQ_ERRCODE(CL_SUCCESS, status);
+
+  const char *source = pipeline_source;
+  cl_program program =
+      clCreateProgramWithSource(context, 1, &source, nullptr, &status);
+  ASSERT_EQ_ERRCODE(CL_SUCCESS, status);
+  ASSERT_EQ_ERRCODE(CL_SUCCESS, clBuildProgram(program, 0, nullptr, nullptr,
+                                               nullptr, nullptr));
+
+  const size_t item_count = state.range(0);
+  cl_mem data = clCreateBuffer(context, CL_MEM_READ_WRITE,
+                               sizeof(cl_float) * item_count, nullptr, &status);
+  ASSERT_EQ_ERRCODE(CL_SUCCESS, status);
+
+  cl_command_queue queue = clCreateCommandQueue(context, device, 0, &status);
+  ASSERT_EQ_ERRCODE(CL_SUCCESS, status);
+
+  cl_command_buffer_khr command_buffer =
+      clCreateCommandBufferKHR(1, &queue, nullptr, &status);
+  ASSERT_EQ_ERRCODE(CL_SUCCESS, status);
+
+  // Use the same explicit local size for every stage so the ranges match,
+  // unless measuring the baseline.
+  const bool same_range = state.range(1);
+  const cl_float factor = 0.5f;
+  const cl_float amount = 0.25f;
+  std::array<cl_kernel, pipeline_stages.size()> kernels;
+  for (size_t i = 0; i < pipeline_stages.size(); i++) {
+    kernels[i] = clCreateKernel(program, pipeline_stages[i], &status);
+    ASSERT_EQ_ERRCODE(CL_SUCCESS, status);
+    ASSERT_EQ_ERRCODE(CL_SUCCESS,
+                      clSetKernelArg(kernels[i], 0, sizeof(cl_mem), &data));
+  }
+  ASSERT_EQ_ERRCODE(CL_SUCCESS,
+                    clSetKernelArg(kernels[0], 1, sizeof(cl_float), &factor));
+  ASSERT_EQ_ERRCODE(CL_SUCCESS,
+                    clSetKernelArg(kernels[1], 1, sizeof(cl_float), &amount));
+  for (size_t i = 0; i < kernels.size(); i++) {
+    const size_t local_size = (same_range || i % 2 == 0) ? 64 : 32;
+    ASSERT_EQ_ERRCODE(CL_SUCCESS,
+                      clCommandNDRangeKernelKHR(
+                          command_buffer, nullptr, nullptr, kernels[i], 1,
+                          nullptr, &item_count, &local_size, 0, nullptr,
+                          nullptr, nullptr));
+  }
+  ASSERT_EQ_ERRCODE(CL_SUCCESS, clFinalizeCommandBufferKHR(command_buffer));
+
+  for (auto _ : state) {
+    (void)_;
+    ASSERT_EQ_ERRCODE(CL_SUCCESS,
+                      clEnqueueCommandBufferKHR(0, nullptr, command_buffer, 0,
+                                                nullptr, nullptr));
+    ASSERT_EQ_ERRCODE(CL_SUCCESS, clFinish(queue));
+  }
+
+  state.SetItemsProcessed(state.iterations() * item_count);
+  state.SetBytesProcessed(state.iterations() * item_count * sizeof(cl_float) *
+                          2 * pipeline_stages.size());
+
+  for (cl_kernel kernel : kernels) {
+    ASSERT_EQ_ERRCODE(CL_SUCCESS, clReleaseKernel(kernel));
+  }
+  ASSERT_EQ_ERRCODE(CL_SUCCESS, clReleaseCommandBufferKHR(command_buffer));
+  ASSERT_EQ_ERRCODE(CL_SUCCESS, clReleaseCommandQueue(queue));
+  ASSERT_EQ_ERRCODE(CL_SUCCESS, clReleaseMemObject(data));
+  ASSERT_EQ_ERRCODE(CL_SUCCESS, clReleaseProgram(program));
+  ASSERT_EQ_ERRCODE(CL_SUCCESS, clReleaseContext(context));
+}
+BENCHMARK(CommandBufferElementwisePipeline)
+    ->ArgsProduct({{1 << 16, 1 << 20, 1 << 24}, {0, 1}});
@@ -0,0 +1,165 @@
+// Copyright (C) Codeplay Software Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+// Exceptions; you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://github.com/codeplaysoftware/oneapi-construction-kit/blob/main/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <BenchCL/environment.h>
+#include <BenchCL/error.h>
+#include <CL/cl.h>
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace {
+/// @brief Math builtins measured, indexed by the first argument of each
+/// benchmark. `pow` is given a constant exponent.
+const std::array<const char *, 5> math_builtins = {"exp", "log", "sin", "cos",
+                                                   "pow"};
+
+template <typename T>
+struct MathType;
+
+template <>
+struct MathType<cl_float> {
+  static constexpr const char *name = "float";
+};
+
+template <>
+struct MathType<cl_double> {
+  static constexpr const char *name = "double";
+};
+
+/// @brief Build an element-wise kernel calling a math builtin, which vecz is
+/// expected to widen to the vector overload of the builtin.
+template <typename T>
+std::string math_source(const std::string &builtin) {
+  const std::string type = MathType<T>::name;
+  const std::string call = builtin == "pow" ? "pow(in[gid], (" + type + ")1.5)"
+                                            : builtin + "(in[gid])";
+  std::string source;
+  if (std::is_same_v<T, cl_double>) {
+    source += "#pragma OPENCL EXTENSION cl_khr_fp64 : enable\n";
+  }
+  source += "kernel void math(global const " + type + " *in, global " + type +
+            " *out) {\n"
+            "  size_t gid = get_global_id(0);\n"
+            "  out[gid] = " +
+            call +
+            ";\n"
+            "}\n";
+  return source;
+}
+}  // namespace
+
+// Measures the throughput of the hottest math builtins after vectorization.
+// The second argument selects small inputs, or inputs spread over the whole
+// exponent range which take the slow path of the sin and cos range reduction.
+template <typename T>
+void MathBuiltinThroughput(benchmark::State &state) {
+  const cl_device_id device = benchcl::env::get()->device;
+  const std::string builtin = math_builtins[state.range(0)];
+  const bool large_inputs = state.range(1) != 0;
+  state.SetLabel(builtin + (large_inputs ? " large" : ""));
+
+  if (std::is_same_v<T, cl_double>) {
+    cl_device_fp_config double_config = 0;
+    ASSERT_EQ_ERRCODE(CL_SUCCESS, clGetDeviceInfo(device,
+                                                  CL_DEVICE_DOUBLE_FP_CONFIG,
+                                                  sizeof(double_config),
+                                                  &double_config, nullptr));
+    if (0 == double_config) {
+      state.SkipWithError("double is not supported");
+      return;
+    }
+  }
+
+  cl_int status = CL_SUCCESS;
+  cl_context context =
+      clCreateContext(nullptr, 1, &device, nullptr, nullptr, &status);
+  ASSERT_EQ_ERRCODE(CL_SUCCESS, status);
+
+  const std::string source_string = math_source<T>(builtin);
+  const char *source = source_string.c_str();
+  cl_program program =
+      clCreateProgramWithSource(context, 1, &source, nullptr, &status);
+  ASSERT_EQ_ERRCODE(CL_SUCCESS, status);
+  ASSERT_EQ_ERRCODE(CL_SUCCESS, clBuildProgram(program, 0, nullptr, nullptr,
+                                               nullptr, nullptr));
+
+  cl_kernel kernel = clCreateKernel(program, "math", &status);
+  ASSERT_EQ_ERRCODE(CL_SUCCESS, status);
+
+  const size_t item_count = 1 << 22;
+  const int max_exponent = std::numeric_limits<T>::max_exponent - 1;
+  std::vector<T> input(item_count);
+  for (size_t i = 0; i < item_count; i++) {
+    // Positive, so that log and pow are defined.
+    const T mantissa = T(1) + static_cast<T>(i % 1021) / T(1021);
+    const int exponent = large_inputs ? static_cast<int>(i % max_exponent)
+                                      : static_cast<int>(i % 7) - 3;
+    input[i] = std::ldexp(mantissa, exponent);
+  }
+
+  const size_t bytes = sizeof(T) * item_count;
+  cl_mem in = clCreateBuffer(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR,
+                             bytes, input.data(), &status);
+  ASSERT_EQ_ERRCODE(CL_SUCCESS, status);
+  cl_mem out =
+      clCreateBuffer(context, CL_MEM_WRITE_ONLY, bytes, nullptr, &status);
+  ASSERT_EQ_ERRCODE(CL_SUCCESS, status);
+  ASSERT_EQ_ERRCODE(CL_SUCCESS, clSetKernelArg(kernel, 0, sizeof(cl_mem), &in));
+  ASSERT_EQ_ERRCODE(CL_SUCCESS,
+                    clSetKernelArg(kernel, 1, sizeof(cl_mem), &out));
+
+  cl_command_queue queue = clCreateCommandQueue(context, device, 0, &status);
+  ASSERT_EQ_ERRCODE(CL_SUCCESS, status);
+
+  // Run once first, so that the kernel is compiled outside the timed loop.
+  ASSERT_EQ_ERRCODE(CL_SUCCESS,
+                    clEnqueueNDRangeKernel(queue, kernel, 1, nullptr,
+                                           &item_count, nullptr, 0, nullptr,
+                                           nullptr));
+  ASSERT_EQ_ERRCODE(CL_SUCCESS, clFinish(queue));
+
+  for (auto _ : state) {
+    (void)_;
+    ASSERT_EQ_ERRCODE(CL_SUCCESS,
+                      clEnqueueNDRangeKernel(queue, kernel, 1, nullptr,
+                                             &item_count, nullptr, 0, nullptr,
+                                             nullptr));
+    ASSERT_EQ_ERRCODE(CL_SUCCESS, clFinish(queue));
+  }
+
+  state.SetItemsProcessed(state.iterations() * item_count);
+
+  ASSERT_EQ_ERRCODE(CL_SUCCESS, clReleaseCommandQueue(queue));
+  ASSERT_EQ_ERRCODE(CL_SUCCESS, clReleaseMemObject(out));
+  ASSERT_EQ_ERRCODE(CL_SUCCESS, clReleaseMemObject(in));
+  ASSERT_EQ_ERRCODE(CL_SUCCESS, clReleaseKernel(kernel));
+  ASSERT_EQ_ERRCODE(CL_SUCCESS, clReleaseProgram(program));
+  ASSERT_EQ_ERRCODE(CL_SUCCESS, clReleaseContext(context));
+}
+BENCHMARK_TEMPLATE(MathBuiltinThroughput, cl_float)
+    ->ArgsProduct({{0, 1, 2, 3, 4}, {0}})
+    ->Args({2, 1})
+    ->Args({3, 1});
+BENCHMARK_TEMPLATE(MathBuiltinThroughput, cl_double)
+    ->ArgsProduct({{0, 1, 2, 3, 4}, {0}})
+    ->Args({2, 1})
+    ->Args({3, 1});
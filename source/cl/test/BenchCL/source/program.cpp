@@ -284,3 +284,52 @@ static void BuildSingleStringProgram(benchmark::State &state) {
 TEMPLATE_FOREACH(InputType::NOP);
 TEMPLATE_FOREACH(InputType::NOBUILTINS);
 TEMPLATE_FOREACH(InputType::MATHBUILTINS);
+
+// Measures building a program with many kernels and creating its binary, the
+// code for which is generated in parallel, partitions of the kernels at a
+// time. Run it again under `taskset -c 0` for a single threaded baseline to
+// compare with, as the compiler's thread pool only uses the CPUs it is allowed
+// to run on.
+static void BuildManyKernelProgramBinary(benchmark::State &state) {
+  CreateProgramData cpd;
+
+  const unsigned kernel_count = state.range(0);
+  std::string source;
+  for (unsigned k = 0; k < kernel_count; k++) {
+    const std::string id = std::to_string(k);
+    source += "void kernel foo" + id + "(global float* o, global float* i) {\n";
+    source += "  const size_t id = get_global_id(0);\n";
+    source += "  o[id] = i[id] + " + id + ".0f;\n";
+    for (unsigned i = 0; i < 16; i++) {
+      source += "  o[id] = pow(o[id], i[id]) + sqrt(o[id]);\n";
+    }
+    source += "}\n";
+  }
+  const char *str = source.c_str();
+
+  for (auto _ : state) {
+    cl_int status = CL_SUCCESS;
+    cl_program program =
+        clCreateProgramWithSource(cpd.context, 1, &str, nullptr, &status);
+    ASSERT_EQ_ERRCODE(CL_SUCCESS, status);
+    ASSERT_EQ_ERRCODE(CL_SUCCESS, clBuildProgram(program, 0, nullptr, nullptr,
+                                                 nullptr, nullptr));
+    // Querying the binary size creates the binary.
+    size_t binary_size = 0;
+    ASSERT_EQ_ERRCODE(CL_SUCCESS,
+                      clGetProgramInfo(program, CL_PROGRAM_BINARY_SIZES,
+                                       sizeof(binary_size), &binary_size,
+                                       nullptr));
+    benchmark::DoNotOptimize(binary_size);
+    clReleaseProgram(program);
+  }
+
+  state.SetItemsProcessed(state.iterations() * kernel_count);
+}
+
+BENCHMARK(BuildManyKernelProgramBinary)
+    ->Arg(1)
+    ->Arg(16)
+    ->Arg(64)
+    ->Arg(256)
+    ->Unit(benchmark::kMillisecond);
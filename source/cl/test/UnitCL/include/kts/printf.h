@@ -184,6 +184,7 @@ struct PrintfExecution : BasePrintfExecution,
 };
 
 using PrintfExecutionSPIRV = PrintfExecution;
+using PrintfExecutionOpenCLC = PrintfExecution;
 
 template <class Param>
 struct PrintfExecutionWithParam
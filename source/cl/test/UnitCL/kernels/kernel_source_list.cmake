@@ -213,6 +213,7 @@ set(KERNEL_FILES
   ${CMAKE_CURRENT_SOURCE_DIR}/precision.91_double_convert_char_rtp.cl
   ${CMAKE_CURRENT_SOURCE_DIR}/precision.92_half_hypot_edgecases.cl
   ${CMAKE_CURRENT_SOURCE_DIR}/precision.93_divide_relaxed.cl
+  ${CMAKE_CURRENT_SOURCE_DIR}/precision.94_double_sin_large.cl
   ${CMAKE_CURRENT_SOURCE_DIR}/printf.01_hello.cl
   ${CMAKE_CURRENT_SOURCE_DIR}/printf.02_order.cl
   ${CMAKE_CURRENT_SOURCE_DIR}/printf.03_string.cl
@@ -238,6 +239,7 @@ set(KERNEL_FILES
   ${CMAKE_CURRENT_SOURCE_DIR}/printf.20_multiple_kernels.cl
   ${CMAKE_CURRENT_SOURCE_DIR}/printf.21_float_with_double_conversion.cl
   ${CMAKE_CURRENT_SOURCE_DIR}/printf.22_half_with_double_conversion.cl
+  ${CMAKE_CURRENT_SOURCE_DIR}/printf.24_many_work_groups.cl
   ${CMAKE_CURRENT_SOURCE_DIR}/regression.01_pointer_to_long_cast.cl
   ${CMAKE_CURRENT_SOURCE_DIR}/regression.02_work_dim.cl
   ${CMAKE_CURRENT_SOURCE_DIR}/regression.03_shuffle_cast.cl
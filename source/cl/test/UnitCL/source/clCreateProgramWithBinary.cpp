@@ -415,3 +415,91 @@ TEST_F(clCreateProgramWithBinaryTest, IL) {
   ASSERT_EQ(param_val[0], 42);
 }
 #endif
+
+class clCreateProgramWithBinaryKernelsTest : public ucl::ContextTest {
+ protected:
+  void SetUp() override {
+    UCL_RETURN_ON_FATAL_FAILURE(ContextTest::SetUp());
+    if (!getDeviceCompilerAvailable()) {
+      GTEST_SKIP();
+    }
+    const char *source = R"(
+kernel void one(global int *a) { *a = 1; }
+
+__attribute__((reqd_work_group_size(4, 2, 1)))
+kernel void two(global int *a, int b) { *a = b; }
+
+kernel void three(global int *a, int b, int c) { *a = b + c; }
+)";
+    cl_int errcode;
+    cl_program source_program =
+        clCreateProgramWithSource(context, 1, &source, nullptr, &errcode);
+    ASSERT_SUCCESS(errcode);
+    ASSERT_SUCCESS(
+        clBuildProgram(source_program, 0, nullptr, nullptr, nullptr, nullptr));
+    size_t binary_size;
+    ASSERT_SUCCESS(clGetProgramInfo(source_program, CL_PROGRAM_BINARY_SIZES,
+                                    sizeof(binary_size), &binary_size,
+                                    nullptr));
+    binary.resize(binary_size);
+    unsigned char *binary_data = binary.data();
+    ASSERT_SUCCESS(clGetProgramInfo(source_program, CL_PROGRAM_BINARIES,
+                                    sizeof(binary_data), &binary_data,
+                                    nullptr));
+    ASSERT_SUCCESS(clReleaseProgram(source_program));
+  }
+
+  void TearDown() override {
+    if (program) {
+      EXPECT_SUCCESS(clReleaseProgram(program));
+    }
+    ContextTest::TearDown();
+  }
+
+  UCL::vector<unsigned char> binary;
+  cl_program program = nullptr;
+};
+
+// The information of each kernel in a binary is only read when the kernel is
+// first used, check that works regardless of the order kernels are used in.
+TEST_F(clCreateProgramWithBinaryKernelsTest, CreateKernelsInReverse) {
+  const unsigned char *binary_data = binary.data();
+  const size_t binary_size = binary.size();
+  cl_int binary_status;
+  cl_int errcode;
+  program = clCreateProgramWithBinary(context, 1, &device, &binary_size,
+                                      &binary_data, &binary_status, &errcode);
+  ASSERT_SUCCESS(errcode);
+  ASSERT_SUCCESS(binary_status);
+  ASSERT_SUCCESS(
+      clBuildProgram(program, 1, &device, nullptr, nullptr, nullptr));
+
+  size_t num_kernels;
+  ASSERT_SUCCESS(clGetProgramInfo(program, CL_PROGRAM_NUM_KERNELS,
+                                  sizeof(num_kernels), &num_kernels, nullptr));
+  ASSERT_EQ(3u, num_kernels);
+
+  const char *names[] = {"three", "two", "one"};
+  const cl_uint num_args[] = {3, 2, 1};
+  for (size_t i = 0; i < 3; i++) {
+    cl_kernel kernel = clCreateKernel(program, names[i], &errcode);
+    ASSERT_SUCCESS(errcode);
+    cl_uint kernel_num_args;
+    EXPECT_SUCCESS(clGetKernelInfo(kernel, CL_KERNEL_NUM_ARGS,
+                                   sizeof(kernel_num_args), &kernel_num_args,
+                                   nullptr));
+    EXPECT_EQ(num_args[i], kernel_num_args);
+    size_t compile_work_group_size[3];
+    EXPECT_SUCCESS(clGetKernelWorkGroupInfo(
+        kernel, device, CL_KERNEL_COMPILE_WORK_GROUP_SIZE,
+        sizeof(compile_work_group_size), compile_work_group_size, nullptr));
+    if (1 == i) {
+      EXPECT_EQ(4u, compile_work_group_size[0]);
+      EXPECT_EQ(2u, compile_work_group_size[1]);
+      EXPECT_EQ(1u, compile_work_group_size[2]);
+    } else {
+      EXPECT_EQ(0u, compile_work_group_size[0]);
+    }
+    ASSERT_SUCCESS(clReleaseKernel(kernel));
+  }
+}
@@ -2509,3 +2509,121 @@ TEST_F(GetEnqueuedLocalSizeTest, Uniform3D) {
         << "incorrect local size in z dimension for workgroup: " << workgroup;
   }
 }
+
+#ifdef CL_VERSION_3_0
+class NonUniformWorkGroupTest : public ucl::CommandQueueTest {
+ protected:
+  void SetUp() override {
+    UCL_RETURN_ON_FATAL_FAILURE(CommandQueueTest::SetUp());
+    // Non-uniform work-groups are optional in OpenCL-3.0.
+    if (!UCL::isDeviceVersionAtLeast({3, 0}) ||
+        !getDeviceNonUniformWorkGroupSupport()) {
+      GTEST_SKIP();
+    }
+    // Requires a compiler to compile the kernel.
+    if (!getDeviceCompilerAvailable()) {
+      GTEST_SKIP();
+    }
+  }
+
+  void TearDown() override {
+    if (nullptr != output_buffer) {
+      EXPECT_SUCCESS(clReleaseMemObject(output_buffer));
+    }
+    if (nullptr != kernel) {
+      EXPECT_SUCCESS(clReleaseKernel(kernel));
+    }
+    if (nullptr != program) {
+      EXPECT_SUCCESS(clReleaseProgram(program));
+    }
+    CommandQueueTest::TearDown();
+  }
+
+  void BuildKernel(const char *options) {
+    const char *source = R"(
+      __kernel void non_uniform(__global uint4 *out) {
+        size_t gid = get_global_id(0);
+        out[gid] = (uint4)((uint)gid, (uint)get_local_size(0),
+                           (uint)get_enqueued_local_size(0),
+                           (uint)get_num_groups(0));
+      }
+    )";
+    cl_int error_code{};
+    program =
+        clCreateProgramWithSource(context, 1, &source, nullptr, &error_code);
+    EXPECT_TRUE(program);
+    ASSERT_SUCCESS(error_code);
+    ASSERT_SUCCESS(
+        clBuildProgram(program, 1, &device, options, nullptr, nullptr));
+    kernel = clCreateKernel(program, "non_uniform", &error_code);
+    EXPECT_TRUE(kernel);
+    ASSERT_SUCCESS(error_code);
+    output_buffer =
+        clCreateBuffer(context, CL_MEM_WRITE_ONLY, sizeof(cl_uint4) * global,
+                       nullptr, &error_code);
+    EXPECT_TRUE(output_buffer);
+    ASSERT_SUCCESS(error_code);
+    ASSERT_SUCCESS(
+        clSetKernelArg(kernel, 0, sizeof(output_buffer), &output_buffer));
+  }
+
+  // A prime, so no local size larger than one divides it.
+  static constexpr size_t global = 1021;
+
+  cl_program program{nullptr};
+  cl_kernel kernel{nullptr};
+  cl_mem output_buffer{nullptr};
+};
+
+TEST_F(NonUniformWorkGroupTest, TrailingWorkGroup) {
+  ASSERT_NO_FATAL_FAILURE(BuildKernel("-cl-std=CL3.0"));
+  const size_t local = 16;
+  ASSERT_SUCCESS(clEnqueueNDRangeKernel(command_queue, kernel, 1, nullptr,
+                                        &global, &local, 0, nullptr, nullptr));
+  UCL::AlignedBuffer<cl_uint4> output{global};
+  ASSERT_SUCCESS(clEnqueueReadBuffer(command_queue, output_buffer, CL_TRUE, 0,
+                                     sizeof(cl_uint4) * global, output.data(),
+                                     0, nullptr, nullptr));
+
+  const size_t trailing_start = (global / local) * local;
+  for (size_t i = 0; i < global; i++) {
+    ASSERT_EQ(output[i].x, i);
+    const size_t expected_local = i < trailing_start ? local : global % local;
+    ASSERT_EQ(output[i].y, expected_local) << "at index " << i;
+    ASSERT_EQ(output[i].z, local) << "at index " << i;
+    ASSERT_EQ(output[i].w, (global + local - 1) / local) << "at index " << i;
+  }
+}
+
+TEST_F(NonUniformWorkGroupTest, DefaultLocalSize) {
+  ASSERT_NO_FATAL_FAILURE(BuildKernel("-cl-std=CL3.0"));
+  ASSERT_SUCCESS(clEnqueueNDRangeKernel(command_queue, kernel, 1, nullptr,
+                                        &global, nullptr, 0, nullptr, nullptr));
+  UCL::AlignedBuffer<cl_uint4> output{global};
+  ASSERT_SUCCESS(clEnqueueReadBuffer(command_queue, output_buffer, CL_TRUE, 0,
+                                     sizeof(cl_uint4) * global, output.data(),
+                                     0, nullptr, nullptr));
+
+  // Whatever local size was picked, every work-item must run once and only
+  // the trailing work-group may be smaller.
+  const size_t enqueued = output[0].z;
+  ASSERT_NE(enqueued, 0);
+  for (size_t i = 0; i < global; i++) {
+    ASSERT_EQ(output[i].x, i);
+    ASSERT_EQ(output[i].z, enqueued) << "at index " << i;
+    const size_t group_start = (i / enqueued) * enqueued;
+    ASSERT_EQ(output[i].y, std::min(enqueued, global - group_start))
+        << "at index " << i;
+  }
+}
+
+TEST_F(NonUniformWorkGroupTest, UniformWorkGroupSizeOption) {
+  ASSERT_NO_FATAL_FAILURE(
+      BuildKernel("-cl-std=CL3.0 -cl-uniform-work-group-size"));
+  const size_t local = 16;
+  ASSERT_EQ_ERRCODE(
+      CL_INVALID_WORK_GROUP_SIZE,
+      clEnqueueNDRangeKernel(command_queue, kernel, 1, nullptr, &global,
+                             &local, 0, nullptr, nullptr));
+}
+#endif
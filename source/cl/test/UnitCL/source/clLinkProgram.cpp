@@ -560,3 +560,62 @@ int extern_function_int() { return 42;})";
   ASSERT_SUCCESS(clReleaseProgram(program_extern_function_def));
   ASSERT_SUCCESS(clReleaseProgram(linked_program));
 }
+
+TEST_F(clLinkProgramTest, RelinkLibraryWithDifferentUses) {
+  if (!getDeviceCompilerAvailable()) {
+    GTEST_SKIP();
+  }
+  cl_int error;
+  const char *source_library = R"(
+int scale(int x) { return x * 3; })";
+  cl_program program_library =
+      clCreateProgramWithSource(context, 1, &source_library, nullptr, &error);
+  ASSERT_SUCCESS(error);
+  ASSERT_SUCCESS(clCompileProgram(program_library, 1, &device, "", 0, nullptr,
+                                  nullptr, nullptr, nullptr));
+
+  // Link the same library with different uses of it, the library is only
+  // optimized once but each linked program must still behave correctly.
+  const char *sources_use[2] = {R"(
+extern int scale(int x);
+void kernel foo(global int *buf) { buf[0] = scale(buf[0]) + 1; })",
+                                R"(
+extern int scale(int x);
+void kernel foo(global int *buf) { buf[0] = scale(buf[0]) + 2; })"};
+  cl_command_queue command_queue =
+      clCreateCommandQueue(context, device, 0, &error);
+  ASSERT_SUCCESS(error);
+  for (cl_int offset = 1; offset <= 2; offset++) {
+    cl_program program_use = clCreateProgramWithSource(
+        context, 1, &sources_use[offset - 1], nullptr, &error);
+    ASSERT_SUCCESS(error);
+    ASSERT_SUCCESS(clCompileProgram(program_use, 1, &device, "", 0, nullptr,
+                                    nullptr, nullptr, nullptr));
+    cl_program programs[2] = {program_library, program_use};
+    cl_program linked_program = clLinkProgram(
+        context, 1, &device, "", 2, programs, nullptr, nullptr, &error);
+    EXPECT_NE(nullptr, linked_program);
+    ASSERT_SUCCESS(error);
+
+    cl_kernel kernel = clCreateKernel(linked_program, "foo", &error);
+    ASSERT_SUCCESS(error);
+    cl_int value = 7;
+    cl_mem buffer =
+        clCreateBuffer(context, CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR,
+                       sizeof(cl_int), &value, &error);
+    ASSERT_SUCCESS(error);
+    ASSERT_SUCCESS(clSetKernelArg(kernel, 0, sizeof(cl_mem), &buffer));
+    ASSERT_SUCCESS(clEnqueueTask(command_queue, kernel, 0, nullptr, nullptr));
+    ASSERT_SUCCESS(clEnqueueReadBuffer(command_queue, buffer, CL_TRUE, 0,
+                                       sizeof(cl_int), &value, 0, nullptr,
+                                       nullptr));
+    EXPECT_EQ(7 * 3 + offset, value);
+
+    ASSERT_SUCCESS(clReleaseMemObject(buffer));
+    ASSERT_SUCCESS(clReleaseKernel(kernel));
+    ASSERT_SUCCESS(clReleaseProgram(linked_program));
+    ASSERT_SUCCESS(clReleaseProgram(program_use));
+  }
+  ASSERT_SUCCESS(clReleaseCommandQueue(command_queue));
+  ASSERT_SUCCESS(clReleaseProgram(program_library));
+}
@@ -14,6 +14,8 @@
 //
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
+#include <CL/cl_ext_codeplay.h>
+
 #include "Common.h"
 
 class cl_codeplay_extra_build_options_BuildFlags : public ucl::ContextTest {
@@ -119,6 +121,99 @@ TEST_F(cl_codeplay_extra_build_options_BuildFlags,
   EXPECT_SUCCESS(clReleaseCommandQueue(command_queue));
 }
 
+TEST_F(cl_codeplay_extra_build_options_BuildFlags, clBuildAndRunLazyKernels) {
+  ASSERT_SUCCESS(clBuildProgram(program, 0, nullptr, "-cl-lazy-kernels",
+                                nullptr, nullptr));
+
+  // Kernels are only optimized when first created, make sure the kernel still
+  // runs correctly.
+  cl_int errorcode = CL_SUCCESS;
+  cl_kernel kernel = clCreateKernel(program, "foo", &errorcode);
+  ASSERT_SUCCESS(errorcode);
+
+  const cl_int input = 42;
+  cl_mem in_buffer =
+      clCreateBuffer(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR,
+                     sizeof(cl_int), const_cast<cl_int *>(&input), &errorcode);
+  ASSERT_TRUE(nullptr != in_buffer);
+  EXPECT_SUCCESS(errorcode);
+
+  cl_mem out_buffer = clCreateBuffer(context, CL_MEM_WRITE_ONLY, sizeof(cl_int),
+                                     nullptr, &errorcode);
+  ASSERT_TRUE(nullptr != out_buffer);
+  EXPECT_SUCCESS(errorcode);
+
+  EXPECT_EQ_ERRCODE(CL_SUCCESS,
+                    clSetKernelArg(kernel, 0, sizeof(cl_mem), &out_buffer));
+  EXPECT_EQ_ERRCODE(CL_SUCCESS,
+                    clSetKernelArg(kernel, 1, sizeof(cl_mem), &in_buffer));
+
+  cl_command_queue command_queue =
+      clCreateCommandQueue(context, device, 0, &errorcode);
+  ASSERT_TRUE(nullptr != command_queue);
+  EXPECT_SUCCESS(errorcode);
+
+  const size_t work_size = 1;
+  ASSERT_SUCCESS(clEnqueueNDRangeKernel(command_queue, kernel, 1, nullptr,
+                                        &work_size, nullptr, 0, nullptr,
+                                        nullptr));
+  cl_int output = 0;
+  ASSERT_SUCCESS(clEnqueueReadBuffer(command_queue, out_buffer, CL_TRUE, 0,
+                                     sizeof(cl_int), &output, 0, nullptr,
+                                     nullptr));
+  EXPECT_EQ(input, output);
+
+  EXPECT_SUCCESS(clReleaseKernel(kernel));
+  EXPECT_SUCCESS(clReleaseMemObject(in_buffer));
+  EXPECT_SUCCESS(clReleaseMemObject(out_buffer));
+  EXPECT_SUCCESS(clReleaseCommandQueue(command_queue));
+}
+
+TEST_F(cl_codeplay_extra_build_options_BuildFlags, clBuildProfile) {
+  if (UCL::isInterceptLayerPresent()) {
+    GTEST_SKIP();  // Injection creates programs from binaries, can't compile.
+  }
+
+  // Nothing is recorded unless asked for.
+  ASSERT_SUCCESS(clBuildProgram(program, 0, nullptr, "", nullptr, nullptr));
+  size_t size = 1;
+  ASSERT_SUCCESS(clGetProgramBuildInfo(program, device,
+                                       CL_PROGRAM_BUILD_PROFILE_CODEPLAY, 0,
+                                       nullptr, &size));
+  EXPECT_EQ(0, size);
+
+  ASSERT_SUCCESS(clBuildProgram(program, 0, nullptr, "-cl-build-profile",
+                                nullptr, nullptr));
+  ASSERT_SUCCESS(clGetProgramBuildInfo(program, device,
+                                       CL_PROGRAM_BUILD_PROFILE_CODEPLAY, 0,
+                                       nullptr, &size));
+  ASSERT_LT(0, size);
+  ASSERT_EQ(0, size % sizeof(cl_program_build_profile_entry_codeplay));
+  std::vector<cl_program_build_profile_entry_codeplay> profile(
+      size / sizeof(cl_program_build_profile_entry_codeplay));
+  ASSERT_SUCCESS(clGetProgramBuildInfo(program, device,
+                                       CL_PROGRAM_BUILD_PROFILE_CODEPLAY, size,
+                                       profile.data(), nullptr));
+
+  // The profile is a tree in depth first order, starting with the frontend.
+  EXPECT_STREQ("frontend", profile[0].name);
+  bool finalized = false;
+  cl_uint depth = 0;
+  for (const auto &stage : profile) {
+    EXPECT_LE(stage.depth, depth + 1);
+    EXPECT_LT(0, stage.count);
+    depth = stage.depth;
+    if (0 == stage.depth && 0 == std::strcmp("finalize", stage.name)) {
+      finalized = true;
+    }
+  }
+  EXPECT_TRUE(finalized);
+  EXPECT_EQ_ERRCODE(CL_INVALID_VALUE,
+                    clGetProgramBuildInfo(program, device,
+                                          CL_PROGRAM_BUILD_PROFILE_CODEPLAY,
+                                          size - 1, profile.data(), nullptr));
+}
+
 TEST_F(cl_codeplay_extra_build_options_BuildFlags,
        clBuildPrecacheLocalSizesInvalid) {
   // Local work group sizes only support up to three dimensions.
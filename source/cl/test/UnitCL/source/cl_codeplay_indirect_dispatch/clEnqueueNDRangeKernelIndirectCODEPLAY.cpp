@@ -0,0 +1,169 @@
+// Copyright (C) Codeplay Software Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+// Exceptions; you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://github.com/codeplaysoftware/oneapi-construction-kit/blob/main/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <CL/cl_ext_codeplay.h>
+
+#include <array>
+#include <cstring>
+#include <vector>
+
+#include "Common.h"
+
+struct clEnqueueNDRangeKernelIndirectCODEPLAYTest : ucl::CommandQueueTest {
+  void SetUp() override {
+    UCL_RETURN_ON_FATAL_FAILURE(CommandQueueTest::SetUp());
+    if (!getDeviceCompilerAvailable() ||
+        !isDeviceExtensionSupported("cl_codeplay_indirect_dispatch")) {
+      GTEST_SKIP();
+    }
+    clEnqueueNDRangeKernelIndirectCODEPLAY =
+        reinterpret_cast<clEnqueueNDRangeKernelIndirectCODEPLAY_fn>(
+            clGetExtensionFunctionAddressForPlatform(
+                platform, "clEnqueueNDRangeKernelIndirectCODEPLAY"));
+    ASSERT_NE(nullptr, clEnqueueNDRangeKernelIndirectCODEPLAY);
+
+    const char *code = R"(
+kernel void test(global uint* out) {
+  size_t id = get_global_id(0);
+  out[id] = (uint)get_global_size(0);
+}
+)";
+    const size_t length = std::strlen(code);
+    cl_int error = !CL_SUCCESS;
+    program = clCreateProgramWithSource(context, 1, &code, &length, &error);
+    ASSERT_SUCCESS(error);
+    ASSERT_SUCCESS(clBuildProgram(program, 1, &device, nullptr,
+                                  ucl::buildLogCallback, nullptr));
+    kernel = clCreateKernel(program, "test", &error);
+    ASSERT_SUCCESS(error);
+
+    out_buffer = clCreateBuffer(context, CL_MEM_READ_WRITE,
+                                sizeof(cl_uint) * max_items, nullptr, &error);
+    ASSERT_SUCCESS(error);
+    ASSERT_SUCCESS(clSetKernelArg(kernel, 0, sizeof(cl_mem),
+                                  static_cast<void *>(&out_buffer)));
+
+    // Leave a padding count before the work-group counts to test the offset.
+    indirect_buffer = clCreateBuffer(context, CL_MEM_READ_ONLY,
+                                     sizeof(cl_uint) * 4, nullptr, &error);
+    ASSERT_SUCCESS(error);
+  }
+
+  void TearDown() override {
+    if (indirect_buffer) {
+      EXPECT_SUCCESS(clReleaseMemObject(indirect_buffer));
+    }
+    if (out_buffer) {
+      EXPECT_SUCCESS(clReleaseMemObject(out_buffer));
+    }
+    if (kernel) {
+      EXPECT_SUCCESS(clReleaseKernel(kernel));
+    }
+    if (program) {
+      EXPECT_SUCCESS(clReleaseProgram(program));
+    }
+    CommandQueueTest::TearDown();
+  }
+
+  static constexpr size_t max_items = 64;
+  clEnqueueNDRangeKernelIndirectCODEPLAY_fn
+      clEnqueueNDRangeKernelIndirectCODEPLAY = nullptr;
+  cl_program program = nullptr;
+  cl_kernel kernel = nullptr;
+  cl_mem out_buffer = nullptr;
+  cl_mem indirect_buffer = nullptr;
+};
+
+TEST_F(clEnqueueNDRangeKernelIndirectCODEPLAYTest, Default) {
+  const std::array<cl_uint, 4> counts = {{0, 4, 1, 1}};
+  ASSERT_SUCCESS(clEnqueueWriteBuffer(command_queue, indirect_buffer, CL_FALSE,
+                                      0, sizeof(counts), counts.data(), 0,
+                                      nullptr, nullptr));
+  const cl_uint zero = 0;
+  ASSERT_SUCCESS(clEnqueueFillBuffer(command_queue, out_buffer, &zero,
+                                     sizeof(zero), 0,
+                                     sizeof(cl_uint) * max_items, 0, nullptr,
+                                     nullptr));
+
+  const size_t local_size = 2;
+  ASSERT_SUCCESS(clEnqueueNDRangeKernelIndirectCODEPLAY(
+      command_queue, kernel, 1, &local_size, indirect_buffer, sizeof(cl_uint),
+      0, nullptr, nullptr));
+
+  std::vector<cl_uint> results(max_items);
+  ASSERT_SUCCESS(clEnqueueReadBuffer(command_queue, out_buffer, CL_TRUE, 0,
+                                     sizeof(cl_uint) * max_items,
+                                     results.data(), 0, nullptr, nullptr));
+
+  // Four work-groups of two work-items.
+  const size_t global_size = counts[1] * local_size;
+  for (size_t i = 0; i < max_items; i++) {
+    EXPECT_EQ(i < global_size ? global_size : 0, results[i]) << "at " << i;
+  }
+}
+
+TEST_F(clEnqueueNDRangeKernelIndirectCODEPLAYTest, ZeroWorkGroups) {
+  const std::array<cl_uint, 4> counts = {{0, 0, 1, 1}};
+  ASSERT_SUCCESS(clEnqueueWriteBuffer(command_queue, indirect_buffer, CL_FALSE,
+                                      0, sizeof(counts), counts.data(), 0,
+                                      nullptr, nullptr));
+  const cl_uint zero = 0;
+  ASSERT_SUCCESS(clEnqueueFillBuffer(command_queue, out_buffer, &zero,
+                                     sizeof(zero), 0,
+                                     sizeof(cl_uint) * max_items, 0, nullptr,
+                                     nullptr));
+
+  const size_t local_size = 1;
+  ASSERT_SUCCESS(clEnqueueNDRangeKernelIndirectCODEPLAY(
+      command_queue, kernel, 1, &local_size, indirect_buffer, sizeof(cl_uint),
+      0, nullptr, nullptr));
+
+  std::vector<cl_uint> results(max_items);
+  ASSERT_SUCCESS(clEnqueueReadBuffer(command_queue, out_buffer, CL_TRUE, 0,
+                                     sizeof(cl_uint) * max_items,
+                                     results.data(), 0, nullptr, nullptr));
+  for (size_t i = 0; i < max_items; i++) {
+    EXPECT_EQ(0, results[i]) << "at " << i;
+  }
+}
+
+TEST_F(clEnqueueNDRangeKernelIndirectCODEPLAYTest, InvalidMemObject) {
+  ASSERT_EQ_ERRCODE(CL_INVALID_MEM_OBJECT,
+                    clEnqueueNDRangeKernelIndirectCODEPLAY(
+                        command_queue, kernel, 1, nullptr, nullptr, 0, 0,
+                        nullptr, nullptr));
+}
+
+TEST_F(clEnqueueNDRangeKernelIndirectCODEPLAYTest, InvalidOffsetAlignment) {
+  ASSERT_EQ_ERRCODE(CL_INVALID_VALUE,
+                    clEnqueueNDRangeKernelIndirectCODEPLAY(
+                        command_queue, kernel, 1, nullptr, indirect_buffer, 2,
+                        0, nullptr, nullptr));
+}
+
+TEST_F(clEnqueueNDRangeKernelIndirectCODEPLAYTest, InvalidOffsetOutOfBounds) {
+  ASSERT_EQ_ERRCODE(CL_INVALID_VALUE,
+                    clEnqueueNDRangeKernelIndirectCODEPLAY(
+                        command_queue, kernel, 1, nullptr, indirect_buffer,
+                        sizeof(cl_uint) * 2, 0, nullptr, nullptr));
+}
+
+TEST_F(clEnqueueNDRangeKernelIndirectCODEPLAYTest, InvalidWorkDimension) {
+  ASSERT_EQ_ERRCODE(CL_INVALID_WORK_DIMENSION,
+                    clEnqueueNDRangeKernelIndirectCODEPLAY(
+                        command_queue, kernel, 0, nullptr, indirect_buffer, 0,
+                        0, nullptr, nullptr));
+}
@@ -126,3 +126,74 @@ TEST_F(cl_codeplay_performance_counters_Test, Default) {
   EXPECT_SUCCESS(clReleaseKernel(kernel));
   EXPECT_SUCCESS(clReleaseProgram(program));
 }
+
+TEST_F(cl_codeplay_performance_counters_Test, NDRangeSliceCounters) {
+  size_t size;
+  ASSERT_SUCCESS(clGetDeviceInfo(
+      device, CL_DEVICE_PERFORMANCE_COUNTERS_CODEPLAY, 0, nullptr, &size));
+  std::vector<cl_performance_counter_codeplay> counters{
+      size / sizeof(cl_performance_counter_codeplay)};
+  if (size) {
+    ASSERT_SUCCESS(clGetDeviceInfo(device,
+                                   CL_DEVICE_PERFORMANCE_COUNTERS_CODEPLAY,
+                                   size, counters.data(), nullptr));
+  }
+  // The ND range slice counters are specific to the host target.
+  auto findCounter = [&](const char *name) {
+    return std::find_if(counters.begin(), counters.end(),
+                        [&](const cl_performance_counter_codeplay &counter) {
+                          return 0 == std::strcmp(counter.category,
+                                                  "ND range") &&
+                                 0 == std::strcmp(counter.name, name);
+                        });
+  };
+  auto ndranges = findCounter("ndranges");
+  auto work_groups = findCounter("work_groups");
+  auto imbalance = findCounter("slice_imbalance");
+  if (ndranges == counters.end() || work_groups == counters.end() ||
+      imbalance == counters.end()) {
+    GTEST_SKIP();
+  }
+  std::array<cl_performance_counter_desc_codeplay, 3> counter_descs{{
+      {ndranges->uuid, nullptr},
+      {work_groups->uuid, nullptr},
+      {imbalance->uuid, nullptr},
+  }};
+  cl_performance_counter_config_codeplay counter_config = {
+      static_cast<cl_uint>(counter_descs.size()), counter_descs.data()};
+  std::array<cl_queue_properties_khr, 3> properties{{
+      CL_QUEUE_PERFORMANCE_COUNTERS_CODEPLAY,
+      reinterpret_cast<cl_queue_properties_khr>(&counter_config),
+      0,
+  }};
+  cl_int error;
+  command_queue = clCreateCommandQueueWithPropertiesKHR(
+      context, device, properties.data(), &error);
+  ASSERT_SUCCESS(error);
+  const char *source = "void kernel foo() {}";
+  const size_t length = strlen(source);
+  cl_program program =
+      clCreateProgramWithSource(context, 1, &source, &length, &error);
+  ASSERT_SUCCESS(error);
+  EXPECT_SUCCESS(clBuildProgram(program, 1, &device, "", nullptr, nullptr));
+  cl_kernel kernel = clCreateKernel(program, "foo", &error);
+  EXPECT_SUCCESS(error);
+  cl_event event;
+  const size_t global_work_size = 64;
+  const size_t local_work_size = 1;
+  EXPECT_SUCCESS(clEnqueueNDRangeKernel(command_queue, kernel, 1, nullptr,
+                                        &global_work_size, &local_work_size, 0,
+                                        nullptr, &event));
+  EXPECT_SUCCESS(clFinish(command_queue));
+  std::array<cl_performance_counter_result_codeplay, 3> results;
+  EXPECT_SUCCESS(clGetEventProfilingInfo(
+      event, CL_PROFILING_COMMAND_PERFORMANCE_COUNTERS_CODEPLAY,
+      sizeof(results), results.data(), nullptr));
+  EXPECT_EQ(1u, results[0].uint64);
+  EXPECT_EQ(global_work_size / local_work_size, results[1].uint64);
+  EXPECT_GE(results[2].float64, 0.0);
+  EXPECT_LE(results[2].float64, 100.0);
+  EXPECT_SUCCESS(clReleaseEvent(event));
+  EXPECT_SUCCESS(clReleaseKernel(kernel));
+  EXPECT_SUCCESS(clReleaseProgram(program));
+}
@@ -0,0 +1,50 @@
+// Copyright (C) Codeplay Software Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+// Exceptions; you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://github.com/codeplaysoftware/oneapi-construction-kit/blob/main/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <cstdlib>
+#include <string>
+
+#include "cl_codeplay_wfv.h"
+
+TEST_F(cl_codeplay_wfv_Test, KernelTuningDecision) {
+  BuildKernel("__kernel void foo() {}", "foo", "-cl-wfv=auto");
+  const size_t local_size = 1;
+  size_t size = 0;
+  ASSERT_SUCCESS(clGetKernelWFVInfoCODEPLAY(
+      kernel, device, 1, nullptr, &local_size,
+      CL_KERNEL_WFV_TUNING_DECISION_CODEPLAY, 0, nullptr, &size));
+  ASSERT_LE(1, size);
+  std::string decision(size, 'x');
+  ASSERT_SUCCESS(clGetKernelWFVInfoCODEPLAY(
+      kernel, device, 1, nullptr, &local_size,
+      CL_KERNEL_WFV_TUNING_DECISION_CODEPLAY, decision.size(), &decision[0],
+      nullptr));
+  ASSERT_EQ('\0', decision.back());
+  // Autotuning is opt-in, so without it being enabled there is no decision.
+  if (!std::getenv("CA_HOST_VECZ_AUTOTUNE")) {
+    ASSERT_EQ(1, size);
+  }
+}
+
+TEST_F(cl_codeplay_wfv_Test, KernelTuningDecisionSizeTooSmall) {
+  BuildKernel("__kernel void foo() {}", "foo", "-cl-wfv=auto");
+  const size_t local_size = 1;
+  char decision;
+  ASSERT_EQ(CL_INVALID_VALUE,
+            clGetKernelWFVInfoCODEPLAY(kernel, device, 1, nullptr, &local_size,
+                                       CL_KERNEL_WFV_TUNING_DECISION_CODEPLAY,
+                                       0, &decision, nullptr));
+}
@@ -2485,3 +2485,37 @@ TEST_P(Execution, Precision_93_Divide_Relaxed) {
 
   RunGeneric1D(N);
 }
+
+TEST_P(ExecutionOpenCLC, Precision_94_Double_Sin_Large) {
+  // The kernel is already written with double4, which is what this test
+  // checks, so don't require vecz to widen it further.
+  fail_if_not_vectorized_ = false;
+
+  if (!UCL::hasDoubleSupport(device)) {
+    GTEST_SKIP();
+  }
+
+  // Spread the inputs across the whole exponent range, so that the vector
+  // Payne-Hanek range reduction reads every window of its payload, and mix the
+  // windows within each double4.
+  const size_t N = 128;
+  std::vector<cl_double> input(N * 4);
+  for (size_t i = 0; i < input.size(); i++) {
+    const double mantissa = 1.0 + static_cast<double>(i % 97) / 97.0;
+    const double value = std::ldexp(mantissa, static_cast<int>((i * 4) % 1024));
+    input[i] = (i & 1) ? -value : value;
+  }
+
+  AddInputBuffer(N * 4, kts::Reference1D<cl_double>(
+                            [&input](size_t id) { return input[id]; }));
+
+  AddOutputBuffer(N * 4, makeULPStreamer<cl_double, 4_ULP>(
+                             [&input](size_t id) -> long double {
+                               const long double promote =
+                                   static_cast<long double>(input[id]);
+                               return std::sin(promote);
+                             },
+                             this->device));
+
+  RunGeneric1D(N);
+}
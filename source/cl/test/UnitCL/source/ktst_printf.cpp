@@ -1754,3 +1754,15 @@ TEST_P(PrintfExecutionSPIRV, Printf_23_String_DPCPP) {
   this->SetPrintfReference(1, ref);
   this->RunPrintf1D(1);
 }
+
+UCL_EXECUTION_TEST_SUITE(PrintfExecutionOpenCLC, testing::Values(OPENCL_C))
+
+// The printf buffer is shared by all work-groups, so launches with more
+// work-groups than there are 8 byte chunks in the buffer can still print.
+TEST_P(PrintfExecutionOpenCLC, Printf_24_Many_Work_Groups) {
+  fail_if_not_vectorized_ = false;
+  const size_t num_groups = 1 << 18;
+  const std::string expected =
+      "last of " + std::to_string(num_groups) + " work-groups\n";
+  this->RunPrintf1DConcurrent(num_groups, 1, expected.size());
+}
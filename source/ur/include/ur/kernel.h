@@ -21,9 +21,12 @@
 #ifndef UR_KERNEL_H_INCLUDED
 #define UR_KERNEL_H_INCLUDED
 
+#include <array>
+#include <mutex>
 #include <unordered_map>
 
 #include "cargo/expected.h"
+#include "cargo/small_vector.h"
 #include "cargo/string_view.h"
 #include "compiler/module.h"
 #include "mux/mux.h"
@@ -60,6 +63,20 @@ struct ur_kernel_handle_t_ : ur::base {
   static cargo::expected<ur_kernel_handle_t, ur_result_t> create(
       ur_program_handle_t program, cargo::string_view kernel_name);
 
+  /// @brief Choose a local size for an ND range enqueued without one.
+  ///
+  /// The chosen local size is cached per device and global size, so repeated
+  /// launches of the same shape don't recompute it.
+  ///
+  /// @param[in] device Device the kernel is being enqueued on.
+  /// @param[in] work_dim Number of dimensions of the ND range.
+  /// @param[in] global_size Global size of the ND range, `work_dim` elements.
+  ///
+  /// @return Returns the local size, unused dimensions are set to 1.
+  std::array<size_t, 3> getDefaultLocalSize(ur_device_handle_t device,
+                                            uint32_t work_dim,
+                                            const size_t *global_size);
+
   /// @brief Program from which this program was created.
   ur_program_handle_t program = nullptr;
   /// @brief The name of the kernel in the source.
@@ -69,6 +86,27 @@ struct ur_kernel_handle_t_ : ur::base {
   /// @brief Device specific kernel map, one for each device in the context
   /// increasing in the order of the devices in the context.
   std::unordered_map<ur_device_handle_t, mux_kernel_t> device_kernel_map;
+
+ private:
+  /// @brief Compute the default local size, see `getDefaultLocalSize`.
+  std::array<size_t, 3> computeDefaultLocalSize(ur_device_handle_t device,
+                                                uint32_t work_dim,
+                                                const size_t *global_size);
+
+  /// @brief A previously chosen default local size.
+  struct local_size_entry_t {
+    ur_device_handle_t device;
+    std::array<size_t, 3> global_size;
+    std::array<size_t, 3> local_size;
+  };
+  /// @brief Maximum number of default local sizes to remember.
+  static constexpr size_t max_local_size_entries = 8;
+  /// @brief Mutex protecting `local_size_cache`, kernels may be enqueued on
+  /// multiple queues concurrently.
+  std::mutex local_size_mutex;
+  /// @brief Default local sizes chosen so far, oldest first.
+  cargo::small_vector<local_size_entry_t, max_local_size_entries>
+      local_size_cache;
 };
 
 #endif  // UR_KERNEL_H_INCLUDED
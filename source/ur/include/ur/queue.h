@@ -96,6 +96,9 @@ struct ur_queue_handle_t_ : ur::base {
     /// @brief Event the dispatch will signal on completion, encompasses a mux
     /// semaphore and a mux fence.
     ur_event_handle_t signal_event;
+    /// @brief Whether further kernel launches may be appended to the command
+    /// buffer, see `getOpenKernelBatch`.
+    bool is_kernel_batch = false;
   };
 
   /// @brief Get a mux command buffer and add it to the queue for dispatch.
@@ -115,6 +118,19 @@ struct ur_queue_handle_t_ : ur::base {
                    uint32_t num_wait_events,
                    const ur_event_handle_t *wait_events);
 
+  /// @brief Get the pending dispatch kernel launches are being batched into.
+  ///
+  /// Consecutive kernel launches which don't wait on any events are recorded
+  /// into the same command buffer, signalling the same event, until the queue
+  /// is flushed or another kind of command is enqueued. This saves creating a
+  /// command buffer, fence and semaphore per launch.
+  ///
+  /// @note This member function is not thread-safe, callers **must** hold a
+  /// lock on `mutex` when calling it.
+  ///
+  /// @return Returns the open batch, or `nullptr` if there isn't one.
+  dispatch_state_t *getOpenKernelBatch();
+
   /// @brief Resets the given mux command buffer and then returns it to the
   /// cache if there's room, or destroys it if there isn't.
   void destroyCommandBuffer(mux_command_buffer_t command_buffer);
@@ -134,6 +150,10 @@ struct ur_queue_handle_t_ : ur::base {
   /// @brief A set of command buffers that are idle and ready to use.
   cargo::ring_buffer<mux_command_buffer_t, 16> cached_command_buffers;
 
+  /// @brief Descriptors of the kernel launch being enqueued, kept between
+  /// launches to avoid an allocation per launch. Guarded by `mutex`.
+  cargo::small_vector<mux_descriptor_info_t, 16> descriptors;
+
   /// @brief List of completed events which are still being waited on by running
   /// dispatches.
   cargo::small_vector<ur_event_handle_t, 32> completed_events;
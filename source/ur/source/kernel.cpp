@@ -16,6 +16,7 @@
 
 #include "ur/kernel.h"
 
+#include <algorithm>
 #include <memory>
 
 #include "ur/context.h"
@@ -75,6 +76,105 @@ cargo::expected<ur_kernel_handle_t, ur_result_t> ur_kernel_handle_t_::create(
   return kernel.release();
 }
 
+std::array<size_t, 3> ur_kernel_handle_t_::getDefaultLocalSize(
+    ur_device_handle_t device, uint32_t work_dim, const size_t *global_size) {
+  std::array<size_t, 3> global{1, 1, 1};
+  std::copy_n(global_size, work_dim, global.begin());
+
+  const std::lock_guard<std::mutex> lock(local_size_mutex);
+  for (const auto &entry : local_size_cache) {
+    if (entry.device == device && entry.global_size == global) {
+      return entry.local_size;
+    }
+  }
+
+  const auto local = computeDefaultLocalSize(device, work_dim, global_size);
+  if (local_size_cache.size() == max_local_size_entries) {
+    local_size_cache.erase(local_size_cache.begin());
+  }
+  // Failing to cache the local size only costs recomputing it next time.
+  (void)local_size_cache.push_back({device, global, local});
+  return local;
+}
+
+std::array<size_t, 3> ur_kernel_handle_t_::computeDefaultLocalSize(
+    ur_device_handle_t device, uint32_t work_dim, const size_t *global_size) {
+  std::array<size_t, 3> local_size{1, 1, 1};
+
+  // A kernel with a required work-group size can only be enqueued with it.
+  auto kernel_data = program->getKernelData(kernel_name);
+  if (kernel_data && kernel_data->reqd_work_group_size.has_value()) {
+    return *kernel_data->reqd_work_group_size;
+  }
+
+  const auto mux_kernel = device_kernel_map[device];
+  const auto device_info = device->mux_device->info;
+  const std::array<size_t, 3> preferred_size{
+      mux_kernel->preferred_local_size_x, mux_kernel->preferred_local_size_y,
+      mux_kernel->preferred_local_size_z};
+  const std::array<size_t, 3> max_size{device_info->max_work_group_size_x,
+                                       device_info->max_work_group_size_y,
+                                       device_info->max_work_group_size_z};
+
+  // Work-items are packed into sub-groups (or vectorized) along the first
+  // dimension, so prefer a multiple of the sub-group size there so that no
+  // work-group ends in a partial sub-group.
+  size_t sub_group_size = 1;
+  if (kernel_data && kernel_data->reqd_sub_group_size.has_value()) {
+    sub_group_size = *kernel_data->reqd_sub_group_size;
+  } else if (device_info->num_sub_group_sizes > 0) {
+    sub_group_size =
+        *std::max_element(device_info->sub_group_sizes,
+                          device_info->sub_group_sizes +
+                              device_info->num_sub_group_sizes);
+  }
+
+  size_t remaining_items = device_info->max_concurrent_work_items;
+  for (uint32_t i = 0; i < work_dim; ++i) {
+    size_t limit = std::min({preferred_size[i], max_size[i], remaining_items,
+                             global_size[i]});
+    if (0 == i) {
+      limit = std::min(limit, size_t(device_info->max_work_width));
+    }
+    limit = std::max(limit, size_t(1));
+    const size_t granularity = (0 == i) ? sub_group_size : 1;
+
+    // Unlike the halving done by the OpenCL runtime, search every size below
+    // the limit for the largest one dividing the global size, preferring one
+    // that is a multiple of the granularity, e.g. a global size of 96 with a
+    // preferred size of 64 gives 48 rather than 32.
+    size_t best = 1;
+    size_t best_aligned = 0;
+    for (size_t size = limit; size > 1; --size) {
+      if (0 != global_size[i] % size) {
+        continue;
+      }
+      if (1 == best) {
+        best = size;
+      }
+      if (0 == size % granularity) {
+        best_aligned = size;
+        break;
+      }
+    }
+
+    if (best_aligned) {
+      local_size[i] = best_aligned;
+    } else if (device_info->supports_non_uniform_work_groups &&
+               best < granularity && limit >= granularity) {
+      // No divisor fills a sub-group, e.g. a prime global size, so keep full
+      // work-groups for the bulk of the range and let the trailing
+      // work-group be smaller.
+      local_size[i] = limit - (limit % granularity);
+    } else {
+      local_size[i] = best;
+    }
+    remaining_items /= local_size[i];
+  }
+
+  return local_size;
+}
+
 UR_APIEXPORT ur_result_t UR_APICALL
 urKernelCreate(ur_program_handle_t hProgram, const char *pKernelName,
                ur_kernel_handle_t *phKernel) {
@@ -165,6 +165,10 @@ ur_result_t ur_mem_handle_t_::sync(ur_queue_handle_t command_queue) {
     return ur::resultFromMux(mux_error);
   }
 
+  // The memory is now resident for this queue, so further commands on it
+  // don't need to synchronize again until another queue uses it.
+  last_command_queue = command_queue;
+
   return UR_RESULT_SUCCESS;
 }
 
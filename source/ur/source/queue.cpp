@@ -19,7 +19,6 @@
 #include <algorithm>
 #include <iterator>
 
-#include "cargo/dynamic_array.h"
 #include "ur/context.h"
 #include "ur/event.h"
 #include "ur/kernel.h"
@@ -141,6 +140,14 @@ ur_queue_handle_t_::getCommandBuffer(const ur_event_handle_t signal_event,
   return command_buffer;
 }
 
+ur_queue_handle_t_::dispatch_state_t *
+ur_queue_handle_t_::getOpenKernelBatch() {
+  if (pending_dispatches.empty() || !pending_dispatches.back().is_kernel_batch) {
+    return nullptr;
+  }
+  return &pending_dispatches.back();
+}
+
 ur_result_t ur_queue_handle_t_::wait() {
   auto error = flush();
   if (error != UR_RESULT_SUCCESS) {
@@ -491,78 +498,96 @@ UR_APIEXPORT ur_result_t UR_APICALL urEnqueueKernelLaunch(
     return UR_RESULT_ERROR_INVALID_NULL_POINTER;
   }
 
-  // TODO: The user is allowed to pass a null local size, in which case the
-  // implementation is required to provide one.
-  assert(
-      localWorkSize &&
-      "Error: Local size for urEnqueueKernelLaunch is currently non-optional");
-
   if (!eventWaitList && numEventsInWaitList != 0) {
     return UR_RESULT_ERROR_INVALID_NULL_HANDLE;
   }
 
-  const auto num_args = hKernel->arguments.size();
   mux_ndrange_options_t options;
-  cargo::dynamic_array<mux_descriptor_info_t> descriptors;
-  if (descriptors.alloc(num_args)) {
-    return UR_RESULT_ERROR_OUT_OF_HOST_MEMORY;
-  }
-
-  const auto device_idx = hQueue->getDeviceIdx();
-
-  for (unsigned arg_idx = 0; arg_idx < num_args; ++arg_idx) {
-    const auto buffer = hKernel->arguments[arg_idx].mem_handle;
-    if (buffer) {
-      // Synchronize the state of the memory buffer across devices in the
-      // context.
-      if (const auto error = buffer->sync(hQueue)) {
-        return error;
-      }
-
-      descriptors[arg_idx].type = mux_descriptor_info_type_buffer;
-      descriptors[arg_idx].buffer_descriptor.buffer =
-          buffer->buffers[device_idx].mux_buffer;
-      descriptors[arg_idx].buffer_descriptor.offset = 0;
-    } else {
-      descriptors[arg_idx].type = mux_descriptor_info_type_plain_old_data;
-      descriptors[arg_idx].plain_old_data_descriptor.data =
-          hKernel->arguments[arg_idx].value.data;
-      descriptors[arg_idx].plain_old_data_descriptor.length =
-          hKernel->arguments[arg_idx].value.size;
-    }
-  }
-  options.descriptors = descriptors.data();
-  options.descriptors_length = num_args;
   std::fill_n(std::begin(options.local_size),
               sizeof(options.local_size) / sizeof(options.local_size[0]), 1);
-  std::copy_n(localWorkSize, workDim, std::begin(options.local_size));
+  if (localWorkSize) {
+    std::copy_n(localWorkSize, workDim, std::begin(options.local_size));
+  } else {
+    // The user is allowed to pass a null local size, in which case the
+    // implementation is required to provide one.
+    const auto local_size =
+        hKernel->getDefaultLocalSize(hQueue->device, workDim, globalWorkSize);
+    std::copy(local_size.begin(), local_size.end(),
+              std::begin(options.local_size));
+  }
   options.global_offset = globalWorkOffset;
   options.global_size = globalWorkSize;
   options.dimensions = workDim;
 
-  auto event = ur_event_handle_t_::create(hQueue);
-
-  if (!event) {
-    return event.error();
-  }
+  const auto device_idx = hQueue->getDeviceIdx();
+  const auto num_args = hKernel->arguments.size();
 
+  ur_event_handle_t event = nullptr;
   {
     const std::lock_guard<std::mutex> lock(hQueue->mutex);
-    auto command_buffer_or_err =
-        hQueue->getCommandBuffer(*event, numEventsInWaitList, eventWaitList);
-    if (!command_buffer_or_err) {
-      return command_buffer_or_err.error();
+    if (hQueue->descriptors.resize(num_args)) {
+      return UR_RESULT_ERROR_OUT_OF_HOST_MEMORY;
     }
+    auto &descriptors = hQueue->descriptors;
+
+    for (unsigned arg_idx = 0; arg_idx < num_args; ++arg_idx) {
+      const auto buffer = hKernel->arguments[arg_idx].mem_handle;
+      if (buffer) {
+        // Synchronize the state of the memory buffer across devices in the
+        // context, this is a no-op if this queue was the last to use it.
+        if (const auto error = buffer->sync(hQueue)) {
+          return error;
+        }
+
+        descriptors[arg_idx].type = mux_descriptor_info_type_buffer;
+        descriptors[arg_idx].buffer_descriptor.buffer =
+            buffer->buffers[device_idx].mux_buffer;
+        descriptors[arg_idx].buffer_descriptor.offset = 0;
+      } else {
+        descriptors[arg_idx].type = mux_descriptor_info_type_plain_old_data;
+        descriptors[arg_idx].plain_old_data_descriptor.data =
+            hKernel->arguments[arg_idx].value.data;
+        descriptors[arg_idx].plain_old_data_descriptor.length =
+            hKernel->arguments[arg_idx].value.size;
+      }
+    }
+    options.descriptors = descriptors.data();
+    options.descriptors_length = num_args;
+
+    // Launches which wait on events start a new dispatch, as the events could
+    // otherwise be signalled by the batch they are waiting in.
+    mux_command_buffer_t command_buffer = nullptr;
+    auto batch =
+        numEventsInWaitList == 0 ? hQueue->getOpenKernelBatch() : nullptr;
+    if (batch) {
+      command_buffer = batch->command_buffer;
+      event = batch->signal_event;
+    } else {
+      auto new_event = ur_event_handle_t_::create(hQueue);
+      if (!new_event) {
+        return new_event.error();
+      }
+      event = *new_event;
+      auto command_buffer_or_err =
+          hQueue->getCommandBuffer(event, numEventsInWaitList, eventWaitList);
+      if (!command_buffer_or_err) {
+        return command_buffer_or_err.error();
+      }
+      command_buffer = *command_buffer_or_err;
+      hQueue->pending_dispatches.back().is_kernel_batch = true;
+    }
+
     if (auto error = muxCommandNDRange(
-            *command_buffer_or_err, hKernel->device_kernel_map[hQueue->device],
+            command_buffer, hKernel->device_kernel_map[hQueue->device],
             options, 0, nullptr, nullptr)) {
       return ur::resultFromMux(error);
     }
   }
 
   if (pEvent) {
-    ur::retain(*event);
-    *pEvent = *event;
+    // Every launch in a batch shares the event signalled at the end of it.
+    ur::retain(event);
+    *pEvent = event;
   }
 
   return UR_RESULT_SUCCESS;
@@ -14,6 +14,9 @@
 //
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
+#include <array>
+#include <vector>
+
 #include "uur/checks.h"
 #include "uur/fixtures.h"
 
@@ -34,6 +37,182 @@ TEST_P(urEnqueueKernelLaunchTest, Success) {
   EXPECT_SUCCESS(urEventRelease(event));
 }
 
+// Runs a kernel which writes one plus its linear global id to each element of
+// a buffer, so the output shows whether every work-item ran exactly once.
+struct urEnqueueKernelLaunchOutputTest : uur::QueueTest {
+  void SetUp() override {
+    UUR_RETURN_ON_FATAL_FAILURE(uur::QueueTest::SetUp());
+    // Assembled from SPIR-V equivalent to the following OpenCL C:
+    // kernel void foo(global uint *out) {
+    //   size_t id = get_global_id(0) + get_global_size(0) *
+    //       (get_global_id(1) + get_global_size(1) * get_global_id(2));
+    //   out[id] = (uint)id + 1;
+    // }
+    const uint8_t source[]{
+        0x03, 0x02, 0x23, 0x07, 0x00, 0x00, 0x01, 0x00, 0x0e, 0x00, 0x06, 0x00,
+        0x1c, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x11, 0x00, 0x02, 0x00,
+        0x04, 0x00, 0x00, 0x00, 0x11, 0x00, 0x02, 0x00, 0x06, 0x00, 0x00, 0x00,
+        0x11, 0x00, 0x02, 0x00, 0x0b, 0x00, 0x00, 0x00, 0x0e, 0x00, 0x03, 0x00,
+        0x02, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x0f, 0x00, 0x06, 0x00,
+        0x06, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x66, 0x6f, 0x6f, 0x00,
+        0x02, 0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x03, 0x00, 0x03, 0x00,
+        0x03, 0x00, 0x00, 0x00, 0x70, 0x8e, 0x01, 0x00, 0x05, 0x00, 0x0b, 0x00,
+        0x02, 0x00, 0x00, 0x00, 0x5f, 0x5f, 0x73, 0x70, 0x69, 0x72, 0x76, 0x5f,
+        0x42, 0x75, 0x69, 0x6c, 0x74, 0x49, 0x6e, 0x47, 0x6c, 0x6f, 0x62, 0x61,
+        0x6c, 0x49, 0x6e, 0x76, 0x6f, 0x63, 0x61, 0x74, 0x69, 0x6f, 0x6e, 0x49,
+        0x64, 0x00, 0x00, 0x00, 0x05, 0x00, 0x09, 0x00, 0x03, 0x00, 0x00, 0x00,
+        0x5f, 0x5f, 0x73, 0x70, 0x69, 0x72, 0x76, 0x5f, 0x42, 0x75, 0x69, 0x6c,
+        0x74, 0x49, 0x6e, 0x47, 0x6c, 0x6f, 0x62, 0x61, 0x6c, 0x53, 0x69, 0x7a,
+        0x65, 0x00, 0x00, 0x00, 0x05, 0x00, 0x03, 0x00, 0x04, 0x00, 0x00, 0x00,
+        0x6f, 0x75, 0x74, 0x00, 0x47, 0x00, 0x04, 0x00, 0x02, 0x00, 0x00, 0x00,
+        0x0b, 0x00, 0x00, 0x00, 0x1c, 0x00, 0x00, 0x00, 0x47, 0x00, 0x03, 0x00,
+        0x02, 0x00, 0x00, 0x00, 0x16, 0x00, 0x00, 0x00, 0x47, 0x00, 0x04, 0x00,
+        0x03, 0x00, 0x00, 0x00, 0x0b, 0x00, 0x00, 0x00, 0x1f, 0x00, 0x00, 0x00,
+        0x47, 0x00, 0x03, 0x00, 0x03, 0x00, 0x00, 0x00, 0x16, 0x00, 0x00, 0x00,
+        0x15, 0x00, 0x04, 0x00, 0x05, 0x00, 0x00, 0x00, 0x40, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x15, 0x00, 0x04, 0x00, 0x06, 0x00, 0x00, 0x00,
+        0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x2b, 0x00, 0x04, 0x00,
+        0x06, 0x00, 0x00, 0x00, 0x07, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00,
+        0x17, 0x00, 0x04, 0x00, 0x08, 0x00, 0x00, 0x00, 0x05, 0x00, 0x00, 0x00,
+        0x03, 0x00, 0x00, 0x00, 0x20, 0x00, 0x04, 0x00, 0x09, 0x00, 0x00, 0x00,
+        0x01, 0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00, 0x13, 0x00, 0x02, 0x00,
+        0x0a, 0x00, 0x00, 0x00, 0x20, 0x00, 0x04, 0x00, 0x0b, 0x00, 0x00, 0x00,
+        0x05, 0x00, 0x00, 0x00, 0x06, 0x00, 0x00, 0x00, 0x21, 0x00, 0x04, 0x00,
+        0x0c, 0x00, 0x00, 0x00, 0x0a, 0x00, 0x00, 0x00, 0x0b, 0x00, 0x00, 0x00,
+        0x3b, 0x00, 0x04, 0x00, 0x09, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00,
+        0x01, 0x00, 0x00, 0x00, 0x3b, 0x00, 0x04, 0x00, 0x09, 0x00, 0x00, 0x00,
+        0x03, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x36, 0x00, 0x05, 0x00,
+        0x0a, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x0c, 0x00, 0x00, 0x00, 0x37, 0x00, 0x03, 0x00, 0x0b, 0x00, 0x00, 0x00,
+        0x04, 0x00, 0x00, 0x00, 0xf8, 0x00, 0x02, 0x00, 0x0d, 0x00, 0x00, 0x00,
+        0x3d, 0x00, 0x06, 0x00, 0x08, 0x00, 0x00, 0x00, 0x0e, 0x00, 0x00, 0x00,
+        0x02, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x20, 0x00, 0x00, 0x00,
+        0x51, 0x00, 0x05, 0x00, 0x05, 0x00, 0x00, 0x00, 0x0f, 0x00, 0x00, 0x00,
+        0x0e, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x51, 0x00, 0x05, 0x00,
+        0x05, 0x00, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00, 0x0e, 0x00, 0x00, 0x00,
+        0x01, 0x00, 0x00, 0x00, 0x51, 0x00, 0x05, 0x00, 0x05, 0x00, 0x00, 0x00,
+        0x11, 0x00, 0x00, 0x00, 0x0e, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00,
+        0x3d, 0x00, 0x06, 0x00, 0x08, 0x00, 0x00, 0x00, 0x12, 0x00, 0x00, 0x00,
+        0x03, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x20, 0x00, 0x00, 0x00,
+        0x51, 0x00, 0x05, 0x00, 0x05, 0x00, 0x00, 0x00, 0x13, 0x00, 0x00, 0x00,
+        0x12, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x51, 0x00, 0x05, 0x00,
+        0x05, 0x00, 0x00, 0x00, 0x14, 0x00, 0x00, 0x00, 0x12, 0x00, 0x00, 0x00,
+        0x01, 0x00, 0x00, 0x00, 0x84, 0x00, 0x05, 0x00, 0x05, 0x00, 0x00, 0x00,
+        0x15, 0x00, 0x00, 0x00, 0x14, 0x00, 0x00, 0x00, 0x11, 0x00, 0x00, 0x00,
+        0x80, 0x00, 0x05, 0x00, 0x05, 0x00, 0x00, 0x00, 0x16, 0x00, 0x00, 0x00,
+        0x10, 0x00, 0x00, 0x00, 0x15, 0x00, 0x00, 0x00, 0x84, 0x00, 0x05, 0x00,
+        0x05, 0x00, 0x00, 0x00, 0x17, 0x00, 0x00, 0x00, 0x13, 0x00, 0x00, 0x00,
+        0x16, 0x00, 0x00, 0x00, 0x80, 0x00, 0x05, 0x00, 0x05, 0x00, 0x00, 0x00,
+        0x18, 0x00, 0x00, 0x00, 0x0f, 0x00, 0x00, 0x00, 0x17, 0x00, 0x00, 0x00,
+        0x46, 0x00, 0x05, 0x00, 0x0b, 0x00, 0x00, 0x00, 0x19, 0x00, 0x00, 0x00,
+        0x04, 0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0x00, 0x71, 0x00, 0x04, 0x00,
+        0x06, 0x00, 0x00, 0x00, 0x1a, 0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0x00,
+        0x80, 0x00, 0x05, 0x00, 0x06, 0x00, 0x00, 0x00, 0x1b, 0x00, 0x00, 0x00,
+        0x1a, 0x00, 0x00, 0x00, 0x07, 0x00, 0x00, 0x00, 0x3e, 0x00, 0x05, 0x00,
+        0x19, 0x00, 0x00, 0x00, 0x1b, 0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00,
+        0x04, 0x00, 0x00, 0x00, 0xfd, 0x00, 0x01, 0x00, 0x38, 0x00, 0x01, 0x00};
+    ASSERT_SUCCESS(urProgramCreateWithIL(context, source, sizeof(source),
+                                         nullptr, &program));
+    ASSERT_SUCCESS(urProgramBuild(context, program, nullptr));
+    ASSERT_SUCCESS(urKernelCreate(program, "foo", &kernel));
+    ASSERT_SUCCESS(urMemBufferCreate(context, UR_MEM_FLAG_READ_WRITE,
+                                     sizeof(uint32_t) * max_count, nullptr,
+                                     &buffer));
+    ASSERT_SUCCESS(urKernelSetArgMemObj(kernel, 0, buffer));
+  }
+
+  void TearDown() override {
+    if (buffer) {
+      EXPECT_SUCCESS(urMemRelease(buffer));
+    }
+    if (kernel) {
+      EXPECT_SUCCESS(urKernelRelease(kernel));
+    }
+    if (program) {
+      EXPECT_SUCCESS(urProgramRelease(program));
+    }
+    uur::QueueTest::TearDown();
+  }
+
+  // Check that each of the first count elements were written exactly once.
+  void checkOutput(size_t count) {
+    std::vector<uint32_t> output(count, 0);
+    ASSERT_SUCCESS(urEnqueueMemBufferRead(queue, buffer, true, 0,
+                                          sizeof(uint32_t) * count,
+                                          output.data(), 0, nullptr, nullptr));
+    for (size_t i = 0; i < count; i++) {
+      ASSERT_EQ(i + 1, output[i]) << "Result at index " << i;
+    }
+  }
+
+  static constexpr size_t max_count = 37 * 5 * 3;
+  ur_program_handle_t program = nullptr;
+  ur_kernel_handle_t kernel = nullptr;
+  ur_mem_handle_t buffer = nullptr;
+};
+
+UUR_INSTANTIATE_DEVICE_TEST_SUITE_P(urEnqueueKernelLaunchOutputTest);
+
+TEST_P(urEnqueueKernelLaunchOutputTest, SuccessNullLocalSize) {
+  const size_t offsets[]{0, 0, 0};
+  const size_t global_size[]{32};
+  ur_event_handle_t event = nullptr;
+  ASSERT_SUCCESS(urEnqueueKernelLaunch(queue, kernel, 1, offsets, global_size,
+                                       nullptr, 0, nullptr, &event));
+  EXPECT_NE(event, nullptr);
+  EXPECT_SUCCESS(urQueueFlush(queue));
+  EXPECT_SUCCESS(urEventWait(1, &event));
+  EXPECT_SUCCESS(urEventRelease(event));
+  checkOutput(32);
+}
+
+TEST_P(urEnqueueKernelLaunchOutputTest, SuccessNullLocalSizeOddGlobalSize) {
+  const size_t offsets[]{0, 0, 0};
+  const size_t global_size[]{37, 5, 3};
+  ur_event_handle_t events[2] = {nullptr, nullptr};
+  // Enqueue the same shape twice so the second launch reuses the cached
+  // local size, clearing the buffer in between so both launches are checked.
+  const uint32_t zero = 0;
+  for (auto &event : events) {
+    ASSERT_SUCCESS(urEnqueueMemBufferFill(queue, buffer, &zero, sizeof(zero), 0,
+                                          sizeof(uint32_t) * max_count, 0,
+                                          nullptr, nullptr));
+    ASSERT_SUCCESS(urEnqueueKernelLaunch(queue, kernel, 3, offsets,
+                                         global_size, nullptr, 0, nullptr,
+                                         &event));
+    EXPECT_NE(event, nullptr);
+    EXPECT_SUCCESS(urEventWait(1, &event));
+    checkOutput(max_count);
+  }
+  EXPECT_SUCCESS(urEventRelease(events[0]));
+  EXPECT_SUCCESS(urEventRelease(events[1]));
+}
+
+TEST_P(urEnqueueKernelLaunchTest, SuccessConsecutiveLaunches) {
+  const size_t offsets[]{0, 0, 0};
+  const size_t global_size[]{32};
+  const size_t local_size[]{8};
+  std::array<ur_event_handle_t, 8> events{};
+  for (auto &event : events) {
+    ASSERT_SUCCESS(urEnqueueKernelLaunch(queue, kernel, 1, offsets,
+                                         global_size, local_size, 0, nullptr,
+                                         &event));
+    EXPECT_NE(event, nullptr);
+  }
+  // A launch waiting on an earlier launch must not deadlock.
+  ur_event_handle_t wait_event = nullptr;
+  ASSERT_SUCCESS(urEnqueueKernelLaunch(queue, kernel, 1, offsets, global_size,
+                                       local_size, 1, &events.back(),
+                                       &wait_event));
+  EXPECT_SUCCESS(urQueueFlush(queue));
+  EXPECT_SUCCESS(urEventWait(events.size(), events.data()));
+  EXPECT_SUCCESS(urEventWait(1, &wait_event));
+  for (auto event : events) {
+    EXPECT_SUCCESS(urEventRelease(event));
+  }
+  EXPECT_SUCCESS(urEventRelease(wait_event));
+}
+
 TEST_P(urEnqueueKernelLaunchTest, InvalidNullHandleQueue) {
   const size_t offsets[]{0, 0, 0};
   const size_t global_size[]{32};
@@ -20,6 +20,7 @@
 #include <compiler/kernel.h>
 #include <compiler/module.h>
 #include <mux/mux.hpp>
+#include <vk/command_pool.h>
 #include <vk/icd.h>
 #include <vk/physical_device.h>
 #include <vk/small_vector.h>
@@ -381,15 +382,10 @@ struct command_buffer_semaphore_fence_tuple {
   mux_fence_t fence;
 };
 
-/// @brief Buffer and memory pair struct
-struct buffer_memory_pair {
-  mux_buffer_t buffer;
-  mux_memory_t memory;
-};
-
 /// @brief internal command_buffer type
 typedef struct command_buffer_t final : icd_t<command_buffer_t> {
   /// @brief constructor for primary command buffers
+  /// @param command_pool Command pool this command buffer is allocated from
   /// @param command_pool_create_flags Flags passed at the creation of this
   /// command buffer's command pool
   /// @param mux_device Mux device that owns this command buffer
@@ -398,7 +394,8 @@ typedef struct command_buffer_t final : icd_t<command_buffer_t> {
   /// @param semaphore Semaphore `command_buffer` will signal when done
   /// @param allocator `vk::allocator` used to initialize `descriptor_sets`
   /// and `commands`
-  command_buffer_t(VkCommandPoolCreateFlags command_pool_create_flags,
+  command_buffer_t(vk::command_pool command_pool,
+                   VkCommandPoolCreateFlags command_pool_create_flags,
                    mux_device_t mux_device,
                    mux::unique_ptr<mux_command_buffer_t> command_buffer,
                    mux::unique_ptr<mux_fence_t> fence,
@@ -420,6 +417,10 @@ typedef struct command_buffer_t final : icd_t<command_buffer_t> {
   /// @brief whether this command buffer is primary or secondary
   VkCommandBufferLevel command_buffer_level;
 
+  /// @brief the command pool this command buffer was allocated from, only set
+  /// for primary command buffers
+  vk::command_pool command_pool;
+
   /// @brief the flags provided when the command pool this command buffer was
   /// allocated from was created
   VkCommandPoolCreateFlags command_pool_create_flags;
@@ -463,9 +464,16 @@ typedef struct command_buffer_t final : icd_t<command_buffer_t> {
   /// @brief Local work group size copied in from bound pipeline
   std::array<uint32_t, 3> wgs;
 
-  /// @brief List of push constant buffer and memory objects created when a
-  /// dispatch command is recorded
-  vk::small_vector<buffer_memory_pair, 2> push_constant_objects;
+  /// @brief Push constant blocks taken from `command_pool` that the push
+  /// constants of recorded dispatch commands are sub-allocated from
+  ///
+  /// Only the last block is allocated from, the others are full. All blocks
+  /// are handed back to the pool when the command buffer is reset.
+  vk::small_vector<push_constant_block, 2> push_constant_blocks;
+
+  /// @brief Offset in bytes of the first unused byte of the last block in
+  /// `push_constant_blocks`
+  uint64_t push_constant_block_offset;
 
   /// @brief A struct representing a recorded kernel.
   struct recorded_kernel {
@@ -788,7 +796,11 @@ void CmdWaitEvents(vk::command_buffer commandBuffer, uint32_t eventCount,
                    const VkBufferMemoryBarrier *, uint32_t,
                    const VkImageMemoryBarrier *);
 
-/// @brief Stub of vkCmdDispatchIndirect
+/// @brief Internal implementation of vkCmdDispatchIndirect
+///
+/// @param commandBuffer Command buffer the command will be recorded into
+/// @param buffer Buffer containing a `VkDispatchIndirectCommand`
+/// @param offset Offset in bytes into `buffer` of the dispatch parameters
 void CmdDispatchIndirect(vk::command_buffer commandBuffer, vk::buffer buffer,
                          VkDeviceSize offset);
 
@@ -17,8 +17,11 @@
 #ifndef VK_COMMAND_POOL_H_INCLUDED
 #define VK_COMMAND_POOL_H_INCLUDED
 
+#include <mux/mux.h>
 #include <vk/small_vector.h>
 
+#include <cstdint>
+
 namespace vk {
 /// @copydoc ::vk::device_t
 typedef struct device_t *device;
@@ -26,6 +29,27 @@ typedef struct device_t *device;
 /// @copydoc ::vk::command_buffer_t
 typedef struct command_buffer_t *command_buffer;
 
+/// @brief Minimum size in bytes of the blocks of host visible memory push
+/// constants are sub-allocated from
+#define CA_VK_PUSH_CONSTANT_BLOCK_SIZE 65536
+
+/// @brief Block of host visible memory that the push constants of dispatch
+/// commands are sub-allocated from
+///
+/// Blocks are owned by the command pool, command buffers take blocks from the
+/// pool as they record dispatches and hand them back when they are reset.
+struct push_constant_block {
+  /// @brief Buffer bound to the whole of `memory`, push constants are bound to
+  /// kernels with an offset into it
+  mux_buffer_t buffer;
+  /// @brief Host visible device memory backing `buffer`
+  mux_memory_t memory;
+  /// @brief Pointer to `memory`, which stays mapped for the block's lifetime
+  uint8_t *mapped;
+  /// @brief Size of `memory` in bytes
+  uint64_t size;
+};
+
 /// @brief internal commandPool type
 typedef struct command_pool_t final {
   /// @brief Constructor
@@ -53,6 +77,34 @@ typedef struct command_pool_t final {
   /// @brief currently the allocator used to create the object, later this will
   /// be an allocator which is only capable of allocating from the pool
   vk::allocator allocator;
+
+  /// @brief Push constant blocks not currently in use by a command buffer
+  vk::small_vector<push_constant_block, 2> free_push_constant_blocks;
+
+  /// @brief Take a push constant block from the pool, creating a new one if
+  /// none of the free blocks are big enough
+  ///
+  /// @param mux_device Mux device to create the block on
+  /// @param size Minimum size of the block in bytes
+  /// @param[out] out_block Returns the block
+  ///
+  /// @return Vulkan result code
+  VkResult acquirePushConstantBlock(mux_device_t mux_device, uint64_t size,
+                                    push_constant_block &out_block);
+
+  /// @brief Return the push constant blocks used by a command buffer to the
+  /// pool so they can be reused
+  ///
+  /// @param mux_device Mux device the blocks were created on
+  /// @param blocks List of blocks, cleared on return
+  void releasePushConstantBlocks(
+      mux_device_t mux_device,
+      vk::small_vector<push_constant_block, 2> &blocks);
+
+  /// @brief Destroy all the free push constant blocks
+  ///
+  /// @param mux_device Mux device the blocks were created on
+  void destroyPushConstantBlocks(mux_device_t mux_device);
 } *command_pool;
 
 /// @brief internal implementation of vkCreateCommandPool
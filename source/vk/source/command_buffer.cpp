@@ -28,16 +28,19 @@
 #include <vk/type_traits.h>
 #include <vk/unique_ptr.h>
 
+#include <algorithm>
 #include <cstring>
 #include <utility>
 
 namespace vk {
 command_buffer_t::command_buffer_t(
+    vk::command_pool command_pool,
     VkCommandPoolCreateFlags command_pool_create_flags, mux_device_t mux_device,
     mux::unique_ptr<mux_command_buffer_t> initial_command_buffer,
     mux::unique_ptr<mux_fence_t> initial_fence,
     mux::unique_ptr<mux_semaphore_t> initial_semaphore, vk::allocator allocator)
     : command_buffer_level(VK_COMMAND_BUFFER_LEVEL_PRIMARY),
+      command_pool(command_pool),
       command_pool_create_flags(command_pool_create_flags),
       descriptor_sets(
           {allocator.getCallbacks(), VK_SYSTEM_ALLOCATION_SCOPE_OBJECT}),
@@ -47,8 +50,9 @@ command_buffer_t::command_buffer_t(
       mux_device(mux_device),
       compiler_kernel(nullptr),
       mux_binary_kernel(nullptr),
-      push_constant_objects(
+      push_constant_blocks(
           {allocator.getCallbacks(), VK_SYSTEM_ALLOCATION_SCOPE_OBJECT}),
+      push_constant_block_offset(0),
       specialized_kernels(
           {allocator.getCallbacks(), VK_SYSTEM_ALLOCATION_SCOPE_OBJECT}),
       dispatched_kernels(
@@ -83,6 +87,7 @@ command_buffer_t::command_buffer_t(
 command_buffer_t::command_buffer_t(
     VkCommandPoolCreateFlags command_pool_create_flags, vk::allocator allocator)
     : command_buffer_level(VK_COMMAND_BUFFER_LEVEL_SECONDARY),
+      command_pool(nullptr),
       command_pool_create_flags(command_pool_create_flags),
       descriptor_sets(
           {allocator.getCallbacks(), VK_SYSTEM_ALLOCATION_SCOPE_OBJECT}),
@@ -91,8 +96,9 @@ command_buffer_t::command_buffer_t(
       allocator(allocator),
       compiler_kernel(nullptr),
       mux_binary_kernel(nullptr),
-      push_constant_objects(
+      push_constant_blocks(
           {allocator.getCallbacks(), VK_SYSTEM_ALLOCATION_SCOPE_OBJECT}),
+      push_constant_block_offset(0),
       specialized_kernels(
           {allocator.getCallbacks(), VK_SYSTEM_ALLOCATION_SCOPE_OBJECT}),
       dispatched_kernels(
@@ -197,10 +203,10 @@ VkResult AllocateCommandBuffers(
           {device->mux_device, command_pool->allocator.getMuxAllocator()});
 
       command_buffer = command_pool->allocator.create<command_buffer_t>(
-          VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE, command_pool->flags,
-          device->mux_device, std::move(initial_command_buffer_ptr),
-          std::move(initial_fence_ptr), std::move(initial_semaphore_ptr),
-          command_pool->allocator);
+          VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE, command_pool,
+          command_pool->flags, device->mux_device,
+          std::move(initial_command_buffer_ptr), std::move(initial_fence_ptr),
+          std::move(initial_semaphore_ptr), command_pool->allocator);
       if (!command_buffer) {
         return VK_ERROR_OUT_OF_HOST_MEMORY;
       }
@@ -277,13 +283,8 @@ void FreeCommandBuffers(vk::device device, vk::command_pool commandPool,
       commandBuffer->dispatched_kernels.clear();
       commandBuffer->specialized_kernels.clear();
 
-      for (auto &buffer_memory_pair : commandBuffer->push_constant_objects) {
-        muxFreeMemory(commandBuffer->mux_device, buffer_memory_pair.memory,
-                      commandBuffer->allocator.getMuxAllocator());
-
-        muxDestroyBuffer(commandBuffer->mux_device, buffer_memory_pair.buffer,
-                         commandBuffer->allocator.getMuxAllocator());
-      }
+      commandPool->releasePushConstantBlocks(
+          commandBuffer->mux_device, commandBuffer->push_constant_blocks);
 
       for (auto &alloc : commandBuffer->descriptor_size_memory_allocs) {
         muxFreeMemory(commandBuffer->mux_device, alloc,
@@ -405,14 +406,13 @@ VkResult ResetCommandBuffer(vk::command_buffer commandBuffer,
 
   commandBuffer->dispatched_kernels.clear();
   commandBuffer->specialized_kernels.clear();
-  for (auto &buffer_memory_pair : commandBuffer->push_constant_objects) {
-    muxFreeMemory(commandBuffer->mux_device, buffer_memory_pair.memory,
-                  commandBuffer->allocator.getMuxAllocator());
-
-    muxDestroyBuffer(commandBuffer->mux_device, buffer_memory_pair.buffer,
-                     commandBuffer->allocator.getMuxAllocator());
+  // hand the push constant blocks back to the pool for reuse rather than
+  // destroying them, only primary command buffers record dispatches into them
+  if (commandBuffer->command_pool) {
+    commandBuffer->command_pool->releasePushConstantBlocks(
+        commandBuffer->mux_device, commandBuffer->push_constant_blocks);
   }
-  commandBuffer->push_constant_objects.clear();
+  commandBuffer->push_constant_block_offset = 0;
 
   return VK_SUCCESS;
 }
@@ -662,13 +662,24 @@ void CmdBindDescriptorSets(vk::command_buffer commandBuffer,
   }
 }
 
-void CmdDispatch(vk::command_buffer commandBuffer, uint32_t x, uint32_t y,
-                 uint32_t z) {
+namespace {
+/// @brief Record or execute a dispatch command, shared by vkCmdDispatch and
+/// vkCmdDispatchIndirect
+///
+/// @param commandBuffer Command buffer the dispatch is recorded into
+/// @param x Number of work-groups to dispatch in the X dimension
+/// @param y Number of work-groups to dispatch in the Y dimension
+/// @param z Number of work-groups to dispatch in the Z dimension
+/// @param command Command which replays the dispatch at submission
+/// @param indirect_buffer Buffer the number of work-groups is read from when
+/// the dispatch executes, or null for a direct dispatch
+/// @param indirect_offset Offset in bytes into `indirect_buffer`
+void Dispatch(vk::command_buffer commandBuffer, uint32_t x, uint32_t y,
+              uint32_t z, const vk::command_info &command,
+              mux_buffer_t indirect_buffer, uint64_t indirect_offset) {
   if (VK_COMMAND_BUFFER_LEVEL_SECONDARY ==
       commandBuffer->command_buffer_level) {
-    const vk::command_info_dispatch command = {x, y, z};
-    if (commandBuffer->compute_command_list->push_back(
-            vk::command_info(command))) {
+    if (commandBuffer->compute_command_list->push_back(command)) {
       commandBuffer->error = VK_ERROR_OUT_OF_HOST_MEMORY;
     }
   } else if (vk::command_buffer_t::recording == commandBuffer->state) {
@@ -703,102 +714,55 @@ void CmdDispatch(vk::command_buffer commandBuffer, uint32_t x, uint32_t y,
     }
 
     if (commandBuffer->total_push_constant_size) {
-      // create push constant buffer
-      mux_buffer_t push_constant_buffer;
-      mux_result_t error = muxCreateBuffer(
-          commandBuffer->mux_device, commandBuffer->total_push_constant_size,
-          commandBuffer->allocator.getMuxAllocator(), &push_constant_buffer);
-      if (error != mux_success) {
-        commandBuffer->error = getVkResult(error);
-        return;
-      }
-      mux::unique_ptr<mux_buffer_t> push_constant_buffer_ptr(
-          push_constant_buffer, {commandBuffer->mux_device,
-                                 commandBuffer->allocator.getMuxAllocator()});
-
-      // our push constant memory needs to be host visible, and we need to know
-      // whether future writes to it will need flushing
-      uint32_t memory_properties = mux_memory_property_host_visible;
-
-      if (commandBuffer->mux_device->info->allocation_capabilities &
-          mux_allocation_capabilities_coherent_host) {
-        memory_properties |= mux_memory_property_host_coherent;
-      } else if (commandBuffer->mux_device->info->allocation_capabilities &
-                 mux_allocation_capabilities_cached_host) {
-        memory_properties |= mux_memory_property_host_cached;
-      }
-
-      mux_memory_t push_constant_memory;
-      error = muxAllocateMemory(
-          commandBuffer->mux_device, commandBuffer->total_push_constant_size, 1,
-          memory_properties, mux_allocation_type_alloc_device, 0,
-          commandBuffer->allocator.getMuxAllocator(), &push_constant_memory);
-
-      if (error != mux_success) {
-        commandBuffer->error = getVkResult(error);
-        return;
-      }
-      mux::unique_ptr<mux_memory_t> push_constant_memory_ptr(
-          push_constant_memory, {commandBuffer->mux_device,
-                                 commandBuffer->allocator.getMuxAllocator()});
-
-      error =
-          muxBindBufferMemory(commandBuffer->mux_device, push_constant_memory,
-                              push_constant_buffer, 0);
-      if (error != mux_success) {
-        commandBuffer->error = getVkResult(error);
-        return;
-      }
-
-      const buffer_memory_pair push_constant_buffer_pair = {
-          push_constant_buffer, push_constant_memory};
-      if (commandBuffer->push_constant_objects.push_back(
-              push_constant_buffer_pair)) {
-        commandBuffer->error = VK_ERROR_OUT_OF_HOST_MEMORY;
-        return;
-      }
-
-      // Now that 'commandBuffer->push_constant_objects' is populated, the
-      // command buffer is responsible for the lifetime of these objects, so
-      // avoid a possible double free by releasing the unique_ptr's.
-      (void)push_constant_buffer_ptr.release();
-      (void)push_constant_memory_ptr.release();
-
-      // map memory and copy
-      void *push_constant_mapped_memory;
-      error = muxMapMemory(commandBuffer->mux_device, push_constant_memory, 0,
-                           commandBuffer->total_push_constant_size,
-                           &push_constant_mapped_memory);
-      if (error != mux_success) {
-        commandBuffer->error = getVkResult(error);
-        return;
+      // sub-allocate the push constants from the current block, starting a
+      // new block when they don't fit in what is left of it
+      const uint64_t size = commandBuffer->total_push_constant_size;
+      const uint64_t alignment = std::max<uint64_t>(
+          commandBuffer->mux_device->info->buffer_alignment, 1);
+      uint64_t offset =
+          ((commandBuffer->push_constant_block_offset + alignment - 1) /
+           alignment) *
+          alignment;
+
+      if (commandBuffer->push_constant_blocks.empty() ||
+          offset + size > commandBuffer->push_constant_blocks.back().size) {
+        // reserve space first so the acquired block can't be dropped
+        if (commandBuffer->push_constant_blocks.reserve(
+                commandBuffer->push_constant_blocks.size() + 1)) {
+          commandBuffer->error = VK_ERROR_OUT_OF_HOST_MEMORY;
+          return;
+        }
+        push_constant_block block;
+        if (auto error = commandBuffer->command_pool->acquirePushConstantBlock(
+                commandBuffer->mux_device, size, block)) {
+          commandBuffer->error = error;
+          return;
+        }
+        (void)commandBuffer->push_constant_blocks.push_back(block);
+        offset = 0;
       }
 
-      std::memcpy(push_constant_mapped_memory,
-                  commandBuffer->push_constants.data(),
-                  commandBuffer->total_push_constant_size);
+      const push_constant_block &block =
+          commandBuffer->push_constant_blocks.back();
+      std::memcpy(block.mapped + offset, commandBuffer->push_constants.data(),
+                  size);
 
-      if (push_constant_memory->properties & mux_memory_property_host_cached) {
-        error = muxFlushMappedMemoryToDevice(
-            commandBuffer->mux_device, push_constant_memory, 0,
-            commandBuffer->total_push_constant_size);
-        if (error != mux_success) {
+      if (block.memory->properties & mux_memory_property_host_cached) {
+        if (auto error = muxFlushMappedMemoryToDevice(
+                commandBuffer->mux_device, block.memory, offset, size)) {
           commandBuffer->error = getVkResult(error);
+          return;
         }
       }
 
-      error = muxUnmapMemory(commandBuffer->mux_device, push_constant_memory);
-      if (error != mux_success) {
-        commandBuffer->error = getVkResult(error);
-        return;
-      }
+      commandBuffer->push_constant_block_offset = offset + size;
 
       // add descriptor
       mux_descriptor_info_s push_constant_descriptor_info = {};
       mux_descriptor_info_buffer_s push_constant_buffer_info = {};
 
-      push_constant_buffer_info.buffer = push_constant_buffer;
-      push_constant_buffer_info.offset = 0;
+      push_constant_buffer_info.buffer = block.buffer;
+      push_constant_buffer_info.offset = offset;
 
       push_constant_descriptor_info.type = mux_descriptor_info_type_buffer;
       push_constant_descriptor_info.buffer_descriptor =
@@ -965,25 +929,31 @@ void CmdDispatch(vk::command_buffer commandBuffer, uint32_t x, uint32_t y,
     }
 
     // need to push the command here so that it gets executed in the submit
-    const vk::command_info_dispatch command = {x, y, z};
-    if (commandBuffer->commands.push_back(vk::command_info(command))) {
+    if (commandBuffer->commands.push_back(command)) {
       commandBuffer->error = VK_ERROR_OUT_OF_HOST_MEMORY;
     }
   } else {
     // Take the next kernel off the kernel list
     auto &specialized_kernel = *commandBuffer->specialized_kernels.begin();
+    mux_command_buffer_t mux_command_buffer = nullptr;
     if (command_buffer_t::pending == commandBuffer->state) {
-      if (auto error = muxCommandNDRange(
-              commandBuffer->compute_command_buffer,
-              specialized_kernel.getMuxKernel(),
-              specialized_kernel.getMuxNDRangeOptions(), 0, nullptr, nullptr)) {
-        commandBuffer->error = vk::getVkResult(error);
-      }
+      mux_command_buffer = commandBuffer->compute_command_buffer;
     } else if (command_buffer_t::resolving == commandBuffer->state) {
-      if (auto error = muxCommandNDRange(
-              commandBuffer->barrier_group_infos.back()->command_buffer,
-              specialized_kernel.getMuxKernel(),
-              specialized_kernel.getMuxNDRangeOptions(), 0, nullptr, nullptr)) {
+      mux_command_buffer =
+          commandBuffer->barrier_group_infos.back()->command_buffer;
+    }
+    if (mux_command_buffer) {
+      const mux_result_t error =
+          indirect_buffer
+              ? muxCommandNDRangeIndirect(
+                    mux_command_buffer, specialized_kernel.getMuxKernel(),
+                    specialized_kernel.getMuxNDRangeOptions(),
+                    indirect_buffer, indirect_offset, 0, nullptr, nullptr)
+              : muxCommandNDRange(
+                    mux_command_buffer, specialized_kernel.getMuxKernel(),
+                    specialized_kernel.getMuxNDRangeOptions(), 0, nullptr,
+                    nullptr);
+      if (error) {
         commandBuffer->error = vk::getVkResult(error);
       }
     }
@@ -1002,6 +972,13 @@ void CmdDispatch(vk::command_buffer commandBuffer, uint32_t x, uint32_t y,
         commandBuffer->specialized_kernels.begin());
   }
 }
+}  // namespace
+
+void CmdDispatch(vk::command_buffer commandBuffer, uint32_t x, uint32_t y,
+                 uint32_t z) {
+  const vk::command_info_dispatch command = {x, y, z};
+  Dispatch(commandBuffer, x, y, z, vk::command_info(command), nullptr, 0);
+}
 
 void ExecuteCommand(vk::command_buffer commandBuffer,
                     const vk::command_info &command_info) {
@@ -1026,6 +1003,9 @@ void ExecuteCommand(vk::command_buffer commandBuffer,
                       command_info.dispatch_command.z);
       break;
     case vk::command_type_dispatch_indirect:
+      vk::CmdDispatchIndirect(commandBuffer,
+                              command_info.dispatch_indirect_command.buffer,
+                              command_info.dispatch_indirect_command.offset);
       break;
     case vk::command_type_copy_buffer:
       vk::CmdCopyBuffer(commandBuffer,
@@ -1455,10 +1435,18 @@ void CmdPipelineBarrier(vk::command_buffer commandBuffer,
 
 void CmdDispatchIndirect(vk::command_buffer commandBuffer, vk::buffer buffer,
                          VkDeviceSize offset) {
-  (void)buffer;
-  (void)offset;
+  if (VK_COMMAND_BUFFER_LEVEL_PRIMARY == commandBuffer->command_buffer_level &&
+      !commandBuffer->mux_device->info->supports_indirect_ndrange) {
+    commandBuffer->error = VK_ERROR_FEATURE_NOT_PRESENT;
+    return;
+  }
 
-  commandBuffer->error = VK_ERROR_FEATURE_NOT_PRESENT;
+  // The number of work-groups is only known once the dispatch executes, so the
+  // kernel is specialized for a single work-group, every work-group of an
+  // indirect dispatch is a whole work-group of the pipeline's local size.
+  const vk::command_info_dispatch_indirect command = {buffer, offset};
+  Dispatch(commandBuffer, 1, 1, 1, vk::command_info(command),
+           buffer->mux_buffer, offset);
 }
 
 void CmdCopyImage(vk::command_buffer commandBuffer, vk::image srcImage,
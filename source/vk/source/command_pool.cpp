@@ -14,9 +14,13 @@
 //
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
+#include <mux/mux.hpp>
 #include <vk/command_buffer.h>
 #include <vk/command_pool.h>
 #include <vk/device.h>
+#include <vk/error.h>
+
+#include <algorithm>
 
 namespace vk {
 command_pool_t::command_pool_t(VkCommandPoolCreateFlags flags,
@@ -26,10 +30,96 @@ command_pool_t::command_pool_t(VkCommandPoolCreateFlags flags,
           {allocator.getCallbacks(), VK_SYSTEM_ALLOCATION_SCOPE_OBJECT}),
       flags(flags),
       queueFamilyIndex(queueFamilyIndex),
-      allocator(allocator) {}
+      allocator(allocator),
+      free_push_constant_blocks(
+          {allocator.getCallbacks(), VK_SYSTEM_ALLOCATION_SCOPE_OBJECT}) {}
 
 command_pool_t::~command_pool_t() {}
 
+VkResult command_pool_t::acquirePushConstantBlock(
+    mux_device_t mux_device, uint64_t size, push_constant_block &out_block) {
+  auto found = std::find_if(
+      free_push_constant_blocks.begin(), free_push_constant_blocks.end(),
+      [size](const push_constant_block &block) { return block.size >= size; });
+  if (found != free_push_constant_blocks.end()) {
+    out_block = *found;
+    free_push_constant_blocks.erase(found);
+    return VK_SUCCESS;
+  }
+
+  const uint64_t block_size =
+      std::max<uint64_t>(size, CA_VK_PUSH_CONSTANT_BLOCK_SIZE);
+
+  mux_buffer_t buffer;
+  if (auto error = muxCreateBuffer(mux_device, block_size,
+                                   allocator.getMuxAllocator(), &buffer)) {
+    return vk::getVkResult(error);
+  }
+  mux::unique_ptr<mux_buffer_t> buffer_ptr(
+      buffer, {mux_device, allocator.getMuxAllocator()});
+
+  // our push constant memory needs to be host visible, and we need to know
+  // whether writes to it will need flushing
+  uint32_t memory_properties = mux_memory_property_host_visible;
+
+  if (mux_device->info->allocation_capabilities &
+      mux_allocation_capabilities_coherent_host) {
+    memory_properties |= mux_memory_property_host_coherent;
+  } else if (mux_device->info->allocation_capabilities &
+             mux_allocation_capabilities_cached_host) {
+    memory_properties |= mux_memory_property_host_cached;
+  }
+
+  // sub-allocations are aligned to the device's buffer alignment relative to
+  // the start of the block, so the block itself must be aligned to it too
+  mux_memory_t memory;
+  if (auto error = muxAllocateMemory(
+          mux_device, block_size, 1, memory_properties,
+          mux_allocation_type_alloc_device, mux_device->info->buffer_alignment,
+          allocator.getMuxAllocator(), &memory)) {
+    return vk::getVkResult(error);
+  }
+  mux::unique_ptr<mux_memory_t> memory_ptr(
+      memory, {mux_device, allocator.getMuxAllocator()});
+
+  if (auto error = muxBindBufferMemory(mux_device, memory, buffer, 0)) {
+    return vk::getVkResult(error);
+  }
+
+  void *mapped;
+  if (auto error = muxMapMemory(mux_device, memory, 0, block_size, &mapped)) {
+    return vk::getVkResult(error);
+  }
+
+  out_block.buffer = buffer_ptr.release();
+  out_block.memory = memory_ptr.release();
+  out_block.mapped = static_cast<uint8_t *>(mapped);
+  out_block.size = block_size;
+  return VK_SUCCESS;
+}
+
+void command_pool_t::releasePushConstantBlocks(
+    mux_device_t mux_device, vk::small_vector<push_constant_block, 2> &blocks) {
+  for (auto &block : blocks) {
+    if (free_push_constant_blocks.push_back(block)) {
+      // we couldn't keep hold of the block, so don't leak it
+      muxUnmapMemory(mux_device, block.memory);
+      muxFreeMemory(mux_device, block.memory, allocator.getMuxAllocator());
+      muxDestroyBuffer(mux_device, block.buffer, allocator.getMuxAllocator());
+    }
+  }
+  blocks.clear();
+}
+
+void command_pool_t::destroyPushConstantBlocks(mux_device_t mux_device) {
+  for (auto &block : free_push_constant_blocks) {
+    muxUnmapMemory(mux_device, block.memory);
+    muxFreeMemory(mux_device, block.memory, allocator.getMuxAllocator());
+    muxDestroyBuffer(mux_device, block.buffer, allocator.getMuxAllocator());
+  }
+  free_push_constant_blocks.clear();
+}
+
 VkResult CreateCommandPool(vk::device device,
                            const VkCommandPoolCreateInfo *pCreateInfo,
                            vk::allocator allocator,
@@ -57,15 +147,19 @@ void DestroyCommandPool(vk::device device, vk::command_pool commandPool,
     FreeCommandBuffers(device, commandPool, commandPool->command_buffers.size(),
                        commandPool->command_buffers.data());
   }
+  commandPool->destroyPushConstantBlocks(device->mux_device);
   allocator.destroy(commandPool);
 }
 
 VkResult ResetCommandPool(vk::device device, vk::command_pool commandPool,
                           VkCommandPoolResetFlags flags) {
-  (void)flags;
   for (vk::command_buffer command_buffer : commandPool->command_buffers) {
     command_buffer->descriptor_sets.clear();
 
+    commandPool->releasePushConstantBlocks(
+        device->mux_device, command_buffer->push_constant_blocks);
+    command_buffer->push_constant_block_offset = 0;
+
     for (auto &barrier_info : command_buffer->barrier_group_infos) {
       muxDestroyCommandBuffer(device->mux_device, barrier_info->command_buffer,
                               commandPool->allocator.getMuxAllocator());
@@ -87,6 +181,10 @@ VkResult ResetCommandPool(vk::device device, vk::command_pool commandPool,
     command_buffer->error = VK_SUCCESS;
     command_buffer->state = command_buffer_t::initial;
   }
+
+  if (flags & VK_COMMAND_POOL_RESET_RELEASE_RESOURCES_BIT) {
+    commandPool->destroyPushConstantBlocks(device->mux_device);
+  }
   return VK_SUCCESS;
 }
 }  // namespace vk
@@ -0,0 +1,250 @@
+// Copyright (C) Codeplay Software Limited
+//
+// Licensed under the Apache License, Version 2.0 (the "License") with LLVM
+// Exceptions; you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     https://github.com/codeplaysoftware/oneapi-construction-kit/blob/main/LICENSE.txt
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations
+// under the License.
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <UnitVK.h>
+
+#include <array>
+#include <cstring>
+
+// https://www.khronos.org/registry/vulkan/specs/1.0/xhtml/vkspec.html#vkCmdDispatchIndirect
+
+class CmdDispatchIndirect : public uvk::PipelineTest,
+                            public uvk::DescriptorSetLayoutTest,
+                            public uvk::DescriptorPoolTest,
+                            public uvk::DeviceMemoryTest,
+                            public uvk::BufferTest {
+ public:
+  CmdDispatchIndirect()
+      : DescriptorSetLayoutTest(true),
+        DescriptorPoolTest(true),
+        DeviceMemoryTest(true),
+        BufferTest(0,
+                   VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+                       VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT |
+                       VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                   true),
+        indirectBuffer(VK_NULL_HANDLE),
+        indirectOffset(0),
+        descriptorSet(VK_NULL_HANDLE) {}
+
+  virtual void SetUp() override {
+    RETURN_ON_FATAL_FAILURE(DeviceTest::SetUp());
+
+    vkGetDeviceQueue(device, 0, 0, &queue);
+  }
+
+  virtual void TearDown() override {
+    if (indirectBuffer) {
+      vkDestroyBuffer(device, indirectBuffer, nullptr);
+      BufferTest::TearDown();
+      DeviceMemoryTest::TearDown();
+      DescriptorPoolTest::TearDown();
+      DescriptorSetLayoutTest::TearDown();
+    }
+    PipelineTest::TearDown();
+  }
+
+  /// @brief Create a pipeline for `dispatchShader` writing to a storage
+  /// buffer of `outSize` bytes, and a buffer holding the dispatch parameters.
+  ///
+  /// The parameters are preceded by a different `VkDispatchIndirectCommand`,
+  /// so a dispatch which ignores the offset reads the wrong work-group count.
+  void SetUpDispatch(uvk::Shader dispatchShader, uint32_t outSize,
+                     const VkDispatchIndirectCommand &params) {
+    RETURN_ON_FATAL_FAILURE(DescriptorSetLayoutTest::SetUp());
+
+    PipelineTest::shader = dispatchShader;
+    pipelineLayoutCreateInfo.setLayoutCount = 1;
+    pipelineLayoutCreateInfo.pSetLayouts = &descriptorSetLayout;
+    RETURN_ON_FATAL_FAILURE(PipelineTest::SetUp());
+
+    bufferSize = outSize;
+    RETURN_ON_FATAL_FAILURE(BufferTest::SetUp());
+    const VkDeviceSize outRequiredSize = bufferMemoryRequirements.size;
+
+    const std::array<VkDispatchIndirectCommand, 2> allParams = {
+        {{1, 1, 1}, params}};
+    bufferCreateInfo.size = sizeof(allParams);
+    ASSERT_EQ_RESULT(VK_SUCCESS, vkCreateBuffer(device, &bufferCreateInfo,
+                                                nullptr, &indirectBuffer));
+    vkGetBufferMemoryRequirements(device, indirectBuffer,
+                                  &bufferMemoryRequirements);
+    indirectOffset = sizeof(VkDispatchIndirectCommand);
+
+    memorySize = outRequiredSize + bufferMemoryRequirements.size;
+    RETURN_ON_FATAL_FAILURE(DeviceMemoryTest::SetUp());
+    ASSERT_EQ_RESULT(VK_SUCCESS, vkBindBufferMemory(device, buffer, memory, 0));
+    ASSERT_EQ_RESULT(VK_SUCCESS, vkBindBufferMemory(device, indirectBuffer,
+                                                    memory, outRequiredSize));
+
+    // Fill the output with a value no work-item writes, so work-groups which
+    // shouldn't have run are detected too.
+    void *mappedMemory;
+    DeviceMemoryTest::mapMemory(0, VK_WHOLE_SIZE, &mappedMemory);
+    std::memset(mappedMemory, 0xFF, outSize);
+    std::memcpy(static_cast<char *>(mappedMemory) + outRequiredSize,
+                allParams.data(), sizeof(allParams));
+    DeviceMemoryTest::unmapMemory();
+
+    RETURN_ON_FATAL_FAILURE(DescriptorPoolTest::SetUp());
+
+    VkDescriptorSetAllocateInfo dSetAllocInf = {};
+    dSetAllocInf.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    dSetAllocInf.descriptorPool = descriptorPool;
+    dSetAllocInf.descriptorSetCount = 1;
+    dSetAllocInf.pSetLayouts = &descriptorSetLayout;
+
+    ASSERT_EQ_RESULT(VK_SUCCESS, vkAllocateDescriptorSets(
+                                     device, &dSetAllocInf, &descriptorSet));
+
+    VkDescriptorBufferInfo bufferInfo = {};
+    bufferInfo.buffer = buffer;
+    bufferInfo.offset = 0;
+    bufferInfo.range = VK_WHOLE_SIZE;
+
+    VkWriteDescriptorSet write = {};
+    write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    write.descriptorCount = 1;
+    write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    write.dstArrayElement = 0;
+    write.dstBinding = 0;
+    write.dstSet = descriptorSet;
+    write.pBufferInfo = &bufferInfo;
+
+    vkUpdateDescriptorSets(device, 1, &write, 0, nullptr);
+  }
+
+  /// @brief Record the indirect dispatch into `cmdBuffer`.
+  void RecordDispatch(VkCommandBuffer cmdBuffer) {
+    vkCmdBindDescriptorSets(cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE,
+                            pipelineLayout, 0, 1, &descriptorSet, 0, nullptr);
+    vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+    vkCmdDispatchIndirect(cmdBuffer, indirectBuffer, indirectOffset);
+  }
+
+  /// @brief End `commandBuffer`, submit it and wait for it to complete.
+  ///
+  /// Skips the test if the device can't execute indirect dispatches.
+  void Submit() {
+    const VkResult result = vkEndCommandBuffer(commandBuffer);
+    if (VK_ERROR_FEATURE_NOT_PRESENT == result) {
+      GTEST_SKIP();
+    }
+    ASSERT_EQ_RESULT(VK_SUCCESS, result);
+
+    VkSubmitInfo submit = {};
+    submit.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submit.commandBufferCount = 1;
+    submit.pCommandBuffers = &commandBuffer;
+
+    ASSERT_EQ_RESULT(VK_SUCCESS,
+                     vkQueueSubmit(queue, 1, &submit, VK_NULL_HANDLE));
+    ASSERT_EQ_RESULT(VK_SUCCESS, vkQueueWaitIdle(queue));
+  }
+
+  VkQueue queue;
+  VkBuffer indirectBuffer;
+  VkDeviceSize indirectOffset;
+  VkDescriptorSet descriptorSet;
+};
+
+TEST_F(CmdDispatchIndirect, glNumWorkGroups) {
+  const VkDispatchIndirectCommand params = {42, 1, 24};
+  RETURN_ON_FATAL_FAILURE(SetUpDispatch(uvk::Shader::num_work_groups,
+                                        sizeof(uint32_t) * 3, params));
+
+  RecordDispatch(commandBuffer);
+  Submit();
+  if (IsSkipped() || HasFatalFailure()) {
+    return;
+  }
+
+  void *mappedMemory;
+  DeviceMemoryTest::mapMemory(0, VK_WHOLE_SIZE, &mappedMemory);
+  const uint32_t *output = static_cast<uint32_t *>(mappedMemory);
+  EXPECT_EQ(params.x, output[0]);
+  EXPECT_EQ(params.y, output[1]);
+  EXPECT_EQ(params.z, output[2]);
+  DeviceMemoryTest::unmapMemory();
+}
+
+TEST_F(CmdDispatchIndirect, glWorkGroupID) {
+  // The shader has a local size of four, dispatch two work-groups into a
+  // buffer with room for three so an extra work-group would be seen.
+  const VkDispatchIndirectCommand params = {2, 1, 1};
+  RETURN_ON_FATAL_FAILURE(SetUpDispatch(uvk::Shader::work_group_id,
+                                        sizeof(uint32_t) * 12, params));
+
+  RecordDispatch(commandBuffer);
+  Submit();
+  if (IsSkipped() || HasFatalFailure()) {
+    return;
+  }
+
+  void *mappedMemory;
+  DeviceMemoryTest::mapMemory(0, VK_WHOLE_SIZE, &mappedMemory);
+  const uint32_t *output = static_cast<uint32_t *>(mappedMemory);
+  for (uint32_t index = 0; index < 12; index++) {
+    const uint32_t expected = index < 8 ? index / 4 : 0xFFFFFFFF;
+    EXPECT_EQ(expected, output[index]) << "at index " << index;
+  }
+  DeviceMemoryTest::unmapMemory();
+}
+
+TEST_F(CmdDispatchIndirect, glNumWorkGroupsSecondaryCommandBuffer) {
+  const VkDispatchIndirectCommand params = {3, 5, 7};
+  RETURN_ON_FATAL_FAILURE(SetUpDispatch(uvk::Shader::num_work_groups,
+                                        sizeof(uint32_t) * 3, params));
+
+  VkCommandBufferAllocateInfo allocInf = {};
+  allocInf.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+  allocInf.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+  allocInf.commandPool = commandPool;
+  allocInf.commandBufferCount = 1;
+
+  VkCommandBuffer secondaryCommandBuffer;
+  ASSERT_EQ_RESULT(VK_SUCCESS, vkAllocateCommandBuffers(
+                                   device, &allocInf, &secondaryCommandBuffer));
+
+  VkCommandBufferInheritanceInfo inheritInfo = {};
+  inheritInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+  inheritInfo.framebuffer = VK_NULL_HANDLE;
+  inheritInfo.occlusionQueryEnable = VK_FALSE;
+
+  VkCommandBufferBeginInfo beginInfo = {};
+  beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+  beginInfo.pInheritanceInfo = &inheritInfo;
+
+  ASSERT_EQ_RESULT(VK_SUCCESS,
+                   vkBeginCommandBuffer(secondaryCommandBuffer, &beginInfo));
+  RecordDispatch(secondaryCommandBuffer);
+  ASSERT_EQ_RESULT(VK_SUCCESS, vkEndCommandBuffer(secondaryCommandBuffer));
+
+  vkCmdExecuteCommands(commandBuffer, 1, &secondaryCommandBuffer);
+  Submit();
+  vkFreeCommandBuffers(device, commandPool, 1, &secondaryCommandBuffer);
+  if (IsSkipped() || HasFatalFailure()) {
+    return;
+  }
+
+  void *mappedMemory;
+  DeviceMemoryTest::mapMemory(0, VK_WHOLE_SIZE, &mappedMemory);
+  const uint32_t *output = static_cast<uint32_t *>(mappedMemory);
+  EXPECT_EQ(params.x, output[0]);
+  EXPECT_EQ(params.y, output[1]);
+  EXPECT_EQ(params.z, output[2]);
+  DeviceMemoryTest::unmapMemory();
+}